@@ -0,0 +1,125 @@
+/* address_index.cc - Virtual address <-> file offset translation */
+#include <address_index.hh>
+
+#include <algorithm>
+
+address_index_t::address_index_t(std::vector<address_range_t> ranges) :
+	_ranges{std::move(ranges)}, _by_offset{}, _reach{}, _shared{} {
+
+	for(auto& range : _ranges)
+		range.file_size = std::min(range.file_size, range.mem_size);
+	_ranges.erase(std::remove_if(_ranges.begin(), _ranges.end(),
+		[](const address_range_t& range) { return range.mem_size == 0; }), _ranges.end());
+	std::sort(_ranges.begin(), _ranges.end(), [](const address_range_t& a, const address_range_t& b) {
+		return (a.address != b.address) ? a.address < b.address : a.index < b.index;
+	});
+
+	/* Whatever comes first keeps an overlap, the one before it gets cut short */
+	size_t kept{};
+	for(size_t idx{}; idx < _ranges.size(); ++idx) {
+		if(kept != 0) {
+			auto& previous = _ranges[kept - 1];
+			if(previous.address + previous.mem_size > _ranges[idx].address) {
+				previous.mem_size = _ranges[idx].address - previous.address;
+				previous.file_size = std::min(previous.file_size, previous.mem_size);
+				if(previous.mem_size == 0)
+					--kept;
+			}
+		}
+		_ranges[kept++] = _ranges[idx];
+	}
+	_ranges.resize(kept);
+
+	for(size_t idx{}; idx < _ranges.size(); ++idx) {
+		if(_ranges[idx].file_size != 0)
+			_by_offset.push_back(uint32_t(idx));
+	}
+	/* Ties go to the lower address, which is already the lower index */
+	std::stable_sort(_by_offset.begin(), _by_offset.end(), [this](const uint32_t a, const uint32_t b) {
+		return _ranges[a].offset < _ranges[b].offset;
+	});
+
+	_reach.resize(_by_offset.size());
+	_shared.resize(_ranges.size());
+	uint64_t reach{};
+	for(size_t idx{}; idx < _by_offset.size(); ++idx) {
+		const auto& range = _ranges[_by_offset[idx]];
+		if(idx != 0 && reach > range.offset) {
+			_shared[_by_offset[idx]] = 1U;
+			/* Anything still reaching this far overlaps it too */
+			for(size_t prior{idx}; prior-- > 0 && _reach[prior] > range.offset;) {
+				const auto& other = _ranges[_by_offset[prior]];
+				if(other.offset + other.file_size > range.offset)
+					_shared[_by_offset[prior]] = 1U;
+			}
+		}
+		reach = std::max(reach, range.offset + range.file_size);
+		_reach[idx] = reach;
+	}
+}
+
+const address_range_t* address_index_t::search_address(const uint64_t address) const noexcept {
+	const auto next = std::upper_bound(_ranges.begin(), _ranges.end(), address,
+		[](const uint64_t value, const address_range_t& range) { return value < range.address; });
+	if(next == _ranges.begin())
+		return nullptr;
+	const auto& range = *(next - 1);
+	return range.contains_address(address) ? &range : nullptr;
+}
+
+const address_range_t* address_index_t::search_offset(const uint64_t offset) const noexcept {
+	const auto next = std::upper_bound(_by_offset.begin(), _by_offset.end(), offset,
+		[this](const uint64_t value, const uint32_t range) { return value < _ranges[range].offset; });
+
+	/* Ranges starting earlier can still cover it, but only back as far as something reaches */
+	const address_range_t* found{nullptr};
+	for(size_t idx{size_t(next - _by_offset.begin())}; idx-- > 0 && _reach[idx] > offset;) {
+		const auto& range = _ranges[_by_offset[idx]];
+		if(range.contains_offset(offset) && (found == nullptr || range.address < found->address))
+			found = &range;
+	}
+	return found;
+}
+
+uint64_t address_index_t::to_offset(const uint64_t address) const noexcept {
+	const auto* range = search_address(address);
+	if(range == nullptr || (address - range->address) >= range->file_size)
+		return npos;
+	return range->offset + (address - range->address);
+}
+
+uint64_t address_index_t::to_address(const uint64_t offset) const noexcept {
+	const auto* range = search_offset(offset);
+	if(range == nullptr)
+		return npos;
+	return range->address + (offset - range->offset);
+}
+
+void address_index_t::to_offsets(const uint64_t* addresses, const size_t count, uint64_t* offsets) const noexcept {
+	const address_range_t* last{nullptr};
+	for(size_t idx{}; idx < count; ++idx) {
+		const uint64_t address{addresses[idx]};
+		if(last == nullptr || !last->contains_address(address))
+			last = search_address(address);
+		offsets[idx] = (last == nullptr || (address - last->address) >= last->file_size) ?
+			npos : last->offset + (address - last->address);
+	}
+}
+
+void address_index_t::to_addresses(const uint64_t* offsets, const size_t count, uint64_t* addresses) const noexcept {
+	const address_range_t* last{nullptr};
+	for(size_t idx{}; idx < count; ++idx) {
+		const uint64_t offset{offsets[idx]};
+		/* Shared file ranges have to be searched to find the right one */
+		if(last == nullptr || !last->contains_offset(offset) || _shared[size_t(last - _ranges.data())] != 0)
+			last = search_offset(offset);
+		addresses[idx] = (last == nullptr) ? npos : last->address + (offset - last->offset);
+	}
+}
+
+uint64_t address_index_t::file_extent(const uint64_t address) const noexcept {
+	const auto* range = search_address(address);
+	if(range == nullptr || (address - range->address) >= range->file_size)
+		return 0;
+	return range->file_size - (address - range->address);
+}
@@ -0,0 +1,254 @@
+/* codec.cc - Common interface over the section compression backends */
+#include <codec.hh>
+#include <zlib.hh>
+#include <zstd.hh>
+
+#include <cmath>
+
+const std::array<const enum_pair_t<codec_type_t>, 3> codec_type_s{{
+	{ codec_type_t::None, "None" },
+	{ codec_type_t::Zlib, "Zlib" },
+	{ codec_type_t::Zstd, "Zstd" },
+}};
+std::ostream& operator<<(std::ostream& out, const codec_type_t& codec) {
+	return (out << enum_name(codec_type_s, codec));
+}
+
+struct zlib_codec_t final : public codec_t {
+	codec_type_t type() const noexcept override { return codec_type_t::Zlib; }
+
+	int32_t min_level() const noexcept override { return Z_BEST_SPEED; }
+	int32_t max_level() const noexcept override { return Z_BEST_COMPRESSION; }
+	int32_t default_level() const noexcept override { return Z_BEST_COMPRESSION; }
+	int32_t fast_level() const noexcept override { return Z_BEST_SPEED; }
+	int32_t strong_level() const noexcept override { return Z_BEST_COMPRESSION; }
+
+	bool decompress(const uint8_t* input, const size_t input_len,
+		uint8_t* output, const size_t output_len) const noexcept override {
+		return zlib_t::inflate_buffer(input, input_len, output, output_len);
+	}
+
+	std::vector<uint8_t> compress(const uint8_t* input, const size_t input_len,
+		const int32_t level) const override {
+		return zlib_t::deflate_buffer(input, input_len, level);
+	}
+
+	bool decompress(const uint8_t* input, const size_t input_len, uint8_t* output,
+		const size_t output_len, const codec_dictionary_t& dictionary) const noexcept override {
+		if(dictionary.codec() != codec_type_t::Zlib)
+			return false;
+		return zlib_t::inflate_buffer(input, input_len, output, output_len,
+			dictionary.contents().data(), dictionary.contents().size());
+	}
+
+	std::vector<uint8_t> compress(const uint8_t* input, const size_t input_len,
+		const int32_t level, const codec_dictionary_t& dictionary) const override {
+		if(dictionary.codec() != codec_type_t::Zlib)
+			return {};
+		return zlib_t::deflate_buffer(input, input_len, dictionary.contents().data(),
+			dictionary.contents().size(), level);
+	}
+
+	uint32_t dictionary_id(const uint8_t* input, const size_t input_len) const noexcept override {
+		return zlib_t::dictionary_id(input, input_len);
+	}
+
+	codec_dictionary_t dictionary(std::vector<uint8_t> contents) const override {
+		if(contents.empty() || contents.size() > zlib_t::max_dictionary)
+			return {};
+		const uint32_t id{zlib_t::adler32(contents.data(), contents.size())};
+		return {codec_type_t::Zlib, id, std::move(contents)};
+	}
+
+	codec_dictionary_t train(const std::vector<span<const uint8_t>>& samples,
+		const size_t capacity) const override {
+		return dictionary(zlib_t::train_dictionary(samples, capacity));
+	}
+
+	size_t default_dictionary_size() const noexcept override { return zlib_t::max_dictionary; }
+};
+
+#if defined(SNS_WITH_ZSTD)
+struct zstd_codec_t final : public codec_t {
+	codec_type_t type() const noexcept override { return codec_type_t::Zstd; }
+
+	int32_t min_level() const noexcept override { return zstd_t::min_level(); }
+	int32_t max_level() const noexcept override { return zstd_t::max_level(); }
+	int32_t default_level() const noexcept override { return ZSTD_CLEVEL_DEFAULT; }
+	int32_t fast_level() const noexcept override { return 1; }
+	/* Past 19 are the "ultra" levels, which need far more memory to decode */
+	int32_t strong_level() const noexcept override { return 19; }
+
+	bool decompress(const uint8_t* input, const size_t input_len,
+		uint8_t* output, const size_t output_len) const noexcept override {
+		return zstd_t::decompress_buffer(input, input_len, output, output_len);
+	}
+
+	std::vector<uint8_t> compress(const uint8_t* input, const size_t input_len,
+		const int32_t level) const override {
+		return zstd_t::compress_buffer(input, input_len, level);
+	}
+
+	bool decompress(const uint8_t* input, const size_t input_len, uint8_t* output,
+		const size_t output_len, const codec_dictionary_t& dictionary) const noexcept override {
+		if(dictionary.codec() != codec_type_t::Zstd)
+			return false;
+		return zstd_t::decompress_buffer(input, input_len, output, output_len,
+			dictionary.contents().data(), dictionary.contents().size());
+	}
+
+	std::vector<uint8_t> compress(const uint8_t* input, const size_t input_len,
+		const int32_t level, const codec_dictionary_t& dictionary) const override {
+		if(dictionary.codec() != codec_type_t::Zstd)
+			return {};
+		return zstd_t::compress_buffer(input, input_len, dictionary.contents().data(),
+			dictionary.contents().size(), level);
+	}
+
+	uint32_t dictionary_id(const uint8_t* input, const size_t input_len) const noexcept override {
+		return zstd_t::dictionary_id(input, input_len);
+	}
+
+	codec_dictionary_t dictionary(std::vector<uint8_t> contents) const override {
+		if(contents.empty())
+			return {};
+		const uint32_t id{zstd_t::dictionary_header_id(contents.data(), contents.size())};
+		return {codec_type_t::Zstd, id, std::move(contents)};
+	}
+
+	codec_dictionary_t train(const std::vector<span<const uint8_t>>& samples,
+		const size_t capacity) const override {
+		return dictionary(zstd_t::train_dictionary(samples, capacity));
+	}
+
+	size_t default_dictionary_size() const noexcept override { return zstd_t::default_dictionary; }
+};
+#endif
+
+const codec_t* get_codec(const codec_type_t type) noexcept {
+	static const zlib_codec_t zlib_codec{};
+#if defined(SNS_WITH_ZSTD)
+	static const zstd_codec_t zstd_codec{};
+#endif
+
+	switch(type) {
+		case codec_type_t::Zlib:
+			return &zlib_codec;
+#if defined(SNS_WITH_ZSTD)
+		case codec_type_t::Zstd:
+			return &zstd_codec;
+#endif
+		default:
+			return nullptr;
+	}
+}
+
+dictionary_store_t::dictionary_ptr dictionary_store_t::add(codec_dictionary_t dictionary) {
+	if(dictionary.empty() || dictionary.id() == 0)
+		return {};
+
+	const uint64_t entry{key(dictionary.codec(), dictionary.id())};
+	std::lock_guard<std::mutex> guard{_lock};
+	auto existing = _dictionaries.find(entry);
+	if(existing != _dictionaries.end())
+		return existing->second;
+	return _dictionaries.emplace(entry,
+		std::make_shared<const codec_dictionary_t>(std::move(dictionary))).first->second;
+}
+
+dictionary_store_t::dictionary_ptr dictionary_store_t::find(const codec_type_t codec,
+	const uint32_t id) const noexcept {
+	std::lock_guard<std::mutex> guard{_lock};
+	auto dictionary = _dictionaries.find(key(codec, id));
+	if(dictionary == _dictionaries.end())
+		return {};
+	return dictionary->second;
+}
+
+bool dictionary_store_t::decompress(const codec_type_t codec, const uint8_t* input,
+	const size_t input_len, uint8_t* output, const size_t output_len) const noexcept {
+
+	const codec_t* decoder{get_codec(codec)};
+	if(decoder == nullptr)
+		return false;
+
+	const uint32_t id{decoder->dictionary_id(input, input_len)};
+	if(id == 0)
+		return decoder->decompress(input, input_len, output, output_len);
+
+	const auto dictionary = find(codec, id);
+	if(!dictionary)
+		return false;
+	return decoder->decompress(input, input_len, output, output_len, *dictionary);
+}
+
+double byte_entropy(const uint8_t* data, const size_t len) noexcept {
+	if(len == 0)
+		return 0.0;
+
+	/* Spread the counts over a few tables so repeated bytes don't serialize */
+	std::array<std::array<uint32_t, 256>, 4> counts{};
+	size_t idx{};
+	for(; idx + 4 <= len; idx += 4) {
+		++counts[0][data[idx + 0]];
+		++counts[1][data[idx + 1]];
+		++counts[2][data[idx + 2]];
+		++counts[3][data[idx + 3]];
+	}
+	for(; idx < len; ++idx)
+		++counts[0][data[idx]];
+
+	double entropy{};
+	for(size_t byte{}; byte < 256; ++byte) {
+		const uint64_t count{uint64_t(counts[0][byte]) + counts[1][byte] + counts[2][byte] + counts[3][byte]};
+		if(count == 0)
+			continue;
+		const double probability{double(count) / double(len)};
+		entropy -= probability * std::log2(probability);
+	}
+	return entropy;
+}
+
+const codec_t* compression_policy_t::codec() const noexcept {
+	if(const codec_t* codec = get_codec(_preferred))
+		return codec;
+	return get_codec(codec_type_t::Zlib);
+}
+
+codec_choice_t compression_policy_t::choose(const uint8_t* data, const size_t len) const {
+	codec_choice_t choice{codec_type_t::None, 0, 0.0, 1.0};
+	const codec_t* codec{this->codec()};
+	if(codec == nullptr || len < _min_size || len == 0)
+		return choice;
+
+	/* Evenly spaced blocks, or the whole thing if it's small enough */
+	std::vector<uint8_t> sample{};
+	const size_t blocks{std::max<size_t>(_sample_blocks, 1)};
+	const size_t block_size{std::max<size_t>(_block_size, 1)};
+	if(len <= blocks * block_size) {
+		sample.assign(data, data + len);
+	} else {
+		sample.reserve(blocks * block_size);
+		const size_t stride{(len - block_size) / (blocks - ((blocks > 1) ? 1 : 0))};
+		for(size_t block{}; block < blocks; ++block) {
+			const uint8_t* start{data + std::min(block * stride, len - block_size)};
+			sample.insert(sample.end(), start, start + block_size);
+		}
+	}
+
+	choice.entropy = byte_entropy(sample.data(), sample.size());
+	if(choice.entropy >= _max_entropy)
+		return choice;
+
+	const auto trial = codec->compress(sample.data(), sample.size(), codec->fast_level());
+	if(trial.empty())
+		return choice;
+
+	choice.ratio = double(trial.size()) / double(sample.size());
+	if(choice.ratio > (1.0 - _min_gain))
+		return choice;
+
+	choice.codec = codec->type();
+	choice.level = (choice.ratio <= _strong_ratio) ? codec->strong_level() : codec->fast_level();
+	return choice;
+}
@@ -0,0 +1,700 @@
+/* dwarf.cc - DWARF line tables and address to source line lookup */
+#include <dwarf.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+/* Just the DW_FORM_* values that get read or skipped here */
+enum class dwarf_form_t : uint16_t {
+	Addr          = 0x01U,
+	Block2        = 0x03U,
+	Block4        = 0x04U,
+	Data2         = 0x05U,
+	Data4         = 0x06U,
+	Data8         = 0x07U,
+	String        = 0x08U,
+	Block         = 0x09U,
+	Block1        = 0x0AU,
+	Data1         = 0x0BU,
+	Flag          = 0x0CU,
+	SData         = 0x0DU,
+	StrP          = 0x0EU,
+	UData         = 0x0FU,
+	RefAddr       = 0x10U,
+	Ref1          = 0x11U,
+	Ref2          = 0x12U,
+	Ref4          = 0x13U,
+	Ref8          = 0x14U,
+	RefUData      = 0x15U,
+	Indirect      = 0x16U,
+	SecOffset     = 0x17U,
+	ExprLoc       = 0x18U,
+	FlagPresent   = 0x19U,
+	StrX          = 0x1AU,
+	AddrX         = 0x1BU,
+	RefSup4       = 0x1CU,
+	StrPSup       = 0x1DU,
+	Data16        = 0x1EU,
+	LineStrP      = 0x1FU,
+	RefSig8       = 0x20U,
+	ImplicitConst = 0x21U,
+	LocListX      = 0x22U,
+	RngListX      = 0x23U,
+	RefSup8       = 0x24U,
+	StrX1         = 0x25U,
+	StrX2         = 0x26U,
+	StrX3         = 0x27U,
+	StrX4         = 0x28U,
+	AddrX1        = 0x29U,
+	AddrX2        = 0x2AU,
+	AddrX3        = 0x2BU,
+	AddrX4        = 0x2CU,
+	GNURefAlt     = 0x1F20U,
+	GNUStrPAlt    = 0x1F21U,
+};
+
+static constexpr uint64_t dw_at_stmt_list{0x10U};
+static constexpr uint64_t dw_lnct_path{0x01U};
+static constexpr uint64_t dw_lnct_directory_index{0x02U};
+static constexpr uint64_t no_unit{std::numeric_limits<uint64_t>::max()};
+
+/* Enough of a unit's header to read forms out of it */
+struct dwarf_format_t final {
+	size_t offset_size;   /* 4, or 8 for 64-bit DWARF */
+	size_t address_size;
+	uint16_t version;
+};
+
+/* Little endian, `size` being at most 8 */
+static bool read_sized(const uint8_t* data, const size_t end, size_t& pos, const size_t size, uint64_t& value) noexcept {
+	if(pos > end || size > (end - pos) || size > sizeof(uint64_t))
+		return false;
+	value = 0;
+	std::memcpy(&value, data + pos, size);
+	pos += size;
+	return true;
+}
+
+template<typename U>
+static bool read_fixed(const uint8_t* data, const size_t end, size_t& pos, U& value) noexcept {
+	if(pos > end || sizeof(U) > (end - pos))
+		return false;
+	std::memcpy(&value, data + pos, sizeof(U));
+	pos += sizeof(U);
+	return true;
+}
+
+static bool read_cstring(const uint8_t* data, const size_t end, size_t& pos, std::string_view& str) noexcept {
+	if(pos >= end)
+		return false;
+	const auto* const chars = reinterpret_cast<const char*>(data + pos); // lgtm[cpp/reinterpret-cast]
+	const size_t len{::strnlen(chars, end - pos)};
+	if(len == (end - pos))
+		return false;
+	str = {chars, len};
+	pos += len + 1U;
+	return true;
+}
+
+/* NUL terminated string at `offset` in a string section, empty if it's out of bounds */
+static std::string_view string_at(const span<const uint8_t> strings, const uint64_t offset) noexcept {
+	size_t pos{size_t(offset)};
+	std::string_view str{};
+	if(offset > strings.size() || !read_cstring(strings.data(), strings.size(), pos, str))
+		return {};
+	return str;
+}
+
+/* The initial length of a unit, 64-bit DWARF's escape included */
+static bool read_unit_length(const uint8_t* data, const size_t end, size_t& pos, size_t& offset_size,
+	size_t& unit_end) noexcept {
+
+	uint32_t length{};
+	if(!read_fixed(data, end, pos, length))
+		return false;
+	uint64_t size{length};
+	offset_size = sizeof(uint32_t);
+	if(length == 0xFFFFFFFFU) {
+		if(!read_fixed(data, end, pos, size))
+			return false;
+		offset_size = sizeof(uint64_t);
+	} else if(length >= 0xFFFFFFF0U)
+		return false;
+	if(size > (end - pos))
+		return false;
+	unit_end = pos + size_t(size);
+	return true;
+}
+
+/*
+	Reads, or just skips, an attribute value. Constants, references, and
+	section offsets come back as they are, strings and blocks as the offset
+	they start at. Implicit constants are in the abbreviation and not here.
+*/
+static bool read_form(const uint8_t* data, const size_t end, size_t& pos, const uint64_t form,
+	const dwarf_format_t& format, uint64_t& value, const bool nested = false) noexcept {
+
+	const auto skip = [&](const uint64_t len) {
+		if(pos > end || len > (end - pos))
+			return false;
+		value = pos;
+		pos += size_t(len);
+		return true;
+	};
+
+	uint64_t len{};
+	switch(dwarf_form_t(form)) {
+		case dwarf_form_t::Addr:
+			return read_sized(data, end, pos, format.address_size, value);
+		case dwarf_form_t::Data1:
+		case dwarf_form_t::Ref1:
+		case dwarf_form_t::Flag:
+		case dwarf_form_t::StrX1:
+		case dwarf_form_t::AddrX1:
+			return read_sized(data, end, pos, 1U, value);
+		case dwarf_form_t::Data2:
+		case dwarf_form_t::Ref2:
+		case dwarf_form_t::StrX2:
+		case dwarf_form_t::AddrX2:
+			return read_sized(data, end, pos, 2U, value);
+		case dwarf_form_t::StrX3:
+		case dwarf_form_t::AddrX3:
+			return read_sized(data, end, pos, 3U, value);
+		case dwarf_form_t::Data4:
+		case dwarf_form_t::Ref4:
+		case dwarf_form_t::RefSup4:
+		case dwarf_form_t::StrX4:
+		case dwarf_form_t::AddrX4:
+			return read_sized(data, end, pos, 4U, value);
+		case dwarf_form_t::Data8:
+		case dwarf_form_t::Ref8:
+		case dwarf_form_t::RefSig8:
+		case dwarf_form_t::RefSup8:
+			return read_sized(data, end, pos, 8U, value);
+		case dwarf_form_t::StrP:
+		case dwarf_form_t::SecOffset:
+		case dwarf_form_t::LineStrP:
+		case dwarf_form_t::StrPSup:
+		case dwarf_form_t::GNURefAlt:
+		case dwarf_form_t::GNUStrPAlt:
+			return read_sized(data, end, pos, format.offset_size, value);
+		/* DWARF 2 had these address sized */
+		case dwarf_form_t::RefAddr:
+			return read_sized(data, end, pos, (format.version <= 2U) ? format.address_size : format.offset_size, value);
+		case dwarf_form_t::UData:
+		case dwarf_form_t::RefUData:
+		case dwarf_form_t::StrX:
+		case dwarf_form_t::AddrX:
+		case dwarf_form_t::LocListX:
+		case dwarf_form_t::RngListX:
+			return read_uleb128(data, end, pos, value);
+		case dwarf_form_t::SData: {
+			int64_t signed_value{};
+			if(!read_sleb128(data, end, pos, signed_value))
+				return false;
+			value = uint64_t(signed_value);
+			return true;
+		}
+		case dwarf_form_t::String: {
+			std::string_view str{};
+			value = pos;
+			return read_cstring(data, end, pos, str);
+		}
+		case dwarf_form_t::FlagPresent:
+		case dwarf_form_t::ImplicitConst:
+			value = 0;
+			return true;
+		case dwarf_form_t::Data16:
+			return skip(16U);
+		case dwarf_form_t::Block1:
+			return read_sized(data, end, pos, 1U, len) && skip(len);
+		case dwarf_form_t::Block2:
+			return read_sized(data, end, pos, 2U, len) && skip(len);
+		case dwarf_form_t::Block4:
+			return read_sized(data, end, pos, 4U, len) && skip(len);
+		case dwarf_form_t::Block:
+		case dwarf_form_t::ExprLoc:
+			return read_uleb128(data, end, pos, len) && skip(len);
+		/* The actual form comes first, but it can't be another indirection */
+		case dwarf_form_t::Indirect: {
+			uint64_t actual{};
+			return !nested && read_uleb128(data, end, pos, actual) &&
+				read_form(data, end, pos, actual, format, value, true);
+		}
+		default:
+			return false;
+	}
+}
+
+std::vector<dwarf_arange_t> decode_aranges(const span<const uint8_t> aranges) {
+	std::vector<dwarf_arange_t> tuples{};
+	const uint8_t* const data{aranges.data()};
+	const size_t len{aranges.size()};
+	size_t set_end{};
+	for(size_t offset{}; offset < len; offset = set_end) {
+		size_t pos{offset};
+		size_t offset_size{};
+		uint16_t version{};
+		uint64_t unit{};
+		uint8_t address_size{};
+		uint8_t segment_size{};
+		if(!read_unit_length(data, len, pos, offset_size, set_end) || !read_fixed(data, set_end, pos, version) ||
+			!read_sized(data, set_end, pos, offset_size, unit) || !read_fixed(data, set_end, pos, address_size) ||
+			!read_fixed(data, set_end, pos, segment_size))
+			break;
+		if(version != 2U || (address_size != 4U && address_size != 8U) || segment_size > 8U)
+			break;
+
+		/* The tuples are aligned to their own size from the start of the set */
+		const size_t align{2U * size_t(address_size)};
+		const size_t tuple_size{size_t(segment_size) + align};
+		pos = offset + ((((pos - offset) + align - 1U) / align) * align);
+		while(pos <= set_end && (set_end - pos) >= tuple_size) {
+			uint64_t segment{};
+			uint64_t address{};
+			uint64_t length{};
+			(void)read_sized(data, set_end, pos, segment_size, segment);
+			(void)read_sized(data, set_end, pos, address_size, address);
+			(void)read_sized(data, set_end, pos, address_size, length);
+			if(segment == 0 && address == 0 && length == 0)
+				break;
+			tuples.push_back({address, length, unit});
+		}
+	}
+	return tuples;
+}
+
+bool decode_stmt_list(const span<const uint8_t> info, const span<const uint8_t> abbrev, const uint64_t unit,
+	uint64_t& offset) noexcept {
+
+	const uint8_t* const data{info.data()};
+	if(unit > info.size())
+		return false;
+	size_t pos{size_t(unit)};
+	size_t unit_end{};
+	dwarf_format_t format{};
+	uint64_t abbrev_offset{};
+	uint8_t address_size{};
+	if(!read_unit_length(data, info.size(), pos, format.offset_size, unit_end) ||
+		!read_fixed(data, unit_end, pos, format.version))
+		return false;
+
+	if(format.version == 5U) {
+		uint8_t unit_type{};
+		if(!read_fixed(data, unit_end, pos, unit_type) || !read_fixed(data, unit_end, pos, address_size) ||
+			!read_sized(data, unit_end, pos, format.offset_size, abbrev_offset))
+			return false;
+		/* Skeleton and split units carry a DWO id, type units a signature and the type's offset */
+		if(unit_type == 0x04U || unit_type == 0x05U)
+			pos += sizeof(uint64_t);
+		else if(unit_type == 0x02U || unit_type == 0x06U)
+			pos += sizeof(uint64_t) + format.offset_size;
+	} else if(format.version >= 2U && format.version <= 4U) {
+		if(!read_sized(data, unit_end, pos, format.offset_size, abbrev_offset) ||
+			!read_fixed(data, unit_end, pos, address_size))
+			return false;
+	} else
+		return false;
+	format.address_size = address_size;
+
+	uint64_t code{};
+	if(!read_uleb128(data, unit_end, pos, code) || code == 0)
+		return false;
+
+	/* The unit DIE's abbreviation */
+	const uint8_t* const abbrevs{abbrev.data()};
+	const size_t abbrev_len{abbrev.size()};
+	if(abbrev_offset > abbrev_len)
+		return false;
+	size_t spec{size_t(abbrev_offset)};
+	for(;;) {
+		uint64_t entry{};
+		uint64_t tag{};
+		if(!read_uleb128(abbrevs, abbrev_len, spec, entry) || entry == 0 ||
+			!read_uleb128(abbrevs, abbrev_len, spec, tag) || spec >= abbrev_len)
+			return false;
+		++spec; /* DW_CHILDREN_* */
+		if(entry == code)
+			break;
+
+		for(uint64_t attribute{1U}, form{1U}; attribute != 0 || form != 0;) {
+			int64_t implicit{};
+			if(!read_uleb128(abbrevs, abbrev_len, spec, attribute) || !read_uleb128(abbrevs, abbrev_len, spec, form) ||
+				(form == uint64_t(dwarf_form_t::ImplicitConst) && !read_sleb128(abbrevs, abbrev_len, spec, implicit)))
+				return false;
+		}
+	}
+
+	/* Then walk the DIE along side it */
+	for(;;) {
+		uint64_t attribute{};
+		uint64_t form{};
+		int64_t implicit{};
+		uint64_t value{};
+		if(!read_uleb128(abbrevs, abbrev_len, spec, attribute) || !read_uleb128(abbrevs, abbrev_len, spec, form) ||
+			(attribute == 0 && form == 0) ||
+			(form == uint64_t(dwarf_form_t::ImplicitConst) && !read_sleb128(abbrevs, abbrev_len, spec, implicit)) ||
+			!read_form(data, unit_end, pos, form, format, value))
+			return false;
+		if(attribute != dw_at_stmt_list)
+			continue;
+
+		/* DWARF 2 and 3 used plain constants for section offsets */
+		if(form != uint64_t(dwarf_form_t::SecOffset) && form != uint64_t(dwarf_form_t::Data4) &&
+			form != uint64_t(dwarf_form_t::Data8))
+			return false;
+		offset = value;
+		return true;
+	}
+}
+
+/*
+	A DWARF 5 directory or file name table, the entry format followed by
+	the entries themselves. Only the path and the directory index are kept.
+*/
+static bool read_entry_table(const dwarf_sections_t& sections, const uint8_t* data, const size_t end, size_t& pos,
+	const dwarf_format_t& format, const std::vector<dwarf_file_t>& directories, std::vector<dwarf_file_t>& entries) {
+
+	uint8_t format_count{};
+	if(!read_fixed(data, end, pos, format_count))
+		return false;
+	std::vector<std::pair<uint64_t, uint64_t>> fields(format_count);
+	for(auto& field : fields) {
+		if(!read_uleb128(data, end, pos, field.first) || !read_uleb128(data, end, pos, field.second))
+			return false;
+	}
+
+	uint64_t count{};
+	if(!read_uleb128(data, end, pos, count) || count > (end - pos))
+		return false;
+	entries.reserve(entries.size() + size_t(count));
+	for(uint64_t entry{}; entry < count; ++entry) {
+		dwarf_file_t file{};
+		for(const auto& field : fields) {
+			uint64_t value{};
+			if(!read_form(data, end, pos, field.second, format, value))
+				return false;
+			if(field.first == dw_lnct_directory_index && value < directories.size())
+				file.directory = directories[size_t(value)].name;
+			if(field.first != dw_lnct_path)
+				continue;
+			if(field.second == uint64_t(dwarf_form_t::String))
+				file.name = string_at({data, end}, value);
+			else if(field.second == uint64_t(dwarf_form_t::LineStrP))
+				file.name = string_at(sections.line_str, value);
+			else if(field.second == uint64_t(dwarf_form_t::StrP))
+				file.name = string_at(sections.str, value);
+		}
+		entries.push_back(file);
+	}
+	return true;
+}
+
+/*
+	Puts the sequences in address order, they're in whatever order the
+	functions were emitted in. Overlapping sequences, which is what the
+	remains of discarded functions left at address 0 look like, only keep
+	the first one as otherwise the rows wouldn't be sorted. Any rows after
+	the last end_sequence are dropped.
+*/
+static void sort_sequences(std::vector<dwarf_line_row_t>& rows) {
+	struct sequence_t final {
+		uint64_t address;
+		uint64_t end;
+		size_t first;
+		size_t last;      /* The end_sequence row */
+	};
+	std::vector<sequence_t> sequences{};
+	size_t first{};
+	for(size_t idx{}; idx < rows.size(); ++idx) {
+		if(rows[idx].file != dwarf_line_row_t::end_sequence)
+			continue;
+		sequences.push_back({rows[first].address, rows[idx].address, first, idx});
+		first = idx + 1U;
+	}
+	std::stable_sort(sequences.begin(), sequences.end(), [](const sequence_t& a, const sequence_t& b) {
+		return (a.address != b.address) ? a.address < b.address : a.end < b.end;
+	});
+
+	std::vector<dwarf_line_row_t> sorted{};
+	sorted.reserve(rows.size());
+	uint64_t covered{};
+	for(const auto& sequence : sequences) {
+		if(!sorted.empty() && sequence.address < covered)
+			continue;
+		sorted.insert(sorted.end(), rows.begin() + ptrdiff_t(sequence.first), rows.begin() + ptrdiff_t(sequence.last + 1U));
+		covered = sequence.end;
+	}
+	rows = std::move(sorted);
+}
+
+bool decode_line_table(const dwarf_sections_t& sections, const uint64_t offset, dwarf_line_table_t& table) {
+	const uint8_t* const data{sections.line.data()};
+	const size_t len{sections.line.size()};
+	table = {};
+	if(offset > len)
+		return false;
+
+	size_t pos{size_t(offset)};
+	size_t unit_end{};
+	dwarf_format_t format{};
+	if(!read_unit_length(data, len, pos, format.offset_size, unit_end) ||
+		!read_fixed(data, unit_end, pos, format.version) || format.version < 2U || format.version > 5U)
+		return false;
+	uint8_t address_size{};
+	uint8_t segment_selector_size{};
+	if(format.version == 5U && (!read_fixed(data, unit_end, pos, address_size) ||
+		!read_fixed(data, unit_end, pos, segment_selector_size)))
+		return false;
+	format.address_size = address_size;
+
+	uint64_t header_length{};
+	if(!read_sized(data, unit_end, pos, format.offset_size, header_length) || header_length > (unit_end - pos))
+		return false;
+	const size_t program{pos + size_t(header_length)};
+
+	uint8_t min_inst_length{};
+	uint8_t max_ops{1U};
+	uint8_t default_is_stmt{};
+	int8_t line_base{};
+	uint8_t line_range{};
+	uint8_t opcode_base{};
+	if(!read_fixed(data, program, pos, min_inst_length) ||
+		(format.version >= 4U && !read_fixed(data, program, pos, max_ops)) ||
+		!read_fixed(data, program, pos, default_is_stmt) || !read_fixed(data, program, pos, line_base) ||
+		!read_fixed(data, program, pos, line_range) || !read_fixed(data, program, pos, opcode_base) ||
+		line_range == 0 || opcode_base == 0 || size_t(opcode_base - 1U) > (program - pos))
+		return false;
+	const uint8_t* const opcode_lengths{data + pos};
+	pos += size_t(opcode_base - 1U);
+
+	std::vector<dwarf_file_t> directories{};
+	if(format.version == 5U) {
+		if(!read_entry_table(sections, data, program, pos, format, directories, directories) ||
+			!read_entry_table(sections, data, program, pos, format, directories, table.files))
+			return false;
+	} else {
+		/* Directory and file 0 are the compilation directory and primary source, neither of which are here */
+		directories.push_back({});
+		table.files.push_back({});
+		std::string_view entry{};
+		while(read_cstring(data, program, pos, entry) && !entry.empty())
+			directories.push_back({{}, entry});
+		while(read_cstring(data, program, pos, entry) && !entry.empty()) {
+			uint64_t directory{};
+			uint64_t mtime{};
+			uint64_t size{};
+			if(!read_uleb128(data, program, pos, directory) || !read_uleb128(data, program, pos, mtime) ||
+				!read_uleb128(data, program, pos, size))
+				return false;
+			table.files.push_back({(directory < directories.size()) ? directories[size_t(directory)].name :
+				std::string_view{}, entry});
+		}
+	}
+
+	/* The state machine, VLIW op_index aside */
+	uint64_t address{};
+	uint64_t file{1U};
+	uint32_t line{1U};
+	uint64_t column{};
+	const auto emit = [&](const uint16_t row_file) {
+		table.rows.push_back({address, line, uint16_t(std::min<uint64_t>(column, UINT16_MAX)), row_file});
+	};
+	const auto row_file = [&file]() { return uint16_t(std::min<uint64_t>(file, dwarf_line_row_t::end_sequence - 1U)); };
+	const uint64_t const_add_pc{uint64_t((255U - opcode_base) / line_range) * min_inst_length};
+
+	pos = program;
+	bool good{true};
+	while(good && pos < unit_end) {
+		const uint8_t opcode{data[pos++]};
+		if(opcode >= opcode_base) {
+			const uint8_t adjusted = uint8_t(opcode - opcode_base);
+			address += uint64_t(adjusted / line_range) * min_inst_length;
+			line = uint32_t(int64_t(line) + line_base + (adjusted % line_range));
+			emit(row_file());
+			continue;
+		}
+
+		uint64_t operand{};
+		int64_t signed_operand{};
+		switch(opcode) {
+			case 0x00U: { /* Extended */
+				if(!read_uleb128(data, unit_end, pos, operand) || operand == 0 || operand > (unit_end - pos)) {
+					good = false;
+					break;
+				}
+				const size_t next{pos + size_t(operand)};
+				const uint8_t extended{data[pos++]};
+				if(extended == 0x01U) { /* DW_LNE_end_sequence */
+					emit(dwarf_line_row_t::end_sequence);
+					address = 0;
+					file = 1U;
+					line = 1U;
+					column = 0;
+				} else if(extended == 0x02U) /* DW_LNE_set_address */
+					good = read_sized(data, next, pos, next - pos, address);
+				else if(extended == 0x03U && format.version < 5U) { /* DW_LNE_define_file */
+					std::string_view name{};
+					uint64_t directory{};
+					good = read_cstring(data, next, pos, name) && read_uleb128(data, next, pos, directory);
+					if(good)
+						table.files.push_back({(directory < directories.size()) ?
+							directories[size_t(directory)].name : std::string_view{}, name});
+				}
+				pos = next;
+				break;
+			}
+			case 0x01U: emit(row_file()); break; /* DW_LNS_copy */
+			case 0x02U: /* DW_LNS_advance_pc */
+				good = read_uleb128(data, unit_end, pos, operand);
+				address += operand * min_inst_length;
+				break;
+			case 0x03U: /* DW_LNS_advance_line */
+				good = read_sleb128(data, unit_end, pos, signed_operand);
+				line = uint32_t(int64_t(line) + signed_operand);
+				break;
+			case 0x04U: good = read_uleb128(data, unit_end, pos, file); break; /* DW_LNS_set_file */
+			case 0x05U: good = read_uleb128(data, unit_end, pos, column); break; /* DW_LNS_set_column */
+			case 0x08U: address += const_add_pc; break; /* DW_LNS_const_add_pc */
+			case 0x09U: { /* DW_LNS_fixed_advance_pc */
+				uint16_t advance{};
+				good = read_fixed(data, unit_end, pos, advance);
+				address += advance;
+				break;
+			}
+			/* negate_stmt, basic_block, prologue_end, epilogue_begin, and set_isa included */
+			default:
+				for(uint8_t operands{}; good && operands < opcode_lengths[opcode - 1U]; ++operands)
+					good = read_uleb128(data, unit_end, pos, operand);
+				break;
+		}
+	}
+
+	sort_sequences(table.rows);
+	return true;
+}
+
+const dwarf_line_row_t* dwarf_line_table_t::find(const uint64_t address) const noexcept {
+	auto row = std::upper_bound(rows.begin(), rows.end(), address,
+		[](const uint64_t value, const dwarf_line_row_t& entry) { return value < entry.address; });
+	if(row == rows.begin())
+		return nullptr;
+	--row;
+	return (row->file == dwarf_line_row_t::end_sequence) ? nullptr : &*row;
+}
+
+/* Every sequence in `table` as a range */
+static void add_ranges(const dwarf_line_table_t& table, const uint64_t unit,
+	std::vector<dwarf_line_index_t::range_t>& ranges) {
+
+	size_t first{};
+	for(size_t idx{}; idx < table.rows.size(); ++idx) {
+		if(table.rows[idx].file != dwarf_line_row_t::end_sequence)
+			continue;
+		if(table.rows[idx].address > table.rows[first].address)
+			ranges.push_back({table.rows[first].address, table.rows[idx].address, unit});
+		first = idx + 1U;
+	}
+}
+
+dwarf_line_index_t::dwarf_line_index_t(const dwarf_sections_t& sections, const size_t cache_limit) :
+	_sections{{}, {}, {}, sections.line, sections.line_str, sections.str}, _ranges{}, _tables{cache_limit} {
+
+	std::unordered_map<uint64_t, uint64_t> units{}; /* .debug_info offset to .debug_line offset */
+	for(const auto& arange : decode_aranges(sections.aranges)) {
+		if(arange.length == 0)
+			continue;
+		auto unit = units.find(arange.unit);
+		if(unit == units.end()) {
+			uint64_t offset{};
+			if(!decode_stmt_list(sections.info, sections.abbrev, arange.unit, offset))
+				offset = no_unit;
+			unit = units.emplace(arange.unit, offset).first;
+		}
+		if(unit->second != no_unit)
+			_ranges.push_back({arange.address, arange.address + arange.length, unit->second});
+	}
+
+	if(_ranges.empty()) {
+		const uint8_t* const data{sections.line.data()};
+		const size_t len{sections.line.size()};
+		size_t unit_end{};
+		for(size_t offset{}; offset < len; offset = unit_end) {
+			size_t pos{offset};
+			size_t offset_size{};
+			if(!read_unit_length(data, len, pos, offset_size, unit_end))
+				break;
+			auto table = std::make_shared<dwarf_line_table_t>();
+			if(!decode_line_table(_sections, offset, *table))
+				continue;
+			add_ranges(*table, offset, _ranges);
+			_tables.insert(offset, std::move(table));
+		}
+	}
+
+	std::sort(_ranges.begin(), _ranges.end(), [](const range_t& a, const range_t& b) {
+		return (a.address != b.address) ? a.address < b.address : a.end < b.end;
+	});
+}
+
+const dwarf_line_index_t::range_t* dwarf_line_index_t::search(const uint64_t address) const noexcept {
+	auto range = std::upper_bound(_ranges.begin(), _ranges.end(), address,
+		[](const uint64_t value, const range_t& entry) { return value < entry.address; });
+	if(range == _ranges.begin())
+		return nullptr;
+	--range;
+	return (address < range->end) ? &*range : nullptr;
+}
+
+dwarf_line_index_t::cache_t::value_ptr dwarf_line_index_t::table(const uint64_t unit) const {
+	return _tables.get_or_insert(unit, [this, unit]() {
+		dwarf_line_table_t table{};
+		(void)decode_line_table(_sections, unit, table);
+		return table;
+	});
+}
+
+static bool resolve(const dwarf_line_table_t& table, const uint64_t address, dwarf_line_t& line) noexcept {
+	const dwarf_line_row_t* row{table.find(address)};
+	if(row == nullptr)
+		return false;
+	if(row->file < table.files.size()) {
+		line.directory = table.files[row->file].directory;
+		line.file = table.files[row->file].name;
+	}
+	line.line = row->line;
+	line.column = row->column;
+	return true;
+}
+
+bool dwarf_line_index_t::find(const uint64_t address, dwarf_line_t& line) const {
+	line = {};
+	const range_t* range{search(address)};
+	if(range == nullptr)
+		return false;
+	return resolve(*table(range->unit), address, line);
+}
+
+void dwarf_line_index_t::find(const uint64_t* addresses, const size_t count, dwarf_line_t* results) const {
+	std::vector<std::pair<uint64_t, size_t>> order{}; /* Line program, then index into addresses */
+	order.reserve(count);
+	for(size_t idx{}; idx < count; ++idx) {
+		results[idx] = {};
+		if(const range_t* range = search(addresses[idx]))
+			order.emplace_back(range->unit, idx);
+	}
+	std::sort(order.begin(), order.end());
+
+	cache_t::value_ptr lines{};
+	uint64_t current{no_unit};
+	for(const auto& [unit, idx] : order) {
+		if(unit != current) {
+			lines = table(unit);
+			current = unit;
+		}
+		(void)resolve(*lines, addresses[idx], results[idx]);
+	}
+}
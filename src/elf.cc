@@ -1,6 +1,18 @@
 #include <elf.hh>
 #include <zlib.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 uint32_t elf_hash(const uint8_t* name) {
 	uint32_t hash{};
@@ -15,6 +27,1382 @@ uint32_t elf_hash(const uint8_t* name) {
 	return hash;
 }
 
+uint32_t elf_hash(const std::string_view name) noexcept {
+	uint32_t hash{};
+	for(const char chr : name) {
+		hash = (hash << 4U) + uint8_t(chr);
+		const uint32_t g{hash & 0xF0000000U};
+		if(g != 0U)
+			hash ^= g >> 24U;
+		hash &= ~g;
+	}
+	return hash;
+}
+
+/* Bernstein's hash, h * 33 + c */
+uint32_t gnu_hash(const uint8_t* name) {
+	uint32_t hash{5381U};
+	while(*name != 0U)
+		hash = (hash << 5U) + hash + *name++;
+	return hash;
+}
+
+uint32_t gnu_hash(const std::string_view name) noexcept {
+	uint32_t hash{5381U};
+	for(const char chr : name)
+		hash = (hash << 5U) + hash + uint8_t(chr);
+	return hash;
+}
+
+static size_t name_length(const char* strtab, const size_t strtab_len, const uint32_t offset) noexcept {
+	if(offset >= strtab_len)
+		return 0;
+
+	const char* name{strtab + offset};
+	const size_t left{strtab_len - offset};
+	size_t len{};
+#if defined(__SSE2__)
+	/* 16 bytes at a time for as long as that stays inside of the table */
+	const __m128i zero{_mm_setzero_si128()};
+	for(; len + sizeof(__m128i) <= left; len += sizeof(__m128i)) {
+		const __m128i chunk{_mm_loadu_si128(reinterpret_cast<const __m128i*>(name + len))}; // lgtm[cpp/reinterpret-cast]
+		const auto nuls = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero)));
+		if(nuls != 0)
+			return len + uint32_t(__builtin_ctz(nuls));
+	}
+#endif
+	while(len < left && name[len] != '\0')
+		++len;
+	return len;
+}
+
+/*
+	Each hash is one long dependency chain through the state, so a few names
+	are run side by side over the prefix they all share, which keeps the
+	pipeline full, and then each is finished off on its own.
+*/
+constexpr static size_t hash_lanes{4};
+
+template<typename S>
+static void hash_batch(const char* strtab, const size_t strtab_len, const uint32_t* offsets,
+	const size_t count, uint32_t* hashes, const uint32_t seed, S step) noexcept {
+
+	size_t base{};
+	for(; base + hash_lanes <= count; base += hash_lanes) {
+		std::array<const uint8_t*, hash_lanes> names{};
+		std::array<size_t, hash_lanes> lengths{};
+		std::array<uint32_t, hash_lanes> state{};
+		size_t common{std::numeric_limits<size_t>::max()};
+		for(size_t lane{}; lane < hash_lanes; ++lane) {
+			const uint32_t offset{offsets[base + lane]};
+			names[lane] = reinterpret_cast<const uint8_t*>(strtab) + ((offset < strtab_len) ? offset : 0); // lgtm[cpp/reinterpret-cast]
+			lengths[lane] = name_length(strtab, strtab_len, offset);
+			state[lane] = seed;
+			common = std::min(common, lengths[lane]);
+		}
+
+		size_t idx{step.block(state, names, common)};
+		for(; idx < common; ++idx) {
+			for(size_t lane{}; lane < hash_lanes; ++lane)
+				state[lane] = step(state[lane], names[lane][idx]);
+		}
+		for(size_t lane{}; lane < hash_lanes; ++lane) {
+			for(size_t tail{idx}; tail < lengths[lane]; ++tail)
+				state[lane] = step(state[lane], names[lane][tail]);
+			hashes[base + lane] = state[lane];
+		}
+	}
+
+	for(; base < count; ++base) {
+		const uint32_t offset{offsets[base]};
+		const size_t len{name_length(strtab, strtab_len, offset)};
+		uint32_t hash{seed};
+		for(size_t idx{}; idx < len; ++idx)
+			hash = step(hash, uint8_t(strtab[offset + idx]));
+		hashes[base] = hash;
+	}
+}
+
+struct elf_hash_step_t final {
+	uint32_t operator()(uint32_t hash, const uint8_t chr) const noexcept {
+		hash = (hash << 4U) + chr;
+		const uint32_t g{hash & 0xF0000000U};
+		return (hash ^ (g >> 24U)) & ~g;
+	}
+
+	/* Nothing to be gained from going wider, every byte depends on the top nibble */
+	size_t block(std::array<uint32_t, hash_lanes>&, const std::array<const uint8_t*, hash_lanes>&,
+		const size_t) const noexcept { return 0; }
+};
+
+struct gnu_hash_step_t final {
+	uint32_t operator()(const uint32_t hash, const uint8_t chr) const noexcept {
+		return (hash << 5U) + hash + chr;
+	}
+
+	/*
+		Four rounds of h * 33 + c folded into one, h * 33^4 plus the bytes
+		times their powers of 33. Everything wraps mod 2^32 the same way the
+		byte at a time version does, so this is still exact.
+	*/
+	size_t block(std::array<uint32_t, hash_lanes>& state, const std::array<const uint8_t*, hash_lanes>& names,
+		const size_t common) const noexcept {
+		size_t idx{};
+		for(; idx + 4 <= common; idx += 4) {
+			for(size_t lane{}; lane < hash_lanes; ++lane) {
+				const uint8_t* chr{names[lane] + idx};
+				state[lane] = (state[lane] * 1185921U) + (uint32_t(chr[0]) * 35937U) +
+					(uint32_t(chr[1]) * 1089U) + (uint32_t(chr[2]) * 33U) + chr[3];
+			}
+		}
+		return idx;
+	}
+};
+
+void elf_hash_batch(const char* strtab, const size_t strtab_len, const uint32_t* offsets,
+	const size_t count, uint32_t* hashes) noexcept {
+	hash_batch(strtab, strtab_len, offsets, count, hashes, 0U, elf_hash_step_t{});
+}
+
+void gnu_hash_batch(const char* strtab, const size_t strtab_len, const uint32_t* offsets,
+	const size_t count, uint32_t* hashes) noexcept {
+	hash_batch(strtab, strtab_len, offsets, count, hashes, 5381U, gnu_hash_step_t{});
+}
+
+/* Symbols per worker below which splitting the hashing up isn't worth it */
+static constexpr size_t hash_chunk{16384U};
+/* Second bloom bit shift, the same one lld and GNU ld use */
+static constexpr uint32_t gnu_bloom_shift{26U};
+
+/*
+	Two bits per symbol gives a false positive rate of (1 - e^(-2n/m))^2
+	for n symbols in m bits, so m/n = -2 / ln(1 - sqrt(rate)). ld.so masks
+	the word index, so the count is rounded up to a power of two.
+*/
+static size_t bloom_words(const size_t symbols, const size_t word_bits, const double rate) noexcept {
+	const double bits_per_symbol{-2.0 / std::log1p(-std::sqrt(std::max(rate, 1e-6)))};
+	const double words{std::ceil((double(symbols) * bits_per_symbol) / double(word_bits))};
+	size_t count{1};
+	while(double(count) < words)
+		count <<= 1U;
+	return count;
+}
+
+elf_hash_tables_t build_hash_tables(const char* strtab, const size_t strtab_len, const uint32_t* names,
+	const uint8_t* hashed, const size_t count, const size_t word_size, const double false_positive_rate,
+	size_t threads) {
+
+	elf_hash_tables_t tables{{}, 0, {}, {}};
+	if((word_size != 4U && word_size != 8U) || !(false_positive_rate > 0.0 && false_positive_rate < 1.0) ||
+		count > std::numeric_limits<uint32_t>::max())
+		return tables;
+	if(threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+	/* Everything .gnu.hash doesn't cover stays up front in its original order */
+	std::vector<uint32_t> members{};
+	tables.order.reserve(count);
+	for(size_t idx{}; idx < count; ++idx) {
+		if(idx != 0 && hashed[idx] != 0U)
+			members.push_back(uint32_t(idx));
+		else
+			tables.order.push_back(uint32_t(idx));
+	}
+	tables.symoffset = uint32_t(tables.order.size());
+
+	const size_t hashed_count{members.size()};
+	const uint32_t nbuckets{uint32_t(std::max<size_t>(hashed_count / 4U, 1U))};
+	const size_t word_bits{word_size * 8U};
+	const size_t nwords{bloom_words(hashed_count, word_bits, false_positive_rate)};
+
+	const size_t chunks{std::max<size_t>(1U, std::min(threads, (hashed_count + hash_chunk - 1U) / hash_chunk))};
+	const size_t chunk_len{(hashed_count + chunks - 1U) / chunks};
+	const auto chunk_bound = [&](const size_t chunk) { return std::min(chunk * chunk_len, hashed_count); };
+
+	/* Each worker hashes its share, counts its buckets, and fills in its own bloom filter */
+	std::vector<uint32_t> offsets(hashed_count);
+	for(size_t idx{}; idx < hashed_count; ++idx)
+		offsets[idx] = names[members[idx]];
+	std::vector<uint32_t> hashes(hashed_count);
+	std::vector<uint32_t> counts(chunks * nbuckets);
+	std::vector<std::vector<uint64_t>> blooms(chunks);
+	parallel_for(chunks, [&](const size_t chunk) {
+		const size_t first{chunk_bound(chunk)};
+		const size_t last{chunk_bound(chunk + 1)};
+		gnu_hash_batch(strtab, strtab_len, offsets.data() + first, last - first, hashes.data() + first);
+
+		uint32_t* const bucket_counts{counts.data() + (chunk * nbuckets)};
+		auto& bloom = blooms[chunk];
+		bloom.resize(nwords);
+		for(size_t idx{first}; idx < last; ++idx) {
+			const uint32_t hash{hashes[idx]};
+			++bucket_counts[hash % nbuckets];
+			bloom[(hash / word_bits) & (nwords - 1U)] |= (uint64_t{1} << (hash % word_bits)) |
+				(uint64_t{1} << ((hash >> gnu_bloom_shift) % word_bits));
+		}
+	}, threads);
+
+	/* Stable counting sort by bucket, each worker's counts become where it writes next */
+	std::vector<uint32_t> starts(nbuckets + 1U);
+	uint32_t position{};
+	for(size_t bucket{}; bucket < nbuckets; ++bucket) {
+		starts[bucket] = position;
+		for(size_t chunk{}; chunk < chunks; ++chunk) {
+			uint32_t& next{counts[(chunk * nbuckets) + bucket]};
+			const uint32_t entries{next};
+			next = position;
+			position += entries;
+		}
+	}
+	starts[nbuckets] = position;
+
+	std::vector<uint32_t> sorted(hashed_count);
+	std::vector<uint32_t> sorted_hashes(hashed_count);
+	parallel_for(chunks, [&](const size_t chunk) {
+		uint32_t* const next{counts.data() + (chunk * nbuckets)};
+		for(size_t idx{chunk_bound(chunk)}; idx < chunk_bound(chunk + 1); ++idx) {
+			const uint32_t slot{next[hashes[idx] % nbuckets]++};
+			sorted[slot] = members[idx];
+			sorted_hashes[slot] = hashes[idx];
+		}
+	}, threads);
+	tables.order.insert(tables.order.end(), sorted.begin(), sorted.end());
+
+	auto& bloom = blooms.front();
+	for(size_t chunk{1}; chunk < chunks; ++chunk) {
+		for(size_t word{}; word < nwords; ++word)
+			bloom[word] |= blooms[chunk][word];
+	}
+
+	tables.gnu_hash.resize((4U + nbuckets + hashed_count) * sizeof(uint32_t) + (nwords * word_size));
+	uint8_t* output{tables.gnu_hash.data()};
+	const auto put = [&output](const void* data, const size_t len) {
+		std::memcpy(output, data, len);
+		output += len;
+	};
+	const std::array<uint32_t, 4> header{{nbuckets, tables.symoffset, uint32_t(nwords), gnu_bloom_shift}};
+	put(header.data(), sizeof(header));
+	for(const uint64_t word : bloom) {
+		const uint32_t narrow{uint32_t(word)};
+		if(word_size == 8U)
+			put(&word, sizeof(word));
+		else
+			put(&narrow, sizeof(narrow));
+	}
+	for(size_t bucket{}; bucket < nbuckets; ++bucket) {
+		const uint32_t first{(starts[bucket] == starts[bucket + 1]) ? 0U : tables.symoffset + starts[bucket]};
+		put(&first, sizeof(first));
+	}
+	/* The low bit marks the end of each bucket's run */
+	for(size_t idx{}; idx < hashed_count; ++idx) {
+		const uint32_t hash{sorted_hashes[idx]};
+		const bool last{idx + 1 == hashed_count || (sorted_hashes[idx + 1] % nbuckets) != (hash % nbuckets)};
+		const uint32_t chain{(hash & ~1U) | (last ? 1U : 0U)};
+		put(&chain, sizeof(chain));
+	}
+
+	/* .hash covers every symbol in the new order */
+	std::vector<uint32_t> sysv_offsets(count);
+	for(size_t idx{}; idx < count; ++idx)
+		sysv_offsets[idx] = names[tables.order[idx]];
+	std::vector<uint32_t> sysv_hashes(count);
+	parallel_for((count + hash_chunk - 1U) / hash_chunk, [&](const size_t chunk) {
+		const size_t first{chunk * hash_chunk};
+		elf_hash_batch(strtab, strtab_len, sysv_offsets.data() + first,
+			std::min(hash_chunk, count - first), sysv_hashes.data() + first);
+	}, threads);
+
+	const uint32_t nbucket{uint32_t(std::max<size_t>(count, 1U))};
+	std::vector<uint32_t> table(2U + nbucket + count);
+	table[0] = nbucket;
+	table[1] = uint32_t(count);
+	for(size_t idx{1}; idx < count; ++idx) {
+		uint32_t& bucket{table[2U + (sysv_hashes[idx] % nbucket)]};
+		table[2U + nbucket + idx] = bucket;
+		bucket = uint32_t(idx);
+	}
+	tables.sysv_hash.resize(table.size() * sizeof(uint32_t));
+	std::memcpy(tables.sysv_hash.data(), table.data(), tables.sysv_hash.size());
+	return tables;
+}
+
+/* How the value for a relocation is worked out */
+enum class reloc_value_t : uint8_t {
+	None,     /* Nothing to do (R_*_NONE, RISC-V RELAX/ALIGN) */
+	Absolute, /* S + A */
+	Relative, /* S + A - P */
+	Page,     /* Page(S + A) - Page(P) */
+	Size,     /* Z + A */
+	PcrelLo,  /* The S + A - P of the %pcrel_hi the symbol points at */
+};
+
+/* Range the value has to be in, `bits` wide */
+enum class reloc_check_t : uint8_t {
+	None,
+	Signed,
+	Unsigned,
+	Either,   /* Fits either way */
+	SignedHi, /* A %hi/%lo pair, so rounded by the %lo before the check */
+};
+
+/* Where the value goes */
+enum class reloc_field_t : uint8_t {
+	Unsupported,
+	None,
+	Word8, Word16, Word32, Word64,
+	Add8, Add16, Add32, Add64,
+	Sub8, Sub16, Sub32, Sub64,
+	Set6, Sub6,
+	/* AArch64 */
+	A64Adr, A64AdrPage, A64Imm12, A64Imm12S1, A64Imm12S2, A64Imm12S3, A64Imm12S4,
+	A64Imm14, A64Imm19, A64Imm26, A64Movw0, A64Movw1, A64Movw2, A64Movw3,
+	/* RISC-V */
+	RvHi20, RvLo12I, RvLo12S, RvBranch, RvJal, RvCall, RvcBranch, RvcJump,
+	Count,
+};
+
+struct reloc_howto_t final {
+	reloc_field_t field;
+	reloc_value_t value;
+	reloc_check_t check;
+	uint8_t bits;
+	bool sequenced; /* Read-modify-write, has to go in file order */
+};
+
+struct reloc_entry_t final {
+	uint32_t type;
+	reloc_howto_t howto;
+};
+
+static constexpr reloc_howto_t howto(const reloc_field_t field, const reloc_value_t value,
+	const reloc_check_t check = reloc_check_t::None, const uint8_t bits = 0, const bool sequenced = false) noexcept {
+	return {field, value, check, bits, sequenced};
+}
+
+/* Types missing from the list are left as Unsupported */
+template<size_t N, size_t M>
+static constexpr std::array<reloc_howto_t, N> reloc_table(const reloc_entry_t (&entries)[M]) noexcept {
+	std::array<reloc_howto_t, N> table{};
+	for(const auto& entry : entries)
+		table[entry.type] = entry.howto;
+	return table;
+}
+
+using rf = reloc_field_t;
+using rv = reloc_value_t;
+using rc = reloc_check_t;
+
+static constexpr auto x86_64_relocs = reloc_table<34>({
+	{0,  howto(rf::None,   rv::None)},                     /* R_X86_64_NONE */
+	{1,  howto(rf::Word64, rv::Absolute)},                 /* R_X86_64_64 */
+	{2,  howto(rf::Word32, rv::Relative, rc::Signed, 32)}, /* R_X86_64_PC32 */
+	{4,  howto(rf::Word32, rv::Relative, rc::Signed, 32)}, /* R_X86_64_PLT32 */
+	{10, howto(rf::Word32, rv::Absolute, rc::Unsigned, 32)}, /* R_X86_64_32 */
+	{11, howto(rf::Word32, rv::Absolute, rc::Signed, 32)}, /* R_X86_64_32S */
+	{12, howto(rf::Word16, rv::Absolute, rc::Either, 16)}, /* R_X86_64_16 */
+	{13, howto(rf::Word16, rv::Relative, rc::Signed, 16)}, /* R_X86_64_PC16 */
+	{14, howto(rf::Word8,  rv::Absolute, rc::Either, 8)},  /* R_X86_64_8 */
+	{15, howto(rf::Word8,  rv::Relative, rc::Signed, 8)},  /* R_X86_64_PC8 */
+	{24, howto(rf::Word64, rv::Relative)},                 /* R_X86_64_PC64 */
+	{32, howto(rf::Word32, rv::Size, rc::Unsigned, 32)},   /* R_X86_64_SIZE32 */
+	{33, howto(rf::Word64, rv::Size)},                     /* R_X86_64_SIZE64 */
+});
+
+static constexpr auto aarch64_relocs = reloc_table<300>({
+	{0,   howto(rf::None,       rv::None)},                     /* R_AARCH64_NONE (old) */
+	{256, howto(rf::None,       rv::None)},                     /* R_AARCH64_NONE */
+	{257, howto(rf::Word64,     rv::Absolute)},                 /* R_AARCH64_ABS64 */
+	{258, howto(rf::Word32,     rv::Absolute, rc::Either, 32)}, /* R_AARCH64_ABS32 */
+	{259, howto(rf::Word16,     rv::Absolute, rc::Either, 16)}, /* R_AARCH64_ABS16 */
+	{260, howto(rf::Word64,     rv::Relative)},                 /* R_AARCH64_PREL64 */
+	{261, howto(rf::Word32,     rv::Relative, rc::Either, 32)}, /* R_AARCH64_PREL32 */
+	{262, howto(rf::Word16,     rv::Relative, rc::Either, 16)}, /* R_AARCH64_PREL16 */
+	{263, howto(rf::A64Movw0,   rv::Absolute, rc::Unsigned, 16)}, /* R_AARCH64_MOVW_UABS_G0 */
+	{264, howto(rf::A64Movw0,   rv::Absolute)},                 /* R_AARCH64_MOVW_UABS_G0_NC */
+	{265, howto(rf::A64Movw1,   rv::Absolute, rc::Unsigned, 32)}, /* R_AARCH64_MOVW_UABS_G1 */
+	{266, howto(rf::A64Movw1,   rv::Absolute)},                 /* R_AARCH64_MOVW_UABS_G1_NC */
+	{267, howto(rf::A64Movw2,   rv::Absolute, rc::Unsigned, 48)}, /* R_AARCH64_MOVW_UABS_G2 */
+	{268, howto(rf::A64Movw2,   rv::Absolute)},                 /* R_AARCH64_MOVW_UABS_G2_NC */
+	{269, howto(rf::A64Movw3,   rv::Absolute)},                 /* R_AARCH64_MOVW_UABS_G3 */
+	{273, howto(rf::A64Imm19,   rv::Relative, rc::Signed, 21)}, /* R_AARCH64_LD_PREL_LO19 */
+	{274, howto(rf::A64Adr,     rv::Relative, rc::Signed, 21)}, /* R_AARCH64_ADR_PREL_LO21 */
+	{275, howto(rf::A64AdrPage, rv::Page,     rc::Signed, 33)}, /* R_AARCH64_ADR_PREL_PG_HI21 */
+	{276, howto(rf::A64AdrPage, rv::Page)},                     /* R_AARCH64_ADR_PREL_PG_HI21_NC */
+	{277, howto(rf::A64Imm12,   rv::Absolute)},                 /* R_AARCH64_ADD_ABS_LO12_NC */
+	{278, howto(rf::A64Imm12,   rv::Absolute)},                 /* R_AARCH64_LDST8_ABS_LO12_NC */
+	{279, howto(rf::A64Imm14,   rv::Relative, rc::Signed, 16)}, /* R_AARCH64_TSTBR14 */
+	{280, howto(rf::A64Imm19,   rv::Relative, rc::Signed, 21)}, /* R_AARCH64_CONDBR19 */
+	{282, howto(rf::A64Imm26,   rv::Relative, rc::Signed, 28)}, /* R_AARCH64_JUMP26 */
+	{283, howto(rf::A64Imm26,   rv::Relative, rc::Signed, 28)}, /* R_AARCH64_CALL26 */
+	{284, howto(rf::A64Imm12S1, rv::Absolute)},                 /* R_AARCH64_LDST16_ABS_LO12_NC */
+	{285, howto(rf::A64Imm12S2, rv::Absolute)},                 /* R_AARCH64_LDST32_ABS_LO12_NC */
+	{286, howto(rf::A64Imm12S3, rv::Absolute)},                 /* R_AARCH64_LDST64_ABS_LO12_NC */
+	{299, howto(rf::A64Imm12S4, rv::Absolute)},                 /* R_AARCH64_LDST128_ABS_LO12_NC */
+});
+
+static constexpr auto riscv_relocs = reloc_table<58>({
+	{0,  howto(rf::None,      rv::None)},                       /* R_RISCV_NONE */
+	{1,  howto(rf::Word32,    rv::Absolute)},                   /* R_RISCV_32 */
+	{2,  howto(rf::Word64,    rv::Absolute)},                   /* R_RISCV_64 */
+	{16, howto(rf::RvBranch,  rv::Relative, rc::Signed, 13)},   /* R_RISCV_BRANCH */
+	{17, howto(rf::RvJal,     rv::Relative, rc::Signed, 21)},   /* R_RISCV_JAL */
+	{18, howto(rf::RvCall,    rv::Relative, rc::SignedHi, 32)}, /* R_RISCV_CALL */
+	{19, howto(rf::RvCall,    rv::Relative, rc::SignedHi, 32)}, /* R_RISCV_CALL_PLT */
+	{23, howto(rf::RvHi20,    rv::Relative, rc::SignedHi, 32)}, /* R_RISCV_PCREL_HI20 */
+	{24, howto(rf::RvLo12I,   rv::PcrelLo)},                    /* R_RISCV_PCREL_LO12_I */
+	{25, howto(rf::RvLo12S,   rv::PcrelLo)},                    /* R_RISCV_PCREL_LO12_S */
+	{26, howto(rf::RvHi20,    rv::Absolute, rc::SignedHi, 32)}, /* R_RISCV_HI20 */
+	{27, howto(rf::RvLo12I,   rv::Absolute)},                   /* R_RISCV_LO12_I */
+	{28, howto(rf::RvLo12S,   rv::Absolute)},                   /* R_RISCV_LO12_S */
+	{33, howto(rf::Add8,      rv::Absolute, rc::None, 0, true)}, /* R_RISCV_ADD8 */
+	{34, howto(rf::Add16,     rv::Absolute, rc::None, 0, true)}, /* R_RISCV_ADD16 */
+	{35, howto(rf::Add32,     rv::Absolute, rc::None, 0, true)}, /* R_RISCV_ADD32 */
+	{36, howto(rf::Add64,     rv::Absolute, rc::None, 0, true)}, /* R_RISCV_ADD64 */
+	{37, howto(rf::Sub8,      rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SUB8 */
+	{38, howto(rf::Sub16,     rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SUB16 */
+	{39, howto(rf::Sub32,     rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SUB32 */
+	{40, howto(rf::Sub64,     rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SUB64 */
+	{43, howto(rf::None,      rv::None)},                       /* R_RISCV_ALIGN */
+	{44, howto(rf::RvcBranch, rv::Relative, rc::Signed, 9)},    /* R_RISCV_RVC_BRANCH */
+	{45, howto(rf::RvcJump,   rv::Relative, rc::Signed, 12)},   /* R_RISCV_RVC_JUMP */
+	{51, howto(rf::None,      rv::None)},                       /* R_RISCV_RELAX */
+	{52, howto(rf::Sub6,      rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SUB6 */
+	{53, howto(rf::Set6,      rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SET6 */
+	{54, howto(rf::Word8,     rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SET8 */
+	{55, howto(rf::Word16,    rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SET16 */
+	{56, howto(rf::Word32,    rv::Absolute, rc::None, 0, true)}, /* R_RISCV_SET32 */
+	{57, howto(rf::Word32,    rv::Relative)},                   /* R_RISCV_32_PCREL */
+});
+
+template<typename U>
+static U load(const uint8_t* location) noexcept {
+	U value{};
+	std::memcpy(&value, location, sizeof(U));
+	return value;
+}
+
+template<typename U>
+static void store(uint8_t* location, const U value) noexcept {
+	std::memcpy(location, &value, sizeof(U));
+}
+
+template<typename U>
+static void patch(uint8_t* location, const U mask, const U bits) noexcept {
+	store<U>(location, U((load<U>(location) & ~mask) | (bits & mask)));
+}
+
+template<typename U>
+static void write_word(uint8_t* location, const uint64_t value) noexcept { store<U>(location, U(value)); }
+template<typename U>
+static void add_word(uint8_t* location, const uint64_t value) noexcept { store<U>(location, U(load<U>(location) + value)); }
+template<typename U>
+static void sub_word(uint8_t* location, const uint64_t value) noexcept { store<U>(location, U(load<U>(location) - value)); }
+template<typename U>
+static int64_t read_word(const uint8_t* location) noexcept { return int64_t(std::make_signed_t<U>(load<U>(location))); }
+
+static void write_set6(uint8_t* location, const uint64_t value) noexcept {
+	*location = uint8_t((*location & 0xC0U) | (value & 0x3FU));
+}
+static void write_sub6(uint8_t* location, const uint64_t value) noexcept {
+	*location = uint8_t((*location & 0xC0U) | ((*location - value) & 0x3FU));
+}
+
+/* ADR/ADRP, immlo in [30:29] and immhi in [23:5] */
+template<uint32_t Shift>
+static void write_a64_adr(uint8_t* location, const uint64_t value) noexcept {
+	const uint64_t imm{value >> Shift};
+	patch<uint32_t>(location, 0x60FFFFE0U, uint32_t(((imm & 0x3U) << 29U) | (((imm >> 2U) & 0x7FFFFU) << 5U)));
+}
+/* The low 12 bits scaled by the access size, in [21:10] */
+template<uint32_t Shift>
+static void write_a64_imm12(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint32_t>(location, 0x003FFC00U, uint32_t(((value & 0xFFFU) >> Shift) << 10U));
+}
+/* Word offsets for TBZ/TBNZ, B.cond/CBZ/LDR (literal), and B/BL */
+template<uint32_t Bits, uint32_t Position>
+static void write_a64_branch(uint8_t* location, const uint64_t value) noexcept {
+	constexpr uint32_t mask{(1U << Bits) - 1U};
+	patch<uint32_t>(location, mask << Position, uint32_t(((value >> 2U) & mask) << Position));
+}
+/* MOVZ/MOVK, 16 bits of the value in [20:5] */
+template<uint32_t Group>
+static void write_a64_movw(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint32_t>(location, 0x001FFFE0U, uint32_t(((value >> (Group * 16U)) & 0xFFFFU) << 5U));
+}
+
+/* %hi is rounded so that adding the sign extended %lo gets back to the value */
+static void write_rv_hi20(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint32_t>(location, 0xFFFFF000U, uint32_t(value + 0x800U));
+}
+static void write_rv_lo12_i(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint32_t>(location, 0xFFF00000U, uint32_t(value << 20U));
+}
+static void write_rv_lo12_s(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint32_t>(location, 0xFE000F80U, uint32_t((((value >> 5U) & 0x7FU) << 25U) | ((value & 0x1FU) << 7U)));
+}
+/* B-type, imm[12|10:5] in [31:25] and imm[4:1|11] in [11:7] */
+static void write_rv_branch(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint32_t>(location, 0xFE000F80U, uint32_t((((value >> 12U) & 0x1U) << 31U) |
+		(((value >> 5U) & 0x3FU) << 25U) | (((value >> 1U) & 0xFU) << 8U) | (((value >> 11U) & 0x1U) << 7U)));
+}
+/* J-type, imm[20|10:1|11|19:12] in [31:12] */
+static void write_rv_jal(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint32_t>(location, 0xFFFFF000U, uint32_t((((value >> 20U) & 0x1U) << 31U) |
+		(((value >> 1U) & 0x3FFU) << 21U) | (((value >> 11U) & 0x1U) << 20U) | (((value >> 12U) & 0xFFU) << 12U)));
+}
+/* AUIPC then JALR */
+static void write_rv_call(uint8_t* location, const uint64_t value) noexcept {
+	write_rv_hi20(location, value);
+	write_rv_lo12_i(location + 4, value);
+}
+/* CB-type, imm[8|4:3] in [12:10] and imm[7:6|2:1|5] in [6:2] */
+static void write_rvc_branch(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint16_t>(location, 0x1C7CU, uint16_t((((value >> 8U) & 0x1U) << 12U) | (((value >> 3U) & 0x3U) << 10U) |
+		(((value >> 6U) & 0x3U) << 5U) | (((value >> 1U) & 0x3U) << 3U) | (((value >> 5U) & 0x1U) << 2U)));
+}
+/* CJ-type, imm[11|4|9:8|10|6|7|3:1|5] in [12:2] */
+static void write_rvc_jump(uint8_t* location, const uint64_t value) noexcept {
+	patch<uint16_t>(location, 0x1FFCU, uint16_t((((value >> 11U) & 0x1U) << 12U) | (((value >> 4U) & 0x1U) << 11U) |
+		(((value >> 8U) & 0x3U) << 9U) | (((value >> 10U) & 0x1U) << 8U) | (((value >> 6U) & 0x1U) << 7U) |
+		(((value >> 7U) & 0x1U) << 6U) | (((value >> 1U) & 0x7U) << 3U) | (((value >> 5U) & 0x1U) << 2U)));
+}
+
+using reloc_writer_t = void (*)(uint8_t*, uint64_t) noexcept;
+using reloc_reader_t = int64_t (*)(const uint8_t*) noexcept;
+
+struct reloc_field_op_t final {
+	reloc_writer_t write;
+	reloc_reader_t read; /* Implicit addend, only for plain data */
+	uint8_t size;
+};
+
+static constexpr std::array<reloc_field_op_t, size_t(reloc_field_t::Count)> reloc_field_table() noexcept {
+	std::array<reloc_field_op_t, size_t(reloc_field_t::Count)> table{};
+	const auto set = [&table](const reloc_field_t field, const reloc_field_op_t op) { table[size_t(field)] = op; };
+	set(rf::Word8,      {write_word<uint8_t>,  read_word<uint8_t>,  1});
+	set(rf::Word16,     {write_word<uint16_t>, read_word<uint16_t>, 2});
+	set(rf::Word32,     {write_word<uint32_t>, read_word<uint32_t>, 4});
+	set(rf::Word64,     {write_word<uint64_t>, read_word<uint64_t>, 8});
+	set(rf::Add8,       {add_word<uint8_t>,    nullptr, 1});
+	set(rf::Add16,      {add_word<uint16_t>,   nullptr, 2});
+	set(rf::Add32,      {add_word<uint32_t>,   nullptr, 4});
+	set(rf::Add64,      {add_word<uint64_t>,   nullptr, 8});
+	set(rf::Sub8,       {sub_word<uint8_t>,    nullptr, 1});
+	set(rf::Sub16,      {sub_word<uint16_t>,   nullptr, 2});
+	set(rf::Sub32,      {sub_word<uint32_t>,   nullptr, 4});
+	set(rf::Sub64,      {sub_word<uint64_t>,   nullptr, 8});
+	set(rf::Set6,       {write_set6,           nullptr, 1});
+	set(rf::Sub6,       {write_sub6,           nullptr, 1});
+	set(rf::A64Adr,     {write_a64_adr<0>,     nullptr, 4});
+	set(rf::A64AdrPage, {write_a64_adr<12>,    nullptr, 4});
+	set(rf::A64Imm12,   {write_a64_imm12<0>,   nullptr, 4});
+	set(rf::A64Imm12S1, {write_a64_imm12<1>,   nullptr, 4});
+	set(rf::A64Imm12S2, {write_a64_imm12<2>,   nullptr, 4});
+	set(rf::A64Imm12S3, {write_a64_imm12<3>,   nullptr, 4});
+	set(rf::A64Imm12S4, {write_a64_imm12<4>,   nullptr, 4});
+	set(rf::A64Imm14,   {write_a64_branch<14, 5>, nullptr, 4});
+	set(rf::A64Imm19,   {write_a64_branch<19, 5>, nullptr, 4});
+	set(rf::A64Imm26,   {write_a64_branch<26, 0>, nullptr, 4});
+	set(rf::A64Movw0,   {write_a64_movw<0>,    nullptr, 4});
+	set(rf::A64Movw1,   {write_a64_movw<1>,    nullptr, 4});
+	set(rf::A64Movw2,   {write_a64_movw<2>,    nullptr, 4});
+	set(rf::A64Movw3,   {write_a64_movw<3>,    nullptr, 4});
+	set(rf::RvHi20,     {write_rv_hi20,        nullptr, 4});
+	set(rf::RvLo12I,    {write_rv_lo12_i,      nullptr, 4});
+	set(rf::RvLo12S,    {write_rv_lo12_s,      nullptr, 4});
+	set(rf::RvBranch,   {write_rv_branch,      nullptr, 4});
+	set(rf::RvJal,      {write_rv_jal,         nullptr, 4});
+	set(rf::RvCall,     {write_rv_call,        nullptr, 8});
+	set(rf::RvcBranch,  {write_rvc_branch,     nullptr, 2});
+	set(rf::RvcJump,    {write_rvc_jump,       nullptr, 2});
+	return table;
+}
+static constexpr auto reloc_fields = reloc_field_table();
+
+static span<const reloc_howto_t> reloc_howtos(const elf_machine_t machine) noexcept {
+	switch(machine) {
+		case elf_machine_t::X86_64:
+			return {x86_64_relocs.data(), x86_64_relocs.size()};
+		case elf_machine_t::AARCH64:
+			return {aarch64_relocs.data(), aarch64_relocs.size()};
+		case elf_machine_t::RISCV:
+			return {riscv_relocs.data(), riscv_relocs.size()};
+		default:
+			return {};
+	}
+}
+
+static bool reloc_fits(const reloc_check_t check, const uint8_t bits, const uint64_t value) noexcept {
+	const auto fits_signed = [bits](const int64_t signed_value) {
+		return signed_value >= -(int64_t{1} << (bits - 1U)) && signed_value < (int64_t{1} << (bits - 1U));
+	};
+	switch(check) {
+		case reloc_check_t::Signed:
+			return fits_signed(int64_t(value));
+		case reloc_check_t::Unsigned:
+			return value < (uint64_t{1} << bits);
+		case reloc_check_t::Either:
+			return fits_signed(int64_t(value)) || value < (uint64_t{1} << bits);
+		case reloc_check_t::SignedHi:
+			return fits_signed(int64_t(value + 0x800U));
+		default:
+			return true;
+	}
+}
+
+bool elf_relocations_supported(const elf_machine_t machine) noexcept {
+	return !reloc_howtos(machine).empty();
+}
+
+elf_relocation_stats_t apply_relocations(const elf_machine_t machine, const elf_relocation_target_t& target,
+	const elf_relocation_t* relocations, const size_t count) {
+
+	elf_relocation_stats_t stats{0, 0, 0};
+	const auto howtos = reloc_howtos(machine);
+	if(howtos.empty()) {
+		stats.unsupported = count;
+		return stats;
+	}
+	const auto howto_of = [&howtos](const uint32_t type) {
+		return (type < howtos.size()) ? howtos[type] : reloc_howto_t{};
+	};
+
+	std::vector<uint32_t> batched{};
+	std::vector<uint32_t> sequenced{};
+	batched.reserve(count);
+	for(size_t idx{}; idx < count; ++idx)
+		(howto_of(relocations[idx].type).sequenced ? sequenced : batched).push_back(uint32_t(idx));
+	std::sort(batched.begin(), batched.end(), [relocations](const uint32_t a, const uint32_t b) {
+		if(relocations[a].type != relocations[b].type)
+			return relocations[a].type < relocations[b].type;
+		return relocations[a].offset < relocations[b].offset;
+	});
+
+	const auto symbol_value = [&target](const uint32_t symbol, uint64_t& value) {
+		if(symbol >= target.symbols.size())
+			return false;
+		value = target.symbols[symbol];
+		return true;
+	};
+
+	/* Each %pcrel_lo points at the AUIPC that did the matching %pcrel_hi */
+	std::vector<std::pair<uint64_t, uint64_t>> pcrel_hi{};
+	for(const uint32_t idx : batched) {
+		const auto& relocation = relocations[idx];
+		const auto howto = howto_of(relocation.type);
+		uint64_t value{};
+		if(howto.field == reloc_field_t::RvHi20 && howto.value == reloc_value_t::Relative &&
+			!relocation.implicit && symbol_value(relocation.symbol, value))
+			pcrel_hi.emplace_back(relocation.offset,
+				value + uint64_t(relocation.addend) - (target.address + relocation.offset));
+	}
+	std::sort(pcrel_hi.begin(), pcrel_hi.end());
+
+	const auto apply = [&](const elf_relocation_t& relocation, const reloc_howto_t& howto,
+		const reloc_field_op_t& field) {
+
+		if(howto.field == reloc_field_t::Unsupported || (relocation.implicit && howto.field != reloc_field_t::None &&
+			field.read == nullptr)) {
+			++stats.unsupported;
+			return;
+		}
+		if(howto.field == reloc_field_t::None) {
+			++stats.applied;
+			return;
+		}
+
+		const size_t length{target.contents.size()};
+		if(relocation.offset > length || field.size > length - relocation.offset) {
+			++stats.failed;
+			return;
+		}
+		uint8_t* const location{target.contents.data() + relocation.offset};
+		const uint64_t place{target.address + relocation.offset};
+		const uint64_t addend{uint64_t(relocation.implicit ? field.read(location) : relocation.addend)};
+
+		uint64_t symbol{};
+		if(!symbol_value(relocation.symbol, symbol)) {
+			++stats.failed;
+			return;
+		}
+
+		uint64_t value{};
+		switch(howto.value) {
+			case reloc_value_t::Absolute:
+				value = symbol + addend;
+				break;
+			case reloc_value_t::Relative:
+				value = symbol + addend - place;
+				break;
+			case reloc_value_t::Page:
+				value = ((symbol + addend) & ~uint64_t{0xFFFU}) - (place & ~uint64_t{0xFFFU});
+				break;
+			case reloc_value_t::Size:
+				value = ((relocation.symbol < target.sizes.size()) ? target.sizes[relocation.symbol] : 0U) + addend;
+				break;
+			case reloc_value_t::PcrelLo: {
+				const std::pair<uint64_t, uint64_t> key{symbol - target.address, 0};
+				const auto hi = std::lower_bound(pcrel_hi.begin(), pcrel_hi.end(), key);
+				if(hi == pcrel_hi.end() || hi->first != key.first) {
+					++stats.failed;
+					return;
+				}
+				value = hi->second;
+				break;
+			}
+			default:
+				break;
+		}
+
+		if(!reloc_fits(howto.check, howto.bits, value)) {
+			++stats.failed;
+			return;
+		}
+		field.write(location, value);
+		++stats.applied;
+	};
+
+	/* One handler per run of a type */
+	for(size_t first{}; first < batched.size();) {
+		const uint32_t type{relocations[batched[first]].type};
+		const reloc_howto_t howto{howto_of(type)};
+		const reloc_field_op_t& field{reloc_fields[size_t(howto.field)]};
+		size_t last{first};
+		for(; last < batched.size() && relocations[batched[last]].type == type; ++last)
+			apply(relocations[batched[last]], howto, field);
+		first = last;
+	}
+
+	for(const uint32_t idx : sequenced) {
+		const reloc_howto_t howto{howto_of(relocations[idx].type)};
+		apply(relocations[idx], howto, reloc_fields[size_t(howto.field)]);
+	}
+	return stats;
+}
+
+uint32_t elf_relative_type(const elf_machine_t machine) noexcept {
+	switch(machine) {
+		case elf_machine_t::I386:
+		case elf_machine_t::X86_64:
+			return 8U;
+		case elf_machine_t::ARM:
+			return 23U;
+		case elf_machine_t::AARCH64:
+			return 1027U;
+		case elf_machine_t::RISCV:
+			return 3U;
+		default:
+			return 0U;
+	}
+}
+
+uint64_t elf_relocation_bias(const elf_machine_t machine, const uint32_t type) noexcept {
+	/* Only x86 measures from the end of the field rather than from the field or instruction */
+	if(machine != elf_machine_t::X86_64)
+		return 0;
+	const auto howtos = reloc_howtos(machine);
+	if(type >= howtos.size() || howtos[type].value != reloc_value_t::Relative)
+		return 0;
+	return reloc_fields[size_t(howtos[type].field)].size;
+}
+
+template<typename U>
+static void append_relr(std::vector<uint8_t>& relr, const uint64_t word) {
+	const U value{U(word)};
+	const auto* bytes = reinterpret_cast<const uint8_t*>(&value); // lgtm[cpp/reinterpret-cast]
+	relr.insert(relr.end(), bytes, bytes + sizeof(U));
+}
+
+std::vector<uint8_t> encode_relr(std::vector<uint64_t> addresses, const size_t word_size) {
+	std::vector<uint8_t> relr{};
+	if(word_size != 4U && word_size != 8U)
+		return relr;
+
+	addresses.erase(std::remove_if(addresses.begin(), addresses.end(),
+		[word_size](const uint64_t address) { return (address % word_size) != 0; }), addresses.end());
+	std::sort(addresses.begin(), addresses.end());
+	addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+	const auto append = [&relr, word_size](const uint64_t word) {
+		if(word_size == 8U)
+			append_relr<uint64_t>(relr, word);
+		else
+			append_relr<uint32_t>(relr, word);
+	};
+
+	/* The low bit tells bitmaps apart from addresses, so each covers one less word than it has bits */
+	const uint64_t bitmap_words{(word_size * 8U) - 1U};
+	for(size_t idx{}; idx < addresses.size();) {
+		append(addresses[idx]);
+		uint64_t base{addresses[idx++] + word_size};
+		while(idx < addresses.size()) {
+			uint64_t bitmap{};
+			for(; idx < addresses.size(); ++idx) {
+				const uint64_t delta{(addresses[idx] - base) / word_size};
+				if(delta >= bitmap_words)
+					break;
+				bitmap |= uint64_t{1} << delta;
+			}
+			if(bitmap == 0)
+				break;
+			append((bitmap << 1U) | 1U);
+			base += bitmap_words * word_size;
+		}
+	}
+	return relr;
+}
+
+std::vector<uint64_t> decode_relr(const span<const uint8_t> relr, const size_t word_size) {
+	std::vector<uint64_t> addresses{};
+	if(word_size != 4U && word_size != 8U)
+		return addresses;
+
+	const uint64_t bitmap_words{(word_size * 8U) - 1U};
+	uint64_t base{};
+	for(size_t offset{}; offset + word_size <= relr.size(); offset += word_size) {
+		uint64_t word{};
+		if(word_size == 8U)
+			std::memcpy(&word, relr.data() + offset, sizeof(uint64_t));
+		else {
+			uint32_t narrow{};
+			std::memcpy(&narrow, relr.data() + offset, sizeof(uint32_t));
+			word = narrow;
+		}
+
+		if((word & 1U) == 0) {
+			addresses.push_back(word);
+			base = word + word_size;
+			continue;
+		}
+		for(uint64_t bit{}; (word >>= 1U) != 0; ++bit) {
+			if((word & 1U) != 0)
+				addresses.push_back(base + (bit * word_size));
+		}
+		base += bitmap_words * word_size;
+	}
+	return addresses;
+}
+
+/* Padding is relative to the start of the notes, which is itself `align` aligned */
+void elf_notes_t::iterator::advance() noexcept {
+	const size_t len{_data.size()};
+	const auto align_up = [this](const size_t value) { return (value + _align - 1U) & ~(_align - 1U); };
+	const size_t offset{_next};
+	if(_done || offset > len || (len - offset) < sizeof(elf32_nhdr_t)) {
+		_done = true;
+		return;
+	}
+
+	elf32_nhdr_t nhdr{};
+	std::memcpy(&nhdr, _data.data() + offset, sizeof(elf32_nhdr_t));
+	const size_t name{offset + sizeof(elf32_nhdr_t)};
+	if(nhdr.name_sz() > len - name) {
+		_done = true;
+		return;
+	}
+	const size_t desc{align_up(name + nhdr.name_sz())};
+	if(desc > len || nhdr.desc_sz() > len - desc) {
+		_done = true;
+		return;
+	}
+
+	const auto* const name_str = reinterpret_cast<const char*>(_data.data() + name); // lgtm[cpp/reinterpret-cast]
+	_note.type = nhdr.type();
+	_note.name = {name_str, ::strnlen(name_str, nhdr.name_sz())};
+	_note.desc = {_data.data() + desc, nhdr.desc_sz()};
+	_next = align_up(desc + nhdr.desc_sz());
+}
+
+bool elf_notes_t::find(const uint32_t type, const std::string_view name, elf_note_t& note) const noexcept {
+	for(const auto& entry : *this) {
+		if(entry.type == type && entry.name == name) {
+			note = entry;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<elf_gnu_property_t> decode_gnu_properties(const span<const uint8_t> desc, const size_t word_size) {
+	std::vector<elf_gnu_property_t> properties{};
+	if(word_size != 4U && word_size != 8U)
+		return properties;
+
+	const size_t len{desc.size()};
+	size_t offset{};
+	while(offset <= len && (len - offset) >= 8U) {
+		uint32_t type{};
+		uint32_t size{};
+		std::memcpy(&type, desc.data() + offset, sizeof(uint32_t));
+		std::memcpy(&size, desc.data() + offset + 4U, sizeof(uint32_t));
+		offset += 8U;
+		if(size > len - offset)
+			break;
+		properties.push_back({type, {desc.data() + offset, size}});
+		offset += (size + word_size - 1U) & ~(word_size - 1U);
+	}
+	return properties;
+}
+
+bool decode_abi_tag(const span<const uint8_t> desc, elf_abi_tag_t& tag) noexcept {
+	std::array<uint32_t, 4> words{};
+	if(desc.size() < sizeof(words))
+		return false;
+	std::memcpy(words.data(), desc.data(), sizeof(words));
+	tag = {elf_note_os_t(words[0]), words[1], words[2], words[3]};
+	return true;
+}
+
+/*
+	Reads a DW_EH_PE_* encoded pointer at `pos` in `data`, which is loaded at
+	`address`. `data_base` is what DataRel is relative to, nullptr where
+	there isn't anything for it to be relative to (i.e. .eh_frame).
+*/
+static bool read_eh_pointer(const span<const uint8_t> data, size_t& pos, const uint8_t encoding,
+	const uint64_t address, const uint64_t* const data_base, const size_t word_size, uint64_t& value) noexcept {
+
+	const size_t len{data.size()};
+	const auto application = elf_eh_encoding_t(encoding & 0x70U);
+	size_t offset{pos};
+	if(application == elf_eh_encoding_t::Aligned)
+		offset = size_t(((address + offset + word_size - 1U) & ~uint64_t(word_size - 1U)) - address);
+	const uint64_t field{address + offset};
+
+	const auto fixed = [&](const size_t size, const bool is_signed) {
+		if(offset > len || size > (len - offset))
+			return false;
+		uint64_t raw{};
+		std::memcpy(&raw, data.data() + offset, size);
+		if(is_signed && size < sizeof(uint64_t) && ((raw >> ((size * 8U) - 1U)) & 1U) != 0)
+			raw |= ~uint64_t{} << (size * 8U);
+		value = raw;
+		offset += size;
+		return true;
+	};
+
+	bool read{false};
+	switch(elf_eh_encoding_t(encoding & 0x0FU)) {
+		case elf_eh_encoding_t::AbsPtr: read = fixed(word_size, false); break;
+		case elf_eh_encoding_t::UData2: read = fixed(sizeof(uint16_t), false); break;
+		case elf_eh_encoding_t::UData4: read = fixed(sizeof(uint32_t), false); break;
+		case elf_eh_encoding_t::UData8: read = fixed(sizeof(uint64_t), false); break;
+		case elf_eh_encoding_t::SData2: read = fixed(sizeof(uint16_t), true); break;
+		case elf_eh_encoding_t::SData4: read = fixed(sizeof(uint32_t), true); break;
+		case elf_eh_encoding_t::SData8: read = fixed(sizeof(uint64_t), true); break;
+		case elf_eh_encoding_t::ULEB128: read = read_uleb128(data.data(), len, offset, value); break;
+		case elf_eh_encoding_t::SLEB128: {
+			int64_t signed_value{};
+			read = read_sleb128(data.data(), len, offset, signed_value);
+			value = uint64_t(signed_value);
+			break;
+		}
+		default: break;
+	}
+	if(!read)
+		return false;
+
+	switch(application) {
+		case elf_eh_encoding_t::AbsPtr:
+		case elf_eh_encoding_t::Aligned: break;
+		case elf_eh_encoding_t::PCRel: value += field; break;
+		case elf_eh_encoding_t::DataRel:
+			if(data_base == nullptr)
+				return false;
+			value += *data_base;
+			break;
+		default: return false;
+	}
+	if(word_size == sizeof(uint32_t))
+		value &= 0xFFFFFFFFU;
+	pos = offset;
+	return true;
+}
+
+/* The framing of one .eh_frame entry, the body being everything after the CIE id/pointer */
+struct eh_entry_t final {
+	size_t id_pos;
+	uint32_t id;
+	size_t body;
+	size_t end;
+};
+
+/* False for the zero terminator as well as anything that runs off the end */
+static bool read_eh_entry(const span<const uint8_t> data, const size_t offset, eh_entry_t& entry) noexcept {
+	const size_t len{data.size()};
+	if(offset > len || (len - offset) < sizeof(uint32_t))
+		return false;
+	uint32_t length{};
+	std::memcpy(&length, data.data() + offset, sizeof(uint32_t));
+	size_t pos{offset + sizeof(uint32_t)};
+	uint64_t size{length};
+	if(length == 0)
+		return false;
+	/* 64-bit DWARF only widens the length, the CIE pointer stays 4 bytes in .eh_frame */
+	if(length == 0xFFFFFFFFU) {
+		if((len - pos) < sizeof(uint64_t))
+			return false;
+		std::memcpy(&size, data.data() + pos, sizeof(uint64_t));
+		pos += sizeof(uint64_t);
+	}
+	if(size > (len - pos) || size < sizeof(uint32_t))
+		return false;
+	entry.id_pos = pos;
+	std::memcpy(&entry.id, data.data() + pos, sizeof(uint32_t));
+	entry.body = pos + sizeof(uint32_t);
+	entry.end = pos + size_t(size);
+	return true;
+}
+
+static bool parse_eh_cie(const span<const uint8_t> data, const uint64_t address, const size_t offset,
+	const size_t word_size, elf_eh_cie_t& cie) noexcept {
+
+	eh_entry_t entry{};
+	if(!read_eh_entry(data, offset, entry) || entry.id != 0 || entry.body >= entry.end)
+		return false;
+	const uint8_t* const bytes{data.data()};
+	const size_t end{entry.end};
+	size_t pos{entry.body};
+
+	cie = {};
+	cie.offset = offset;
+	cie.version = bytes[pos++];
+	cie.fde_encoding = uint8_t(elf_eh_encoding_t::AbsPtr);
+	cie.lsda_encoding = uint8_t(elf_eh_encoding_t::Omit);
+	const auto* const augmentation = reinterpret_cast<const char*>(bytes + pos); // lgtm[cpp/reinterpret-cast]
+	const size_t augmentation_len{::strnlen(augmentation, end - pos)};
+	if(augmentation_len == (end - pos))
+		return false;
+	cie.augmentation = {augmentation, augmentation_len};
+	pos += augmentation_len + 1U;
+
+	std::string_view remaining{cie.augmentation};
+	/* Ancient GCC, an eh_ptr follows the augmentation */
+	if(remaining.substr(0, 2) == "eh") {
+		pos += word_size;
+		remaining.remove_prefix(2);
+	}
+	if(!read_uleb128(bytes, end, pos, cie.code_align) || !read_sleb128(bytes, end, pos, cie.data_align))
+		return false;
+	if(cie.version == 1U) {
+		if(pos >= end)
+			return false;
+		cie.return_register = bytes[pos++];
+	} else if(!read_uleb128(bytes, end, pos, cie.return_register))
+		return false;
+
+	if(!remaining.empty()) {
+		/* Without the 'z' there's no telling where the rest of it ends */
+		uint64_t augmentation_size{};
+		if(remaining.front() != 'z' || !read_uleb128(bytes, end, pos, augmentation_size) ||
+			augmentation_size > (end - pos))
+			return false;
+		const size_t augmentation_end{pos + size_t(augmentation_size)};
+		const span<const uint8_t> fields{bytes, augmentation_end};
+		for(const char field : remaining.substr(1)) {
+			if(field == 'S') {
+				cie.signal_frame = true;
+				continue;
+			}
+			/* AArch64 BTI and MTE, neither carry any data */
+			if(field == 'B' || field == 'G')
+				continue;
+			if(field != 'R' && field != 'L' && field != 'P')
+				break;
+			if(pos >= augmentation_end)
+				return false;
+			const uint8_t encoding{bytes[pos++]};
+			if(field == 'R')
+				cie.fde_encoding = encoding;
+			else if(field == 'L')
+				cie.lsda_encoding = encoding;
+			else if(!read_eh_pointer(fields, pos, encoding, address, nullptr, word_size, cie.personality))
+				return false;
+		}
+		pos = augmentation_end;
+	}
+
+	cie.instructions = {bytes + pos, end - pos};
+	return true;
+}
+
+static bool parse_eh_fde(const span<const uint8_t> data, const uint64_t address, const eh_entry_t& entry,
+	const size_t offset, const size_t word_size, const elf_eh_cie_t& cie, elf_eh_fde_t& fde) noexcept {
+
+	const uint8_t* const bytes{data.data()};
+	const span<const uint8_t> body{bytes, entry.end};
+	size_t pos{entry.body};
+
+	fde = {};
+	fde.offset = offset;
+	fde.cie = cie.offset;
+	/* The range is only ever the format, never relative to anything */
+	if(!read_eh_pointer(body, pos, cie.fde_encoding, address, nullptr, word_size, fde.pc_begin) ||
+		!read_eh_pointer(body, pos, uint8_t(cie.fde_encoding & 0x0FU), address, nullptr, word_size, fde.pc_range))
+		return false;
+
+	if(!cie.augmentation.empty() && cie.augmentation.front() == 'z') {
+		uint64_t augmentation_size{};
+		if(!read_uleb128(bytes, entry.end, pos, augmentation_size) || augmentation_size > (entry.end - pos))
+			return false;
+		const size_t augmentation_end{pos + size_t(augmentation_size)};
+		if(cie.lsda_encoding != uint8_t(elf_eh_encoding_t::Omit) &&
+			!read_eh_pointer({bytes, augmentation_end}, pos, cie.lsda_encoding, address, nullptr, word_size, fde.lsda))
+			return false;
+		pos = augmentation_end;
+	}
+
+	fde.instructions = {bytes + pos, entry.end - pos};
+	return true;
+}
+
+static const elf_eh_cie_t* find_eh_cie(const std::vector<elf_eh_cie_t>& cies, const uint64_t offset) noexcept {
+	const auto cie = std::lower_bound(cies.begin(), cies.end(), offset,
+		[](const elf_eh_cie_t& entry, const uint64_t value) { return entry.offset < value; });
+	if(cie == cies.end() || cie->offset != offset)
+		return nullptr;
+	return &*cie;
+}
+
+elf_eh_frame_t parse_eh_frame(const span<const uint8_t> eh_frame, const uint64_t address, const size_t word_size) {
+	elf_eh_frame_t frame{};
+	if(word_size != 4U && word_size != 8U)
+		return frame;
+
+	eh_entry_t entry{};
+	for(size_t offset{}; read_eh_entry(eh_frame, offset, entry); offset = entry.end) {
+		if(entry.id == 0) {
+			elf_eh_cie_t cie{};
+			if(parse_eh_cie(eh_frame, address, offset, word_size, cie))
+				frame.cies.push_back(cie);
+			continue;
+		}
+
+		/* The CIE pointer is backwards from itself, the CIE is nearly always already parsed */
+		if(entry.id > entry.id_pos)
+			continue;
+		const size_t cie_offset{entry.id_pos - entry.id};
+		elf_eh_cie_t later{};
+		const elf_eh_cie_t* cie{find_eh_cie(frame.cies, cie_offset)};
+		if(cie == nullptr) {
+			if(!parse_eh_cie(eh_frame, address, cie_offset, word_size, later))
+				continue;
+			cie = &later;
+		}
+
+		elf_eh_fde_t fde{};
+		if(parse_eh_fde(eh_frame, address, entry, offset, word_size, *cie, fde))
+			frame.fdes.push_back(fde);
+	}
+
+	std::stable_sort(frame.fdes.begin(), frame.fdes.end(),
+		[](const elf_eh_fde_t& a, const elf_eh_fde_t& b) { return a.pc_begin < b.pc_begin; });
+	return frame;
+}
+
+bool decode_eh_fde(const span<const uint8_t> eh_frame, const uint64_t address, const uint64_t offset,
+	const size_t word_size, elf_eh_fde_t& fde) noexcept {
+
+	eh_entry_t entry{};
+	if((word_size != 4U && word_size != 8U) || offset > eh_frame.size() ||
+		!read_eh_entry(eh_frame, size_t(offset), entry) || entry.id == 0 || entry.id > entry.id_pos)
+		return false;
+	elf_eh_cie_t cie{};
+	return parse_eh_cie(eh_frame, address, entry.id_pos - entry.id, word_size, cie) &&
+		parse_eh_fde(eh_frame, address, entry, size_t(offset), word_size, cie, fde);
+}
+
+const elf_eh_fde_t* elf_eh_frame_t::find(const uint64_t pc) const noexcept {
+	auto fde = std::upper_bound(fdes.begin(), fdes.end(), pc,
+		[](const uint64_t value, const elf_eh_fde_t& entry) { return value < entry.pc_begin; });
+	if(fde == fdes.begin())
+		return nullptr;
+	--fde;
+	return fde->contains(pc) ? &*fde : nullptr;
+}
+
+const elf_eh_cie_t* elf_eh_frame_t::cie(const elf_eh_fde_t& fde) const noexcept {
+	return find_eh_cie(cies, fde.cie);
+}
+
+/* The only table encoding anything emits, and the only one with fixed size entries worth searching */
+static constexpr uint8_t eh_table_encoding{uint8_t(elf_eh_encoding_t::DataRel) | uint8_t(elf_eh_encoding_t::SData4)};
+
+bool parse_eh_frame_hdr(const span<const uint8_t> data, const uint64_t address, const size_t word_size,
+	elf_eh_frame_hdr_t& hdr) noexcept {
+
+	if((word_size != 4U && word_size != 8U) || data.size() < 4U || data[0] != 1U)
+		return false;
+	const uint8_t frame_encoding{data[1]};
+	const uint8_t count_encoding{data[2]};
+	const uint8_t table_encoding{data[3]};
+	constexpr auto omit = uint8_t(elf_eh_encoding_t::Omit);
+
+	hdr = {address, 0, {}, 0};
+	size_t pos{4U};
+	if(frame_encoding != omit &&
+		!read_eh_pointer(data, pos, frame_encoding, address, &address, word_size, hdr.eh_frame))
+		return false;
+	if(count_encoding == omit || table_encoding != eh_table_encoding)
+		return true;
+
+	uint64_t count{};
+	if(!read_eh_pointer(data, pos, count_encoding, address, &address, word_size, count) ||
+		count > ((data.size() - pos) / 8U))
+		return false;
+	hdr.table = {data.data() + pos, size_t(count) * 8U};
+	hdr.count = size_t(count);
+	return true;
+}
+
+bool elf_eh_frame_hdr_t::find(const uint64_t pc, uint64_t& fde) const noexcept {
+	const auto entry = [this](const size_t index, const size_t field) {
+		int32_t value{};
+		std::memcpy(&value, table.data() + (index * 8U) + (field * sizeof(int32_t)), sizeof(int32_t));
+		return address + uint64_t(int64_t(value));
+	};
+
+	/* upper_bound on the initial locations */
+	size_t first{};
+	for(size_t remaining{count}; remaining != 0;) {
+		const size_t step{remaining / 2U};
+		if(entry(first + step, 0) <= pc) {
+			first += step + 1U;
+			remaining -= step + 1U;
+		} else
+			remaining = step;
+	}
+	if(first == 0)
+		return false;
+	fde = entry(first - 1U, 1U);
+	return true;
+}
+
+std::vector<uint8_t> build_eh_frame_hdr(const elf_eh_frame_t& frame, const uint64_t eh_frame, const uint64_t address) {
+	const auto relative = [](const uint64_t value, const uint64_t base, int32_t& result) {
+		const auto delta = int64_t(value - base);
+		if(delta < std::numeric_limits<int32_t>::min() || delta > std::numeric_limits<int32_t>::max())
+			return false;
+		result = int32_t(delta);
+		return true;
+	};
+	if(frame.fdes.size() > std::numeric_limits<uint32_t>::max())
+		return {};
+
+	std::vector<uint8_t> hdr(12U + (frame.fdes.size() * 8U));
+	hdr[0] = 1U;
+	hdr[1] = uint8_t(elf_eh_encoding_t::PCRel) | uint8_t(elf_eh_encoding_t::SData4);
+	hdr[2] = uint8_t(elf_eh_encoding_t::UData4);
+	hdr[3] = eh_table_encoding;
+
+	int32_t frame_ptr{};
+	if(!relative(eh_frame, address + 4U, frame_ptr))
+		return {};
+	const auto count = uint32_t(frame.fdes.size());
+	std::memcpy(hdr.data() + 4U, &frame_ptr, sizeof(int32_t));
+	std::memcpy(hdr.data() + 8U, &count, sizeof(uint32_t));
+
+	/* fdes are already sorted by pc_begin, which is what the table is searched by */
+	size_t pos{12U};
+	for(const auto& fde : frame.fdes) {
+		std::array<int32_t, 2> entry{};
+		if(!relative(fde.pc_begin, address, entry[0]) || !relative(eh_frame + fde.offset, address, entry[1]))
+			return {};
+		std::memcpy(hdr.data() + pos, entry.data(), sizeof(entry));
+		pos += sizeof(entry);
+	}
+	return hdr;
+}
+
+/*
+	A deflate stream can't expand past ~1032:1, so anything claiming more
+	than that is junk and we don't want to go allocating for it.
+*/
+static constexpr uint64_t max_inflate_ratio{1032U};
+
+std::vector<uint8_t> elf_section_view_t::inflate() const {
+	if(_size > ((_raw.size() + 1U) * max_inflate_ratio))
+		return {};
+
+	const codec_t* codec{get_codec(elf_chdr_codec(_compression))};
+	if(codec == nullptr)
+		return {};
+
+	std::vector<uint8_t> contents(_size);
+	if(!codec->decompress(_raw.data(), _raw.size(), contents.data(), contents.size()))
+		return {};
+	return contents;
+}
+
+span<const uint8_t> elf_section_view_t::data() const {
+	if(!compressed())
+		return _raw;
+
+	if(!_inflated) {
+		if(_cache != nullptr)
+			_inflated = _cache->get_or_insert(_index, [this]() { return inflate(); });
+		else
+			_inflated = std::make_shared<const std::vector<uint8_t>>(inflate());
+	}
+	return {_inflated->data(), _inflated->size()};
+}
+
+uint32_t elf_xref_index_t::node(const size_t symtab, const size_t symbol) const noexcept {
+	const auto table = std::lower_bound(tables.begin(), tables.end(), symtab);
+	if(table == tables.end() || *table != symtab)
+		return npos;
+	const size_t idx{size_t(table - tables.begin())};
+	if(symbol >= size_t(bases[idx + 1U] - bases[idx]))
+		return npos;
+	return canonical[bases[idx] + symbol];
+}
+
+bool elf_xref_index_t::symbol(const uint32_t node, size_t& symtab, size_t& symbol) const noexcept {
+	if(node >= canonical.size())
+		return false;
+	const auto upper = std::upper_bound(bases.begin(), bases.end(), node);
+	const size_t idx{size_t(upper - bases.begin()) - 1U};
+	symtab = tables[idx];
+	symbol = node - bases[idx];
+	return true;
+}
+
+std::vector<uint32_t> elf_xref_index_t::reachable(const std::vector<uint32_t>& roots) const {
+	std::vector<uint32_t> folded{};
+	folded.reserve(roots.size());
+	for(const uint32_t root : roots) {
+		if(root < canonical.size())
+			folded.push_back(canonical[root]);
+	}
+	return index.reachable(folded);
+}
+
+elf_class_t elf_class_of(const fs::path& file) noexcept {
+	const fd_t fd{file.c_str(), O_RDONLY};
+	elf_ident_t ident{};
+	if(!fd.valid() || !fd.read(ident) || !ident.magic().is_valid() || ident.data() != elf_host_data)
+		return elf_class_t::None;
+	if(ident.eclass() != elf_class_t::ELF32 && ident.eclass() != elf_class_t::ELF64)
+		return elf_class_t::None;
+	return ident.eclass();
+}
+
+bool open_elf(const fs::path& file, elf_any_t& elf) {
+	bool valid{false};
+	switch(elf_class_of(file)) {
+		case elf_class_t::ELF32:
+			valid = elf.emplace<elf32_t>(file).valid();
+			break;
+		case elf_class_t::ELF64:
+			valid = elf.emplace<elf64_t>(file).valid();
+			break;
+		default:
+			break;
+	}
+	if(!valid)
+		elf.emplace<std::monostate>();
+	return valid;
+}
+
 /* ELF enum <-> string mappings */
 /* I know, I know, i can't find a better way, so sue me. */
 const std::array<const enum_pair_t<elf_class_t>, 3> elf_class_s{{
@@ -327,7 +1715,7 @@ std::ostream& operator<<(std::ostream& out, const elf_shns_t& shns) {
 
 
 
-const std::array<const enum_pair_t<elf_shtype_t>, 33> elf_shtype_s{{
+const std::array<const enum_pair_t<elf_shtype_t>, 34> elf_shtype_s{{
 	{ elf_shtype_t::Null,             "Null"                   },
 	{ elf_shtype_t::ProgBits,         "Prog Bits"              },
 	{ elf_shtype_t::SymbolTable,      "Symbol Table"           },
@@ -345,6 +1733,7 @@ const std::array<const enum_pair_t<elf_shtype_t>, 33> elf_shtype_s{{
 	{ elf_shtype_t::PreinitArray,     "Preinit Array"          },
 	{ elf_shtype_t::Group,            "Group"                  },
 	{ elf_shtype_t::SymbolTableIndex, "Symbol Table Index"     },
+	{ elf_shtype_t::Relr,             "Relr"                   },
 	{ elf_shtype_t::LowOS,            "Low OS"                 },
 	{ elf_shtype_t::GNUAttributes,    "GNU Attributes"         },
 	{ elf_shtype_t::GNUHash,          "GNU Hash"               },
@@ -484,7 +1873,7 @@ std::ostream& operator<<(std::ostream& out, const elf_syminfo_flag_t& symiflag)
 	return (out << enum_name(elf_syminfo_flag_s, symiflag));
 }
 
-const std::array<const enum_pair_t<elf_phdr_type_t>, 17> elf_phdr_type_s{{
+const std::array<const enum_pair_t<elf_phdr_type_t>, 18> elf_phdr_type_s{{
 	{ elf_phdr_type_t::None,               "None"                     },
 	{ elf_phdr_type_t::Load,               "Load"                     },
 	{ elf_phdr_type_t::Dynamic,            "Dynamic"                  },
@@ -497,6 +1886,7 @@ const std::array<const enum_pair_t<elf_phdr_type_t>, 17> elf_phdr_type_s{{
 	{ elf_phdr_type_t::GNUEHFrame,         "GNU EH Frame"             },
 	{ elf_phdr_type_t::GNUStack,           "GNU Stack"                },
 	{ elf_phdr_type_t::GNURelRO,           "GNU Read Only Relocation" },
+	{ elf_phdr_type_t::GNUProperty,        "GNU Property"             },
 	{ elf_phdr_type_t::SUNBSS,             "SUN BSS"                  },
 	{ elf_phdr_type_t::SUNStack,           "SUN Stack"                },
 	{ elf_phdr_type_t::HighOS,             "High OS"                  },
@@ -585,7 +1975,7 @@ std::ostream& operator<<(std::ostream& out, const elf_note_desc_t& notedesc) {
 	return (out << enum_name(elf_note_desc_s, notedesc));
 }
 
-const std::array<const enum_pair_t<elf32_dyn_tag_t>, 71> elf32_dyn_tag_s{{
+const std::array<const enum_pair_t<elf32_dyn_tag_t>, 74> elf32_dyn_tag_s{{
 	{ elf32_dyn_tag_t::None,             "None"                                  },
 	{ elf32_dyn_tag_t::Needed,           "Name of needed library"                },
 	{ elf32_dyn_tag_t::PLTRelSize,       "Size of PLT relocations"               },
@@ -620,6 +2010,9 @@ const std::array<const enum_pair_t<elf32_dyn_tag_t>, 71> elf32_dyn_tag_s{{
 	{ elf32_dyn_tag_t::Encoding,         "Start of encoded range"                },
 	{ elf32_dyn_tag_t::PreInitArray,     "Array with addresses of preinit funcs" },
 	{ elf32_dyn_tag_t::PreInitArraySize, "Size of preinit funcs array"           },
+	{ elf32_dyn_tag_t::RelrSize,         "Total size of Relr relocations"        },
+	{ elf32_dyn_tag_t::Relr,             "Address of Relr relocations"           },
+	{ elf32_dyn_tag_t::RelrEnt,          "Size of one Relr relocation"           },
 	{ elf32_dyn_tag_t::LowOS,            "Low OS"                                },
 	{ elf32_dyn_tag_t::HighOS,           "High OS"                               },
 	{ elf32_dyn_tag_t::GNUPrelinked,     "Prelinking timestamp"                  },
@@ -661,7 +2054,7 @@ std::ostream& operator<<(std::ostream& out, const elf32_dyn_tag_t& dyntag) {
 	return (out << enum_name(elf32_dyn_tag_s, dyntag));
 }
 
-const std::array<const enum_pair_t<elf64_dyn_tag_t>, 71> elf64_dyn_tag_s{{
+const std::array<const enum_pair_t<elf64_dyn_tag_t>, 74> elf64_dyn_tag_s{{
 	{ elf64_dyn_tag_t::None,             "None"                                  },
 	{ elf64_dyn_tag_t::Needed,           "Name of needed library"                },
 	{ elf64_dyn_tag_t::PLTRelSize,       "Size of PLT relocations"               },
@@ -696,6 +2089,9 @@ const std::array<const enum_pair_t<elf64_dyn_tag_t>, 71> elf64_dyn_tag_s{{
 	{ elf64_dyn_tag_t::Encoding,         "Start of encoded range"                },
 	{ elf64_dyn_tag_t::PreInitArray,     "Array with addresses of preinit funcs" },
 	{ elf64_dyn_tag_t::PreInitArraySize, "Size of preinit funcs array"           },
+	{ elf64_dyn_tag_t::RelrSize,         "Total size of Relr relocations"        },
+	{ elf64_dyn_tag_t::Relr,             "Address of Relr relocations"           },
+	{ elf64_dyn_tag_t::RelrEnt,          "Size of one Relr relocation"           },
 	{ elf64_dyn_tag_t::LowOS,            "Low OS"                                },
 	{ elf64_dyn_tag_t::HighOS,           "High OS"                               },
 	{ elf64_dyn_tag_t::GNUPrelinked,     "Prelinking timestamp"                  },
@@ -805,9 +2201,10 @@ std::ostream& operator<<(std::ostream& out, const elf_dyn_posflag_t& dynposf) {
 	return (out << enum_name(elf_dyn_posflag_s, dynposf));
 }
 
-const std::array<const enum_pair_t<elf_chdr_type_t>, 6> elf_chdr_type_s{{
+const std::array<const enum_pair_t<elf_chdr_type_t>, 7> elf_chdr_type_s{{
 	{ elf_chdr_type_t::None,     "None"           },
 	{ elf_chdr_type_t::Zlib,     "ZLib"           },
+	{ elf_chdr_type_t::Zstd,     "Zstd"           },
 	{ elf_chdr_type_t::LowOS,    "Low OS"         },
 	{ elf_chdr_type_t::HighOS,   "High OS"        },
 	{ elf_chdr_type_t::LowProc,  "Low Processor"  },
@@ -817,6 +2214,22 @@ std::ostream& operator<<(std::ostream& out, const elf_chdr_type_t& chdrtype) {
 	return (out << enum_name(elf_chdr_type_s, chdrtype));
 }
 
+codec_type_t elf_chdr_codec(const elf_chdr_type_t type) noexcept {
+	switch(type) {
+		case elf_chdr_type_t::Zlib: return codec_type_t::Zlib;
+		case elf_chdr_type_t::Zstd: return codec_type_t::Zstd;
+		default: return codec_type_t::None;
+	}
+}
+
+elf_chdr_type_t elf_codec_chdr(const codec_type_t codec) noexcept {
+	switch(codec) {
+		case codec_type_t::Zlib: return elf_chdr_type_t::Zlib;
+		case codec_type_t::Zstd: return elf_chdr_type_t::Zstd;
+		default: return elf_chdr_type_t::None;
+	}
+}
+
 const std::array<const enum_pair_t<elf_verdef_revision_t>, 2> elf_verdef_revision_s{{
 	{ elf_verdef_revision_t::None,    "None"    },
 	{ elf_verdef_revision_t::Current, "Current" },
@@ -920,3 +2333,37 @@ const std::array<const enum_pair_t<elf_note_type_t>, 6> elf_note_type_s{{
 std::ostream& operator<<(std::ostream& out, const elf_note_type_t& notetype) {
 	return (out << enum_name(elf_note_type_s, notetype));
 }
+
+const std::array<const enum_pair_t<elf_gnu_property_type_t>, 6> elf_gnu_property_type_s{{
+	{ elf_gnu_property_type_t::StackSize,          "StackSize"          },
+	{ elf_gnu_property_type_t::NoCopyOnProtected,  "NoCopyOnProtected"  },
+	{ elf_gnu_property_type_t::AArch64Feature1And, "AArch64Feature1And" },
+	{ elf_gnu_property_type_t::X86Feature1And,     "X86Feature1And"     },
+	{ elf_gnu_property_type_t::X86ISA1Needed,      "X86ISA1Needed"      },
+	{ elf_gnu_property_type_t::X86Feature2Used,    "X86Feature2Used"    },
+}};
+std::ostream& operator<<(std::ostream& out, const elf_gnu_property_type_t& proptype) {
+	return (out << enum_name(elf_gnu_property_type_s, proptype));
+}
+
+const std::array<const enum_pair_t<elf_eh_encoding_t>, 16> elf_eh_encoding_s{{
+	{ elf_eh_encoding_t::AbsPtr,   "AbsPtr"   },
+	{ elf_eh_encoding_t::ULEB128,  "ULEB128"  },
+	{ elf_eh_encoding_t::UData2,   "UData2"   },
+	{ elf_eh_encoding_t::UData4,   "UData4"   },
+	{ elf_eh_encoding_t::UData8,   "UData8"   },
+	{ elf_eh_encoding_t::SLEB128,  "SLEB128"  },
+	{ elf_eh_encoding_t::SData2,   "SData2"   },
+	{ elf_eh_encoding_t::SData4,   "SData4"   },
+	{ elf_eh_encoding_t::SData8,   "SData8"   },
+	{ elf_eh_encoding_t::PCRel,    "PCRel"    },
+	{ elf_eh_encoding_t::TextRel,  "TextRel"  },
+	{ elf_eh_encoding_t::DataRel,  "DataRel"  },
+	{ elf_eh_encoding_t::FuncRel,  "FuncRel"  },
+	{ elf_eh_encoding_t::Aligned,  "Aligned"  },
+	{ elf_eh_encoding_t::Indirect, "Indirect" },
+	{ elf_eh_encoding_t::Omit,     "Omit"     },
+}};
+std::ostream& operator<<(std::ostream& out, const elf_eh_encoding_t& encoding) {
+	return (out << enum_name(elf_eh_encoding_s, encoding));
+}
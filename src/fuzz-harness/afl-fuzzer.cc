@@ -12,17 +12,22 @@ int main(int argc, char** argv) {
 
 
 #if defined(_fuzz_target_elf)
-	elf64_t elf{argv[1]};
-	std::cout << "CLASS: " << elf.header().ident().eclass() << "\n";
-	std::cout << "DATA: " << elf.header().ident().data() << "\n";
-	std::cout << "VERSION: " << elf.header().ident().version() << "\n";
-	std::cout << "ABI: " << elf.header().ident().abi() << "\n";
-	std::cout << "ABI VERSION: " << elf.header().ident().abi_version() << "\n";
-	std::cout << "TYPE: " << elf.header().type() << "\n";
-	std::cout << "MACHINE: " << elf.header().machine() << "\n";
-	std::cout << "VERSION: " << elf.header().version() << "\n";
-	std::cout << "ENTRY: " << elf.header().entry() << "\n";
-	std::cout << "PHOFF: " << elf.header().phoff() << "\n";
+	elf_any_t elf{};
+	if(!open_elf(argv[1], elf))
+		return 0;
+	visit_elf(elf, [](const auto& object) {
+		const auto header = object.header();
+		std::cout << "CLASS: " << header.ident().eclass() << "\n";
+		std::cout << "DATA: " << header.ident().data() << "\n";
+		std::cout << "VERSION: " << header.ident().version() << "\n";
+		std::cout << "ABI: " << header.ident().abi() << "\n";
+		std::cout << "ABI VERSION: " << header.ident().abi_version() << "\n";
+		std::cout << "TYPE: " << header.type() << "\n";
+		std::cout << "MACHINE: " << header.machine() << "\n";
+		std::cout << "VERSION: " << header.version() << "\n";
+		std::cout << "ENTRY: " << header.entry() << "\n";
+		std::cout << "PHOFF: " << header.phoff() << "\n";
+	});
 
 #endif
 
@@ -0,0 +1,81 @@
+/* address_index.hh - Virtual address <-> file offset translation */
+#pragma once
+#if !defined(__SNS_ADDRESS_INDEX_HH__)
+#define __SNS_ADDRESS_INDEX_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/* A loaded range, a segment or a section, independent of the object format */
+struct address_range_t final {
+	uint64_t address;   /* Where it starts in memory */
+	uint64_t offset;    /* Where it starts in the file */
+	uint64_t file_size; /* How much of it comes from the file */
+	uint64_t mem_size;  /* How much of it there is in memory, the rest being zero fill */
+	uint32_t index;     /* Segment or section it came from */
+
+	[[nodiscard]]
+	bool contains_address(const uint64_t addr) const noexcept { return (addr - address) < mem_size; }
+	[[nodiscard]]
+	bool contains_offset(const uint64_t off) const noexcept { return (off - offset) < file_size; }
+};
+
+/*
+	Ranges sorted both by address and by file offset so either direction is
+	a single binary search. Memory ranges are not allowed to overlap, where
+	they do the earlier one is cut short. File ranges are, as neighbouring
+	segments often map the same page, the lowest address wins there.
+
+	Batch lookups try the range the previous one landed in before searching,
+	pointer chasing and sorted input tend to stay inside the same segment.
+*/
+struct address_index_t final {
+	constexpr static const uint64_t npos{std::numeric_limits<uint64_t>::max()};
+private:
+	std::vector<address_range_t> _ranges; /* By address */
+	std::vector<uint32_t> _by_offset;     /* Into _ranges, by file offset */
+	std::vector<uint64_t> _reach;         /* Furthest file end up to each _by_offset entry */
+	std::vector<uint8_t> _shared;         /* If a range's file bytes are also loaded elsewhere */
+
+	[[nodiscard]]
+	const address_range_t* search_address(uint64_t address) const noexcept;
+	[[nodiscard]]
+	const address_range_t* search_offset(uint64_t offset) const noexcept;
+public:
+	address_index_t() noexcept :
+		_ranges{}, _by_offset{}, _reach{}, _shared{} { /* NOP */ }
+
+	explicit address_index_t(std::vector<address_range_t> ranges);
+
+	/* The range covering `address`, nullptr if nothing is mapped there */
+	[[nodiscard]]
+	const address_range_t* find_address(uint64_t address) const noexcept { return search_address(address); }
+	/* The range `offset` is loaded by, nullptr if it isn't */
+	[[nodiscard]]
+	const address_range_t* find_offset(uint64_t offset) const noexcept { return search_offset(offset); }
+
+	/* npos if the address is unmapped, or zero fill without any backing in the file */
+	[[nodiscard]]
+	uint64_t to_offset(uint64_t address) const noexcept;
+	[[nodiscard]]
+	uint64_t to_address(uint64_t offset) const noexcept;
+
+	/* `results` must have room for `count` entries, npos as for the single lookups */
+	void to_offsets(const uint64_t* addresses, size_t count, uint64_t* offsets) const noexcept;
+	void to_addresses(const uint64_t* offsets, size_t count, uint64_t* addresses) const noexcept;
+
+	/* How many bytes from `address` to the end of its range are backed by the file */
+	[[nodiscard]]
+	uint64_t file_extent(uint64_t address) const noexcept;
+
+	[[nodiscard]]
+	const std::vector<address_range_t>& ranges() const noexcept { return _ranges; }
+	[[nodiscard]]
+	size_t size() const noexcept { return _ranges.size(); }
+	[[nodiscard]]
+	bool empty() const noexcept { return _ranges.empty(); }
+};
+
+#endif /* __SNS_ADDRESS_INDEX_HH__ */
@@ -0,0 +1,234 @@
+/* codec.hh - Common interface over the section compression backends */
+#pragma once
+#if !defined(__SNS_CODEC_HH__)
+#define __SNS_CODEC_HH__
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <span.hh>
+#include <utility.hh>
+
+/* Compression backends */
+enum class codec_type_t : uint8_t {
+	None = 0x00U,
+	Zlib = 0x01U,
+	Zstd = 0x02U,
+};
+extern const std::array<const enum_pair_t<codec_type_t>, 3> codec_type_s;
+extern std::ostream& operator<<(std::ostream& out, const codec_type_t& codec);
+
+/*
+	A dictionary trained for one codec, referenced by the ID the compressed
+	data itself records. For zlib that is the adler32 of the dictionary, for
+	zstd the one written into the dictionary header when it was trained.
+*/
+struct codec_dictionary_t final {
+private:
+	codec_type_t _codec;
+	uint32_t _id;
+	std::vector<uint8_t> _contents;
+public:
+	codec_dictionary_t() noexcept :
+		_codec{codec_type_t::None}, _id{}, _contents{} { /* NOP */ }
+
+	codec_dictionary_t(const codec_type_t codec, const uint32_t id, std::vector<uint8_t> contents) noexcept :
+		_codec{codec}, _id{id}, _contents{std::move(contents)} { /* NOP */ }
+
+	[[nodiscard]]
+	codec_type_t codec() const noexcept { return _codec; }
+	[[nodiscard]]
+	uint32_t id() const noexcept { return _id; }
+	[[nodiscard]]
+	const std::vector<uint8_t>& contents() const noexcept { return _contents; }
+	[[nodiscard]]
+	bool empty() const noexcept { return _contents.empty(); }
+};
+
+struct codec_t {
+	virtual ~codec_t() noexcept = default;
+
+	[[nodiscard]]
+	virtual codec_type_t type() const noexcept = 0;
+
+	[[nodiscard]]
+	virtual int32_t min_level() const noexcept = 0;
+	[[nodiscard]]
+	virtual int32_t max_level() const noexcept = 0;
+	[[nodiscard]]
+	virtual int32_t default_level() const noexcept = 0;
+	/* Levels the compression policy picks between */
+	[[nodiscard]]
+	virtual int32_t fast_level() const noexcept = 0;
+	[[nodiscard]]
+	virtual int32_t strong_level() const noexcept = 0;
+
+	/* Decompresses exactly `output_len` bytes, anything else is a failure */
+	[[nodiscard]]
+	virtual bool decompress(const uint8_t* input, size_t input_len,
+		uint8_t* output, size_t output_len) const noexcept = 0;
+
+	/* Returns an empty buffer on failure */
+	[[nodiscard]]
+	virtual std::vector<uint8_t> compress(const uint8_t* input, size_t input_len,
+		int32_t level) const = 0;
+
+	[[nodiscard]]
+	std::vector<uint8_t> compress(const uint8_t* input, size_t input_len) const {
+		return compress(input, input_len, default_level());
+	}
+
+	/* Dictionaries for other codecs are a failure */
+	[[nodiscard]]
+	virtual bool decompress(const uint8_t* input, size_t input_len, uint8_t* output,
+		size_t output_len, const codec_dictionary_t& dictionary) const noexcept = 0;
+
+	[[nodiscard]]
+	virtual std::vector<uint8_t> compress(const uint8_t* input, size_t input_len,
+		int32_t level, const codec_dictionary_t& dictionary) const = 0;
+
+	/* ID of the dictionary the compressed data needs, 0 if it doesn't need one */
+	[[nodiscard]]
+	virtual uint32_t dictionary_id(const uint8_t* input, size_t input_len) const noexcept = 0;
+
+	/* Wraps an existing dictionary, i.e. one read back from disk */
+	[[nodiscard]]
+	virtual codec_dictionary_t dictionary(std::vector<uint8_t> contents) const = 0;
+
+	/* Empty if nothing useful could be learned from the samples */
+	[[nodiscard]]
+	virtual codec_dictionary_t train(const std::vector<span<const uint8_t>>& samples,
+		size_t capacity) const = 0;
+	[[nodiscard]]
+	virtual size_t default_dictionary_size() const noexcept = 0;
+
+	[[nodiscard]]
+	codec_dictionary_t train(const std::vector<span<const uint8_t>>& samples) const {
+		return train(samples, default_dictionary_size());
+	}
+};
+
+/* nullptr if SNS was built without support for the codec */
+[[nodiscard]]
+const codec_t* get_codec(codec_type_t type) noexcept;
+
+[[nodiscard]]
+inline bool codec_available(const codec_type_t type) noexcept { return get_codec(type) != nullptr; }
+
+/*
+	Every dictionary we know about, so that compressed data can find the one
+	it was built against from the ID it carries. Adding a dictionary whose
+	ID is already present keeps the existing one.
+*/
+struct dictionary_store_t final {
+	using dictionary_ptr = std::shared_ptr<const codec_dictionary_t>;
+private:
+	mutable std::mutex _lock;
+	std::unordered_map<uint64_t, dictionary_ptr> _dictionaries;
+
+	static uint64_t key(const codec_type_t codec, const uint32_t id) noexcept {
+		return (uint64_t(codec) << 32U) | id;
+	}
+public:
+	dictionary_store_t() noexcept : _lock{}, _dictionaries{} { /* NOP */ }
+
+	dictionary_store_t(const dictionary_store_t&) = delete;
+	dictionary_store_t& operator=(const dictionary_store_t&) = delete;
+
+	/* Empty dictionaries and those without an ID can't be referenced, so aren't stored */
+	dictionary_ptr add(codec_dictionary_t dictionary);
+
+	[[nodiscard]]
+	dictionary_ptr find(codec_type_t codec, uint32_t id) const noexcept;
+
+	[[nodiscard]]
+	size_t count() const noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		return _dictionaries.size();
+	}
+
+	/* Decompresses with whichever dictionary the data asks for, if any */
+	[[nodiscard]]
+	bool decompress(codec_type_t codec, const uint8_t* input, size_t input_len,
+		uint8_t* output, size_t output_len) const noexcept;
+};
+
+/* Shannon entropy of the byte distribution in bits per byte, 0.0 - 8.0 */
+[[nodiscard]]
+double byte_entropy(const uint8_t* data, size_t len) noexcept;
+
+/* What the compression policy settled on for a buffer */
+struct codec_choice_t final {
+	codec_type_t codec; /* None if the data should be left alone */
+	int32_t level;
+	double entropy;     /* Sampled entropy in bits per byte */
+	double ratio;       /* Trial compressed size over sampled size, 1.0 if no trial was run */
+};
+
+/*
+	Decides per-buffer if compression is worthwhile and how hard to try.
+
+	A handful of evenly spaced blocks are sampled, if their byte entropy is
+	already close to random (compressed, encrypted, or just noise) we bail
+	immediately. Otherwise the samples are trial compressed at the fast
+	level, anything that doesn't gain at least `min_gain` is left alone,
+	anything that compresses well gets the strong level since that's where
+	the extra CPU actually pays for itself.
+*/
+struct compression_policy_t final {
+private:
+	codec_type_t _preferred; /* Used if available, otherwise falls back to zlib */
+	size_t _min_size;        /* Anything smaller isn't worth the chdr_t */
+	size_t _block_size;      /* Size of each sampled block */
+	size_t _sample_blocks;   /* Number of blocks sampled */
+	double _max_entropy;     /* Entropy past which we don't even trial */
+	double _min_gain;        /* Fraction that must be saved to bother */
+	double _strong_ratio;    /* Trial ratio at or under which the strong level is used */
+public:
+	compression_policy_t() noexcept :
+		_preferred{codec_type_t::Zstd}, _min_size{256}, _block_size{4_KiB},
+		_sample_blocks{8}, _max_entropy{7.5}, _min_gain{0.05}, _strong_ratio{0.6}
+		{ /* NOP */ }
+
+	void preferred(const codec_type_t preferred) noexcept { _preferred = preferred; }
+	[[nodiscard]]
+	codec_type_t preferred() const noexcept { return _preferred; }
+
+	void min_size(const size_t min_size) noexcept { _min_size = min_size; }
+	[[nodiscard]]
+	size_t min_size() const noexcept { return _min_size; }
+
+	void block_size(const size_t block_size) noexcept { _block_size = block_size; }
+	[[nodiscard]]
+	size_t block_size() const noexcept { return _block_size; }
+
+	void sample_blocks(const size_t sample_blocks) noexcept { _sample_blocks = sample_blocks; }
+	[[nodiscard]]
+	size_t sample_blocks() const noexcept { return _sample_blocks; }
+
+	void max_entropy(const double max_entropy) noexcept { _max_entropy = max_entropy; }
+	[[nodiscard]]
+	double max_entropy() const noexcept { return _max_entropy; }
+
+	void min_gain(const double min_gain) noexcept { _min_gain = min_gain; }
+	[[nodiscard]]
+	double min_gain() const noexcept { return _min_gain; }
+
+	void strong_ratio(const double strong_ratio) noexcept { _strong_ratio = strong_ratio; }
+	[[nodiscard]]
+	double strong_ratio() const noexcept { return _strong_ratio; }
+
+	/* The codec that would be used, ignoring the data */
+	[[nodiscard]]
+	const codec_t* codec() const noexcept;
+
+	[[nodiscard]]
+	codec_choice_t choose(const uint8_t* data, size_t len) const;
+};
+
+#endif /* __SNS_CODEC_HH__ */
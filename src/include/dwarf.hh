@@ -0,0 +1,149 @@
+/* dwarf.hh - DWARF line tables and address to source line lookup */
+#pragma once
+#if !defined(__SNS_DWARF_HH__)
+#define __SNS_DWARF_HH__
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include <lru_cache.hh>
+#include <span.hh>
+#include <utility.hh>
+
+/* The debug sections as the line index sees them, any of them can be empty */
+struct dwarf_sections_t final {
+	span<const uint8_t> info;
+	span<const uint8_t> abbrev;
+	span<const uint8_t> aranges;
+	span<const uint8_t> line;
+	span<const uint8_t> line_str;
+	span<const uint8_t> str;
+};
+
+/* One .debug_aranges tuple */
+struct dwarf_arange_t final {
+	uint64_t address;
+	uint64_t length;
+	uint64_t unit;    /* Offset of the CU in .debug_info */
+};
+
+/* Every tuple in every set, in the order they're in, stopping at the first malformed set */
+[[nodiscard]]
+std::vector<dwarf_arange_t> decode_aranges(span<const uint8_t> aranges);
+
+/* DW_AT_stmt_list of the CU at `unit` in .debug_info, false if it doesn't have one */
+[[nodiscard]]
+bool decode_stmt_list(span<const uint8_t> info, span<const uint8_t> abbrev, uint64_t unit,
+	uint64_t& offset) noexcept;
+
+/* One row of the line number matrix, 16 bytes so a CU's worth stays cache friendly */
+struct dwarf_line_row_t final {
+	/* The row's file when it's the address just past the end of a sequence */
+	constexpr static const uint16_t end_sequence{std::numeric_limits<uint16_t>::max()};
+
+	uint64_t address;
+	uint32_t line;
+	uint16_t column;
+	uint16_t file;    /* Into the table's files as numbered by the line program */
+};
+
+/* A file table entry, both pointing into .debug_line, .debug_line_str, or .debug_str */
+struct dwarf_file_t final {
+	std::string_view directory; /* Empty for the compilation directory prior to DWARF 5 */
+	std::string_view name;
+};
+
+/* A decoded line program */
+struct dwarf_line_table_t final {
+	std::vector<dwarf_file_t> files;     /* 1 based prior to DWARF 5, entry 0 being empty */
+	std::vector<dwarf_line_row_t> rows;  /* Sequences sorted by address, each ended by an end_sequence row */
+
+	/* The row covering `address`, nullptr if it's outside of every sequence */
+	[[nodiscard]]
+	const dwarf_line_row_t* find(uint64_t address) const noexcept;
+};
+
+/*
+	Runs the line program at `offset` in .debug_line, DWARF 2 through 5.
+	Only .debug_line, .debug_line_str, and .debug_str are used. Returns
+	false if the header is malformed, if the program itself goes wrong
+	part way through the rows up to that point are kept.
+*/
+[[nodiscard]]
+bool decode_line_table(const dwarf_sections_t& sections, uint64_t offset, dwarf_line_table_t& table);
+
+/* Where an address came from, line 0 and an empty file if there's no row for it */
+struct dwarf_line_t final {
+	std::string_view directory;
+	std::string_view file;
+	uint32_t line;
+	uint16_t column;
+};
+
+/* What the row cache charges for a line table */
+struct dwarf_line_table_cost_t final {
+	size_t operator()(const dwarf_line_table_t& table) const noexcept {
+		return (table.rows.size() * sizeof(dwarf_line_row_t)) + (table.files.size() * sizeof(dwarf_file_t));
+	}
+};
+
+/*
+	Address to file:line lookup for batch symbolization. The address ranges
+	of every CU come from .debug_aranges up front, which is small, and each
+	CU's line program is only decoded the first time an address lands in it.
+	Decoded tables are kept in a byte bounded LRU cache, so the memory used
+	is the ranges plus at most `cache_limit` of rows no matter how big the
+	debug info is.
+
+	Without .debug_aranges every line program has to be run once to find
+	out what it covers, what fits of the result primes the cache.
+
+	Only .debug_line, .debug_line_str, and .debug_str need to outlive the
+	index, the rest of `sections` is only looked at while it's built.
+*/
+struct dwarf_line_index_t final {
+	constexpr static const size_t default_cache_limit{64_MiB};
+
+	/* [address, end) is covered by the line program at `unit` in .debug_line */
+	struct range_t final {
+		uint64_t address;
+		uint64_t end;
+		uint64_t unit;
+	};
+	using cache_t = lru_cache_t<uint64_t, dwarf_line_table_t, dwarf_line_table_cost_t>;
+private:
+	dwarf_sections_t _sections;
+	std::vector<range_t> _ranges; /* By address */
+	mutable cache_t _tables;      /* By .debug_line offset */
+
+	[[nodiscard]]
+	const range_t* search(uint64_t address) const noexcept;
+	[[nodiscard]]
+	cache_t::value_ptr table(uint64_t unit) const;
+public:
+	dwarf_line_index_t() noexcept :
+		_sections{}, _ranges{}, _tables{default_cache_limit} { /* NOP */ }
+
+	explicit dwarf_line_index_t(const dwarf_sections_t& sections, size_t cache_limit = default_cache_limit);
+
+	[[nodiscard]]
+	bool find(uint64_t address, dwarf_line_t& line) const;
+
+	/*
+		`results` must have room for `count` entries. The addresses are
+		grouped by CU first so each line table is only looked up, or
+		decoded, once per batch.
+	*/
+	void find(const uint64_t* addresses, size_t count, dwarf_line_t* results) const;
+
+	[[nodiscard]]
+	const std::vector<range_t>& ranges() const noexcept { return _ranges; }
+	[[nodiscard]]
+	bool empty() const noexcept { return _ranges.empty(); }
+	[[nodiscard]]
+	const cache_t& cache() const noexcept { return _tables; }
+};
+
+#endif /* __SNS_DWARF_HH__ */
@@ -5,7 +5,14 @@
 
 #include <cstdint>
 #include <cstring>
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
 #include <vector>
 #include <iostream>
 /* I know this is my code, but shh */
@@ -14,6 +21,14 @@
 #include <utility.hh>
 #include <mmap_t.hh>
 #include <fd_t.hh>
+#include <lazy.hh>
+#include <lru_cache.hh>
+#include <codec.hh>
+#include <symbol_index.hh>
+#include <address_index.hh>
+#include <dwarf.hh>
+#include <sidecar.hh>
+#include <xref_index.hh>
 #include <zlib.hh>
 
 #if defined(CXXFS_EXP)
@@ -381,6 +396,9 @@ enum class elf_shns_t : uint16_t {
 extern const std::array<const enum_pair_t<elf_shns_t>, 12> elf_shns_s;
 extern std::ostream& operator<<(std::ostream& out, const elf_shns_t& shns);
 
+/* e_phnum escape, the real number of program headers is in section 0's sh_info */
+constexpr uint16_t elf_pn_xnum{0xFFFFU};
+
 
 /* ELF section header types */
 enum class elf_shtype_t : uint32_t {
@@ -401,6 +419,7 @@ enum class elf_shtype_t : uint32_t {
 	PreinitArray     = 0x00000010U,
 	Group            = 0x00000011U,
 	SymbolTableIndex = 0x00000012U,
+	Relr             = 0x00000013U,
 	LowOS            = 0x60000000U,
 	GNUAttributes    = 0x6FFFFFF5U,
 	GNUHash          = 0x6FFFFFF6U,
@@ -418,7 +437,7 @@ enum class elf_shtype_t : uint32_t {
 	LowUser          = 0x80000000U,
 	HighUser         = 0xFFFFFFFFU,
 };
-extern const std::array<const enum_pair_t<elf_shtype_t>, 33> elf_shtype_s;
+extern const std::array<const enum_pair_t<elf_shtype_t>, 34> elf_shtype_s;
 extern std::ostream& operator<<(std::ostream& out, const elf_shtype_t& type);
 
 
@@ -571,13 +590,14 @@ enum class elf_phdr_type_t : uint32_t {
 	GNUEHFrame         = 0x6474E550U,
 	GNUStack           = 0x6474E551U,
 	GNURelRO           = 0x6474E552U,
+	GNUProperty        = 0x6474E553U,
 	SUNBSS             = 0x6FFFFFFAU,
 	SUNStack           = 0x6FFFFFFBU,
 	HighOS             = 0x6FFFFFFFU,
 	LowProc            = 0x70000000U,
 	HighProc           = 0x7FFFFFFFU,
 };
-extern const std::array<const enum_pair_t<elf_phdr_type_t>, 17> elf_phdr_type_s;
+extern const std::array<const enum_pair_t<elf_phdr_type_t>, 18> elf_phdr_type_s;
 extern std::ostream& operator<<(std::ostream& out, const elf_phdr_type_t& phdrtype);
 
 
@@ -679,7 +699,7 @@ enum class elf32_dyn_tag_t : elf32_sword_t {
 	Hash             = 0x00000004,
 	StrTab           = 0x00000005,
 	SymTab           = 0x00000006,
-	RelA             = 0x00000006,
+	RelA             = 0x00000007,
 	RelASize         = 0x00000008,
 	RelAEnt          = 0x00000009,
 	StrTabSize       = 0x0000000A,
@@ -707,6 +727,9 @@ enum class elf32_dyn_tag_t : elf32_sword_t {
 	PreInitArray     = 0x00000020,
 	PreInitArraySize = 0x00000021,
 	SymtabSHNDX      = 0x00000022,
+	RelrSize         = 0x00000023,
+	Relr             = 0x00000024,
+	RelrEnt          = 0x00000025,
 	LowOS            = 0x6000000D,
 	HighOS           = 0x6FFFF000,
 	GNUPrelinked     = 0x6FFFFDF5,
@@ -744,7 +767,7 @@ enum class elf32_dyn_tag_t : elf32_sword_t {
 	Auxiliary        = 0x7FFFFFFD,
 	HighProc         = 0x7FFFFFFF,
 };
-extern const std::array<const enum_pair_t<elf32_dyn_tag_t>, 71> elf32_dyn_tag_s;
+extern const std::array<const enum_pair_t<elf32_dyn_tag_t>, 74> elf32_dyn_tag_s;
 extern std::ostream& operator<<(std::ostream& out, const elf32_dyn_tag_t& dyntag);
 
 
@@ -756,7 +779,7 @@ enum class elf64_dyn_tag_t : elf64_sxword_t {
 	Hash             = 0x00000004,
 	StrTab           = 0x00000005,
 	SymTab           = 0x00000006,
-	RelA             = 0x00000006,
+	RelA             = 0x00000007,
 	RelASize         = 0x00000008,
 	RelAEnt          = 0x00000009,
 	StrTabSize       = 0x0000000A,
@@ -784,6 +807,9 @@ enum class elf64_dyn_tag_t : elf64_sxword_t {
 	PreInitArray     = 0x00000020,
 	PreInitArraySize = 0x00000021,
 	SymtabSHNDX      = 0x00000022,
+	RelrSize         = 0x00000023,
+	Relr             = 0x00000024,
+	RelrEnt          = 0x00000025,
 	LowOS            = 0x6000000D,
 	HighOS           = 0x6FFFF000,
 	GNUPrelinked     = 0x6FFFFDF5,
@@ -821,7 +847,7 @@ enum class elf64_dyn_tag_t : elf64_sxword_t {
 	Auxiliary        = 0x7FFFFFFD,
 	HighProc         = 0x7FFFFFFF,
 };
-extern const std::array<const enum_pair_t<elf64_dyn_tag_t>, 71> elf64_dyn_tag_s;
+extern const std::array<const enum_pair_t<elf64_dyn_tag_t>, 74> elf64_dyn_tag_s;
 extern std::ostream& operator<<(std::ostream& out, const elf64_dyn_tag_t& dyntag);
 
 
@@ -914,14 +940,21 @@ extern std::ostream& operator<<(std::ostream& out, const elf_dyn_posflag_t& dynp
 enum class elf_chdr_type_t : uint32_t {
 	None     = 0x00000000U,
 	Zlib     = 0x00000001U,
+	Zstd     = 0x00000002U,
 	LowOS    = 0x60000000U,
 	HighOS   = 0x6fffffffU,
 	LowProc  = 0x70000000U,
 	HighProc = 0x7fffffffU,
 };
-extern const std::array<const enum_pair_t<elf_chdr_type_t>, 6> elf_chdr_type_s;
+extern const std::array<const enum_pair_t<elf_chdr_type_t>, 7> elf_chdr_type_s;
 extern std::ostream& operator<<(std::ostream& out, const elf_chdr_type_t& chdrtype);
 
+/* Mapping between compressed section types and our codecs */
+[[nodiscard]]
+codec_type_t elf_chdr_codec(elf_chdr_type_t type) noexcept;
+[[nodiscard]]
+elf_chdr_type_t elf_codec_chdr(codec_type_t codec) noexcept;
+
 /* Version definition revisions */
 enum class elf_verdef_revision_t : uint16_t {
 	None    = 0x0000U,
@@ -948,7 +981,7 @@ extern std::ostream& operator<<(std::ostream& out, const elf_verdef_flag_t& verd
 /* Versym index values */
 enum class elf_verdef_index_t : uint16_t {
 	Local      = 0x0000U,
-	Global     = 0x0000U,
+	Global     = 0x0001U,
 	LowReserve = 0xFF00U,
 	Eliminate  = 0xFF01U,
 };
@@ -1040,6 +1073,40 @@ enum class elf_note_type_t : uint32_t {
 extern const std::array<const enum_pair_t<elf_note_type_t>, 6> elf_note_type_s;
 extern std::ostream& operator<<(std::ostream& out, const elf_note_type_t& notetype);
 
+/* NT_GNU_PROPERTY_TYPE_0 property types */
+enum class elf_gnu_property_type_t : uint32_t {
+	StackSize          = 0x00000001U,
+	NoCopyOnProtected  = 0x00000002U,
+	AArch64Feature1And = 0xC0000000U,
+	X86Feature1And     = 0xC0000002U,
+	X86ISA1Needed      = 0xC0008002U,
+	X86Feature2Used    = 0xC0010001U,
+};
+extern const std::array<const enum_pair_t<elf_gnu_property_type_t>, 6> elf_gnu_property_type_s;
+extern std::ostream& operator<<(std::ostream& out, const elf_gnu_property_type_t& proptype);
+
+/* DW_EH_PE_* pointer encodings, the low nibble being the format and the high the application */
+enum class elf_eh_encoding_t : uint8_t {
+	AbsPtr   = 0x00U,
+	ULEB128  = 0x01U,
+	UData2   = 0x02U,
+	UData4   = 0x03U,
+	UData8   = 0x04U,
+	SLEB128  = 0x09U,
+	SData2   = 0x0AU,
+	SData4   = 0x0BU,
+	SData8   = 0x0CU,
+	PCRel    = 0x10U,
+	TextRel  = 0x20U,
+	DataRel  = 0x30U,
+	FuncRel  = 0x40U,
+	Aligned  = 0x50U,
+	Indirect = 0x80U,
+	Omit     = 0xFFU,
+};
+extern const std::array<const enum_pair_t<elf_eh_encoding_t>, 16> elf_eh_encoding_s;
+extern std::ostream& operator<<(std::ostream& out, const elf_eh_encoding_t& encoding);
+
 
 
 /* ELF Structure definitions */
@@ -1303,7 +1370,7 @@ public:
 };
 
 using elf32_shdr_t = elf_shdr_t<elf_types_32_t>;
-using elf64_shdr_t = elf_shdr_t<elf_types_32_t>;
+using elf64_shdr_t = elf_shdr_t<elf_types_64_t>;
 
 
 /* 32-Bit Symbol Table Entry */
@@ -1462,6 +1529,16 @@ public:
 	void info(const xword_t info) noexcept { _info = info; }
 	[[nodiscard]]
 	xword_t info() const noexcept { return _info; }
+
+	[[nodiscard]]
+	xword_t sym() const noexcept { return (_info >> T::sym_shift); }
+
+	[[nodiscard]]
+	xword_t type() const noexcept { return (_info & ((xword_t{1} << T::sym_shift) - 1U)); }
+
+	static xword_t make_info(xword_t sym, xword_t type) {
+		return (sym << T::sym_shift) + (type & ((xword_t{1} << T::sym_shift) - 1U));
+	}
 };
 
 using elf32_rel_t = elf_rel_t<elf_types_32_t>;
@@ -1472,16 +1549,16 @@ template<typename T>
 struct elf_rela_t final {
 	using addr_t    = typename T::addr_t;
 	using xword_t   = typename T::xword_t;
-	using sword_t   = typename T::sword_t;
+	using sxword_t  = typename T::sxword_t;
 private:
 	addr_t _offset;
 	xword_t _info;
-	sword_t _addend;
+	sxword_t _addend;
 public:
 	constexpr elf_rela_t() noexcept :
 		_offset{}, _info{}, _addend{} { /* NOP */ }
 
-	elf_rela_t(addr_t offset, xword_t info,	sword_t addend) noexcept :
+	elf_rela_t(addr_t offset, xword_t info, sxword_t addend) noexcept :
 		_offset{offset}, _info{info}, _addend{addend} { /* NOP */ }
 
 	void offset(const addr_t offset) noexcept { _offset = offset; }
@@ -1492,19 +1569,19 @@ public:
 	[[nodiscard]]
 	xword_t info() const noexcept { return _info; }
 
-	void addend(const sword_t addend) noexcept { _addend = addend; }
+	void addend(const sxword_t addend) noexcept { _addend = addend; }
 	[[nodiscard]]
-	sword_t addend() const noexcept { return _addend; }
-
+	sxword_t addend() const noexcept { return _addend; }
 
 	[[nodiscard]]
 	xword_t sym() const noexcept { return (_info >> T::sym_shift); }
 
+	/* The low 8 bits for ELF32, 32 bits for ELF64 */
 	[[nodiscard]]
-	xword_t type() const noexcept { return (_info & 0xFFFFFFFFUL); }
+	xword_t type() const noexcept { return (_info & ((xword_t{1} << T::sym_shift) - 1U)); }
 
 	static xword_t make_info(xword_t sym, xword_t type) {
-		return (sym << T::sym_shift) + (type & 0xFFFFFFFFUL);
+		return (sym << T::sym_shift) + (type & ((xword_t{1} << T::sym_shift) - 1U));
 	}
 };
 
@@ -1945,7 +2022,7 @@ public:
 
 	void type(const word_t type) noexcept { _type = type; }
 	[[nodiscard]]
-	word_t type() const noexcept { return type; }
+	word_t type() const noexcept { return _type; }
 };
 using elf32_nhdr_t = elf_nhdr_t<elf_types_32_t>;
 using elf64_nhdr_t = elf_nhdr_t<elf_types_64_t>;
@@ -2049,6 +2126,395 @@ public:
 
 };
 
+/* Section contents, compressed sections are inflated on first access */
+struct elf_section_view_t final {
+	using cache_t = lru_cache_t<size_t, std::vector<uint8_t>>;
+private:
+	span<const uint8_t> _raw;     /* Contents as they are in the file, sans chdr_t */
+	elf_chdr_type_t _compression; /* Compression type from the chdr_t */
+	uint64_t _size;               /* Size of the contents once inflated */
+	uint64_t _addr_align;         /* Alignment of the contents once inflated */
+	size_t _index;                /* Section index, used as the cache key */
+	bool _legacy;                 /* GNU .zdebug_* framing rather than a chdr_t */
+	cache_t* _cache;              /* Owning elf_t's inflated section cache */
+	mutable cache_t::value_ptr _inflated;
+
+	[[nodiscard]]
+	std::vector<uint8_t> inflate() const;
+public:
+	constexpr elf_section_view_t() noexcept :
+		_raw{}, _compression{}, _size{}, _addr_align{}, _index{}, _legacy{},
+		_cache{}, _inflated{} { /* NOP */ }
+
+	elf_section_view_t(span<const uint8_t> raw, uint64_t addr_align) noexcept :
+		_raw{raw}, _compression{elf_chdr_type_t::None}, _size{raw.size()},
+		_addr_align{addr_align}, _index{}, _legacy{}, _cache{}, _inflated{} { /* NOP */ }
+
+	elf_section_view_t(span<const uint8_t> raw, elf_chdr_type_t compression,
+			uint64_t size, uint64_t addr_align, size_t index, cache_t* cache,
+			bool legacy = false) noexcept :
+		_raw{raw}, _compression{compression}, _size{size}, _addr_align{addr_align},
+		_index{index}, _legacy{legacy}, _cache{cache}, _inflated{} { /* NOP */ }
+
+	[[nodiscard]]
+	bool compressed() const noexcept { return _compression != elf_chdr_type_t::None; }
+	[[nodiscard]]
+	elf_chdr_type_t compression() const noexcept { return _compression; }
+	[[nodiscard]]
+	uint64_t size() const noexcept { return _size; }
+	[[nodiscard]]
+	uint64_t addr_align() const noexcept { return _addr_align; }
+	[[nodiscard]]
+	bool legacy() const noexcept { return _legacy; }
+	/* The compressed stream, without the chdr_t or GNU header */
+	[[nodiscard]]
+	span<const uint8_t> raw() const noexcept { return _raw; }
+
+	/* Inflated contents, empty if they fail to inflate */
+	[[nodiscard]]
+	span<const uint8_t> data() const;
+};
+
+/* Symbol name hashes used by .hash (SysV) and .gnu.hash */
+uint32_t elf_hash(const uint8_t* name);
+uint32_t gnu_hash(const uint8_t* name);
+[[nodiscard]]
+uint32_t elf_hash(std::string_view name) noexcept;
+[[nodiscard]]
+uint32_t gnu_hash(std::string_view name) noexcept;
+
+/*
+	Batch versions for hashing lots of names out of one string table, the
+	name for `hashes[i]` being the NUL terminated string at `offsets[i]`.
+	Names are bounded by the end of the table, offsets outside of it hash as
+	the empty string. Results are identical to the single name versions.
+*/
+void elf_hash_batch(const char* strtab, size_t strtab_len, const uint32_t* offsets,
+	size_t count, uint32_t* hashes) noexcept;
+void gnu_hash_batch(const char* strtab, size_t strtab_len, const uint32_t* offsets,
+	size_t count, uint32_t* hashes) noexcept;
+
+/* .gnu.hash bloom false positive rate we aim for, about what lld's 12 bits per symbol gives */
+constexpr double default_hash_false_positive{0.025};
+
+/* Freshly built .gnu.hash and .hash contents for a dynamic symbol table */
+struct elf_hash_tables_t final {
+	std::vector<uint32_t> order;    /* Old symbol index for each new .dynsym slot */
+	uint32_t symoffset;             /* First symbol covered by .gnu.hash */
+	std::vector<uint8_t> gnu_hash;
+	std::vector<uint8_t> sysv_hash;
+};
+
+/*
+	Builds both hash tables for `count` symbols whose names are at
+	`names[i]` in `strtab`. Symbols with `hashed[i]` set (the global
+	definitions) go into .gnu.hash, which needs them at the end of .dynsym
+	grouped by bucket, everything else keeps its relative order ahead of
+	them. Symbol 0 is always left where it is.
+
+	Sizing follows lld, a bucket per 4 hashed symbols for .gnu.hash and one
+	per symbol for .hash, with the bloom filter made just big enough in
+	`word_size` (4 or 8) byte words to hit `false_positive_rate`. Hashing
+	and bucketing are split across `threads` workers, 0 for one per core.
+	Tables are written in host byte order, and come back empty if the
+	arguments don't make sense.
+*/
+[[nodiscard]]
+elf_hash_tables_t build_hash_tables(const char* strtab, size_t strtab_len, const uint32_t* names,
+	const uint8_t* hashed, size_t count, size_t word_size,
+	double false_positive_rate = default_hash_false_positive, size_t threads = 0);
+
+/* One relocation, whichever of SHT_REL or SHT_RELA it came from */
+struct elf_relocation_t final {
+	uint64_t offset;  /* From the start of the section being relocated */
+	int64_t addend;
+	uint32_t type;
+	uint32_t symbol;
+	bool implicit;    /* SHT_REL, the addend is what's in the section already */
+};
+
+/* What happened to a set of relocations */
+struct elf_relocation_stats_t final {
+	size_t applied;
+	size_t unsupported; /* Unknown types, and any that need a GOT, PLT, or TLS block */
+	size_t failed;      /* Out of range, outside of the section, or missing their pair */
+
+	elf_relocation_stats_t& operator+=(const elf_relocation_stats_t& stats) noexcept {
+		applied += stats.applied;
+		unsupported += stats.unsupported;
+		failed += stats.failed;
+		return *this;
+	}
+};
+
+/*
+	Section contents being relocated and the address they are at (P of
+	offset 0), `symbols[i]` and `sizes[i]` being the value (S) and size (Z)
+	of symbol `i` in the symbol table the relocations refer to.
+*/
+struct elf_relocation_target_t final {
+	span<uint8_t> contents;
+	uint64_t address;
+	span<const uint64_t> symbols;
+	span<const uint64_t> sizes;
+};
+
+/* If apply_relocations() knows about `machine` */
+[[nodiscard]]
+bool elf_relocations_supported(elf_machine_t machine) noexcept;
+
+/*
+	Applies x86-64, AArch64, or RISC-V (little endian) relocations to
+	`target`. How each type is computed, range checked, and written comes
+	from constexpr tables indexed by type, the relocations being grouped by
+	type then offset so each run goes through a single handler in address
+	order. RISC-V's read-modify-write types (ADD, SUB, and SET) are applied
+	after that in their original order, as they can stack up on the same
+	location. Nothing is relaxed, and GOT, PLT, and TLS relocations are
+	left alone, calls through the PLT going straight to the symbol.
+*/
+elf_relocation_stats_t apply_relocations(elf_machine_t machine, const elf_relocation_target_t& target,
+	const elf_relocation_t* relocations, size_t count);
+
+/* R_*_RELATIVE for `machine`, 0 if we don't know it */
+[[nodiscard]]
+uint32_t elf_relative_type(elf_machine_t machine) noexcept;
+
+/*
+	How far short of what it points at S + A is for a PC relative `type`.
+	x86-64 addends are biased to measure from the end of the field, i.e.
+	-4 for a call, so that's the field size there and 0 everywhere else.
+*/
+[[nodiscard]]
+uint64_t elf_relocation_bias(elf_machine_t machine, uint32_t type) noexcept;
+
+/*
+	SHT_RELR contents for relative relocations at `addresses` in
+	`word_size` (4 or 8) byte words, each run starting with an address
+	followed by bitmaps of which of the next word bits - 1 words also need
+	relocating. Addresses are sorted and deduplicated here, ones that aren't
+	word aligned can't be encoded and are skipped. Written in host order.
+*/
+[[nodiscard]]
+std::vector<uint8_t> encode_relr(std::vector<uint64_t> addresses, size_t word_size);
+
+/* Every address a SHT_RELR table relocates, in order */
+[[nodiscard]]
+std::vector<uint64_t> decode_relr(span<const uint8_t> relr, size_t word_size);
+
+/*
+	xref_index_t over the symbols of every symbol table a relocation section
+	uses, numbered one table after another. Aliases, sized definitions at
+	the same place, are folded into the first of them so whichever name is
+	asked about gets every reference to the thing. References made through
+	a section symbol (how assemblers refer to statics) are put under the
+	definition they land in.
+*/
+struct elf_xref_index_t final {
+	constexpr static const uint32_t npos{xref_index_t::npos};
+
+	std::vector<uint32_t> tables;    /* Symbol table sections, ascending */
+	std::vector<uint32_t> bases;     /* Node of symbol 0 of each table, then the node count */
+	std::vector<uint32_t> canonical; /* The node each node's references are kept under */
+	xref_index_t index;
+
+	/* The node `symbol` of `symtab` is folded into, npos if no relocation section uses the table */
+	[[nodiscard]]
+	uint32_t node(size_t symtab, size_t symbol) const noexcept;
+	/* Where `node` came from, false if it's out of range */
+	[[nodiscard]]
+	bool symbol(uint32_t node, size_t& symtab, size_t& symbol) const noexcept;
+
+	/* Every relocation against `symbol` of `symtab` or any of its aliases */
+	[[nodiscard]]
+	span<const xref_site_t> references(size_t symtab, size_t symbol) const noexcept {
+		return index.references(node(symtab, symbol));
+	}
+
+	/* xref_index_t::reachable() with the roots folded first */
+	[[nodiscard]]
+	std::vector<uint32_t> reachable(const std::vector<uint32_t>& roots) const;
+};
+
+/* One note, pointing into the segment or section it's in */
+struct elf_note_t final {
+	uint32_t type;
+	std::string_view name; /* Without the trailing NUL */
+	span<const uint8_t> desc;
+};
+
+/*
+	The notes packed into a PT_NOTE segment or SHT_NOTE section, parsed in
+	place as they're iterated. The name and descriptor are padded out to
+	`align`, which is 8 for things like .note.gnu.property and 4 for just
+	about everything else. Iteration stops at the first malformed note.
+*/
+struct elf_notes_t final {
+	struct iterator final {
+	private:
+		span<const uint8_t> _data;
+		size_t _align;
+		size_t _next;    /* Where the note after this one starts */
+		bool _done;
+		elf_note_t _note;
+
+		void advance() noexcept;
+	public:
+		iterator(const span<const uint8_t> data, const size_t align, const bool done) noexcept :
+			_data{data}, _align{align}, _next{}, _done{done}, _note{} { if(!_done) advance(); }
+
+		const elf_note_t& operator*() const noexcept { return _note; }
+		const elf_note_t* operator->() const noexcept { return &_note; }
+		iterator& operator++() noexcept {
+			advance();
+			return *this;
+		}
+
+		bool operator==(const iterator& itr) const noexcept {
+			return _done == itr._done && (_done || _next == itr._next);
+		}
+		bool operator!=(const iterator& itr) const noexcept { return !(*this == itr); }
+	};
+private:
+	span<const uint8_t> _data;
+	size_t _align;
+public:
+	constexpr elf_notes_t() noexcept :
+		_data{}, _align{4U} { /* NOP */ }
+	elf_notes_t(const span<const uint8_t> data, const size_t align) noexcept :
+		_data{data}, _align{(align == 8U) ? 8U : 4U} { /* NOP */ }
+
+	[[nodiscard]]
+	iterator begin() const noexcept { return {_data, _align, false}; }
+	[[nodiscard]]
+	iterator end() const noexcept { return {_data, _align, true}; }
+
+	[[nodiscard]]
+	span<const uint8_t> data() const noexcept { return _data; }
+	[[nodiscard]]
+	size_t align() const noexcept { return _align; }
+	[[nodiscard]]
+	bool empty() const noexcept { return _data.empty(); }
+
+	/* The first note of `type` from `name` (i.e. "GNU"), false if there isn't one */
+	[[nodiscard]]
+	bool find(uint32_t type, std::string_view name, elf_note_t& note) const noexcept;
+};
+
+/* One NT_GNU_PROPERTY_TYPE_0 property */
+struct elf_gnu_property_t final {
+	uint32_t type;
+	span<const uint8_t> data;
+};
+
+/* The properties in a NT_GNU_PROPERTY_TYPE_0 descriptor, each padded out to `word_size` */
+[[nodiscard]]
+std::vector<elf_gnu_property_t> decode_gnu_properties(span<const uint8_t> desc, size_t word_size);
+
+/* NT_GNU_ABI_TAG, the oldest kernel the object will run on */
+struct elf_abi_tag_t final {
+	elf_note_os_t os;
+	uint32_t major;
+	uint32_t minor;
+	uint32_t patch;
+};
+
+/* False if `desc` is too short to be one */
+[[nodiscard]]
+bool decode_abi_tag(span<const uint8_t> desc, elf_abi_tag_t& tag) noexcept;
+
+/* A dynamic symbol's version, as .gnu.version and either .gnu.version_d or .gnu.version_r have it */
+struct elf_symbol_version_t final {
+	std::string_view name; /* Empty for local and unversioned symbols */
+	std::string_view file; /* Library it's needed from, empty if it's defined here */
+	uint16_t index;        /* Without the hidden bit */
+	bool hidden;           /* Not the default version, name@VERSION rather than name@@VERSION */
+	bool weak;
+};
+
+/* A Common Information Entry out of .eh_frame */
+struct elf_eh_cie_t final {
+	uint64_t offset;                   /* Into .eh_frame */
+	uint8_t version;
+	std::string_view augmentation;
+	uint64_t code_align;
+	int64_t data_align;
+	uint64_t return_register;
+	uint8_t fde_encoding;              /* elf_eh_encoding_t, AbsPtr without an 'R' augmentation */
+	uint8_t lsda_encoding;             /* Omit without an 'L' augmentation */
+	uint64_t personality;              /* 0 without a 'P' augmentation, the slot if it's Indirect */
+	bool signal_frame;
+	span<const uint8_t> instructions;
+};
+
+/* A Frame Description Entry, the unwind rules for [pc_begin, pc_begin + pc_range) */
+struct elf_eh_fde_t final {
+	uint64_t offset;                   /* Into .eh_frame */
+	uint64_t cie;                      /* Offset of the CIE it uses */
+	uint64_t pc_begin;
+	uint64_t pc_range;
+	uint64_t lsda;                     /* 0 if there isn't one */
+	span<const uint8_t> instructions;
+
+	[[nodiscard]]
+	bool contains(const uint64_t pc) const noexcept { return (pc - pc_begin) < pc_range; }
+};
+
+/* Every CIE and FDE in .eh_frame, the FDEs sorted by pc_begin */
+struct elf_eh_frame_t final {
+	std::vector<elf_eh_cie_t> cies;    /* By offset */
+	std::vector<elf_eh_fde_t> fdes;
+
+	/* The FDE covering `pc`, nullptr if there isn't one */
+	[[nodiscard]]
+	const elf_eh_fde_t* find(uint64_t pc) const noexcept;
+	/* The CIE `fde` uses, nullptr if it isn't one of these */
+	[[nodiscard]]
+	const elf_eh_cie_t* cie(const elf_eh_fde_t& fde) const noexcept;
+};
+
+/*
+	Walks .eh_frame as loaded at `address`, stopping at the zero terminator
+	or the first malformed entry. pc relative pointers are resolved against
+	`address`, text and function relative ones aren't supported and leave
+	the FDEs using them out, indirect ones are left as the slot address.
+*/
+[[nodiscard]]
+elf_eh_frame_t parse_eh_frame(span<const uint8_t> eh_frame, uint64_t address, size_t word_size);
+
+/* Just the FDE at `offset` into .eh_frame and the CIE it points to, false if either is malformed */
+[[nodiscard]]
+bool decode_eh_fde(span<const uint8_t> eh_frame, uint64_t address, uint64_t offset, size_t word_size,
+	elf_eh_fde_t& fde) noexcept;
+
+/* .eh_frame_hdr, or PT_GNU_EH_FRAME, and its binary search table */
+struct elf_eh_frame_hdr_t final {
+	uint64_t address;                  /* Of .eh_frame_hdr itself */
+	uint64_t eh_frame;                 /* eh_frame_ptr, 0 if it was omitted */
+	span<const uint8_t> table;         /* (initial location, FDE address) int32 pairs relative to `address` */
+	size_t count;                      /* 0 if there's no table, or it isn't DataRel|SData4 */
+
+	/*
+		Address of the FDE with the highest initial location at or below
+		`pc`, false if they're all above it. Whether the FDE actually covers
+		`pc` is up to the caller to check.
+	*/
+	[[nodiscard]]
+	bool find(uint64_t pc, uint64_t& fde) const noexcept;
+};
+
+[[nodiscard]]
+bool parse_eh_frame_hdr(span<const uint8_t> data, uint64_t address, size_t word_size,
+	elf_eh_frame_hdr_t& hdr) noexcept;
+
+/*
+	Contents for an .eh_frame_hdr at `address` over `frame` loaded at
+	`eh_frame`, with the table encoded the same way ld does it. Empty if
+	something is more than 2GiB away from `address` and won't fit.
+*/
+[[nodiscard]]
+std::vector<uint8_t> build_eh_frame_hdr(const elf_eh_frame_t& frame, uint64_t eh_frame, uint64_t address);
+
 /* ELF Type definitions */
 struct elf_types_32_t final {
 	/* Basic Types */
@@ -2059,6 +2525,7 @@ struct elf_types_32_t final {
 	using xword_t   = word_t;
 	using sword_t   = ALIGN(0x04) int32_t;
 	using xsword_t  = sword_t;
+	using sxword_t  = sword_t;
 	using uchar_t   = ALIGN(0x01) uint8_t;
 
 	/* Structure Definitions */
@@ -2139,6 +2606,7 @@ struct elf_t final {
 	using rela_t    = typename T::rela_t;
 	using phdr_t    = typename T::phdr_t;
 	using dyn_t     = typename T::dyn_t;
+	using dyn_tag_t = typename T::dyn_tag_t;
 	using chdr_t    = typename T::chdr_t;
 	using verdef_t  = typename T::verdef_t;
 	using verdaux_t = typename T::verdaux_t;
@@ -2147,6 +2615,7 @@ struct elf_t final {
 	using auxv_t    = typename T::auxv_t;
 	using nhdr_t    = typename T::nhdr_t;
 	using move_t    = typename T::move_t;
+	using shflags_t = typename T::shflags_t;
 private:
 	fs::path _file;         /* The path to the object file */
 	fd_t _file_fd;          /* File descriptor */
@@ -2154,37 +2623,1020 @@ private:
 	ehdr_t _header;         /* The executable header */
 	span<phdr_t> _pheaders; /* Program Headers */
 	span<shdr_t> _sheaders; /* Section Headers */
+	size_t _shstrndx;       /* Section name string table index, SHN_XINDEX resolved */
 	char* _strtbl;          /* Section name string table */
+	size_t _strtbl_len;     /* Size of the section name string table */
+	/* .symtab_shndx contents keyed by the index of the symbol table they extend */
+	std::unordered_map<size_t, span<const uint32_t>> _shndx_tables;
+
+	struct section_index_t final {
+		std::unordered_map<std::string_view, size_t> by_name;     /* First section with each name */
+		std::vector<std::pair<std::string_view, size_t>> sorted; /* By name then index, for prefixes */
+	};
+	lazy_t<section_index_t> _section_index;
+	lazy_t<symbol_index_t> _symbol_index;
+
+	/* .gnu.hash bloom filter words are the size of an address */
+	using bloom_word_t = std::conditional_t<sizeof(typename T::addr_t) == 8, uint64_t, uint32_t>;
+	constexpr static const uint32_t bloom_bits{sizeof(bloom_word_t) * 8U};
+
+	struct symbol_hash_t final {
+		size_t symtab;                  /* The .dynsym the table is over, 0 if there isn't one */
+		bool gnu;                       /* .gnu.hash rather than .hash */
+		uint32_t symoffset;             /* First symbol in the hash table (GNU) */
+		uint32_t bloom_shift;           /* Shift for the second bloom bit (GNU) */
+		span<const bloom_word_t> bloom; /* (GNU) */
+		span<const uint32_t> buckets;
+		span<const uint32_t> chains;    /* Indexed from symoffset for GNU, from 0 for SysV */
+	};
+	lazy_t<symbol_hash_t> _symbol_hash;
+	lazy_t<address_index_t> _address_index;
+
+	/* DT_NULL up to this get a slot each, everything past it (OS and processor specific) is looked up */
+	constexpr static const size_t dynamic_dense_tags{0x40U};
+	struct dynamic_index_t final {
+		using range_t = std::pair<uint32_t, uint32_t>;     /* [first, last) of order */
+		span<const dyn_t> entries;                         /* Up to but not including DT_NULL */
+		std::vector<uint32_t> order;                       /* Entries grouped by tag, in order within each */
+		std::array<range_t, dynamic_dense_tags> dense;
+		std::unordered_map<int64_t, range_t> sparse;
+		std::string_view strtab;                           /* DT_STRTAB, DT_STRSZ long */
+	};
+	lazy_t<dynamic_index_t> _dynamic_index;
+
+	/* The section to segment mapping both ways, as CSR rows */
+	struct segment_map_t final {
+		std::vector<uint32_t> segment_rows; /* sections[segment_rows[p], segment_rows[p + 1]) are in segment p */
+		std::vector<uint32_t> sections;
+		std::vector<uint32_t> section_rows; /* Likewise into segments for each section */
+		std::vector<uint32_t> segments;
+	};
+	lazy_t<segment_map_t> _segment_map;
+
+	/* .gnu.version indices are 15 bits, the top one being the hidden flag */
+	constexpr static const uint16_t version_hidden{0x8000U};
+	struct version_index_t final {
+		struct version_t final {
+			std::string_view name;
+			std::string_view file;
+			bool weak;
+		};
+		size_t symtab;                  /* The .dynsym .gnu.version is for, 0 if there isn't one */
+		span<const uint16_t> versym;
+		std::vector<version_t> versions; /* By index */
+	};
+	lazy_t<version_index_t> _version_index;
+	lazy_t<elf_eh_frame_t> _eh_frame;
+	lazy_t<elf_xref_index_t> _xref_index;
+
+	/* The line index and the sections it reads from, holding on to anything that had to be inflated */
+	struct debug_lines_t final {
+		elf_section_view_t line;
+		elf_section_view_t line_str;
+		elf_section_view_t str;
+		dwarf_line_index_t index;
+	};
+	lazy_t<debug_lines_t> _debug_lines;
+	mutable elf_section_view_t::cache_t _section_cache; /* Inflated section contents */
 
 	bool _constructed;
+
+	constexpr static const char gnu_debug_prefix[]{".zdebug"};
+	constexpr static const char debug_prefix[]{".debug"};
+
+	[[nodiscard]]
+	bool section_name_starts_with(const shdr_t& shdr, const char* prefix, const size_t len) const noexcept {
+		return _strtbl != nullptr && shdr.name() < _strtbl_len && (_strtbl_len - shdr.name()) >= len &&
+			std::strncmp(_strtbl + shdr.name(), prefix, len) == 0;
+	}
+
+	/* Bounded by the string table, so a missing NUL doesn't run off the end */
+	[[nodiscard]]
+	std::string_view section_name_view(const shdr_t& shdr) const noexcept {
+		if(_strtbl == nullptr || shdr.name() >= _strtbl_len)
+			return {};
+		return {_strtbl + shdr.name(), ::strnlen(_strtbl + shdr.name(), _strtbl_len - shdr.name())};
+	}
+
+	[[nodiscard]]
+	section_index_t build_section_index() const {
+		section_index_t index{};
+		index.by_name.reserve(_sheaders.size());
+		index.sorted.reserve(_sheaders.size());
+		for(size_t section{}; section < _sheaders.size(); ++section) {
+			const auto name = section_name_view(_sheaders[section]);
+			index.by_name.emplace(name, section);
+			index.sorted.emplace_back(name, section);
+		}
+		std::sort(index.sorted.begin(), index.sorted.end());
+		return index;
+	}
+
+	/*
+		Only things that code or data lives at, mapping symbols ($x, $d, etc)
+		and section/file/TLS symbols would just be noise when symbolizing.
+	*/
+	[[nodiscard]]
+	static bool indexable_symbol(const symbol_t& symbol, const std::string_view name) noexcept {
+		if(symbol.shndx() == uint16_t(elf_shns_t::Undefined) || name.empty())
+			return false;
+		switch(elf_symbol_type_t(symbol.type())) {
+			case elf_symbol_type_t::Object:
+			case elf_symbol_type_t::Function:
+			case elf_symbol_type_t::LowOS: /* STT_GNU_IFUNC */
+				return true;
+			case elf_symbol_type_t::NoType:
+				return name.front() != '$';
+			default:
+				return false;
+		}
+	}
+
+	[[nodiscard]]
+	symbol_index_t build_symbol_index(const size_t threads) const {
+		constexpr size_t chunk_len{16_KiB};
+
+		/* .symtab is a superset of .dynsym, so only fall back to the latter */
+		auto tables = find_sections_of_type(elf_shtype_t::SymbolTable);
+		if(tables.empty())
+			tables = find_sections_of_type(elf_shtype_t::DynamicSymbols);
+
+		struct chunk_t final {
+			size_t table;
+			size_t first;
+		};
+		std::vector<chunk_t> chunks{};
+		for(const auto table : tables) {
+			const size_t count{symbol_table(table).size()};
+			for(size_t first{}; first < count; first += chunk_len)
+				chunks.push_back({table, first});
+		}
+
+		/*
+			Every function in a relocatable object built with -ffunction-sections
+			is at 0, so they're placed where section_addresses() puts their
+			section or they'd all be taken as aliases of each other. Anything
+			that isn't in a SHF_ALLOC section has nowhere to go.
+		*/
+		const bool relocatable{_header.type() == elf_type_t::Relocatable};
+		const auto addresses = relocatable ? section_addresses() : std::vector<uint64_t>{};
+
+		std::vector<std::vector<symbol_entry_t>> found(chunks.size());
+		parallel_for(chunks.size(), [&](const size_t idx) {
+			const auto& chunk = chunks[idx];
+			const auto symbols = symbol_table(chunk.table);
+			const size_t strtab{_sheaders[chunk.table].link()};
+			const size_t last{std::min(symbols.size(), chunk.first + chunk_len)};
+			for(size_t symbol{chunk.first}; symbol < last; ++symbol) {
+				const symbol_t& sym{symbols[symbol]};
+				const auto name = section_string(strtab, sym.name());
+				if(!indexable_symbol(sym, name))
+					continue;
+				uint64_t address{sym.value()};
+				if(relocatable) {
+					const size_t section{symbol_section(chunk.table, symbol, sym)};
+					if(section < _sheaders.size() &&
+						(_sheaders[section].flags() & shflags_t::Alloc) == shflags_t::Alloc)
+						address += addresses[section];
+					else if(section != size_t(elf_shns_t::ABS))
+						continue;
+				}
+				found[idx].push_back({
+					address, uint64_t(sym.size()), name, uint32_t(chunk.table),
+					uint32_t(symbol), sym.bind(), sym.type()
+				});
+			}
+		}, threads);
+
+		std::vector<symbol_entry_t> entries{};
+		size_t total{};
+		for(const auto& chunk : found)
+			total += chunk.size();
+		entries.reserve(total);
+		for(auto& chunk : found)
+			entries.insert(entries.end(), chunk.begin(), chunk.end());
+		return symbol_index_t{std::move(entries), threads};
+	}
+
+	/*
+		readelf's (strict) ELF_SECTION_IN_SEGMENT. TLS sections only go in
+		PT_TLS, PT_LOAD, and PT_GNU_RELRO, with .tbss taking up no room
+		outside of PT_TLS and so not counting, and empty sections have to be
+		strictly inside rather than sitting on the end.
+	*/
+	[[nodiscard]]
+	static bool section_in_segment(const shdr_t& shdr, const phdr_t& phdr) noexcept {
+		const bool tls{(shdr.flags() & shflags_t::TLS) == shflags_t::TLS};
+		const bool alloc{(shdr.flags() & shflags_t::Alloc) == shflags_t::Alloc};
+		const bool nobits{shdr.type() == elf_shtype_t::NoBits};
+		const elf_phdr_type_t type{phdr.type()};
+		if(tls && nobits && type != elf_phdr_type_t::ThreadLocalStorage)
+			return false;
+		if(tls ? (type != elf_phdr_type_t::ThreadLocalStorage && type != elf_phdr_type_t::Load &&
+				type != elf_phdr_type_t::GNURelRO) :
+			(type == elf_phdr_type_t::ThreadLocalStorage || type == elf_phdr_type_t::ProgramHeader))
+			return false;
+		if(!alloc && (type == elf_phdr_type_t::Load || type == elf_phdr_type_t::Dynamic ||
+			type == elf_phdr_type_t::GNUEHFrame || type == elf_phdr_type_t::GNUStack ||
+			type == elf_phdr_type_t::GNURelRO))
+			return false;
+
+		/* `len` - 1 wraps for empty segments, which then only hold empty sections right at the start */
+		const uint64_t size{shdr.size()};
+		const auto inside = [size](const uint64_t start, const uint64_t base, const uint64_t len) {
+			return start >= base && (start - base) <= (len - 1U) && (start - base) <= len &&
+				size <= (len - (start - base));
+		};
+		const uint64_t offset{shdr.offset()};
+		const uint64_t address{shdr.addr()};
+		if(!nobits && !inside(offset, phdr.offset(), phdr.filesz()))
+			return false;
+		if(alloc && !inside(address, phdr.vaddr(), phdr.memsize()))
+			return false;
+		if((type == elf_phdr_type_t::Dynamic || type == elf_phdr_type_t::Note) && size == 0 && phdr.memsize() != 0)
+			return (nobits || (offset > phdr.offset() && (offset - phdr.offset()) < phdr.filesz())) &&
+				(!alloc || (address > phdr.vaddr() && (address - phdr.vaddr()) < phdr.memsize()));
+		return true;
+	}
+
+	/*
+		Rather than trying every section against every segment, the only
+		sections that can be in a segment are those starting inside its file
+		range, or for SHT_NOBITS its memory range. Those are found by binary
+		search over sections sorted by offset and by address, which leaves
+		non-SHF_ALLOC SHT_NOBITS sections, there's never more than a handful,
+		to be tried against everything.
+	*/
+	[[nodiscard]]
+	segment_map_t build_segment_map() const {
+		std::vector<uint32_t> by_offset{};
+		std::vector<uint32_t> by_address{};
+		std::vector<uint32_t> loose{};
+		for(size_t index{1}; index < _sheaders.size(); ++index) {
+			const shdr_t& shdr{_sheaders[index]};
+			if(shdr.type() != elf_shtype_t::NoBits)
+				by_offset.push_back(uint32_t(index));
+			else if((shdr.flags() & shflags_t::Alloc) == shflags_t::Alloc)
+				by_address.push_back(uint32_t(index));
+			else
+				loose.push_back(uint32_t(index));
+		}
+		const auto offset_of = [this](const uint32_t index) { return uint64_t(_sheaders[index].offset()); };
+		const auto address_of = [this](const uint32_t index) { return uint64_t(_sheaders[index].addr()); };
+		std::sort(by_offset.begin(), by_offset.end(), [&offset_of](const uint32_t a, const uint32_t b) {
+			return offset_of(a) < offset_of(b);
+		});
+		std::sort(by_address.begin(), by_address.end(), [&address_of](const uint32_t a, const uint32_t b) {
+			return address_of(a) < address_of(b);
+		});
+
+		/* Everything in `sorted` with a key in [first, first + len] */
+		const auto candidates = [](const std::vector<uint32_t>& sorted, const auto& key, const uint64_t first,
+			const uint64_t len, std::vector<uint32_t>& found) {
+			const uint64_t last{(len > (std::numeric_limits<uint64_t>::max() - first)) ?
+				std::numeric_limits<uint64_t>::max() : first + len};
+			auto entry = std::lower_bound(sorted.begin(), sorted.end(), first,
+				[&key](const uint32_t index, const uint64_t value) { return key(index) < value; });
+			for(; entry != sorted.end() && key(*entry) <= last; ++entry)
+				found.push_back(*entry);
+		};
+
+		segment_map_t map{};
+		map.segment_rows.push_back(0U);
+		std::vector<uint32_t> found{};
+		for(const phdr_t& phdr : _pheaders) {
+			found = loose;
+			candidates(by_offset, offset_of, phdr.offset(), phdr.filesz(), found);
+			candidates(by_address, address_of, phdr.vaddr(), phdr.memsize(), found);
+			std::sort(found.begin(), found.end());
+			for(const uint32_t section : found) {
+				if(section_in_segment(_sheaders[section], phdr))
+					map.sections.push_back(section);
+			}
+			map.segment_rows.push_back(uint32_t(map.sections.size()));
+		}
+
+		map.section_rows.assign(_sheaders.size() + 1U, 0U);
+		for(const uint32_t section : map.sections)
+			++map.section_rows[section + 1U];
+		for(size_t section{}; section < _sheaders.size(); ++section)
+			map.section_rows[section + 1U] += map.section_rows[section];
+		map.segments.resize(map.sections.size());
+		std::vector<uint32_t> next(map.section_rows.begin(), map.section_rows.end() - 1);
+		for(size_t segment{}; segment < _pheaders.size(); ++segment) {
+			for(uint32_t entry{map.segment_rows[segment]}; entry < map.segment_rows[segment + 1U]; ++entry)
+				map.segments[next[map.sections[entry]]++] = uint32_t(segment);
+		}
+		return map;
+	}
+
+	/*
+		PT_LOAD segments, or when there aren't any (i.e. relocatable objects)
+		the SHF_ALLOC sections wherever section_addresses() puts them.
+	*/
+	[[nodiscard]]
+	address_index_t build_address_index() const {
+		std::vector<address_range_t> ranges{};
+		for(size_t idx{}; idx < _pheaders.size(); ++idx) {
+			const phdr_t& phdr{_pheaders[idx]};
+			if(phdr.type() == elf_phdr_type_t::Load)
+				ranges.push_back({uint64_t(phdr.vaddr()), uint64_t(phdr.offset()), uint64_t(phdr.filesz()),
+					uint64_t(phdr.memsize()), uint32_t(idx)});
+		}
+		if(!ranges.empty())
+			return address_index_t{std::move(ranges)};
+
+		const auto addresses = section_addresses();
+		for(size_t idx{1}; idx < _sheaders.size(); ++idx) {
+			const shdr_t& shdr{_sheaders[idx]};
+			if((shdr.flags() & shflags_t::Alloc) != shflags_t::Alloc)
+				continue;
+			const uint64_t file_size{(shdr.type() == elf_shtype_t::NoBits) ? 0U : uint64_t(shdr.size())};
+			ranges.push_back({addresses[idx], uint64_t(shdr.offset()), file_size, uint64_t(shdr.size()),
+				uint32_t(idx)});
+		}
+		return address_index_t{std::move(ranges)};
+	}
+
+	/*
+		.dynamic from the SHT_DYNAMIC section, or PT_DYNAMIC if the section
+		headers are gone, bucketed by tag with a counting sort. DT_STRTAB is
+		found through the address index, falling back to the section
+		.dynamic links to.
+	*/
+	[[nodiscard]]
+	dynamic_index_t build_dynamic_index() const {
+		dynamic_index_t index{};
+		index.dense.fill({});
+
+		span<const dyn_t> entries{};
+		size_t strtab_section{};
+		const auto sections = find_sections_of_type(elf_shtype_t::Dynamic);
+		if(!sections.empty()) {
+			entries = section_entries<dyn_t>(sections.front(), elf_shtype_t::Dynamic);
+			strtab_section = _sheaders[sections.front()].link();
+		} else {
+			const uint64_t file_len = uint64_t(_file_map.length());
+			for(const auto& phdr : _pheaders) {
+				if(phdr.type() != elf_phdr_type_t::Dynamic || phdr.offset() > file_len ||
+					phdr.filesz() > (file_len - phdr.offset()))
+					continue;
+				entries = {reinterpret_cast<const dyn_t*>( // lgtm[cpp/reinterpret-cast]
+					_file_map.address<uint8_t>() + phdr.offset()), size_t(phdr.filesz() / sizeof(dyn_t))};
+				break;
+			}
+		}
+		size_t count{};
+		while(count < entries.size() && entries[count].tag() != dyn_tag_t::None)
+			++count;
+		index.entries = {entries.data(), count};
+
+		/* Count, turn the counts into ranges, then drop every entry into its range */
+		const auto tag_of = [&index](const size_t entry) { return int64_t(index.entries[entry].tag()); };
+		const auto dense = [](const int64_t tag) { return tag >= 0 && uint64_t(tag) < dynamic_dense_tags; };
+		for(size_t entry{}; entry < count; ++entry) {
+			const int64_t tag{tag_of(entry)};
+			++(dense(tag) ? index.dense[size_t(tag)] : index.sparse[tag]).second;
+		}
+		uint32_t next{};
+		for(auto& range : index.dense) {
+			const uint32_t tags{range.second};
+			range = {next, next};
+			next += tags;
+		}
+		for(auto& range : index.sparse) {
+			const uint32_t tags{range.second.second};
+			range.second = {next, next};
+			next += tags;
+		}
+		index.order.resize(count);
+		for(size_t entry{}; entry < count; ++entry) {
+			const int64_t tag{tag_of(entry)};
+			auto& range = dense(tag) ? index.dense[size_t(tag)] : index.sparse[tag];
+			index.order[range.second++] = uint32_t(entry);
+		}
+
+		uint64_t strtab_address{};
+		uint64_t strtab_len{};
+		const auto first_value = [&index](const dyn_tag_t tag, uint64_t& value) {
+			const auto& range = index.dense[size_t(tag)];
+			if(range.first == range.second)
+				return false;
+			value = uint64_t(index.entries[index.order[range.first]].value());
+			return true;
+		};
+		if(first_value(dyn_tag_t::StrTab, strtab_address) && first_value(dyn_tag_t::StrTabSize, strtab_len)) {
+			const auto strtab = vaddr_view(strtab_address, size_t(strtab_len));
+			index.strtab = {reinterpret_cast<const char*>(strtab.data()), strtab.size()}; // lgtm[cpp/reinterpret-cast]
+		}
+		if(index.strtab.empty() && strtab_section != 0)
+			index.strtab = string_table(strtab_section);
+		return index;
+	}
+
+	[[nodiscard]]
+	const dynamic_index_t& dynamic_index() const {
+		return _dynamic_index.get([this]() { return build_dynamic_index(); });
+	}
+
+	/* Where the entries with `tag` are in the index's order, empty if there aren't any */
+	[[nodiscard]]
+	typename dynamic_index_t::range_t dynamic_range(const dyn_tag_t tag) const {
+		const auto& index = dynamic_index();
+		const int64_t value{int64_t(tag)};
+		if(value >= 0 && uint64_t(value) < dynamic_dense_tags)
+			return index.dense[size_t(value)];
+		const auto range = index.sparse.find(value);
+		return (range == index.sparse.end()) ? typename dynamic_index_t::range_t{} : range->second;
+	}
+
+	/* A section's contents as a string table, empty if it isn't one */
+	[[nodiscard]]
+	std::string_view string_table(const size_t section) const noexcept {
+		if(section >= _sheaders.size() || _sheaders[section].type() != elf_shtype_t::StringTable)
+			return {};
+		const auto strtab = section_data(section).raw();
+		return {reinterpret_cast<const char*>(strtab.data()), strtab.size()}; // lgtm[cpp/reinterpret-cast]
+	}
+
+	[[nodiscard]]
+	static std::string_view string_at(const std::string_view strtab, const uint64_t offset) noexcept {
+		if(offset >= strtab.size())
+			return {};
+		const char* const str{strtab.data() + offset};
+		return {str, ::strnlen(str, strtab.size() - size_t(offset))};
+	}
+
+	/*
+		Walks the verdef and verneed chains once, after which a symbol's
+		version is two array lookups. Each chain is bounded by its entry
+		count in sh_info as well as by the section, so a loop in the next
+		offsets can't keep it going.
+	*/
+	[[nodiscard]]
+	version_index_t build_version_index() const {
+		version_index_t index{};
+		const auto versym_sections = find_sections_of_type(elf_shtype_t::GNUVerSym);
+		if(versym_sections.empty())
+			return index;
+		index.versym = section_entries<uint16_t>(versym_sections.front(), elf_shtype_t::GNUVerSym);
+		index.symtab = _sheaders[versym_sections.front()].link();
+
+		const auto version = [&index](const size_t idx) -> typename version_index_t::version_t& {
+			if(idx >= index.versions.size())
+				index.versions.resize(idx + 1U);
+			return index.versions[idx];
+		};
+
+		/* Up to `count` entries starting at `offset`, `visit` returning how far away the next one is */
+		const auto walk = [](const span<const uint8_t> data, size_t offset, const size_t count, auto&& visit) {
+			for(size_t entry{}; entry < count && offset <= data.size(); ++entry) {
+				const size_t next{visit(offset)};
+				if(next == 0 || next > data.size() - offset)
+					return;
+				offset += next;
+			}
+		};
+
+		for(const auto section : find_sections_of_type(elf_shtype_t::GNUVerDef)) {
+			const auto data = section_data(section).raw();
+			const auto strtab = string_table(_sheaders[section].link());
+			walk(data, 0, _sheaders[section].info(), [&](const size_t offset) -> size_t {
+				verdef_t verdef{};
+				if(data.size() - offset < sizeof(verdef_t))
+					return 0;
+				std::memcpy(&verdef, data.data() + offset, sizeof(verdef_t));
+				const size_t aux{offset + verdef.aux_offset()};
+				/* The base definition is the object's own name rather than a version */
+				if((verdef.flags() & elf_verdef_flag_t::Base) != elf_verdef_flag_t::Base && verdef.count() != 0 &&
+					aux <= data.size() && data.size() - aux >= sizeof(verdaux_t)) {
+					verdaux_t verdaux{};
+					std::memcpy(&verdaux, data.data() + aux, sizeof(verdaux_t));
+					auto& entry = version(uint16_t(verdef.index()) & ~version_hidden);
+					entry.name = string_at(strtab, verdaux.name());
+					entry.weak = (verdef.flags() & elf_verdef_flag_t::Weak) == elf_verdef_flag_t::Weak;
+				}
+				return verdef.next_offset();
+			});
+		}
+
+		for(const auto section : find_sections_of_type(elf_shtype_t::GNUVerNeed)) {
+			const auto data = section_data(section).raw();
+			const auto strtab = string_table(_sheaders[section].link());
+			walk(data, 0, _sheaders[section].info(), [&](const size_t offset) -> size_t {
+				verneed_t verneed{};
+				if(data.size() - offset < sizeof(verneed_t))
+					return 0;
+				std::memcpy(&verneed, data.data() + offset, sizeof(verneed_t));
+				const auto file = string_at(strtab, verneed.file());
+				if(verneed.aux() <= data.size() - offset) {
+					walk(data, offset + verneed.aux(), verneed.count(), [&](const size_t aux) -> size_t {
+						vernaux_t vernaux{};
+						if(data.size() - aux < sizeof(vernaux_t))
+							return 0;
+						std::memcpy(&vernaux, data.data() + aux, sizeof(vernaux_t));
+						auto& entry = version(vernaux.other() & ~version_hidden);
+						entry.name = string_at(strtab, vernaux.name());
+						entry.file = file;
+						entry.weak = (vernaux.flags() & elf_vernaux_flag_t::Weak) == elf_vernaux_flag_t::Weak;
+						return vernaux.next();
+					});
+				}
+				return verneed.next();
+			});
+		}
+		return index;
+	}
+
+	/* What pack_relative_relocations() has to rewrite to give libc.so.6 a GLIBC_ABI_DT_RELR version need */
+	struct relr_version_need_t final {
+		size_t verneed;                        /* .gnu.version_r, 0 if nothing needs adding */
+		std::vector<uint8_t> verneed_contents;
+		size_t dynstr;                         /* .dynstr, 0 if it already has the name */
+		std::vector<uint8_t> dynstr_contents;
+	};
+
+	/*
+		glibc refuses DT_RELR in anything with a DT_VERNEED unless one of
+		libc.so.6's vernaux entries is GLIBC_ABI_DT_RELR, which is what lld
+		adds for -z pack-relative-relocs. The new entry goes on the end of
+		.gnu.version_r, chained from the last of libc.so.6's, with an index
+		nothing else uses. False if it's needed but can't be added, i.e. there
+		is a DT_VERNEED with no libc.so.6 in it.
+	*/
+	[[nodiscard]]
+	bool relr_version_need(const span<const dyn_t> entries, relr_version_need_t& need) const {
+		constexpr std::string_view relr_version{"GLIBC_ABI_DT_RELR"};
+		need = {0, {}, 0, {}};
+
+		const auto tag = std::find_if(entries.data(), entries.data() + entries.size(),
+			[](const dyn_t& entry) { return entry.tag() == dyn_tag_t::VerNeed; });
+		if(tag == entries.data() + entries.size())
+			return true;
+		size_t verneed{};
+		for(size_t index{1}; index < _sheaders.size(); ++index) {
+			if(_sheaders[index].type() == elf_shtype_t::GNUVerNeed && _sheaders[index].addr() == tag->pointer())
+				verneed = index;
+		}
+		if(verneed == 0)
+			return false;
+		const size_t dynstr{_sheaders[verneed].link()};
+		const auto data = section_data(verneed).raw();
+		const auto strtab = string_table(dynstr);
+
+		/* Bounded by the count in sh_info as well as the section, same as build_version_index() */
+		constexpr size_t none{std::numeric_limits<size_t>::max()};
+		size_t libc{none};
+		size_t last_aux{none};
+		size_t highest{1};
+		size_t offset{};
+		for(size_t entry{}; entry < _sheaders[verneed].info() && offset <= data.size() &&
+			data.size() - offset >= sizeof(verneed_t); ++entry) {
+			verneed_t file{};
+			std::memcpy(&file, data.data() + offset, sizeof(verneed_t));
+			const bool is_libc{string_at(strtab, file.file()) == "libc.so.6"};
+			if(is_libc)
+				libc = offset;
+			size_t aux{offset + file.aux()};
+			for(size_t count{}; count < file.count() && aux <= data.size() &&
+				data.size() - aux >= sizeof(vernaux_t); ++count) {
+				vernaux_t vernaux{};
+				std::memcpy(&vernaux, data.data() + aux, sizeof(vernaux_t));
+				highest = std::max<size_t>(highest, vernaux.other() & ~version_hidden);
+				if(is_libc) {
+					if(string_at(strtab, vernaux.name()) == relr_version)
+						return true;
+					last_aux = aux;
+				}
+				if(vernaux.next() == 0)
+					break;
+				aux += vernaux.next();
+			}
+			if(file.next() == 0)
+				break;
+			offset += file.next();
+		}
+		/* Definitions share the index space */
+		const auto& versions = _version_index.get([this]() { return build_version_index(); }).versions;
+		if(!versions.empty())
+			highest = std::max(highest, versions.size() - 1U);
+		if(libc == none || highest >= version_hidden - 1U)
+			return false;
+
+		/* Suffix sharing means any NUL terminated occurrence will do */
+		size_t name{strtab.find(std::string_view{"GLIBC_ABI_DT_RELR\0", relr_version.size() + 1U})};
+		if(name == std::string_view::npos) {
+			need.dynstr = dynstr;
+			need.dynstr_contents.assign(strtab.begin(), strtab.end());
+			name = need.dynstr_contents.size();
+			need.dynstr_contents.insert(need.dynstr_contents.end(), relr_version.begin(), relr_version.end());
+			need.dynstr_contents.push_back(0);
+		}
+
+		need.verneed = verneed;
+		need.verneed_contents.assign(data.data(), data.data() + data.size());
+		need.verneed_contents.resize((need.verneed_contents.size() + 3U) & ~size_t(3U));
+		const size_t added{need.verneed_contents.size()};
+		const vernaux_t vernaux{elf_hash(relr_version), elf_vernaux_flag_t::None, uint16_t(highest + 1U),
+			uint32_t(name), 0};
+		need.verneed_contents.resize(added + sizeof(vernaux_t));
+		std::memcpy(need.verneed_contents.data() + added, &vernaux, sizeof(vernaux_t));
+
+		verneed_t file{};
+		std::memcpy(&file, need.verneed_contents.data() + libc, sizeof(verneed_t));
+		if(last_aux == none)
+			file.aux(uint32_t(added - libc));
+		else {
+			vernaux_t last{};
+			std::memcpy(&last, need.verneed_contents.data() + last_aux, sizeof(vernaux_t));
+			last.next(uint32_t(added - last_aux));
+			std::memcpy(need.verneed_contents.data() + last_aux, &last, sizeof(vernaux_t));
+		}
+		file.count(uint16_t(file.count() + 1U));
+		std::memcpy(need.verneed_contents.data() + libc, &file, sizeof(verneed_t));
+		return true;
+	}
+
+	/*
+		.eh_frame's contents and where it's loaded, from the section if there
+		is one or through .eh_frame_hdr's eh_frame_ptr if the section headers
+		have been stripped. In the latter case the span runs to the end of
+		whatever it's loaded in and parsing stops at the zero terminator.
+	*/
+	[[nodiscard]]
+	span<const uint8_t> eh_frame_data(uint64_t& address) const {
+		const size_t section{find_section(".eh_frame")};
+		if(section != 0) {
+			const auto view = section_data(section);
+			if(view.compressed())
+				return {};
+			address = (_header.type() == elf_type_t::Relocatable) ?
+				section_addresses()[section] : uint64_t(_sheaders[section].addr());
+			return view.raw();
+		}
+
+		elf_eh_frame_hdr_t hdr{};
+		if(!eh_frame_hdr(hdr) || hdr.eh_frame == 0)
+			return {};
+		address = hdr.eh_frame;
+		return vaddr_view(hdr.eh_frame, size_t(address_index().file_extent(hdr.eh_frame)));
+	}
+
+	[[nodiscard]]
+	elf_eh_frame_t build_eh_frame() const {
+		uint64_t address{};
+		const auto data = eh_frame_data(address);
+		return parse_eh_frame(data, address, sizeof(typename T::addr_t));
+	}
+
+	/*
+		Every SHT_REL/SHT_RELA section inverted, a worker per section. Sites
+		are attributed to the sized definition they lie within, which for
+		relocatable objects means in the section being relocated, otherwise
+		r_offset and the symbol values are both addresses.
+
+		Relocations against a section symbol are resolved the same way, to
+		whatever is defined at S + A (plus elf_relocation_bias()). SHT_REL
+		addends are in the section contents, which isn't read here, so those
+		stay with the section symbol.
+	*/
+	[[nodiscard]]
+	elf_xref_index_t build_xref_index(const size_t threads) const {
+		elf_xref_index_t xrefs{};
+		std::vector<size_t> sources{};
+		for(size_t index{}; index < _sheaders.size(); ++index) {
+			const shdr_t& shdr{_sheaders[index]};
+			if((shdr.type() != elf_shtype_t::Rel && shdr.type() != elf_shtype_t::RelA) ||
+				symbol_table(shdr.link()).empty())
+				continue;
+			sources.push_back(index);
+			xrefs.tables.push_back(uint32_t(shdr.link()));
+		}
+		std::sort(xrefs.tables.begin(), xrefs.tables.end());
+		xrefs.tables.erase(std::unique(xrefs.tables.begin(), xrefs.tables.end()), xrefs.tables.end());
+
+		uint64_t nodes{};
+		for(const auto table : xrefs.tables) {
+			xrefs.bases.push_back(uint32_t(nodes));
+			nodes += symbol_table(table).size();
+			if(nodes >= elf_xref_index_t::npos)
+				return {};
+		}
+		xrefs.bases.push_back(uint32_t(nodes));
+		xrefs.canonical.resize(size_t(nodes));
+		std::iota(xrefs.canonical.begin(), xrefs.canonical.end(), 0U);
+
+		struct definition_t final {
+			uint64_t section; /* 0 unless it's a relocatable object */
+			uint64_t address;
+			uint64_t size;
+			uint32_t node;
+			uint32_t parent;  /* Closest enclosing definition */
+		};
+		const bool relocatable{_header.type() == elf_type_t::Relocatable};
+		std::vector<definition_t> definitions{};
+		for(size_t idx{}; idx < xrefs.tables.size(); ++idx) {
+			const auto symbols = symbol_table(xrefs.tables[idx]);
+			for(size_t symbol{1}; symbol < symbols.size(); ++symbol) {
+				const symbol_t& sym{symbols[symbol]};
+				const size_t section{symbol_section(xrefs.tables[idx], symbol, sym)};
+				const auto type = elf_symbol_type_t(sym.type());
+				if(sym.size() == 0 || section == size_t(elf_shns_t::Undefined) ||
+					section >= size_t(elf_shns_t::LowReserve) || type == elf_symbol_type_t::Section ||
+					type == elf_symbol_type_t::File)
+					continue;
+				definitions.push_back({relocatable ? section : 0U, uint64_t(sym.value()), uint64_t(sym.size()),
+					uint32_t(xrefs.bases[idx] + symbol), elf_xref_index_t::npos});
+			}
+		}
+		const auto before = [](const definition_t& a, const uint64_t section, const uint64_t address) {
+			return (a.section != section) ? a.section < section : a.address < address;
+		};
+		std::sort(definitions.begin(), definitions.end(), [&before](const definition_t& a, const definition_t& b) {
+			return before(a, b.section, b.address) || (!before(b, a.section, a.address) && a.node < b.node);
+		});
+
+		/* Aliases fold into the lowest numbered one, which also takes the largest size */
+		size_t kept{};
+		for(const auto& definition : definitions) {
+			if(kept != 0 && definitions[kept - 1].section == definition.section &&
+				definitions[kept - 1].address == definition.address) {
+				xrefs.canonical[definition.node] = definitions[kept - 1].node;
+				definitions[kept - 1].size = std::max(definitions[kept - 1].size, definition.size);
+				continue;
+			}
+			definitions[kept++] = definition;
+		}
+		definitions.resize(kept);
+
+		std::vector<uint32_t> open{};
+		for(size_t idx{}; idx < definitions.size(); ++idx) {
+			auto& definition = definitions[idx];
+			while(!open.empty() && (definitions[open.back()].section != definition.section ||
+				(definition.address - definitions[open.back()].address) >= definitions[open.back()].size))
+				open.pop_back();
+			definition.parent = open.empty() ? elf_xref_index_t::npos : open.back();
+			open.push_back(uint32_t(idx));
+		}
+
+		const auto within = [&definitions](const uint64_t section, const uint64_t offset) {
+			const definition_t* const first{definitions.data()};
+			const auto* const upper = std::upper_bound(first, first + definitions.size(), offset,
+				[section](const uint64_t value, const definition_t& definition) {
+					return (section != definition.section) ? section < definition.section : value < definition.address;
+				});
+			auto candidate = (upper == first) ? elf_xref_index_t::npos : uint32_t((upper - first) - 1);
+			while(candidate != elf_xref_index_t::npos) {
+				const definition_t& definition{first[candidate]};
+				if(definition.section == section && (offset - definition.address) < definition.size)
+					return definition.node;
+				candidate = definition.parent;
+			}
+			return elf_xref_index_t::npos;
+		};
+
+		std::vector<std::vector<xref_t>> references(sources.size());
+		parallel_for(sources.size(), [&](const size_t idx) {
+			const size_t source{sources[idx]};
+			const shdr_t& shdr{_sheaders[source]};
+			const auto table = std::lower_bound(xrefs.tables.begin(), xrefs.tables.end(), uint32_t(shdr.link()));
+			const uint32_t base{xrefs.bases[size_t(table - xrefs.tables.begin())]};
+			const auto symbols = symbol_table(shdr.link());
+			const size_t section{(shdr.info() < _sheaders.size()) ? size_t(shdr.info()) : 0U};
+			const auto entries = relocations(source);
+			references[idx].reserve(entries.size());
+			for(const auto& entry : entries) {
+				if(entry.symbol == 0 || entry.symbol >= symbols.size())
+					continue;
+				uint32_t target{xrefs.canonical[base + entry.symbol]};
+				const symbol_t& sym{symbols[entry.symbol]};
+				if(elf_symbol_type_t(sym.type()) == elf_symbol_type_t::Section && !entry.implicit) {
+					const size_t defined{symbol_section(shdr.link(), entry.symbol, sym)};
+					const uint32_t definition{within(relocatable ? defined : 0U, uint64_t(sym.value()) +
+						uint64_t(entry.addend) + elf_relocation_bias(_header.machine(), entry.type))};
+					if(definition != elf_xref_index_t::npos)
+						target = definition;
+				}
+				references[idx].push_back({target, {
+					entry.offset, uint32_t(section), uint32_t(source), entry.type,
+					within(relocatable ? section : 0U, entry.offset)
+				}});
+			}
+		}, threads);
+		xrefs.index = xref_index_t{size_t(nodes), references};
+		return xrefs;
+	}
+
+	/* .debug_`name`, or the GNU .zdebug_`name` if that's how it was compressed */
+	[[nodiscard]]
+	elf_section_view_t debug_section(const std::string_view name) const {
+		const std::string suffix{name};
+		const size_t section{find_section(".debug_" + suffix)};
+		return section_data((section != 0) ? section : find_section(".zdebug_" + suffix));
+	}
+
+	/*
+		.debug_info and .debug_abbrev are only needed to get from the
+		.debug_aranges sets to the line programs, so they are let go of as
+		soon as the index is built.
+	*/
+	[[nodiscard]]
+	debug_lines_t build_debug_lines(const size_t cache_limit) const {
+		auto line = debug_section("line");
+		auto line_str = debug_section("line_str");
+		auto str = debug_section("str");
+		const auto info = debug_section("info");
+		const auto abbrev = debug_section("abbrev");
+		const auto aranges = debug_section("aranges");
+		const dwarf_sections_t sections{
+			info.data(), abbrev.data(), aranges.data(), line.data(), line_str.data(), str.data()
+		};
+		return {std::move(line), std::move(line_str), std::move(str), dwarf_line_index_t{sections, cache_limit}};
+	}
+
+	/* Section contents as 32-bit words, empty if they run off the end of the file */
+	[[nodiscard]]
+	span<const uint32_t> section_words(const shdr_t& shdr) const noexcept {
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if(shdr.type() == elf_shtype_t::NoBits || shdr.offset() > file_len ||
+			shdr.size() > (file_len - shdr.offset()))
+			return {};
+		const auto* words = reinterpret_cast<const uint32_t*>( // lgtm[cpp/reinterpret-cast]
+			_file_map.address<uint8_t>() + shdr.offset());
+		return {words, size_t(shdr.size() / sizeof(uint32_t))};
+	}
+
+	/* Fixed size entries of a section of `type`, empty if it's something else or is truncated */
+	template<typename E>
+	[[nodiscard]]
+	span<const E> section_entries(const size_t section, const elf_shtype_t type) const noexcept {
+		if(section >= _sheaders.size() || _sheaders[section].type() != type)
+			return {};
+		const shdr_t& shdr{_sheaders[section]};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if(shdr.offset() > file_len || shdr.size() > (file_len - shdr.offset()))
+			return {};
+		const auto* entries = reinterpret_cast<const E*>( // lgtm[cpp/reinterpret-cast]
+			_file_map.address<uint8_t>() + shdr.offset());
+		return {entries, size_t(shdr.size() / sizeof(E))};
+	}
+
+	/* Prefers .gnu.hash like ld.so does, anything malformed is treated as absent */
+	[[nodiscard]]
+	symbol_hash_t build_symbol_hash() const noexcept {
+		symbol_hash_t hash{};
+		for(const auto type : {elf_shtype_t::GNUHash, elf_shtype_t::HashTable}) {
+			for(size_t section{}; section < _sheaders.size(); ++section) {
+				const shdr_t& shdr{_sheaders[section]};
+				if(shdr.type() != type || symbol_table(shdr.link()).empty())
+					continue;
+
+				const auto words = section_words(shdr);
+				if(type == elf_shtype_t::GNUHash) {
+					if(words.size() < 4)
+						continue;
+					const uint32_t nbuckets{words[0]};
+					const size_t bloom_words{size_t(words[2]) * (sizeof(bloom_word_t) / sizeof(uint32_t))};
+					const size_t header{4 + bloom_words + nbuckets};
+					/* Bloom size has to be a power of two for the masking ld.so does */
+					if(nbuckets == 0 || words[2] == 0 || (words[2] & (words[2] - 1U)) != 0 ||
+						header > words.size())
+						continue;
+
+					hash.gnu = true;
+					hash.symoffset = words[1];
+					hash.bloom_shift = words[3];
+					hash.bloom = {reinterpret_cast<const bloom_word_t*>(words.data() + 4), words[2]}; // lgtm[cpp/reinterpret-cast]
+					hash.buckets = {words.data() + 4 + bloom_words, nbuckets};
+					hash.chains = {words.data() + header, words.size() - header};
+				} else {
+					if(words.size() < 2 || words[0] == 0 || (size_t(words[0]) + words[1] + 2U) > words.size())
+						continue;
+
+					hash.buckets = {words.data() + 2, words[0]};
+					hash.chains = {words.data() + 2 + words[0], words[1]};
+				}
+				hash.symtab = shdr.link();
+				return hash;
+			}
+		}
+		return hash;
+	}
+
+	[[nodiscard]]
+	const symbol_hash_t& symbol_hash() const {
+		return _symbol_hash.get([this]() { return build_symbol_hash(); });
+	}
+
+	/* The same test ld.so's do_lookup applies before comparing names */
+	[[nodiscard]]
+	bool dynamic_match(const span<const symbol_t> symbols, const size_t strtab, const uint32_t index,
+		const std::string_view name) const noexcept {
+		if(index >= symbols.size())
+			return false;
+		const symbol_t& sym{symbols[index]};
+		if(sym.shndx() == uint16_t(elf_shns_t::Undefined) ||
+			(sym.value() == 0 && elf_symbol_type_t(sym.type()) != elf_symbol_type_t::ThreadLocalStorage))
+			return false;
+		return section_string(strtab, sym.name()) == name;
+	}
+
+	[[nodiscard]]
+	bool gnu_compressed_name(const shdr_t& shdr) const noexcept {
+		return section_name_starts_with(shdr, gnu_debug_prefix, sizeof(gnu_debug_prefix) - 1);
+	}
+
+	/* Only the tables are found here, the symbols themselves are resolved on demand */
+	void map_shndx_tables() noexcept {
+		const uint64_t file_len = uint64_t(_file_map.length());
+		for(size_t index{}; index < _sheaders.size(); ++index) {
+			const shdr_t& shdr{_sheaders[index]};
+			if(shdr.type() != elf_shtype_t::SymbolTableIndex || shdr.link() >= _sheaders.size() ||
+				shdr.offset() > file_len || shdr.size() > (file_len - shdr.offset()))
+				continue;
+
+			const auto* table = reinterpret_cast<const uint32_t*>( // lgtm[cpp/reinterpret-cast]
+				_file_map.address<uint8_t>() + shdr.offset());
+			_shndx_tables.emplace(shdr.link(), span<const uint32_t>{table, size_t(shdr.size() / sizeof(uint32_t))});
+		}
+	}
 public:
+	constexpr static size_t default_section_cache_limit{64_MiB};
+
+	/* Which way convert_compressed_sections() should go */
+	enum class compression_style_t : uint8_t {
+		Chdr, /* SHF_COMPRESSED with a chdr_t */
+		GNU,  /* Legacy .zdebug_* sections */
+	};
+
+	/* Replacement name, flags, and contents for a converted section */
+	struct section_rewrite_t final {
+		size_t index;
+		std::string name;
+		shflags_t flags;
+		std::vector<uint8_t> contents;
+	};
+
 	constexpr elf_t() noexcept :
 		_file{}, _file_fd{}, _file_map{}, _header{}, _pheaders{}, _sheaders{},
-		_strtbl{}, _constructed{true} { /* NOP */ }
+		_shstrndx{}, _strtbl{}, _strtbl_len{}, _shndx_tables{}, _section_index{},
+		_symbol_index{}, _symbol_hash{}, _address_index{}, _dynamic_index{}, _segment_map{}, _version_index{},
+		_eh_frame{}, _xref_index{}, _debug_lines{}, _section_cache{default_section_cache_limit},
+		_constructed{true} { /* NOP */ }
 
 	elf_t(fs::path file, bool readonly = true) noexcept :
 		_file{std::move(file)}, _file_fd{_file.c_str(), O_RDONLY},
 		_file_map{_file_fd.map(PROT_READ)},
-		_header{}, _pheaders{}, _sheaders{}, _strtbl{}, _constructed{true} {
+		_header{}, _pheaders{}, _sheaders{}, _shstrndx{}, _strtbl{}, _strtbl_len{},
+		_shndx_tables{}, _section_index{}, _symbol_index{}, _symbol_hash{}, _address_index{},
+		_dynamic_index{}, _segment_map{}, _version_index{}, _eh_frame{}, _xref_index{}, _debug_lines{},
+		_section_cache{default_section_cache_limit}, _constructed{true} {
 
 		if(!_file_map.valid()) {
 			_constructed = false;
 			return;
 		} else {
 			_header = _file_map.at<ehdr_t>(0);
+			const uint64_t file_len = uint64_t(_file_map.length());
+
+			/*
+				Once the counts no longer fit in the ehdr_t they're escaped and
+				the real values are kept in section 0, which is otherwise unused.
+			*/
+			uint64_t shnum{_header.shnum()};
+			uint64_t phnum{_header.phnum()};
+			_shstrndx = _header.shstrndx();
+			const bool has_sheaders{_header.shoff() != 0 && _header.shoff() < file_len &&
+				(file_len - _header.shoff()) >= sizeof(shdr_t)};
+			if(has_sheaders) {
+				const shdr_t& null_section{_file_map.at<shdr_t>(_header.shoff())};
+				if(shnum == 0)
+					shnum = null_section.size();
+				if(_shstrndx == size_t(elf_shns_t::XIndex))
+					_shstrndx = null_section.link();
+				if(phnum == elf_pn_xnum)
+					phnum = null_section.info();
+			}
 
-			if(_header.phnum() > 0 && _header.phoff() < _file_map.length())
-				_pheaders = {&_file_map.at<phdr_t>(_header.phoff()), _header.phnum()};
-
+			/* Never take the counts further than the file actually goes */
+			if(phnum > 0 && _header.phoff() < file_len) {
+				phnum = std::min<uint64_t>(phnum, (file_len - _header.phoff()) / sizeof(phdr_t));
+				_pheaders = {&_file_map.at<phdr_t>(_header.phoff()), size_t(phnum)};
+			}
 
-			if(_header.shnum() > 0 && _header.shoff() < _file_map.length()) {
-				_sheaders = {&_file_map.at<shdr_t>(_header.shoff()), _header.shnum()};
+			if(has_sheaders && shnum > 0) {
+				shnum = std::min<uint64_t>(shnum, (file_len - _header.shoff()) / sizeof(shdr_t));
+				_sheaders = {&_file_map.at<shdr_t>(_header.shoff()), size_t(shnum)};
 				/* Map the string table */
-				if(_header.shstrndx() < _file_map.length()) {
-					auto strtbl_offset =  (_sheaders[_header.shstrndx()]).offset();
-					if(strtbl_offset < _file_map.length())
+				if(_shstrndx < _sheaders.size()) {
+					auto strtbl_offset =  (_sheaders[_shstrndx]).offset();
+					if(strtbl_offset < file_len) {
 						_strtbl = &_file_map.at<char>(strtbl_offset);
+						_strtbl_len = std::min<uint64_t>((_sheaders[_shstrndx]).size(),
+							file_len - strtbl_offset);
+					}
 				}
+				map_shndx_tables();
 			}
 		}
 	}
@@ -2196,22 +3648,1231 @@ public:
 	[[nodiscard]]
 	ehdr_t header() const noexcept { return _header; }
 
-	void pheaders(const span<phdr_t> pheaders) noexcept { _pheaders = pheaders; }
+	void pheaders(const span<phdr_t> pheaders) noexcept {
+		_pheaders = pheaders;
+		_address_index.reset();
+		_dynamic_index.reset();
+		_segment_map.reset();
+		_eh_frame.reset();
+	}
 	[[nodiscard]]
 	span<phdr_t> pheaders() const noexcept { return _pheaders; }
 
-	void sheaders(const span<shdr_t> sheaders) noexcept { _sheaders = sheaders; }
+	void sheaders(const span<shdr_t> sheaders) noexcept {
+		_sheaders = sheaders;
+		_section_index.reset();
+		_symbol_index.reset();
+		_symbol_hash.reset();
+		_address_index.reset();
+		_dynamic_index.reset();
+		_segment_map.reset();
+		_version_index.reset();
+		_eh_frame.reset();
+		_xref_index.reset();
+		_debug_lines.reset();
+	}
 	[[nodiscard]]
 	span<shdr_t> sheaders() const noexcept { return _sheaders; }
 
 
+	/*
+		Section and segment counts with any extended numbering resolved, which
+		is not the case for the raw values in header().
+	*/
+	[[nodiscard]]
+	size_t shnum() const noexcept { return _sheaders.size(); }
+	[[nodiscard]]
+	size_t phnum() const noexcept { return _pheaders.size(); }
+	[[nodiscard]]
+	size_t shstrndx() const noexcept { return _shstrndx; }
+
+	/* Every section of the given type, in section order */
+	[[nodiscard]]
+	std::vector<size_t> find_sections_of_type(const elf_shtype_t type) const {
+		std::vector<size_t> sections{};
+		for(size_t section{}; section < _sheaders.size(); ++section) {
+			if(_sheaders[section].type() == type)
+				sections.push_back(section);
+		}
+		return sections;
+	}
+
+	/* NUL terminated string at `offset` in the string table `section`, bounded by the section */
+	[[nodiscard]]
+	std::string_view section_string(const size_t section, const size_t offset) const noexcept {
+		if(section >= _sheaders.size())
+			return {};
+		const shdr_t& shdr{_sheaders[section]};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if(shdr.type() == elf_shtype_t::NoBits || shdr.offset() > file_len ||
+			shdr.size() > (file_len - shdr.offset()) || offset >= shdr.size())
+			return {};
+		const char* str{_file_map.address<char>() + shdr.offset() + offset};
+		return {str, ::strnlen(str, shdr.size() - offset)};
+	}
+
+	/* Entries of the symbol table `section` (.symtab or .dynsym), empty if it isn't one */
+	[[nodiscard]]
+	span<const symbol_t> symbol_table(const size_t section) const noexcept {
+		if(section >= _sheaders.size())
+			return {};
+		const shdr_t& shdr{_sheaders[section]};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if((shdr.type() != elf_shtype_t::SymbolTable && shdr.type() != elf_shtype_t::DynamicSymbols) ||
+			shdr.offset() > file_len || shdr.size() > (file_len - shdr.offset()))
+			return {};
+		const auto* symbols = reinterpret_cast<const symbol_t*>( // lgtm[cpp/reinterpret-cast]
+			_file_map.address<uint8_t>() + shdr.offset());
+		return {symbols, size_t(shdr.size() / sizeof(symbol_t))};
+	}
+
+	/* Entries of the SHT_REL section `section`, empty if it isn't one */
+	[[nodiscard]]
+	span<const rel_t> rel_table(const size_t section) const noexcept {
+		return section_entries<rel_t>(section, elf_shtype_t::Rel);
+	}
+
+	/* Entries of the SHT_RELA section `section`, empty if it isn't one */
+	[[nodiscard]]
+	span<const rela_t> rela_table(const size_t section) const noexcept {
+		return section_entries<rela_t>(section, elf_shtype_t::RelA);
+	}
+
+	/* The entries of either kind of relocation section in file order */
+	[[nodiscard]]
+	std::vector<elf_relocation_t> relocations(const size_t section) const {
+		std::vector<elf_relocation_t> entries{};
+		const auto rel = rel_table(section);
+		const auto rela = rela_table(section);
+		entries.reserve(rel.size() + rela.size());
+		for(const auto& entry : rel)
+			entries.push_back({uint64_t(entry.offset()), 0, uint32_t(entry.type()), uint32_t(entry.sym()), true});
+		for(const auto& entry : rela)
+			entries.push_back({uint64_t(entry.offset()), int64_t(entry.addend()), uint32_t(entry.type()),
+				uint32_t(entry.sym()), false});
+		return entries;
+	}
+
+	/* S for every symbol in `symtab` given `addresses`, undefined and common symbols being 0 */
+	[[nodiscard]]
+	std::vector<uint64_t> symbol_values(const size_t symtab, const std::vector<uint64_t>& addresses) const {
+		const auto symbols = symbol_table(symtab);
+		const bool relocatable{_header.type() == elf_type_t::Relocatable};
+		std::vector<uint64_t> values(symbols.size());
+		for(size_t idx{}; idx < symbols.size(); ++idx) {
+			const symbol_t& sym{symbols[idx]};
+			const size_t section{symbol_section(symtab, idx, sym)};
+			if(section == size_t(elf_shns_t::ABS) || (!relocatable && section != size_t(elf_shns_t::Undefined)))
+				values[idx] = uint64_t(sym.value());
+			else if(section != size_t(elf_shns_t::Undefined) && section < addresses.size())
+				values[idx] = addresses[section] + uint64_t(sym.value());
+		}
+		return values;
+	}
+
+	/* A section's contents with the relocations against it applied */
+	struct relocated_section_t final {
+		size_t index;
+		uint64_t address;
+		std::vector<uint8_t> contents;
+		elf_relocation_stats_t stats;
+	};
+
+	/*
+		Applies every SHT_REL/SHT_RELA section to a copy of the section it
+		targets with apply_relocations(), giving an image of a relocatable
+		object as if it were linked at `base` with everything it imports at
+		0. Sections are relocated in parallel across `threads` workers, 0 for
+		one per core.
+	*/
+	[[nodiscard]]
+	std::vector<relocated_section_t> relocate_sections(const uint64_t base = 0, const size_t threads = 0) const {
+		const auto addresses = section_addresses(base);
+
+		std::vector<std::vector<size_t>> sources(_sheaders.size());
+		std::vector<size_t> targets{};
+		std::unordered_map<size_t, std::pair<std::vector<uint64_t>, std::vector<uint64_t>>> symtabs{};
+		for(size_t index{}; index < _sheaders.size(); ++index) {
+			const shdr_t& shdr{_sheaders[index]};
+			if((shdr.type() != elf_shtype_t::Rel && shdr.type() != elf_shtype_t::RelA) ||
+				shdr.info() == 0 || shdr.info() >= _sheaders.size() ||
+				_sheaders[shdr.info()].type() == elf_shtype_t::NoBits)
+				continue;
+			if(sources[shdr.info()].empty())
+				targets.push_back(shdr.info());
+			sources[shdr.info()].push_back(index);
+			symtabs.emplace(shdr.link(), std::pair<std::vector<uint64_t>, std::vector<uint64_t>>{});
+		}
+		for(auto& [symtab, symbols] : symtabs) {
+			symbols.first = symbol_values(symtab, addresses);
+			for(const auto& sym : symbol_table(symtab))
+				symbols.second.push_back(uint64_t(sym.size()));
+		}
+
+		std::vector<relocated_section_t> relocated(targets.size());
+		parallel_for(targets.size(), [&](const size_t idx) {
+			const size_t target{targets[idx]};
+			/* The view owns whatever was inflated, the cache may not hold on to it */
+			const auto view = section_data(target);
+			const auto contents = view.data();
+			auto& section = relocated[idx];
+			section.index = target;
+			section.address = addresses[target];
+			section.contents.assign(contents.data(), contents.data() + contents.size());
+			section.stats = {0, 0, 0};
+			for(const size_t source : sources[target]) {
+				const auto entries = relocations(source);
+				const auto& symbols = symtabs.at(_sheaders[source].link());
+				section.stats += apply_relocations(_header.machine(), {
+					{section.contents.data(), section.contents.size()}, section.address,
+					{symbols.first.data(), symbols.first.size()}, {symbols.second.data(), symbols.second.size()}
+				}, entries.data(), entries.size());
+			}
+		}, threads);
+		return relocated;
+	}
+
+	/*
+		Who references what, from every relocation against a symbol. Built
+		on first use across `threads` workers (0 for one per core), later
+		calls ignore `threads`.
+	*/
+	[[nodiscard]]
+	const elf_xref_index_t& xref_index(const size_t threads = 0) const {
+		return _xref_index.get([this, threads]() { return build_xref_index(threads); });
+	}
+
+	/* Every relocation against `symbol` of `symtab` or its aliases, empty if there are none */
+	[[nodiscard]]
+	span<const xref_site_t> references(const size_t symtab, const size_t symbol) const {
+		return xref_index().references(symtab, symbol);
+	}
+
+	/* Result of pack_relative_relocations() */
+	struct relr_rewrite_t final {
+		struct header_t final {
+			size_t index;
+			shdr_t header;
+		};
+		size_t packed;                           /* Relocations moved to .relr.dyn */
+		size_t remaining;                        /* Entries left in the rel(a) table */
+		/*
+			The rel(a) table, .relr.dyn, .dynamic, .gnu.version_r and .dynstr
+			if they moved, then the sections given addends by index.
+		*/
+		std::vector<section_rewrite_t> sections;
+		/*
+			Headers that change, the rel(a) table's and any that moved along
+			with the new .relr.dyn, which is one past the last section and
+			has no sh_name yet.
+		*/
+		std::vector<header_t> headers;
+	};
+
+	/*
+		Moves the word aligned R_*_RELATIVE entries of the DT_RELA (or DT_REL)
+		table into a new SHT_RELR .relr.dyn. RELR addends are implicit, so for
+		RELA they get written into the relocated words, which is why anything
+		landing in SHT_NOBITS stays where it is. .relr.dyn is placed in the
+		space the rel(a) table no longer needs, so nothing else has to move,
+		and DT_RELR/DT_RELRSZ/DT_RELRENT go into spare DT_NULL slots in
+		.dynamic, along with the updated size and count.
+
+		The loader has to understand DT_RELR (glibc 2.36, musl 1.2.4, bionic).
+		glibc also wants a GLIBC_ABI_DT_RELR version need on libc.so.6, so if
+		there's a DT_VERNEED that entry is added and .gnu.version_r, plus
+		.dynstr if it doesn't have the name yet, are moved into the freed
+		space after .relr.dyn to make room for it.
+
+		Returns nothing packed if there is nothing to pack, the object already
+		has a DT_RELR, .dynamic doesn't have the four DT_NULLs needed, there
+		is a DT_VERNEED without libc.so.6 in it, or the freed space is too
+		small.
+	*/
+	[[nodiscard]]
+	relr_rewrite_t pack_relative_relocations() const {
+		constexpr size_t word_size{sizeof(typename T::addr_t)};
+		relr_rewrite_t rewrite{0, 0, {}, {}};
+
+		const uint32_t relative{elf_relative_type(_header.machine())};
+		const auto dynamic_sections = find_sections_of_type(elf_shtype_t::Dynamic);
+		if(relative == 0 || dynamic_sections.empty())
+			return rewrite;
+		const size_t dynamic{dynamic_sections.front()};
+		const auto entries = section_entries<dyn_t>(dynamic, elf_shtype_t::Dynamic);
+
+		uint64_t table_address{};
+		bool rela{false};
+		size_t spare{};
+		for(const auto& entry : entries) {
+			if(entry.tag() == dyn_tag_t::Relr)
+				return rewrite;
+			if(entry.tag() == dyn_tag_t::RelA) {
+				table_address = uint64_t(entry.pointer());
+				rela = true;
+			} else if(entry.tag() == dyn_tag_t::Rel && !rela)
+				table_address = uint64_t(entry.pointer());
+			else if(entry.tag() == dyn_tag_t::None)
+				++spare;
+		}
+		/* Three new tags and a terminator, .dynamic can't grow without moving whatever follows it */
+		if(spare < 3U + 1U)
+			return rewrite;
+		size_t table{};
+		for(size_t index{1}; index < _sheaders.size(); ++index) {
+			if(_sheaders[index].type() == (rela ? elf_shtype_t::RelA : elf_shtype_t::Rel) &&
+				uint64_t(_sheaders[index].addr()) == table_address)
+				table = index;
+		}
+		if(table == 0)
+			return rewrite;
+		relr_version_need_t need{};
+		if(!relr_version_need(entries, need))
+			return rewrite;
+
+		/* Loaded sections with contents, by address, for writing the addends out */
+		std::vector<size_t> loaded{};
+		for(size_t index{1}; index < _sheaders.size(); ++index) {
+			const shdr_t& shdr{_sheaders[index]};
+			if((shdr.flags() & shflags_t::Alloc) == shflags_t::Alloc && shdr.size() != 0)
+				loaded.push_back(index);
+		}
+		std::sort(loaded.begin(), loaded.end(), [this](const size_t a, const size_t b) {
+			return _sheaders[a].addr() < _sheaders[b].addr();
+		});
+		const auto section_at = [&](const uint64_t address) -> size_t {
+			const auto next = std::upper_bound(loaded.begin(), loaded.end(), address,
+				[this](const uint64_t value, const size_t index) { return value < uint64_t(_sheaders[index].addr()); });
+			if(next == loaded.begin())
+				return 0;
+			const shdr_t& shdr{_sheaders[*(next - 1)]};
+			if(shdr.type() == elf_shtype_t::NoBits || shdr.size() < word_size ||
+				address - uint64_t(shdr.addr()) > uint64_t(shdr.size()) - word_size)
+				return 0;
+			return *(next - 1);
+		};
+
+		std::unordered_map<size_t, std::vector<uint8_t>> patched{};
+		std::vector<uint64_t> addresses{};
+		std::vector<uint8_t> kept{};
+		size_t leading{};
+		const auto keep = [&](const void* entry, const size_t len, const bool is_relative) {
+			if(is_relative && kept.size() == leading * len)
+				++leading;
+			kept.insert(kept.end(), static_cast<const uint8_t*>(entry), static_cast<const uint8_t*>(entry) + len);
+			++rewrite.remaining;
+		};
+		const auto pack = [&](const uint64_t address, const int64_t* addend) {
+			if((address % word_size) != 0)
+				return false;
+			const size_t section{section_at(address)};
+			if(section == 0)
+				return false;
+			if(addend != nullptr) {
+				auto contents = patched.find(section);
+				if(contents == patched.end()) {
+					const auto data = section_data(section).raw();
+					contents = patched.emplace(section, std::vector<uint8_t>(data.data(), data.data() + data.size())).first;
+				}
+				const typename T::addr_t value{typename T::addr_t(*addend)};
+				std::memcpy(contents->second.data() + (address - uint64_t(_sheaders[section].addr())), &value, word_size);
+			}
+			addresses.push_back(address);
+			return true;
+		};
+
+		if(rela) {
+			for(const auto& entry : rela_table(table)) {
+				const int64_t addend{int64_t(entry.addend())};
+				const bool is_relative{entry.type() == relative && entry.sym() == 0};
+				if(!is_relative || !pack(uint64_t(entry.offset()), &addend))
+					keep(&entry, sizeof(rela_t), is_relative);
+			}
+		} else {
+			for(const auto& entry : rel_table(table)) {
+				const bool is_relative{entry.type() == relative && entry.sym() == 0};
+				if(!is_relative || !pack(uint64_t(entry.offset()), nullptr))
+					keep(&entry, sizeof(rel_t), is_relative);
+			}
+		}
+		if(addresses.empty())
+			return rewrite;
+
+		/* Everything new goes in the space the packed entries leave behind, in the order it's placed */
+		const shdr_t& table_shdr{_sheaders[table]};
+		const uint64_t table_start{uint64_t(table_shdr.addr())};
+		const uint64_t table_end{table_start + uint64_t(table_shdr.size())};
+		uint64_t free_space{table_start + kept.size()};
+		const auto place = [&](const size_t len, const uint64_t align, uint64_t& address) {
+			address = ((free_space + align - 1U) / align) * align;
+			if(address > table_end || len > table_end - address)
+				return false;
+			free_space = address + len;
+			return true;
+		};
+		const auto placed_header = [&](shdr_t header, const uint64_t address, const size_t len) {
+			header.addr(typename T::addr_t(address));
+			header.offset(typename T::offset_t(uint64_t(table_shdr.offset()) + (address - table_start)));
+			header.size(typename T::xword_t(len));
+			return header;
+		};
+
+		auto relr = encode_relr(addresses, word_size);
+		uint64_t relr_address{};
+		uint64_t verneed_address{};
+		uint64_t dynstr_address{};
+		if(!place(relr.size(), word_size, relr_address) ||
+			(need.verneed != 0 && !place(need.verneed_contents.size(),
+				std::max<uint64_t>(uint64_t(_sheaders[need.verneed].addraline()), 4U), verneed_address)) ||
+			(need.dynstr != 0 && !place(need.dynstr_contents.size(), 1U, dynstr_address)))
+			return {0, 0, {}, {}};
+		rewrite.packed = addresses.size();
+
+		/* Everything up to the first DT_NULL, then ours, then the rest of the DT_NULLs */
+		std::vector<dyn_t> updated{};
+		const size_t removed{(rela ? sizeof(rela_t) : sizeof(rel_t)) * rewrite.packed};
+		for(const auto& entry : entries) {
+			if(entry.tag() == dyn_tag_t::None)
+				continue;
+			dyn_t copy{entry};
+			if(copy.tag() == (rela ? dyn_tag_t::RelASize : dyn_tag_t::RelSize))
+				copy.value(typename T::xword_t(uint64_t(copy.value()) - std::min<uint64_t>(uint64_t(copy.value()), removed)));
+			else if(copy.tag() == (rela ? dyn_tag_t::RelACount : dyn_tag_t::RelCount))
+				copy.value(typename T::xword_t(leading));
+			else if(copy.tag() == dyn_tag_t::VerNeed && need.verneed != 0)
+				copy.pointer(typename T::addr_t(verneed_address));
+			else if(copy.tag() == dyn_tag_t::StrTab && need.dynstr != 0)
+				copy.pointer(typename T::addr_t(dynstr_address));
+			else if(copy.tag() == dyn_tag_t::StrTabSize && need.dynstr != 0)
+				copy.value(typename T::xword_t(need.dynstr_contents.size()));
+			updated.push_back(copy);
+		}
+		updated.emplace_back(dyn_tag_t::Relr, typename T::xword_t(relr_address));
+		updated.emplace_back(dyn_tag_t::RelrSize, typename T::xword_t(relr.size()));
+		updated.emplace_back(dyn_tag_t::RelrEnt, typename T::xword_t(word_size));
+		updated.resize(updated.size() + spare - 3U);
+
+		const size_t relr_index{_sheaders.size()};
+		rewrite.headers.push_back({table, placed_header(table_shdr, table_start, kept.size())});
+		shdr_t relr_header{};
+		relr_header.type(elf_shtype_t::Relr);
+		relr_header.flags(shflags_t::Alloc);
+		relr_header.addraline(typename T::xword_t(word_size));
+		relr_header.entsize(typename T::xword_t(word_size));
+		rewrite.headers.push_back({relr_index, placed_header(relr_header, relr_address, relr.size())});
+
+		const auto name_of = [this](const size_t index) { return std::string{section_name_view(_sheaders[index])}; };
+		rewrite.sections.push_back({table, name_of(table), table_shdr.flags(), std::move(kept)});
+		rewrite.sections.push_back({relr_index, ".relr.dyn", shflags_t::Alloc, std::move(relr)});
+		std::vector<uint8_t> dynamic_contents(updated.size() * sizeof(dyn_t));
+		std::memcpy(dynamic_contents.data(), updated.data(), dynamic_contents.size());
+		rewrite.sections.push_back({dynamic, name_of(dynamic), _sheaders[dynamic].flags(), std::move(dynamic_contents)});
+		if(need.verneed != 0) {
+			rewrite.headers.push_back({need.verneed,
+				placed_header(_sheaders[need.verneed], verneed_address, need.verneed_contents.size())});
+			rewrite.sections.push_back({need.verneed, name_of(need.verneed), _sheaders[need.verneed].flags(),
+				std::move(need.verneed_contents)});
+		}
+		if(need.dynstr != 0) {
+			rewrite.headers.push_back({need.dynstr,
+				placed_header(_sheaders[need.dynstr], dynstr_address, need.dynstr_contents.size())});
+			rewrite.sections.push_back({need.dynstr, name_of(need.dynstr), _sheaders[need.dynstr].flags(),
+				std::move(need.dynstr_contents)});
+		}
+		const size_t fixed{rewrite.sections.size()};
+		for(auto& [index, contents] : patched)
+			rewrite.sections.push_back({index, name_of(index), _sheaders[index].flags(), std::move(contents)});
+		std::sort(rewrite.sections.begin() + ptrdiff_t(fixed), rewrite.sections.end(),
+			[](const section_rewrite_t& a, const section_rewrite_t& b) { return a.index < b.index; });
+		return rewrite;
+	}
+
+	/*
+		Where each section is, relocatable objects getting their SHF_ALLOC
+		sections laid out one after another from `base` in section order.
+		Everything else uses sh_addr.
+	*/
+	[[nodiscard]]
+	std::vector<uint64_t> section_addresses(const uint64_t base = 0) const {
+		std::vector<uint64_t> addresses(_sheaders.size());
+		const bool relocatable{_header.type() == elf_type_t::Relocatable};
+		uint64_t next{base};
+		for(size_t index{1}; index < _sheaders.size(); ++index) {
+			const shdr_t& shdr{_sheaders[index]};
+			if(!relocatable) {
+				addresses[index] = uint64_t(shdr.addr());
+				continue;
+			}
+			if((shdr.flags() & shflags_t::Alloc) != shflags_t::Alloc)
+				continue;
+			const uint64_t align{std::max<uint64_t>(uint64_t(shdr.addraline()), 1U)};
+			next = ((next + align - 1U) / align) * align;
+			addresses[index] = next;
+			next += uint64_t(shdr.size());
+		}
+		return addresses;
+	}
+
+	/*
+		Address to symbol lookup over .symtab, or .dynsym if the object has been
+		stripped. Built on first use across `threads` workers (0 for one per
+		core), later calls ignore `threads`. For relocatable objects the
+		addresses are where section_addresses() puts each symbol's section
+		plus its st_value.
+	*/
+	[[nodiscard]]
+	const symbol_index_t& symbol_index(const size_t threads = 0) const {
+		return _symbol_index.get([this, threads]() { return build_symbol_index(threads); });
+	}
+
+	/*
+		Sections in `segment` by index, as readelf's section to segment
+		mapping has them. The mapping is worked out both ways on first use.
+	*/
+	[[nodiscard]]
+	span<const uint32_t> segment_sections(const size_t segment) const {
+		const auto& map = _segment_map.get([this]() { return build_segment_map(); });
+		if(segment >= _pheaders.size())
+			return {};
+		return {map.sections.data() + map.segment_rows[segment],
+			size_t(map.segment_rows[segment + 1U] - map.segment_rows[segment])};
+	}
+
+	/* Segments `section` is in by index, empty if it isn't in any */
+	[[nodiscard]]
+	span<const uint32_t> section_segments(const size_t section) const {
+		const auto& map = _segment_map.get([this]() { return build_segment_map(); });
+		if(section >= _sheaders.size())
+			return {};
+		return {map.segments.data() + map.section_rows[section],
+			size_t(map.section_rows[section + 1U] - map.section_rows[section])};
+	}
+
+	/* The notes in `segment`, empty if it isn't PT_NOTE/PT_GNU_PROPERTY or runs off the end of the file */
+	[[nodiscard]]
+	elf_notes_t segment_notes(const size_t segment) const noexcept {
+		if(segment >= _pheaders.size())
+			return {};
+		const phdr_t& phdr{_pheaders[segment]};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if((phdr.type() != elf_phdr_type_t::Note && phdr.type() != elf_phdr_type_t::GNUProperty) ||
+			phdr.offset() > file_len || phdr.filesz() > (file_len - phdr.offset()))
+			return {};
+		return {{_file_map.address<uint8_t>() + phdr.offset(), size_t(phdr.filesz())}, size_t(phdr.align())};
+	}
+
+	/* The notes in `section`, empty if it isn't an uncompressed SHT_NOTE inside of the file */
+	[[nodiscard]]
+	elf_notes_t section_notes(const size_t section) const noexcept {
+		if(section >= _sheaders.size())
+			return {};
+		const shdr_t& shdr{_sheaders[section]};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if(shdr.type() != elf_shtype_t::Note || (shdr.flags() & shflags_t::Compressed) == shflags_t::Compressed ||
+			shdr.offset() > file_len || shdr.size() > (file_len - shdr.offset()))
+			return {};
+		return {{_file_map.address<uint8_t>() + shdr.offset(), size_t(shdr.size())}, size_t(shdr.addraline())};
+	}
+
+	/*
+		The first note of `type` from `name`, looking through the PT_NOTE
+		segments before the SHT_NOTE sections so a linked object only has
+		its program headers and note pages touched.
+	*/
+	[[nodiscard]]
+	bool find_note(const uint32_t type, const std::string_view name, elf_note_t& note) const noexcept {
+		for(size_t segment{}; segment < _pheaders.size(); ++segment) {
+			if(_pheaders[segment].type() == elf_phdr_type_t::Note && segment_notes(segment).find(type, name, note))
+				return true;
+		}
+		for(size_t section{1}; section < _sheaders.size(); ++section) {
+			if(section_notes(section).find(type, name, note))
+				return true;
+		}
+		return false;
+	}
+
+	/* NT_GNU_BUILD_ID's descriptor, empty if there isn't one */
+	[[nodiscard]]
+	span<const uint8_t> build_id() const noexcept {
+		elf_note_t note{};
+		if(!find_note(uint32_t(elf_note_type_t::GNUBuildID), "GNU", note))
+			return {};
+		return note.desc;
+	}
+
+	/* NT_GNU_PROPERTY_TYPE_0, from PT_GNU_PROPERTY when there is one as that's what the loader uses */
+	[[nodiscard]]
+	std::vector<elf_gnu_property_t> gnu_properties() const {
+		constexpr auto property_note = uint32_t(elf_note_type_t::GNUPropertyType);
+		elf_note_t note{};
+		bool found{false};
+		for(size_t segment{}; segment < _pheaders.size() && !found; ++segment) {
+			if(_pheaders[segment].type() == elf_phdr_type_t::GNUProperty)
+				found = segment_notes(segment).find(property_note, "GNU", note);
+		}
+		if(!found && !find_note(property_note, "GNU", note))
+			return {};
+		return decode_gnu_properties(note.desc, sizeof(typename T::addr_t));
+	}
+
+	/* NT_GNU_ABI_TAG, false if there isn't one */
+	[[nodiscard]]
+	bool abi_tag(elf_abi_tag_t& tag) const noexcept {
+		elf_note_t note{};
+		return find_note(uint32_t(elf_note_type_t::GNUABI), "GNU", note) && decode_abi_tag(note.desc, tag);
+	}
+
+	/* Every CIE and FDE in .eh_frame, parsed on first use */
+	[[nodiscard]]
+	const elf_eh_frame_t& eh_frame() const {
+		return _eh_frame.get([this]() { return build_eh_frame(); });
+	}
+
+	/* PT_GNU_EH_FRAME, or the .eh_frame_hdr section, false if there's neither or it's malformed */
+	[[nodiscard]]
+	bool eh_frame_hdr(elf_eh_frame_hdr_t& hdr) const {
+		constexpr size_t word_size{sizeof(typename T::addr_t)};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		for(size_t segment{}; segment < _pheaders.size(); ++segment) {
+			const phdr_t& phdr{_pheaders[segment]};
+			if(phdr.type() != elf_phdr_type_t::GNUEHFrame || phdr.offset() > file_len ||
+				phdr.filesz() > (file_len - phdr.offset()))
+				continue;
+			return parse_eh_frame_hdr({_file_map.address<uint8_t>() + phdr.offset(), size_t(phdr.filesz())},
+				uint64_t(phdr.vaddr()), word_size, hdr);
+		}
+
+		const size_t section{find_section(".eh_frame_hdr")};
+		if(section == 0)
+			return false;
+		return parse_eh_frame_hdr(section_data(section).raw(), uint64_t(_sheaders[section].addr()), word_size, hdr);
+	}
+
+	/*
+		The FDE covering `pc`. If there's an .eh_frame_hdr search table it's
+		used to find the one FDE to decode, the way the unwinder does it, so
+		nothing is allocated. Otherwise all of .eh_frame is parsed and kept
+		for later lookups.
+	*/
+	[[nodiscard]]
+	bool find_fde(const uint64_t pc, elf_eh_fde_t& fde) const {
+		elf_eh_frame_hdr_t hdr{};
+		if(eh_frame_hdr(hdr) && hdr.count != 0) {
+			uint64_t fde_address{};
+			uint64_t address{};
+			if(!hdr.find(pc, fde_address))
+				return false;
+			const auto data = eh_frame_data(address);
+			return fde_address >= address &&
+				decode_eh_fde(data, address, fde_address - address, sizeof(typename T::addr_t), fde) &&
+				fde.contains(pc);
+		}
+
+		const elf_eh_fde_t* entry{eh_frame().find(pc)};
+		if(entry == nullptr)
+			return false;
+		fde = *entry;
+		return true;
+	}
+
+	/*
+		Regenerates .eh_frame_hdr from .eh_frame with build_eh_frame_hdr(),
+		for when .eh_frame has been spliced into or either has moved. The
+		replacement is empty if there's no .eh_frame_hdr section or the table
+		can't be encoded, it will only be the same size as the old one if
+		the number of FDEs hasn't changed.
+	*/
+	[[nodiscard]]
+	section_rewrite_t rebuild_eh_frame_hdr() const {
+		const size_t section{find_section(".eh_frame_hdr")};
+		const size_t frame{find_section(".eh_frame")};
+		if(section == 0 || frame == 0)
+			return {};
+		const shdr_t& shdr{_sheaders[section]};
+		return {section, std::string{section_name_view(shdr)}, shdr.flags(),
+			build_eh_frame_hdr(eh_frame(), uint64_t(_sheaders[frame].addr()), uint64_t(shdr.addr()))};
+	}
+
+	/*
+		Address to file:line lookup from .debug_aranges and .debug_line,
+		compressed or not. Line programs are decoded as addresses land in
+		them with at most `cache_limit` bytes of decoded rows kept around,
+		later calls ignore `cache_limit`. For relocatable objects the
+		addresses are whatever the unrelocated line programs say.
+	*/
+	[[nodiscard]]
+	const dwarf_line_index_t& line_index(const size_t cache_limit = dwarf_line_index_t::default_cache_limit) const {
+		return _debug_lines.get([this, cache_limit]() { return build_debug_lines(cache_limit); }).index;
+	}
+
+	[[nodiscard]]
+	bool find_line(const uint64_t address, dwarf_line_t& line) const { return line_index().find(address, line); }
+
+	/* `results` must have room for `count` entries, those without a line are left empty */
+	void find_lines(const uint64_t* addresses, const size_t count, dwarf_line_t* results) const {
+		line_index().find(addresses, count, results);
+	}
+
+	/*
+		.dynamic up to DT_NULL, empty if there isn't one. The entries are
+		indexed by tag on first use so none of the lookups below walk it.
+	*/
+	[[nodiscard]]
+	span<const dyn_t> dynamic_entries() const { return dynamic_index().entries; }
+
+	[[nodiscard]]
+	size_t dynamic_count(const dyn_tag_t tag) const {
+		const auto range = dynamic_range(tag);
+		return range.second - range.first;
+	}
+
+	/* d_val of the `nth` entry with `tag`, false if there aren't that many */
+	[[nodiscard]]
+	bool dynamic_value(const dyn_tag_t tag, uint64_t& value, const size_t nth = 0) const {
+		const auto range = dynamic_range(tag);
+		if(nth >= size_t(range.second - range.first))
+			return false;
+		const auto& index = dynamic_index();
+		value = uint64_t(index.entries[index.order[range.first + nth]].value());
+		return true;
+	}
+
+	/* The string at `offset` in DT_STRTAB, empty if it's outside of it */
+	[[nodiscard]]
+	std::string_view dynamic_string_at(const uint64_t offset) const {
+		return string_at(dynamic_index().strtab, offset);
+	}
+
+	/* The string the `nth` entry with `tag` refers to, i.e. DT_SONAME or DT_RUNPATH */
+	[[nodiscard]]
+	std::string_view dynamic_string(const dyn_tag_t tag, const size_t nth = 0) const {
+		uint64_t offset{};
+		if(!dynamic_value(tag, offset, nth))
+			return {};
+		return dynamic_string_at(offset);
+	}
+
+	/* Every string for `tag` in the order they're in .dynamic */
+	[[nodiscard]]
+	std::vector<std::string_view> dynamic_strings(const dyn_tag_t tag) const {
+		std::vector<std::string_view> strings(dynamic_count(tag));
+		for(size_t idx{}; idx < strings.size(); ++idx)
+			strings[idx] = dynamic_string(tag, idx);
+		return strings;
+	}
+
+	/* DT_NEEDED */
+	[[nodiscard]]
+	std::vector<std::string_view> needed() const { return dynamic_strings(dyn_tag_t::Needed); }
+
+	/* The .dynsym that .gnu.version covers, 0 if the object isn't versioned */
+	[[nodiscard]]
+	size_t versioned_symbol_table() const {
+		return _version_index.get([this]() { return build_version_index(); }).symtab;
+	}
+
+	/*
+		Version of symbol `index` in versioned_symbol_table(), resolved
+		through a table of every version the object defines or needs that's
+		built on first use. Local (0) and global (1) symbols have no name.
+	*/
+	[[nodiscard]]
+	elf_symbol_version_t symbol_version(const size_t index) const {
+		const auto& versions = _version_index.get([this]() { return build_version_index(); });
+		if(index >= versions.versym.size())
+			return {};
+		const uint16_t versym{versions.versym[index]};
+		elf_symbol_version_t version{{}, {}, uint16_t(versym & ~version_hidden), (versym & version_hidden) != 0, false};
+		if(version.index < versions.versions.size()) {
+			const auto& entry = versions.versions[version.index];
+			version.name = entry.name;
+			version.file = entry.file;
+			version.weak = entry.weak;
+		}
+		return version;
+	}
+
+	/*
+		Virtual address <-> file offset translation, built on first use. The
+		lookups return address_index_t::npos for anything that isn't backed
+		by the file, zero fill included.
+	*/
+	[[nodiscard]]
+	const address_index_t& address_index() const {
+		return _address_index.get([this]() { return build_address_index(); });
+	}
+
+	[[nodiscard]]
+	uint64_t vaddr_to_offset(const uint64_t address) const { return address_index().to_offset(address); }
+	[[nodiscard]]
+	uint64_t offset_to_vaddr(const uint64_t offset) const { return address_index().to_address(offset); }
+
+	/* `results` must have room for `count` entries */
+	void vaddr_to_offset(const uint64_t* addresses, const size_t count, uint64_t* results) const {
+		address_index().to_offsets(addresses, count, results);
+	}
+	void offset_to_vaddr(const uint64_t* offsets, const size_t count, uint64_t* results) const {
+		address_index().to_addresses(offsets, count, results);
+	}
+
+	/*
+		`len` bytes at `address` straight out of the mapped file, empty if
+		any of them are zero fill, unmapped, or past the end of the file.
+	*/
+	[[nodiscard]]
+	span<const uint8_t> vaddr_view(const uint64_t address, const size_t len) const {
+		const auto& index = address_index();
+		const uint64_t offset{index.to_offset(address)};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if(offset == address_index_t::npos || index.file_extent(address) < len ||
+			offset > file_len || len > (file_len - offset))
+			return {};
+		return {_file_map.address<uint8_t>() + offset, len};
+	}
+
+	/* The symbol whose extent covers `address`, nullptr if there isn't one */
+	[[nodiscard]]
+	const symbol_entry_t* find_symbol(const uint64_t address) const {
+		return symbol_index().find(address);
+	}
+
+	/* The .dynsym covered by .gnu.hash or .hash, 0 if there's no usable hash table */
+	[[nodiscard]]
+	size_t dynamic_symbol_table() const { return symbol_hash().symtab; }
+
+	/*
+		Resolves a dynamic symbol definition by name the same way ld.so does,
+		with .gnu.hash (bloom filter, bucket, then the chain until the entry
+		with the low bit set) if it's there, or the .hash chains otherwise.
+		Returns the index into dynamic_symbol_table(), 0 (STN_UNDEF) if the
+		object doesn't define it.
+	*/
+	[[nodiscard]]
+	size_t find_dynamic_symbol(const std::string_view name) const {
+		const auto& hash = symbol_hash();
+		if(hash.symtab == 0)
+			return 0;
+		const auto symbols = symbol_table(hash.symtab);
+		const size_t strtab{_sheaders[hash.symtab].link()};
+
+		if(hash.gnu) {
+			const uint32_t h1{gnu_hash(name)};
+			const bloom_word_t word{hash.bloom[(h1 / bloom_bits) & (hash.bloom.size() - 1U)]};
+			const bloom_word_t mask{(bloom_word_t{1} << (h1 % bloom_bits)) |
+				(bloom_word_t{1} << ((h1 >> (hash.bloom_shift % 32U)) % bloom_bits))};
+			if((word & mask) != mask)
+				return 0;
+
+			uint32_t index{hash.buckets[h1 % hash.buckets.size()]};
+			if(index < hash.symoffset)
+				return 0;
+			for(; size_t(index - hash.symoffset) < hash.chains.size(); ++index) {
+				const uint32_t h2{hash.chains[index - hash.symoffset]};
+				if(((h1 ^ h2) >> 1U) == 0 && dynamic_match(symbols, strtab, index, name))
+					return index;
+				if((h2 & 1U) != 0)
+					break;
+			}
+			return 0;
+		}
+
+		/* Bounded by the chain length, so a looping chain can't hang us */
+		uint32_t index{hash.buckets[elf_hash(name) % hash.buckets.size()]};
+		for(size_t steps{}; index != 0 && index < hash.chains.size() && steps < hash.chains.size(); ++steps) {
+			if(dynamic_match(symbols, strtab, index, name))
+				return index;
+			index = hash.chains[index];
+		}
+		return 0;
+	}
+
+	/* Rewritten sections and, for each new .dynsym slot, the index the symbol used to have */
+	struct hash_rewrite_t final {
+		std::vector<uint32_t> order;
+		std::vector<section_rewrite_t> sections;
+	};
+
+	/*
+		Regenerates .gnu.hash and .hash for the dynamic symbol table with
+		build_hash_tables(), the global definitions past sh_info being the
+		ones that go into .gnu.hash. .dynsym and .gnu.version are reordered
+		to match. Only sections that are already there get rewritten, anything
+		else that refers to .dynsym by index (i.e. relocations) needs to be
+		remapped through `order`.
+	*/
+	[[nodiscard]]
+	hash_rewrite_t rebuild_symbol_hash(const double false_positive_rate = default_hash_false_positive,
+		const size_t threads = 0) const {
+
+		hash_rewrite_t rewrite{};
+		size_t dynsym{dynamic_symbol_table()};
+		if(dynsym == 0) {
+			const auto tables = find_sections_of_type(elf_shtype_t::DynamicSymbols);
+			if(tables.empty())
+				return rewrite;
+			dynsym = tables.front();
+		}
+		const shdr_t& shdr{_sheaders[dynsym]};
+		const auto symbols = symbol_table(dynsym);
+		const auto strtab_view = section_data(shdr.link());
+		const auto strtab = strtab_view.data();
+
+		std::vector<uint32_t> names(symbols.size());
+		std::vector<uint8_t> hashed(symbols.size());
+		for(size_t idx{}; idx < symbols.size(); ++idx) {
+			names[idx] = uint32_t(symbols[idx].name());
+			hashed[idx] = uint8_t(idx >= shdr.info() && symbols[idx].shndx() != 0);
+		}
+		auto tables = build_hash_tables(reinterpret_cast<const char*>(strtab.data()), strtab.size(), // lgtm[cpp/reinterpret-cast]
+			names.data(), hashed.data(), names.size(), sizeof(bloom_word_t), false_positive_rate, threads);
+		if(tables.order.size() != symbols.size())
+			return rewrite;
+
+		const auto permuted = [&](const size_t index, const void* entries, const size_t entry_len) {
+			section_rewrite_t section{index, std::string{section_name_view(_sheaders[index])},
+				_sheaders[index].flags(), std::vector<uint8_t>(tables.order.size() * entry_len)};
+			for(size_t idx{}; idx < tables.order.size(); ++idx)
+				std::memcpy(section.contents.data() + (idx * entry_len),
+					static_cast<const uint8_t*>(entries) + (tables.order[idx] * entry_len), entry_len);
+			return section;
+		};
+		rewrite.sections.push_back(permuted(dynsym, symbols.data(), sizeof(symbol_t)));
+
+		for(size_t index{}; index < _sheaders.size(); ++index) {
+			const shdr_t& section{_sheaders[index]};
+			if(section.link() != dynsym)
+				continue;
+			if(section.type() == elf_shtype_t::GNUVerSym) {
+				const auto view = section_data(index);
+				const auto versym = view.data();
+				if(versym.size() >= symbols.size() * sizeof(uint16_t))
+					rewrite.sections.push_back(permuted(index, versym.data(), sizeof(uint16_t)));
+			} else if(section.type() == elf_shtype_t::GNUHash) {
+				rewrite.sections.push_back({index, std::string{section_name_view(section)}, section.flags(),
+					std::move(tables.gnu_hash)});
+			} else if(section.type() == elf_shtype_t::HashTable) {
+				rewrite.sections.push_back({index, std::string{section_name_view(section)}, section.flags(),
+					std::move(tables.sysv_hash)});
+			}
+		}
+		rewrite.order = std::move(tables.order);
+		return rewrite;
+	}
+
+	/* The .symtab_shndx extending the symbol table at `symtab`, if there is one */
+	[[nodiscard]]
+	span<const uint32_t> shndx_table(const size_t symtab) const noexcept {
+		const auto table = _shndx_tables.find(symtab);
+		if(table == _shndx_tables.end())
+			return {};
+		return table->second;
+	}
+
+	/*
+		Section index of the `symbol`th entry in the symbol table at `symtab`,
+		following SHN_XINDEX into the matching .symtab_shndx. The other reserved
+		indices (SHN_ABS, SHN_COMMON, etc) are returned as-is, as is SHN_XINDEX
+		if there is no entry for the symbol.
+	*/
+	[[nodiscard]]
+	size_t symbol_section(const size_t symtab, const size_t symbol, const symbol_t& sym) const noexcept {
+		if(sym.shndx() != uint16_t(elf_shns_t::XIndex))
+			return sym.shndx();
+
+		const auto table = shndx_table(symtab);
+		if(symbol >= table.size())
+			return size_t(elf_shns_t::XIndex);
+		return table[symbol];
+	}
+
 	std::string section_name(const size_t index) const noexcept { return std::string(_strtbl + index); }
 
+	/*
+		Index of the first section called `name`, 0 (SHN_UNDEF) if there isn't
+		one. The name index is built over the section headers on first use.
+	*/
+	[[nodiscard]]
+	size_t find_section(const std::string_view name) const {
+		const auto& index = _section_index.get([this]() { return build_section_index(); });
+		const auto section = index.by_name.find(name);
+		if(section == index.by_name.end())
+			return 0;
+		return section->second;
+	}
+
+	/*
+		Writes the section name index, symbol_index(), and address_index() to
+		a sidecar next to the file, or in `cache_dir`, for open_sidecar() to
+		map on later runs instead of parsing the object again. Building the
+		symbol index runs across `threads` workers as symbol_index() does.
+	*/
+	[[nodiscard]]
+	bool save_sidecar(const fs::path& cache_dir = {}, const size_t threads = 0) const {
+		sidecar_key_t key{};
+		if(!sidecar_key_t::of(_file, build_id(), key))
+			return false;
+		const auto& index = _section_index.get([this]() { return build_section_index(); });
+		return write_sidecar(sidecar_path(_file, key, cache_dir), key, index.sorted, symbol_index(threads),
+			address_index());
+	}
+
+	/* Every section whose name starts with `prefix` (i.e. ".text."), in section order */
+	[[nodiscard]]
+	std::vector<size_t> find_sections(const std::string_view prefix) const {
+		const auto& index = _section_index.get([this]() { return build_section_index(); });
+		std::vector<size_t> sections{};
+		auto entry = std::lower_bound(index.sorted.begin(), index.sorted.end(),
+			std::make_pair(prefix, size_t{}));
+		for(; entry != index.sorted.end() && entry->first.substr(0, prefix.size()) == prefix; ++entry)
+			sections.push_back(entry->second);
+		std::sort(sections.begin(), sections.end());
+		return sections;
+	}
+
+	/*
+		Contents of the section at `index`, if it's SHF_COMPRESSED nothing is
+		inflated until the views data() is called, after which the result is
+		kept in the section cache until it's evicted.
+	*/
+	[[nodiscard]]
+	elf_section_view_t section_data(const size_t index) const noexcept {
+		if(index >= _sheaders.size())
+			return {};
+
+		const shdr_t& shdr{_sheaders[index]};
+		const uint64_t file_len = uint64_t(_file_map.length());
+		if(shdr.type() == elf_shtype_t::NoBits || shdr.offset() > file_len ||
+			shdr.size() > (file_len - shdr.offset()))
+			return {};
+
+		const uint8_t* raw{_file_map.address<uint8_t>() + shdr.offset()};
+		if((shdr.flags() & T::shflags_t::Compressed) != T::shflags_t::Compressed) {
+			uint64_t size{};
+			if(gnu_compressed_name(shdr) && zlib_t::read_gnu_header(raw, shdr.size(), size)) {
+				return {
+					{raw + zlib_t::gnu_header_size, shdr.size() - zlib_t::gnu_header_size},
+					elf_chdr_type_t::Zlib, size, shdr.addraline(), index, &_section_cache, true
+				};
+			}
+			return {{raw, shdr.size()}, shdr.addraline()};
+		}
+
+		if(shdr.size() < sizeof(chdr_t))
+			return {};
+
+		chdr_t chdr{};
+		std::memcpy(&chdr, raw, sizeof(chdr_t));
+		return {
+			{raw + sizeof(chdr_t), shdr.size() - sizeof(chdr_t)},
+			chdr.type(), chdr.size(), chdr.addr_align(), index, &_section_cache
+		};
+	}
+
+	/*
+		Builds the on-disk contents of an SHF_COMPRESSED section, that being
+		the chdr_t followed by the compressed data. An empty buffer is returned
+		if the codec isn't available or compression fails.
+	*/
+	[[nodiscard]]
+	static std::vector<uint8_t> compress_section(const span<const uint8_t> contents,
+		const elf_chdr_type_t type, const uint64_t addr_align, const int32_t level) {
+
+		const codec_t* codec{get_codec(elf_chdr_codec(type))};
+		if(codec == nullptr)
+			return {};
+
+		auto payload = codec->compress(contents.data(), contents.size(), level);
+		if(payload.empty())
+			return {};
+
+		chdr_t chdr{};
+		chdr.type(type);
+		chdr.size(typename T::xword_t(contents.size()));
+		chdr.addr_align(typename T::xword_t(addr_align));
+
+		std::vector<uint8_t> section(sizeof(chdr_t) + payload.size());
+		std::memcpy(section.data(), &chdr, sizeof(chdr_t));
+		std::memcpy(section.data() + sizeof(chdr_t), payload.data(), payload.size());
+		return section;
+	}
+
+	[[nodiscard]]
+	static std::vector<uint8_t> compress_section(const span<const uint8_t> contents,
+		const elf_chdr_type_t type, const uint64_t addr_align) {
+
+		const codec_t* codec{get_codec(elf_chdr_codec(type))};
+		if(codec == nullptr)
+			return {};
+		return compress_section(contents, type, addr_align, codec->default_level());
+	}
+
+	/*
+		Same as above but lets the policy pick the codec and level, if it
+		decides the contents aren't worth compressing an empty buffer is
+		returned and the section should be written out as-is.
+	*/
+	[[nodiscard]]
+	static std::vector<uint8_t> compress_section(const span<const uint8_t> contents,
+		const uint64_t addr_align, const compression_policy_t& policy) {
+
+		const auto choice = policy.choose(contents.data(), contents.size());
+		if(choice.codec == codec_type_t::None)
+			return {};
+
+		auto section = compress_section(contents, elf_codec_chdr(choice.codec), addr_align, choice.level);
+		/* The trial was only a sample, the real thing still has to earn its keep */
+		if(section.size() >= contents.size())
+			return {};
+		return section;
+	}
+
+	/*
+		Converts compressed debug sections between the legacy GNU .zdebug_*
+		framing and SHF_COMPRESSED. Both wrap a plain zlib stream so in most
+		cases only the header is swapped, zstd sections going to .zdebug_*
+		have to be recompressed, which is why this runs across `threads`
+		workers (0 for one per core). Sections already in the target style,
+		or that can't be converted, are skipped.
+	*/
+	[[nodiscard]]
+	std::vector<section_rewrite_t> convert_compressed_sections(const compression_style_t style,
+		const size_t threads = 0) const {
+
+		std::vector<size_t> candidates{};
+		for(size_t index{}; index < _sheaders.size(); ++index) {
+			const shdr_t& shdr{_sheaders[index]};
+			const bool chdr{(shdr.flags() & shflags_t::Compressed) == shflags_t::Compressed};
+			if(style == compression_style_t::Chdr && !chdr && gnu_compressed_name(shdr))
+				candidates.push_back(index);
+			else if(style == compression_style_t::GNU && chdr &&
+				section_name_starts_with(shdr, debug_prefix, sizeof(debug_prefix) - 1))
+				candidates.push_back(index);
+		}
+
+		std::vector<section_rewrite_t> rewrites(candidates.size());
+		parallel_for(candidates.size(), [&](const size_t idx) {
+			rewrites[idx] = convert_compressed_section(candidates[idx], style);
+		}, threads);
+
+		rewrites.erase(std::remove_if(rewrites.begin(), rewrites.end(),
+			[](const section_rewrite_t& rewrite) { return rewrite.contents.empty(); }), rewrites.end());
+		return rewrites;
+	}
+
+	[[nodiscard]]
+	section_rewrite_t convert_compressed_section(const size_t index, const compression_style_t style) const {
+		const auto view = section_data(index);
+		if(!view.compressed())
+			return {};
+
+		const shdr_t& shdr{_sheaders[index]};
+		const bool named{(style == compression_style_t::Chdr) ? gnu_compressed_name(shdr) :
+			section_name_starts_with(shdr, debug_prefix, sizeof(debug_prefix) - 1)};
+		if(!named)
+			return {};
+
+		const std::string name{section_name_view(shdr)};
+		section_rewrite_t rewrite{index, {}, shdr.flags(), {}};
+
+		if(style == compression_style_t::Chdr) {
+			if(!view.legacy())
+				return {};
+
+			chdr_t chdr{};
+			chdr.type(elf_chdr_type_t::Zlib);
+			chdr.size(typename T::xword_t(view.size()));
+			chdr.addr_align(typename T::xword_t(view.addr_align()));
+
+			rewrite.name = debug_prefix + name.substr(sizeof(gnu_debug_prefix) - 1);
+			rewrite.flags |= shflags_t::Compressed;
+			rewrite.contents.resize(sizeof(chdr_t) + view.raw().size());
+			std::memcpy(rewrite.contents.data(), &chdr, sizeof(chdr_t));
+			std::memcpy(rewrite.contents.data() + sizeof(chdr_t), view.raw().data(), view.raw().size());
+			return rewrite;
+		}
+
+		if(view.legacy())
+			return {};
+
+		std::vector<uint8_t> recompressed{};
+		span<const uint8_t> payload{view.raw()};
+		if(view.compression() != elf_chdr_type_t::Zlib) {
+			const auto contents = view.data();
+			if(contents.size() != view.size())
+				return {};
+			recompressed = zlib_t::deflate_buffer(contents.data(), contents.size());
+			if(recompressed.empty())
+				return {};
+			payload = {recompressed.data(), recompressed.size()};
+		}
+
+		rewrite.name = gnu_debug_prefix + name.substr(sizeof(debug_prefix) - 1);
+		rewrite.flags &= ~shflags_t::Compressed;
+		rewrite.contents.resize(zlib_t::gnu_header_size + payload.size());
+		zlib_t::write_gnu_header(rewrite.contents.data(), view.size());
+		std::memcpy(rewrite.contents.data() + zlib_t::gnu_header_size, payload.data(), payload.size());
+		return rewrite;
+	}
+
+	/* Upper bound in bytes on how much inflated section data is retained */
+	void section_cache_limit(const size_t limit) noexcept { _section_cache.capacity(limit); }
+	[[nodiscard]]
+	size_t section_cache_limit() const noexcept { return _section_cache.capacity(); }
+	[[nodiscard]]
+	const elf_section_view_t::cache_t& section_cache() const noexcept { return _section_cache; }
 };
 using elf32_t = elf_t<elf_types_32_t>;
 using elf64_t = elf_t<elf_types_64_t>;
 
-uint32_t elf_hash(const uint8_t* name);
+/* The byte order elf_t reads its fields in */
+constexpr static const elf_data_t elf_host_data{
+	(__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__) ? elf_data_t::MSB : elf_data_t::LSB
+};
+
+/*
+	Whichever of elf32_t or elf64_t an object turned out to be. Code written
+	against elf_t<T> is stamped out for both through visit_elf(), so after
+	the one branch on the identity nothing dispatches at runtime.
+*/
+using elf_any_t = std::variant<std::monostate, elf32_t, elf64_t>;
+
+/*
+	The class the identity of `file` says it is, None if it isn't ELF. The
+	headers are read as they lie, so objects of the other byte order are
+	None as well rather than being misread.
+*/
+[[nodiscard]]
+elf_class_t elf_class_of(const fs::path& file) noexcept;
+
+/* Opens `file` as the matching elf_t, false (leaving std::monostate) if neither fits */
+[[nodiscard]]
+bool open_elf(const fs::path& file, elf_any_t& elf);
+
+/* Calls `func` with the elf32_t or elf64_t held, false if there isn't one */
+template<typename F>
+bool visit_elf(elf_any_t& elf, F&& func) {
+	return std::visit([&func](auto& object) {
+		if constexpr (std::is_same_v<std::decay_t<decltype(object)>, std::monostate>)
+			return false;
+		else {
+			func(object);
+			return true;
+		}
+	}, elf);
+}
+
+template<typename F>
+bool visit_elf(const elf_any_t& elf, F&& func) {
+	return std::visit([&func](const auto& object) {
+		if constexpr (std::is_same_v<std::decay_t<decltype(object)>, std::monostate>)
+			return false;
+		else {
+			func(object);
+			return true;
+		}
+	}, elf);
+}
 
 
 #endif /* __SNS_ELF_HH__ */
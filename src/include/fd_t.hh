@@ -2,6 +2,8 @@
 #pragma once
 #if !defined(__SNS_FD_T_HH__)
 #define __SNS_FD_T_HH__
+#include <cerrno>
+
 #include <utility.hh>
 
 #include <mmap_t.hh>
@@ -85,6 +87,25 @@ public:
 		return actualLen == valueLen;
 	}
 
+	template<typename T> bool pread(T &value, const off_t offset) const noexcept
+		{ size_t actualLen; return pread(&value, sizeof(T), offset, actualLen); }
+
+	/* Reads at `offset` without touching the file position, only coming up short at the end of the file */
+	[[nodiscard]]
+	bool pread(void *const value, const size_t valueLen, const off_t offset, size_t &actualLen) const noexcept {
+		actualLen = 0;
+		while (actualLen < valueLen) {
+			const ssize_t result = ::pread(fd, static_cast<uint8_t *>(value) + actualLen, valueLen - actualLen,
+				offset + off_t(actualLen));
+			if (result < 0 && errno == EINTR)
+				continue;
+			if (result <= 0)
+				break;
+			actualLen += size_t(result);
+		}
+		return actualLen == valueLen;
+	}
+
 	ssize_t write(const void *const bufferPtr, const size_t len) const noexcept { return ::write(fd, bufferPtr, len); }
 	[[nodiscard]]
 	off_t seek(off_t offset, int32_t whence) const noexcept { return ::lseek(fd, offset, whence); }
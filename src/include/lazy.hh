@@ -0,0 +1,60 @@
+/* lazy.hh - Thread-safe build-on-first-use value */
+#pragma once
+#if !defined(__SNS_LAZY_HH__)
+#define __SNS_LAZY_HH__
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/*
+	Holds an index or table that is expensive to build and not always
+	needed. The first call to `get` runs the factory under the lock, every
+	call after that is a single acquire load.
+
+	References handed out stay valid until `reset` is called or the owner
+	is destroyed.
+*/
+template<typename T>
+struct lazy_t final {
+private:
+	mutable std::mutex _lock;
+	mutable std::unique_ptr<const T> _owner;
+	mutable std::atomic<const T*> _value;
+public:
+	lazy_t() noexcept : _lock{}, _owner{}, _value{nullptr} { /* NOP */ }
+
+	/* The lock is not moved, the new value gets its own */
+	lazy_t(lazy_t&& lazy) noexcept : lazy_t() {
+		std::lock_guard<std::mutex> guard{lazy._lock};
+		_owner = std::move(lazy._owner);
+		_value.store(lazy._value.exchange(nullptr));
+	}
+
+	lazy_t(const lazy_t&) = delete;
+	lazy_t& operator=(const lazy_t&) = delete;
+
+	template<typename F>
+	const T& get(F&& factory) const {
+		if(const T* value = _value.load(std::memory_order_acquire))
+			return *value;
+
+		std::lock_guard<std::mutex> guard{_lock};
+		if(!_owner) {
+			_owner = std::make_unique<const T>(factory());
+			_value.store(_owner.get(), std::memory_order_release);
+		}
+		return *_owner;
+	}
+
+	[[nodiscard]]
+	bool built() const noexcept { return _value.load(std::memory_order_acquire) != nullptr; }
+
+	void reset() noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		_value.store(nullptr);
+		_owner.reset();
+	}
+};
+
+#endif /* __SNS_LAZY_HH__ */
@@ -0,0 +1,165 @@
+/* lru_cache.hh - Byte bounded least-recently-used cache */
+#pragma once
+#if !defined(__SNS_LRU_CACHE_HH__)
+#define __SNS_LRU_CACHE_HH__
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <utility.hh>
+
+/* Default cost of a cached value, the number of bytes it's holding onto */
+template<typename V>
+struct lru_byte_cost_t final {
+	size_t operator()(const V& value) const noexcept {
+		return (value.size() * sizeof(typename V::value_type));
+	}
+};
+
+/*
+	Values are handed out as shared pointers so that anything which has
+	been evicted stays alive for as long as someone is still looking at it,
+	the cache only stops accounting for it.
+
+	All of the operations are guarded, but the value factory passed to
+	`get_or_insert` is run outside of the lock so that expensive entries
+	(like inflating a section) don't stall everyone else.
+*/
+template<typename K, typename V, typename C = lru_byte_cost_t<V>>
+struct lru_cache_t final {
+	using key_type   = K;
+	using value_type = V;
+	using value_ptr  = std::shared_ptr<const V>;
+private:
+	struct entry_t final {
+		value_ptr value;
+		size_t cost;
+		typename std::list<K>::iterator position;
+	};
+
+	mutable std::mutex _lock;
+	std::list<K> _order; /* Most recently used at the front */
+	std::unordered_map<K, entry_t> _entries;
+	size_t _capacity;
+	size_t _size;
+
+	void evict() noexcept {
+		while(_size > _capacity && !_order.empty()) {
+			auto entry = _entries.find(_order.back());
+			_size -= entry->second.cost;
+			_entries.erase(entry);
+			_order.pop_back();
+		}
+	}
+
+	void touch(entry_t& entry) noexcept {
+		_order.splice(_order.begin(), _order, entry.position);
+	}
+public:
+	lru_cache_t(const size_t capacity) noexcept :
+		_lock{}, _order{}, _entries{}, _capacity{capacity}, _size{} { /* NOP */ }
+
+	/* The lock is not moved, the new cache gets its own */
+	lru_cache_t(lru_cache_t&& cache) noexcept : lru_cache_t(0) {
+		std::lock_guard<std::mutex> guard{cache._lock};
+		_order = std::move(cache._order);
+		_entries = std::move(cache._entries);
+		_capacity = cache._capacity;
+		_size = std::exchange(cache._size, 0);
+	}
+
+	lru_cache_t(const lru_cache_t&) = delete;
+	lru_cache_t& operator=(const lru_cache_t&) = delete;
+
+	[[nodiscard]]
+	value_ptr find(const K& key) noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		auto entry = _entries.find(key);
+		if(entry == _entries.end())
+			return {};
+
+		touch(entry->second);
+		return entry->second.value;
+	}
+
+	/* If the key already exists the existing value wins and is returned */
+	value_ptr insert(const K& key, value_ptr value) {
+		const size_t cost{C{}(*value)};
+		std::lock_guard<std::mutex> guard{_lock};
+		auto entry = _entries.find(key);
+		if(entry != _entries.end()) {
+			touch(entry->second);
+			return entry->second.value;
+		}
+		/* Things that would blow the whole budget are never retained */
+		if(cost > _capacity)
+			return value;
+
+		_order.push_front(key);
+		_entries.emplace(key, entry_t{value, cost, _order.begin()});
+		_size += cost;
+		evict();
+		return value;
+	}
+
+	template<typename F>
+	value_ptr get_or_insert(const K& key, F&& factory) {
+		if(auto value = find(key))
+			return value;
+		return insert(key, std::make_shared<const V>(factory()));
+	}
+
+	bool erase(const K& key) noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		auto entry = _entries.find(key);
+		if(entry == _entries.end())
+			return false;
+
+		_size -= entry->second.cost;
+		_order.erase(entry->second.position);
+		_entries.erase(entry);
+		return true;
+	}
+
+	void clear() noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		_entries.clear();
+		_order.clear();
+		_size = 0;
+	}
+
+	void capacity(const size_t capacity) noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		_capacity = capacity;
+		evict();
+	}
+	[[nodiscard]]
+	size_t capacity() const noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		return _capacity;
+	}
+
+	/* Total cost of everything currently retained */
+	[[nodiscard]]
+	size_t size() const noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		return _size;
+	}
+
+	[[nodiscard]]
+	size_t count() const noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		return _entries.size();
+	}
+
+	[[nodiscard]]
+	bool contains(const K& key) const noexcept {
+		std::lock_guard<std::mutex> guard{_lock};
+		return _entries.find(key) != _entries.end();
+	}
+};
+
+#endif /* __SNS_LRU_CACHE_HH__ */
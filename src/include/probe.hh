@@ -0,0 +1,76 @@
+/* probe.hh - Object format identification from the headers alone */
+#pragma once
+#if !defined(__SNS_PROBE_HH__)
+#define __SNS_PROBE_HH__
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <fd_t.hh>
+#include <utility.hh>
+
+#if defined(CXXFS_EXP)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+enum class object_format_t : uint8_t {
+	Unknown  = 0x00U,
+	AOut     = 0x01U,
+	COFF     = 0x02U,
+	ECOFF    = 0x03U,
+	ELF      = 0x04U,
+	MachO    = 0x05U,
+	MachOFat = 0x06U,
+	OS360    = 0x07U,
+	PE       = 0x08U,
+	XCOFF    = 0x09U,
+};
+extern const std::array<const enum_pair_t<object_format_t>, 10> object_format_s;
+extern std::ostream& operator<<(std::ostream& out, const object_format_t& format);
+
+/* The first read, enough for the fixed headers of every format */
+constexpr size_t probe_header_len{4_KiB};
+/* Everything read for one file, program headers and notes included, stops here */
+constexpr size_t probe_read_limit{16_KiB};
+
+/* What can be told about a file without mapping it */
+struct probe_t final {
+	object_format_t format;
+	uint8_t bits;                  /* 32 or 64, 0 if the format doesn't say */
+	bool big_endian;
+	uint32_t machine;              /* e_machine, cputype, f_magic, etc. Format specific */
+	uint32_t type;                 /* e_type, filetype, or PE characteristics, 0 otherwise */
+	uint64_t file_size;
+	uint64_t bytes_read;
+	std::vector<uint8_t> build_id; /* NT_GNU_BUILD_ID or LC_UUID, empty if there isn't one */
+
+	probe_t() noexcept :
+		format{object_format_t::Unknown}, bits{}, big_endian{}, machine{}, type{},
+		file_size{}, bytes_read{}, build_id{} { /* NOP */ }
+
+	[[nodiscard]]
+	bool valid() const noexcept { return format != object_format_t::Unknown; }
+};
+
+/*
+	Identifies an object by its magic number and pulls out the class,
+	machine, and type from the headers with pread(). For ELF the program
+	headers are read and then only the PT_NOTE segments, for the build-id.
+	Nothing is mapped, and no more than probe_read_limit bytes are read.
+*/
+[[nodiscard]]
+probe_t probe_object(const fd_t& file);
+[[nodiscard]]
+probe_t probe_object(const fs::path& file);
+
+/* Probes every file across `threads` workers, 0 for one per core */
+[[nodiscard]]
+std::vector<probe_t> probe_objects(const std::vector<fs::path>& files, size_t threads = 0);
+
+#endif /* __SNS_PROBE_HH__ */
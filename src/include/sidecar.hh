@@ -0,0 +1,195 @@
+/* sidecar.hh - Persistent, mappable lookup indices for an object file */
+#pragma once
+#if !defined(__SNS_SIDECAR_HH__)
+#define __SNS_SIDECAR_HH__
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <address_index.hh>
+#include <fd_t.hh>
+#include <mmap_t.hh>
+#include <span.hh>
+#include <symbol_index.hh>
+
+#if defined(CXXFS_EXP)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+/*
+	What a sidecar belongs to. With a build-id that's all that's compared,
+	so copies of the same object share one, otherwise it has to be the very
+	same file, unchanged.
+*/
+struct sidecar_key_t final {
+	constexpr static const size_t max_build_id{64U};
+
+	std::vector<uint8_t> build_id;
+	uint64_t inode;
+	uint64_t size;
+	uint64_t mtime;   /* Nanoseconds since the epoch */
+
+	sidecar_key_t() noexcept : build_id{}, inode{}, size{}, mtime{} { /* NOP */ }
+
+	/* stat()s the file, and takes the build-id as given. False if the file isn't there */
+	[[nodiscard]]
+	static bool of(const fs::path& file, span<const uint8_t> build_id, sidecar_key_t& key) noexcept;
+	/* As above with the build-id from probe_object(), so nothing gets mapped */
+	[[nodiscard]]
+	static bool of(const fs::path& file, sidecar_key_t& key);
+
+	[[nodiscard]]
+	bool matches(const sidecar_key_t& key) const noexcept;
+};
+
+/*
+	Next to `file` as <file>.sns-index, or if `cache_dir` is given in there
+	named for the build-id (or the inode, size, and mtime if there isn't
+	one) so a read-only or shared tree can still have one.
+*/
+[[nodiscard]]
+fs::path sidecar_path(const fs::path& file, const sidecar_key_t& key, const fs::path& cache_dir = {});
+
+/* On disk layout, all of it host endian and naturally aligned */
+struct sidecar_table_t final {
+	uint64_t offset;  /* From the start of the sidecar */
+	uint64_t count;
+};
+
+struct sidecar_header_t final {
+	constexpr static const std::array<char, 8> magic_value{{'S', 'N', 'S', 'I', 'N', 'D', 'E', 'X'}};
+	constexpr static const uint32_t current_version{1U};
+	constexpr static const uint32_t byte_order_value{0x01020304U};
+
+	std::array<char, 8> magic;
+	uint32_t version;
+	uint32_t byte_order;  /* byte_order_value as the writer saw it */
+	uint64_t inode;
+	uint64_t size;
+	uint64_t mtime;
+	uint32_t build_id_len;
+	std::array<uint8_t, sidecar_key_t::max_build_id> build_id;
+	uint32_t reserved;
+	sidecar_table_t sections;
+	sidecar_table_t symbols;
+	sidecar_table_t ranges;
+	sidecar_table_t strings;
+};
+
+/* Section names sorted by name, for the first section with each */
+struct sidecar_section_t final {
+	uint32_t name;     /* Offset and length in the string table */
+	uint32_t name_len;
+	uint32_t index;
+};
+
+/* symbol_index_t's entries, sorted by address with aliases already collapsed */
+struct sidecar_symbol_t final {
+	constexpr static const uint32_t npos{symbol_index_t::npos};
+
+	uint64_t address;
+	uint64_t size;
+	uint32_t name;
+	uint32_t name_len;
+	uint32_t table;
+	uint32_t index;
+	uint32_t parent;   /* Closest enclosing sized symbol, or npos */
+	uint8_t binding;
+	uint8_t type;
+	uint16_t reserved;
+
+	[[nodiscard]]
+	bool contains(const uint64_t addr) const noexcept { return (addr - address) < size || addr == address; }
+};
+
+/* address_index_t's ranges, by address and not overlapping */
+struct sidecar_range_t final {
+	uint64_t address;
+	uint64_t offset;
+	uint64_t file_size;
+	uint64_t mem_size;
+	uint32_t index;
+	uint32_t reserved;
+};
+
+/*
+	Writes a sidecar to a temporary file next to `path` and renames it into
+	place, so readers only ever see a complete one. The file and then its
+	directory are synced, so that holds across a crash too. False if it
+	can't be written or synced, or the build-id is too long to key on.
+*/
+[[nodiscard]]
+bool write_sidecar(const fs::path& path, const sidecar_key_t& key,
+	const std::vector<std::pair<std::string_view, size_t>>& sections, const symbol_index_t& symbols,
+	const address_index_t& addresses);
+
+/*
+	A sidecar mapped read only. Everything is checked to be in bounds when
+	it's opened and the lookups work straight out of the mapping, so the
+	cost of opening one is the page faults for what's actually looked at.
+*/
+struct sidecar_t final {
+	constexpr static const uint64_t npos{address_index_t::npos};
+private:
+	mmap_t _map;
+	span<const sidecar_section_t> _sections;
+	span<const sidecar_symbol_t> _symbols;
+	span<const sidecar_range_t> _ranges;
+	std::string_view _strings;
+	bool _valid;
+
+	[[nodiscard]]
+	std::string_view string(uint32_t offset, uint32_t len) const noexcept;
+public:
+	sidecar_t() noexcept :
+		_map{}, _sections{}, _symbols{}, _ranges{}, _strings{}, _valid{false} { /* NOP */ }
+
+	/* Not valid() if it's missing, malformed, from a foreign host, or for anything other than `key` */
+	sidecar_t(const fs::path& path, const sidecar_key_t& key) noexcept;
+
+	[[nodiscard]]
+	bool valid() const noexcept { return _valid; }
+
+	/* Index of the first section called `name`, 0 if there isn't one */
+	[[nodiscard]]
+	size_t find_section(std::string_view name) const noexcept;
+
+	/* Same answer symbol_index_t::find() gives, nullptr if no symbol covers `address` */
+	[[nodiscard]]
+	const sidecar_symbol_t* find_symbol(uint64_t address) const noexcept;
+	[[nodiscard]]
+	std::string_view symbol_name(const sidecar_symbol_t& symbol) const noexcept {
+		return string(symbol.name, symbol.name_len);
+	}
+
+	/* npos if the address isn't backed by the file */
+	[[nodiscard]]
+	uint64_t to_offset(uint64_t address) const noexcept;
+
+	[[nodiscard]]
+	span<const sidecar_section_t> sections() const noexcept { return _sections; }
+	[[nodiscard]]
+	std::string_view section_name(const sidecar_section_t& section) const noexcept {
+		return string(section.name, section.name_len);
+	}
+	[[nodiscard]]
+	span<const sidecar_symbol_t> symbols() const noexcept { return _symbols; }
+	[[nodiscard]]
+	span<const sidecar_range_t> ranges() const noexcept { return _ranges; }
+};
+
+/*
+	Maps the sidecar for `file`, next to it or in `cache_dir`, keyed as
+	sidecar_key_t::of() does it. Not valid() if there isn't a current one.
+*/
+[[nodiscard]]
+sidecar_t open_sidecar(const fs::path& file, const fs::path& cache_dir = {});
+
+#endif /* __SNS_SIDECAR_HH__ */
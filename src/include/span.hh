@@ -8,8 +8,10 @@
 #pragma once
 #if !defined(__SNS_SPAN_HH__)
 #define __SNS_SPAN_HH__
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <stdexcept>
 
 constexpr size_t dynamic_extent = std::numeric_limits<size_t>::max();
 
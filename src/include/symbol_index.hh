@@ -0,0 +1,76 @@
+/* symbol_index.hh - Address to symbol lookup */
+#pragma once
+#if !defined(__SNS_SYMBOL_INDEX_HH__)
+#define __SNS_SYMBOL_INDEX_HH__
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+/* One symbol as far as the index cares, independent of the ELF class */
+struct symbol_entry_t final {
+	uint64_t address;
+	uint64_t size;
+	std::string_view name;
+	uint32_t table;   /* Section index of the symbol table it came from */
+	uint32_t index;   /* Index within that symbol table */
+	uint8_t binding;  /* elf_symbol_binding_t */
+	uint8_t type;     /* elf_symbol_type_t */
+
+	[[nodiscard]]
+	bool contains(const uint64_t addr) const noexcept {
+		/* Unsized symbols only cover their own address */
+		return (addr - address) < size || addr == address;
+	}
+};
+
+/*
+	Symbols sorted by address with aliases collapsed to a single entry, the
+	best name for an address being the sized, most visible, function-like
+	one. The start addresses are additionally kept in an Eytzinger (BFS)
+	layout so that the search touches one cache line per couple of levels
+	and the descent has no data dependent branches.
+
+	Symbols can nest (i.e. an unsized label inside of a function), so every
+	entry knows the closest sized symbol before it that covers its address,
+	which is where a lookup goes if the nearest symbol doesn't contain it.
+*/
+struct symbol_index_t final {
+	constexpr static const uint32_t npos{std::numeric_limits<uint32_t>::max()};
+private:
+	std::vector<symbol_entry_t> _symbols; /* Sorted by address, one per address */
+	std::vector<uint32_t> _parents;       /* Closest enclosing sized symbol, or npos */
+	std::vector<uint64_t> _layout;        /* Eytzinger ordered addresses, 1-based */
+	std::vector<uint32_t> _ranks;         /* Eytzinger position to sorted index */
+
+	void build_layout(size_t& next, size_t position) noexcept;
+	/* Turns where a search fell off the bottom of the tree into a symbol */
+	[[nodiscard]]
+	const symbol_entry_t* resolve(size_t position, uint64_t address) const noexcept;
+public:
+	symbol_index_t() noexcept :
+		_symbols{}, _parents{}, _layout{}, _ranks{} { /* NOP */ }
+
+	/* Sorting is split across `threads` workers, 0 for one per core */
+	explicit symbol_index_t(std::vector<symbol_entry_t> symbols, size_t threads = 0);
+
+	/* The symbol containing `address`, nullptr if there isn't one */
+	[[nodiscard]]
+	const symbol_entry_t* find(uint64_t address) const noexcept;
+
+	/* `results` must have room for `count` entries */
+	void find(const uint64_t* addresses, size_t count, const symbol_entry_t** results) const noexcept;
+
+	[[nodiscard]]
+	const std::vector<symbol_entry_t>& symbols() const noexcept { return _symbols; }
+	/* For each symbol, the closest sized symbol before it that covers its address, or npos */
+	[[nodiscard]]
+	const std::vector<uint32_t>& parents() const noexcept { return _parents; }
+	[[nodiscard]]
+	size_t size() const noexcept { return _symbols.size(); }
+	[[nodiscard]]
+	bool empty() const noexcept { return _symbols.empty(); }
+};
+
+#endif /* __SNS_SYMBOL_INDEX_HH__ */
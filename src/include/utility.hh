@@ -14,6 +14,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <fcntl.h>
 #include <iostream>
@@ -21,6 +22,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -286,6 +288,46 @@ uint16_t _sns_bswap16(const uint16_t x) noexcept;
 uint32_t _sns_bswap32(const uint32_t x) noexcept;
 uint64_t _sns_bswap64(const uint64_t x) noexcept;
 
+/*
+	DWARF style variable length integers out of `data`, advancing `pos`
+	past them. False if they run off the end or don't fit in 64 bits, in
+	which case `pos` is left where it was.
+*/
+bool read_uleb128(const uint8_t* data, size_t len, size_t& pos, uint64_t& value) noexcept;
+bool read_sleb128(const uint8_t* data, size_t len, size_t& pos, int64_t& value) noexcept;
+
+
+/*
+	Runs `func(index)` for every index in [0, count) spread across `threads`
+	workers (0 being one per core), indices are handed out dynamically so
+	uneven work still balances out. Small counts just run inline.
+*/
+template<typename F>
+void parallel_for(const size_t count, F&& func, size_t threads = 0) {
+	if(threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1U);
+	threads = std::min(threads, count);
+
+	if(threads <= 1) {
+		for(size_t idx{}; idx < count; ++idx)
+			func(idx);
+		return;
+	}
+
+	std::atomic<size_t> next{0};
+	auto worker = [&]() {
+		for(size_t idx{next++}; idx < count; idx = next++)
+			func(idx);
+	};
+
+	std::vector<std::thread> workers{};
+	workers.reserve(threads - 1);
+	for(size_t thread{1}; thread < threads; ++thread)
+		workers.emplace_back(worker);
+	worker();
+	for(auto& thread : workers)
+		thread.join();
+}
 
 /* Extract a collection of flags set in a field */
 /* This is kind of expensive run-time wise, being at leas O(n+1) but *shrug* */
@@ -0,0 +1,76 @@
+/* xref_index.hh - Who references what, inverted from relocations */
+#pragma once
+#if !defined(__SNS_XREF_INDEX_HH__)
+#define __SNS_XREF_INDEX_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <span.hh>
+
+/* Where a reference is made from, independent of the object format */
+struct xref_site_t final {
+	uint64_t offset;  /* As the relocation gives it, into `section` or an address */
+	uint32_t section; /* Section being relocated, 0 if there isn't one */
+	uint32_t source;  /* Relocation section it came from */
+	uint32_t type;    /* Relocation type */
+	uint32_t from;    /* Node the site lies within, xref_index_t::npos if none */
+};
+
+/* One reference to node `target` */
+struct xref_t final {
+	uint32_t target;
+	xref_site_t site;
+};
+
+/*
+	References inverted into CSR (compressed sparse row) form, nodes being
+	whatever the caller numbers its targets as. Every site referencing a
+	node is in one contiguous run, so finding them is two loads and the
+	answer is O(k) to walk. The distinct nodes each node references, from
+	the sites' `from`, are kept the same way for reachability.
+
+	Building is a counting sort, two passes over the references and no
+	comparisons. Sites keep the order they were given in within a node.
+*/
+struct xref_index_t final {
+	constexpr static const uint32_t npos{std::numeric_limits<uint32_t>::max()};
+private:
+	std::vector<uint32_t> _site_rows; /* _sites[_site_rows[n], _site_rows[n + 1]) reference node n */
+	std::vector<xref_site_t> _sites;
+	std::vector<uint32_t> _edge_rows; /* _edges[_edge_rows[n], _edge_rows[n + 1]) are referenced by n */
+	std::vector<uint32_t> _edges;
+public:
+	xref_index_t() noexcept :
+		_site_rows{}, _sites{}, _edge_rows{}, _edges{} { /* NOP */ }
+
+	/*
+		`references` is in chunks as they were collected (i.e. one per
+		relocation section) so they don't have to be concatenated first.
+		Targets past `nodes` are dropped, as are `from`s. Empty if there
+		are npos or more nodes or references.
+	*/
+	xref_index_t(size_t nodes, const std::vector<std::vector<xref_t>>& references);
+
+	/* Every site referencing `node` */
+	[[nodiscard]]
+	span<const xref_site_t> references(uint32_t node) const noexcept;
+	/* Every node `node` references, sorted and without duplicates */
+	[[nodiscard]]
+	span<const uint32_t> referenced(uint32_t node) const noexcept;
+
+	/* All nodes reachable from `roots` (themselves included) through referenced(), sorted */
+	[[nodiscard]]
+	std::vector<uint32_t> reachable(const std::vector<uint32_t>& roots) const;
+
+	[[nodiscard]]
+	size_t nodes() const noexcept { return _site_rows.empty() ? 0 : _site_rows.size() - 1U; }
+	[[nodiscard]]
+	size_t size() const noexcept { return _sites.size(); }
+	[[nodiscard]]
+	bool empty() const noexcept { return _sites.empty(); }
+};
+
+#endif /* __SNS_XREF_INDEX_HH__ */
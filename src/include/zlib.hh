@@ -6,7 +6,9 @@
 #include <zlib.h>
 #include <cstdint>
 
+#include <span.hh>
 #include <utility.hh>
+#include <zlib_backend.hh>
 #include <vector>
 
 
@@ -38,6 +40,17 @@ public:
 				_eos = (::deflateInit(&_stream, 9) != Z_OK);
 		}
 
+		~zlib_ctx_t() noexcept {
+			if(_mode == zlib_t::mode_t::Inflate)
+				::inflateEnd(&_stream);
+			else if(_mode == zlib_t::mode_t::Deflate)
+				::deflateEnd(&_stream);
+		}
+
+		/* z_stream keeps a back pointer to itself, so these can't be moved */
+		zlib_ctx_t(const zlib_ctx_t&) = delete;
+		zlib_ctx_t& operator=(const zlib_ctx_t&) = delete;
+
 		zlib_t::mode_t mode() const noexcept { return _mode; }
 
 		template<typename T>
@@ -64,6 +77,70 @@ public:
 		_zlib_inflate{zlib_t::mode_t::Inflate}
 	{ /* NOP */ }
 
+	/*
+		Whole buffer operations, used when both sizes are known up front
+		(i.e. from a sections chdr_t) so there is no need to stream. These go
+		through the configured backend, see zlib_backend.hh, where the
+		streaming interface is always plain zlib.
+	*/
+	[[nodiscard]]
+	static const char* backend() noexcept { return zlib_backend_t::name(); }
+
+	/* Inflates exactly `output_len` bytes, anything else is a failure */
+	[[nodiscard]]
+	static bool inflate_buffer(const uint8_t* input, size_t input_len,
+		uint8_t* output, size_t output_len) noexcept;
+
+	[[nodiscard]]
+	static std::vector<uint8_t> deflate_buffer(const uint8_t* input,
+		size_t input_len, int32_t level = Z_BEST_COMPRESSION);
+
+	/*
+		Preset dictionary variants, these always go through zlib itself as
+		not every backend supports them. The stream records the adler32 of
+		the dictionary it was compressed against, which is its ID.
+	*/
+	constexpr static const size_t max_dictionary{32_KiB};
+
+	[[nodiscard]]
+	static bool inflate_buffer(const uint8_t* input, size_t input_len, uint8_t* output,
+		size_t output_len, const uint8_t* dictionary, size_t dictionary_len) noexcept;
+
+	[[nodiscard]]
+	static std::vector<uint8_t> deflate_buffer(const uint8_t* input, size_t input_len,
+		const uint8_t* dictionary, size_t dictionary_len, int32_t level = Z_BEST_COMPRESSION);
+
+	/* ID of the dictionary a stream needs, 0 if it doesn't need one */
+	[[nodiscard]]
+	static uint32_t dictionary_id(const uint8_t* input, size_t input_len) noexcept;
+
+	/* Builds a dictionary of up to `capacity` bytes from content common to the samples */
+	[[nodiscard]]
+	static std::vector<uint8_t> train_dictionary(const std::vector<span<const uint8_t>>& samples,
+		size_t capacity = max_dictionary);
+
+	/* Running checksums, vectorised when the backend is */
+	[[nodiscard]]
+	static uint32_t adler32(const uint8_t* data, size_t len,
+		uint32_t adler = zlib_backend_t::adler32_seed) noexcept {
+		return zlib_backend_t::adler32(adler, data, len);
+	}
+	[[nodiscard]]
+	static uint32_t crc32(const uint8_t* data, size_t len,
+		uint32_t crc = zlib_backend_t::crc32_seed) noexcept {
+		return zlib_backend_t::crc32(crc, data, len);
+	}
+
+	/*
+		Legacy GNU .zdebug_* sections use their own framing rather than a
+		chdr_t, the magic "ZLIB" followed by the big-endian uncompressed
+		size, then the zlib stream itself.
+	*/
+	constexpr static const size_t gnu_header_size{12};
+
+	[[nodiscard]]
+	static bool read_gnu_header(const uint8_t* data, size_t len, uint64_t& size) noexcept;
+	static void write_gnu_header(uint8_t* data, uint64_t size) noexcept;
 
 	template<typename T>
 	T inflate(uint8_t* buff, size_t size) {
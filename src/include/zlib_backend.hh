@@ -0,0 +1,42 @@
+/* zlib_backend.hh - Whole buffer deflate backend selection */
+#pragma once
+#if !defined(__SNS_ZLIB_BACKEND_HH__)
+#define __SNS_ZLIB_BACKEND_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+	The one-shot operations are routed through whichever library meson was
+	told to use with `-Dzlib_backend=`, libdeflate or zlib-ng both being a
+	good deal quicker than streaming zlib when the sizes are known. Every
+	backend produces and consumes plain RFC 1950 zlib streams.
+
+	This deliberately doesn't pull in zlib.h, zlib-ng's native header refuses
+	to be included alongside it.
+*/
+struct zlib_backend_t final {
+	/* Initial values for a running checksum */
+	constexpr static const uint32_t adler32_seed{1U};
+	constexpr static const uint32_t crc32_seed{0U};
+
+	[[nodiscard]]
+	static const char* name() noexcept;
+
+	/* Inflates exactly `output_len` bytes, anything else is a failure */
+	[[nodiscard]]
+	static bool inflate(const uint8_t* input, size_t input_len,
+		uint8_t* output, size_t output_len) noexcept;
+
+	/* `level` is on zlib's scale, where -1 is the library default */
+	[[nodiscard]]
+	static std::vector<uint8_t> deflate(const uint8_t* input, size_t input_len, int32_t level);
+
+	[[nodiscard]]
+	static uint32_t adler32(uint32_t adler, const uint8_t* data, size_t len) noexcept;
+	[[nodiscard]]
+	static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t len) noexcept;
+};
+
+#endif /* __SNS_ZLIB_BACKEND_HH__ */
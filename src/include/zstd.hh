@@ -0,0 +1,69 @@
+/* zstd.hh - Zstandard whole buffer compression */
+#pragma once
+#if !defined(__SNS_ZSTD_HH__)
+#define __SNS_ZSTD_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include <span.hh>
+#include <utility.hh>
+
+#if defined(SNS_WITH_ZSTD)
+#include <zstd.h>
+
+struct zstd_t final {
+	/* Inputs smaller than this aren't worth handing off to worker threads */
+	constexpr static const uint64_t mt_threshold{4_MiB};
+
+	/* Inflates exactly `output_len` bytes, anything else is a failure */
+	[[nodiscard]]
+	static bool decompress_buffer(const uint8_t* input, size_t input_len,
+		uint8_t* output, size_t output_len) noexcept;
+
+	/* `workers` of 0 picks based on the input size and available cores */
+	[[nodiscard]]
+	static std::vector<uint8_t> compress_buffer(const uint8_t* input,
+		size_t input_len, int32_t level = ZSTD_CLEVEL_DEFAULT, uint32_t workers = 0);
+
+	/*
+		Dictionary variants, trained dictionaries carry their own ID which
+		gets recorded in every frame compressed against them.
+	*/
+	constexpr static const size_t default_dictionary{112_KiB};
+
+	[[nodiscard]]
+	static bool decompress_buffer(const uint8_t* input, size_t input_len, uint8_t* output,
+		size_t output_len, const uint8_t* dictionary, size_t dictionary_len) noexcept;
+
+	[[nodiscard]]
+	static std::vector<uint8_t> compress_buffer(const uint8_t* input, size_t input_len,
+		const uint8_t* dictionary, size_t dictionary_len, int32_t level = ZSTD_CLEVEL_DEFAULT,
+		uint32_t workers = 0);
+
+	/* ID of the dictionary a frame needs, 0 if it doesn't need one */
+	[[nodiscard]]
+	static uint32_t dictionary_id(const uint8_t* input, size_t input_len) noexcept {
+		return ::ZSTD_getDictID_fromFrame(input, input_len);
+	}
+
+	/* ID a dictionary identifies itself with, 0 for raw content dictionaries */
+	[[nodiscard]]
+	static uint32_t dictionary_header_id(const uint8_t* dictionary, size_t dictionary_len) noexcept {
+		return ::ZSTD_getDictID_fromDict(dictionary, dictionary_len);
+	}
+
+	/* Empty if there wasn't enough sample data to train on */
+	[[nodiscard]]
+	static std::vector<uint8_t> train_dictionary(const std::vector<span<const uint8_t>>& samples,
+		size_t capacity = default_dictionary);
+
+	[[nodiscard]]
+	static int32_t min_level() noexcept { return ZSTD_minCLevel(); }
+	[[nodiscard]]
+	static int32_t max_level() noexcept { return ZSTD_maxCLevel(); }
+};
+
+#endif /* SNS_WITH_ZSTD */
+
+#endif /* __SNS_ZSTD_HH__ */
@@ -0,0 +1,349 @@
+/* probe.cc - Object format identification from the headers alone */
+#include <probe.hh>
+#include <elf.hh>
+#include <span.hh>
+
+#include <cstring>
+
+const std::array<const enum_pair_t<object_format_t>, 10> object_format_s{{
+	{ object_format_t::Unknown,  "Unknown"  },
+	{ object_format_t::AOut,     "a.out"    },
+	{ object_format_t::COFF,     "COFF"     },
+	{ object_format_t::ECOFF,    "ECOFF"    },
+	{ object_format_t::ELF,      "ELF"      },
+	{ object_format_t::MachO,    "Mach-O"   },
+	{ object_format_t::MachOFat, "Mach-O Universal" },
+	{ object_format_t::OS360,    "OS/360"   },
+	{ object_format_t::PE,       "PE"       },
+	{ object_format_t::XCOFF,    "XCOFF"    },
+}};
+std::ostream& operator<<(std::ostream& out, const object_format_t& format) {
+	return (out << enum_name(object_format_s, format));
+}
+
+/* The caller checks that it's in bounds, the host is assumed to be little endian */
+template<typename T>
+static T load(const uint8_t* const data, const bool big_endian) noexcept {
+	T value{};
+	std::memcpy(&value, data, sizeof(T));
+	if(!big_endian)
+		return value;
+	if constexpr(sizeof(T) == 2)
+		return T(_sns_bswap16(uint16_t(value)));
+	else if constexpr(sizeof(T) == 4)
+		return T(_sns_bswap32(uint32_t(value)));
+	else
+		return T(_sns_bswap64(uint64_t(value)));
+}
+
+/* Reads up to `len` bytes, less at the end of the file or once the budget's spent */
+static void read_into(const fd_t& file, probe_t& probe, const uint64_t offset, size_t len,
+	std::vector<uint8_t>& buffer) {
+
+	len = size_t(std::min<uint64_t>(len, probe_read_limit - probe.bytes_read));
+	if(offset >= probe.file_size)
+		len = 0;
+	len = size_t(std::min<uint64_t>(len, probe.file_size - std::min(offset, probe.file_size)));
+
+	buffer.resize(len);
+	size_t actual{};
+	if(len != 0)
+		static_cast<void>(file.pread(buffer.data(), len, off_t(offset), actual));
+	probe.bytes_read += actual;
+	buffer.resize(actual);
+}
+
+/* Out of `header` if it's already been read, otherwise into `scratch`. May come up short */
+static span<const uint8_t> fetch(const fd_t& file, probe_t& probe, const std::vector<uint8_t>& header,
+	const uint64_t offset, const size_t len, std::vector<uint8_t>& scratch) {
+
+	if(offset <= header.size() && len <= header.size() - offset)
+		return {header.data() + offset, len};
+	read_into(file, probe, offset, len, scratch);
+	return {scratch.data(), scratch.size()};
+}
+
+static bool find_build_id(const span<const uint8_t> notes, const bool big_endian, const size_t align,
+	std::vector<uint8_t>& build_id) {
+
+	const auto align_up = [align](const size_t value) { return (value + align - 1U) & ~(align - 1U); };
+	const size_t len{notes.size()};
+	size_t pos{};
+	while(pos <= len && (len - pos) >= 12U) {
+		const uint32_t name_len{load<uint32_t>(notes.data() + pos, big_endian)};
+		const uint32_t desc_len{load<uint32_t>(notes.data() + pos + 4U, big_endian)};
+		const uint32_t type{load<uint32_t>(notes.data() + pos + 8U, big_endian)};
+		const size_t name{pos + 12U};
+		if(name_len > len - name)
+			return false;
+		/* Padding is from the start of the notes, not of each field */
+		const size_t desc{align_up(name + name_len)};
+		if(desc > len || desc_len > len - desc)
+			return false;
+
+		if(type == uint32_t(elf_note_type_t::GNUBuildID) && name_len == 4U &&
+			std::memcmp(notes.data() + name, "GNU", 4U) == 0) {
+			build_id.assign(notes.data() + desc, notes.data() + desc + desc_len);
+			return true;
+		}
+		pos = align_up(desc + desc_len);
+	}
+	return false;
+}
+
+static void probe_elf(const fd_t& file, probe_t& probe, const std::vector<uint8_t>& header) {
+	probe.format = object_format_t::ELF;
+	/* Only the magic number is known to be there */
+	if(header.size() < sizeof(elf_ident_t))
+		return;
+	const auto eclass = elf_class_t(header[4]);
+	const auto data = elf_data_t(header[5]);
+	if((eclass != elf_class_t::ELF32 && eclass != elf_class_t::ELF64) ||
+		(data != elf_data_t::LSB && data != elf_data_t::MSB))
+		return;
+
+	const bool elf64{eclass == elf_class_t::ELF64};
+	const bool big_endian{data == elf_data_t::MSB};
+	probe.bits = elf64 ? 64U : 32U;
+	probe.big_endian = big_endian;
+	if(header.size() < (elf64 ? sizeof(elf64_ehdr_t) : sizeof(elf32_ehdr_t)))
+		return;
+
+	const auto word = [&](const size_t offset32, const size_t offset64) -> uint64_t {
+		return elf64 ? load<uint64_t>(header.data() + offset64, big_endian) :
+			load<uint32_t>(header.data() + offset32, big_endian);
+	};
+	const auto half = [&](const size_t offset32, const size_t offset64) -> uint16_t {
+		return load<uint16_t>(header.data() + (elf64 ? offset64 : offset32), big_endian);
+	};
+	probe.type = half(16U, 16U);
+	probe.machine = half(18U, 18U);
+	const uint64_t phoff{word(28U, 32U)};
+	const uint64_t shoff{word(32U, 40U)};
+	const size_t phentsize{half(42U, 54U)};
+	size_t phnum{half(44U, 56U)};
+	const size_t phdr_len{elf64 ? sizeof(elf64_phdr_t) : sizeof(elf32_phdr_t)};
+	if(phoff == 0 || phnum == 0 || phentsize < phdr_len)
+		return;
+
+	std::vector<uint8_t> scratch{};
+	/* Escaped into sh_info of section 0 */
+	if(phnum == elf_pn_xnum && shoff != 0) {
+		const auto info = fetch(file, probe, header, shoff + (elf64 ? 44U : 28U), 4U, scratch);
+		if(info.size() != 4U)
+			return;
+		phnum = load<uint32_t>(info.data(), big_endian);
+	}
+
+	struct note_t final {
+		uint64_t offset;
+		uint64_t size;
+		size_t align;
+	};
+	std::vector<note_t> notes{};
+	const auto phdrs = fetch(file, probe, header, phoff, phnum * phentsize, scratch);
+	if(phdrs.size() != phnum * phentsize)
+		return;
+	for(size_t idx{}; idx < phnum; ++idx) {
+		const uint8_t* const phdr{phdrs.data() + (idx * phentsize)};
+		if(load<uint32_t>(phdr, big_endian) != uint32_t(elf_phdr_type_t::Note))
+			continue;
+		if(elf64)
+			notes.push_back({load<uint64_t>(phdr + 8U, big_endian), load<uint64_t>(phdr + 32U, big_endian),
+				(load<uint64_t>(phdr + 48U, big_endian) == 8U) ? 8U : 4U});
+		else
+			notes.push_back({load<uint32_t>(phdr + 4U, big_endian), load<uint32_t>(phdr + 16U, big_endian),
+				(load<uint32_t>(phdr + 28U, big_endian) == 8U) ? 8U : 4U});
+	}
+
+	for(const auto& note : notes) {
+		const auto contents = fetch(file, probe, header, note.offset, size_t(std::min<uint64_t>(note.size,
+			probe_read_limit)), scratch);
+		if(find_build_id(contents, big_endian, note.align, probe.build_id))
+			return;
+	}
+}
+
+static void probe_macho(const fd_t& file, probe_t& probe, const std::vector<uint8_t>& header,
+	const bool macho64, const bool big_endian) {
+
+	constexpr uint32_t lc_uuid{0x1BU};
+	probe.format = object_format_t::MachO;
+	probe.bits = macho64 ? 64U : 32U;
+	probe.big_endian = big_endian;
+	const size_t header_len{macho64 ? 32U : 28U};
+	if(header.size() < header_len)
+		return;
+	probe.machine = load<uint32_t>(header.data() + 4U, big_endian);
+	probe.type = load<uint32_t>(header.data() + 12U, big_endian);
+
+	const uint32_t ncmds{load<uint32_t>(header.data() + 16U, big_endian)};
+	const uint32_t cmds_len{load<uint32_t>(header.data() + 20U, big_endian)};
+	std::vector<uint8_t> scratch{};
+	const auto cmds = fetch(file, probe, header, header_len, cmds_len, scratch);
+	size_t pos{};
+	for(uint32_t idx{}; idx < ncmds && (cmds.size() - pos) >= 8U; ++idx) {
+		const uint32_t cmd{load<uint32_t>(cmds.data() + pos, big_endian)};
+		const uint32_t cmd_len{load<uint32_t>(cmds.data() + pos + 4U, big_endian)};
+		if(cmd_len < 8U || cmd_len > cmds.size() - pos)
+			return;
+		if(cmd == lc_uuid && cmd_len >= 24U) {
+			probe.build_id.assign(cmds.data() + pos + 8U, cmds.data() + pos + 24U);
+			return;
+		}
+		pos += cmd_len;
+	}
+}
+
+static void probe_pe(const fd_t& file, probe_t& probe, const std::vector<uint8_t>& header) {
+	constexpr size_t lfanew{0x3CU};
+	if(header.size() < lfanew + 4U)
+		return;
+	std::vector<uint8_t> scratch{};
+	const auto pe = fetch(file, probe, header, load<uint32_t>(header.data() + lfanew, false), 26U, scratch);
+	if(pe.size() != 26U || std::memcmp(pe.data(), "PE\0\0", 4U) != 0)
+		return;
+
+	probe.format = object_format_t::PE;
+	probe.machine = load<uint16_t>(pe.data() + 4U, false);
+	probe.type = load<uint16_t>(pe.data() + 22U, false);
+	if(load<uint16_t>(pe.data() + 20U, false) >= 2U) {
+		const uint16_t magic{load<uint16_t>(pe.data() + 24U, false)};
+		probe.bits = (magic == 0x020BU) ? 64U : (magic == 0x010BU) ? 32U : 0U;
+	}
+}
+
+/* f_magic values, which double as the machine */
+static bool ecoff_magic(const uint16_t magic) noexcept {
+	switch(magic) {
+		case 0x0160U: /* MIPSEB */
+		case 0x0162U: /* MIPSEL */
+		case 0x0163U: /* MIPSEL, MIPS II */
+		case 0x0166U: /* MIPSEB, MIPS II */
+		case 0x0140U: /* MIPSEB, MIPS III */
+		case 0x0142U: /* MIPSEL, MIPS III */
+		case 0x0183U: /* Alpha */
+		case 0x0188U: /* Alpha, compressed */
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool coff_magic(const uint16_t magic) noexcept {
+	switch(magic) {
+		case 0x014CU: /* i386 */
+		case 0x01C0U: /* ARM */
+		case 0x01C4U: /* ARMv7 Thumb-2 */
+		case 0x01F0U: /* PowerPC */
+		case 0x0200U: /* IA-64 */
+		case 0x8664U: /* AMD64 */
+		case 0xAA64U: /* ARM64 */
+			return true;
+		default:
+			return false;
+	}
+}
+
+/* a.out's N_MAGIC */
+static bool aout_magic(const uint16_t magic) noexcept {
+	return magic == 0407U || magic == 0410U || magic == 0413U || magic == 0314U;
+}
+
+/* Object decks are 80 column cards, 0x02 then the record type in EBCDIC */
+static bool os360_card(const std::vector<uint8_t>& header) noexcept {
+	constexpr std::array<std::array<uint8_t, 3>, 5> records{{
+		{{0xC5U, 0xE2U, 0xC4U}}, /* ESD */
+		{{0xE3U, 0xE7U, 0xE3U}}, /* TXT */
+		{{0xD9U, 0xD3U, 0xC4U}}, /* RLD */
+		{{0xC5U, 0xD5U, 0xC4U}}, /* END */
+		{{0xE2U, 0xE8U, 0xD4U}}, /* SYM */
+	}};
+	if(header.size() < 80U || header[0] != 0x02U)
+		return false;
+	return std::any_of(records.begin(), records.end(), [&header](const std::array<uint8_t, 3>& record) {
+		return std::memcmp(header.data() + 1U, record.data(), record.size()) == 0;
+	});
+}
+
+probe_t probe_object(const fd_t& file) {
+	probe_t probe{};
+	if(!file.valid())
+		return probe;
+	probe.file_size = uint64_t(std::max<off_t>(file.length(), 0));
+
+	std::vector<uint8_t> header{};
+	read_into(file, probe, 0, probe_header_len, header);
+	if(header.size() < 4U)
+		return probe;
+
+	const uint32_t magic{load<uint32_t>(header.data(), false)};
+	const uint16_t magic_le{load<uint16_t>(header.data(), false)};
+	const uint16_t magic_be{load<uint16_t>(header.data(), true)};
+	if(header[0] == 0x7FU && header[1] == 'E' && header[2] == 'L' && header[3] == 'F')
+		probe_elf(file, probe, header);
+	else if(magic == 0xFEEDFACEU || magic == 0xFEEDFACFU)
+		probe_macho(file, probe, header, magic == 0xFEEDFACFU, false);
+	else if(magic == 0xCEFAEDFEU || magic == 0xCFFAEDFEU)
+		probe_macho(file, probe, header, magic == 0xCFFAEDFEU, true);
+	else if(magic == 0xBEBAFECAU || magic == 0xBFBAFECAU) {
+		/* Java class files share the magic, but their version is never this small */
+		if(header.size() >= 12U) {
+			const uint32_t archs{load<uint32_t>(header.data() + 4U, true)};
+			if(archs != 0 && archs < 30U) {
+				probe.format = object_format_t::MachOFat;
+				probe.bits = (magic == 0xBFBAFECAU) ? 64U : 32U;
+				probe.big_endian = true;
+				probe.machine = load<uint32_t>(header.data() + 8U, true);
+			}
+		}
+	} else if(header[0] == 'M' && header[1] == 'Z')
+		probe_pe(file, probe, header);
+	else if(magic_be == 0x01DFU || magic_be == 0x01F7U) {
+		probe.format = object_format_t::XCOFF;
+		probe.bits = (magic_be == 0x01F7U) ? 64U : 32U;
+		probe.big_endian = true;
+		probe.machine = magic_be;
+	} else if(ecoff_magic(magic_le) || ecoff_magic(magic_be)) {
+		probe.format = object_format_t::ECOFF;
+		probe.big_endian = !ecoff_magic(magic_le);
+		probe.machine = probe.big_endian ? magic_be : magic_le;
+		probe.bits = (probe.machine == 0x0183U || probe.machine == 0x0188U) ? 64U : 32U;
+	} else if(coff_magic(magic_le) && header.size() >= 20U &&
+		(load<uint16_t>(header.data() + 16U, false) == 0 || load<uint16_t>(header.data() + 16U, false) == 28U)) {
+		/* No optional header for objects, or the SysV a.out one for executables */
+		probe.format = object_format_t::COFF;
+		probe.machine = magic_le;
+		probe.bits = (magic_le == 0x8664U || magic_le == 0xAA64U || magic_le == 0x0200U) ? 64U : 32U;
+	} else if(aout_magic(magic_le) && header.size() >= 32U) {
+		probe.format = object_format_t::AOut;
+		probe.machine = (magic >> 16U) & 0xFFU;
+		probe.bits = 32U;
+	} else if(aout_magic(uint16_t(load<uint32_t>(header.data(), true))) && header.size() >= 32U) {
+		/* NetBSD style, network byte order with the machine ID above the magic */
+		probe.format = object_format_t::AOut;
+		probe.machine = (load<uint32_t>(header.data(), true) >> 16U) & 0x3FFU;
+		probe.bits = 32U;
+		probe.big_endian = true;
+	} else if(os360_card(header)) {
+		probe.format = object_format_t::OS360;
+		probe.bits = 32U;
+		probe.big_endian = true;
+	}
+	return probe;
+}
+
+probe_t probe_object(const fs::path& file) {
+	const fd_t fd{file.c_str(), O_RDONLY | O_CLOEXEC};
+	if(!fd.valid())
+		return {};
+	/* Only the headers are wanted, readahead would pull in far more than that */
+	static_cast<void>(::posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM));
+	return probe_object(fd);
+}
+
+std::vector<probe_t> probe_objects(const std::vector<fs::path>& files, const size_t threads) {
+	std::vector<probe_t> probes(files.size());
+	parallel_for(files.size(), [&](const size_t idx) { probes[idx] = probe_object(files[idx]); }, threads);
+	return probes;
+}
@@ -0,0 +1,255 @@
+/* sidecar.cc - Persistent, mappable lookup indices for an object file */
+#include <sidecar.hh>
+#include <probe.hh>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool sidecar_key_t::of(const fs::path& file, const span<const uint8_t> build_id, sidecar_key_t& key) noexcept {
+	struct stat info{};
+	if(::stat(file.c_str(), &info) != 0)
+		return false;
+	key.inode = uint64_t(info.st_ino);
+	key.size = uint64_t(info.st_size);
+	key.mtime = (uint64_t(info.st_mtim.tv_sec) * 1000000000U) + uint64_t(info.st_mtim.tv_nsec);
+	key.build_id.assign(build_id.data(), build_id.data() + build_id.size());
+	return true;
+}
+
+bool sidecar_key_t::of(const fs::path& file, sidecar_key_t& key) {
+	const probe_t probe{probe_object(file)};
+	return of(file, {probe.build_id.data(), probe.build_id.size()}, key);
+}
+
+bool sidecar_key_t::matches(const sidecar_key_t& key) const noexcept {
+	if(!build_id.empty() || !key.build_id.empty())
+		return build_id == key.build_id;
+	return inode == key.inode && size == key.size && mtime == key.mtime;
+}
+
+fs::path sidecar_path(const fs::path& file, const sidecar_key_t& key, const fs::path& cache_dir) {
+	constexpr std::string_view suffix{".sns-index"};
+	if(cache_dir.empty()) {
+		fs::path path{file};
+		path += suffix;
+		return path;
+	}
+
+	std::string name{};
+	if(!key.build_id.empty()) {
+		constexpr char digits[]{"0123456789abcdef"};
+		for(const uint8_t byte : key.build_id) {
+			name += digits[byte >> 4U];
+			name += digits[byte & 0x0FU];
+		}
+	} else
+		name = std::to_string(key.inode) + '-' + std::to_string(key.size) + '-' + std::to_string(key.mtime);
+	name += suffix;
+	return cache_dir / name;
+}
+
+/* Appends `value` as it is in memory, padded out to 8 bytes */
+template<typename T>
+static void append(std::vector<uint8_t>& buffer, const T* const values, const size_t count) {
+	const size_t offset{buffer.size()};
+	buffer.resize(offset + (count * sizeof(T)));
+	if(count != 0)
+		std::memcpy(buffer.data() + offset, values, count * sizeof(T));
+	buffer.resize((buffer.size() + 7U) & ~size_t(7U));
+}
+
+bool write_sidecar(const fs::path& path, const sidecar_key_t& key,
+	const std::vector<std::pair<std::string_view, size_t>>& sections, const symbol_index_t& symbols,
+	const address_index_t& addresses) {
+
+	if(key.build_id.size() > sidecar_key_t::max_build_id)
+		return false;
+
+	std::string strings{};
+	bool fits{true};
+	const auto add_string = [&strings, &fits](const std::string_view str, uint32_t& offset, uint32_t& len) {
+		fits &= (strings.size() + str.size()) <= UINT32_MAX;
+		offset = uint32_t(strings.size());
+		len = uint32_t(str.size());
+		strings += str;
+	};
+
+	auto by_name = sections;
+	std::sort(by_name.begin(), by_name.end());
+	by_name.erase(std::unique(by_name.begin(), by_name.end(), [](const auto& a, const auto& b) {
+		return a.first == b.first;
+	}), by_name.end());
+	std::vector<sidecar_section_t> section_entries(by_name.size());
+	for(size_t idx{}; idx < by_name.size(); ++idx) {
+		add_string(by_name[idx].first, section_entries[idx].name, section_entries[idx].name_len);
+		section_entries[idx].index = uint32_t(by_name[idx].second);
+	}
+
+	const auto& entries = symbols.symbols();
+	const auto& parents = symbols.parents();
+	std::vector<sidecar_symbol_t> symbol_entries(entries.size());
+	for(size_t idx{}; idx < entries.size(); ++idx) {
+		const auto& entry = entries[idx];
+		auto& symbol = symbol_entries[idx];
+		symbol = {entry.address, entry.size, 0, 0, entry.table, entry.index, parents[idx],
+			entry.binding, entry.type, 0};
+		add_string(entry.name, symbol.name, symbol.name_len);
+	}
+
+	std::vector<sidecar_range_t> range_entries{};
+	range_entries.reserve(addresses.size());
+	for(const auto& range : addresses.ranges())
+		range_entries.push_back({range.address, range.offset, range.file_size, range.mem_size, range.index, 0});
+	if(!fits)
+		return false;
+
+	sidecar_header_t header{};
+	header.magic = sidecar_header_t::magic_value;
+	header.version = sidecar_header_t::current_version;
+	header.byte_order = sidecar_header_t::byte_order_value;
+	header.inode = key.inode;
+	header.size = key.size;
+	header.mtime = key.mtime;
+	header.build_id_len = uint32_t(key.build_id.size());
+	std::copy(key.build_id.begin(), key.build_id.end(), header.build_id.begin());
+
+	std::vector<uint8_t> buffer{};
+	append(buffer, &header, 1);
+	header.sections = {buffer.size(), section_entries.size()};
+	append(buffer, section_entries.data(), section_entries.size());
+	header.symbols = {buffer.size(), symbol_entries.size()};
+	append(buffer, symbol_entries.data(), symbol_entries.size());
+	header.ranges = {buffer.size(), range_entries.size()};
+	append(buffer, range_entries.data(), range_entries.size());
+	header.strings = {buffer.size(), strings.size()};
+	append(buffer, strings.data(), strings.size());
+	std::memcpy(buffer.data(), &header, sizeof(sidecar_header_t));
+
+	std::error_code error{};
+	if(path.has_parent_path())
+		fs::create_directories(path.parent_path(), error);
+	/* Unique per writer, so threads of one process saving the same sidecar can't interleave */
+	std::string temporary{path.string() + ".tmp.XXXXXX"};
+	bool written{false};
+	{
+		const fd_t file{::mkostemp(temporary.data(), O_CLOEXEC)};
+		if(!file.valid())
+			return false;
+		size_t offset{};
+		while(offset < buffer.size()) {
+			const ssize_t result{file.write(buffer.data() + offset, buffer.size() - offset)};
+			if(result < 0 && errno == EINTR)
+				continue;
+			if(result <= 0)
+				break;
+			offset += size_t(result);
+		}
+		written = offset == buffer.size() && ::fchmod(file, 0644) == 0 && ::fsync(file) == 0;
+	}
+	if(!written || ::rename(temporary.c_str(), path.c_str()) != 0) {
+		::unlink(temporary.c_str());
+		return false;
+	}
+
+	/* The rename only survives a crash once the directory holding it has been synced */
+	const fs::path directory{path.has_parent_path() ? path.parent_path() : fs::path{"."}};
+	const fd_t parent{directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC};
+	return parent.valid() && ::fsync(parent) == 0;
+}
+
+/* `table` as a span of T inside of the mapping, false if it's misaligned or runs off the end */
+template<typename T>
+static bool map_table(const mmap_t& map, const sidecar_table_t& table, span<const T>& values) noexcept {
+	const auto len = uint64_t(map.length());
+	if(table.offset > len || (table.offset % alignof(T)) != 0 || table.count > ((len - table.offset) / sizeof(T)))
+		return false;
+	values = {reinterpret_cast<const T*>(map.address<uint8_t>() + table.offset), size_t(table.count)}; // lgtm[cpp/reinterpret-cast]
+	return true;
+}
+
+sidecar_t::sidecar_t(const fs::path& path, const sidecar_key_t& key) noexcept : sidecar_t() {
+	fd_t file{path.c_str(), O_RDONLY};
+	if(!file.valid() || file.length() < off_t(sizeof(sidecar_header_t)))
+		return;
+	_map = file.map(PROT_READ);
+	if(!_map.valid())
+		return;
+
+	sidecar_header_t header{};
+	std::memcpy(&header, _map.address<uint8_t>(), sizeof(sidecar_header_t));
+	if(header.magic != sidecar_header_t::magic_value || header.version != sidecar_header_t::current_version ||
+		header.byte_order != sidecar_header_t::byte_order_value || header.build_id_len > sidecar_key_t::max_build_id)
+		return;
+
+	const bool keyed{header.build_id_len != 0 || !key.build_id.empty()};
+	if(keyed && !(header.build_id_len == key.build_id.size() &&
+		std::equal(key.build_id.begin(), key.build_id.end(), header.build_id.begin())))
+		return;
+	if(!keyed && (header.inode != key.inode || header.size != key.size || header.mtime != key.mtime))
+		return;
+
+	span<const char> strings{};
+	if(!map_table(_map, header.sections, _sections) || !map_table(_map, header.symbols, _symbols) ||
+		!map_table(_map, header.ranges, _ranges) || !map_table(_map, header.strings, strings))
+		return;
+	_strings = {strings.data(), strings.size()};
+	_valid = true;
+}
+
+std::string_view sidecar_t::string(const uint32_t offset, const uint32_t len) const noexcept {
+	if(offset > _strings.size() || len > (_strings.size() - offset))
+		return {};
+	return _strings.substr(offset, len);
+}
+
+size_t sidecar_t::find_section(const std::string_view name) const noexcept {
+	const sidecar_section_t* const end{_sections.data() + _sections.size()};
+	const auto* const section = std::lower_bound(_sections.data(), end, name,
+		[this](const sidecar_section_t& entry, const std::string_view value) { return section_name(entry) < value; });
+	if(section == end || section_name(*section) != name)
+		return 0;
+	return section->index;
+}
+
+const sidecar_symbol_t* sidecar_t::find_symbol(const uint64_t address) const noexcept {
+	const sidecar_symbol_t* const symbols{_symbols.data()};
+	const auto* const upper = std::upper_bound(symbols, symbols + _symbols.size(), address,
+		[](const uint64_t value, const sidecar_symbol_t& entry) { return value < entry.address; });
+	if(upper == symbols)
+		return nullptr;
+
+	/* Parents always come earlier, anything else would be a loop */
+	auto candidate = uint32_t((upper - symbols) - 1);
+	while(!symbols[candidate].contains(address)) {
+		const uint32_t parent{symbols[candidate].parent};
+		if(parent >= candidate)
+			return nullptr;
+		candidate = parent;
+	}
+	return &symbols[candidate];
+}
+
+uint64_t sidecar_t::to_offset(const uint64_t address) const noexcept {
+	const sidecar_range_t* const ranges{_ranges.data()};
+	const auto* const upper = std::upper_bound(ranges, ranges + _ranges.size(), address,
+		[](const uint64_t value, const sidecar_range_t& entry) { return value < entry.address; });
+	if(upper == ranges)
+		return npos;
+	const sidecar_range_t& range{*(upper - 1)};
+	const uint64_t delta{address - range.address};
+	return (delta < range.mem_size && delta < range.file_size) ? range.offset + delta : npos;
+}
+
+sidecar_t open_sidecar(const fs::path& file, const fs::path& cache_dir) {
+	sidecar_key_t key{};
+	if(!sidecar_key_t::of(file, key))
+		return {};
+	return {sidecar_path(file, key, cache_dir), key};
+}
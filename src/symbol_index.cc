@@ -0,0 +1,156 @@
+/* symbol_index.cc - Address to symbol lookup */
+#include <symbol_index.hh>
+#include <utility.hh>
+
+#include <algorithm>
+#include <array>
+
+/* Ordering used to pick which alias names an address, lower is better */
+static uint32_t alias_rank(const symbol_entry_t& symbol) noexcept {
+	/* Global, then weak, then local, everything else after that */
+	constexpr uint8_t binding_ranks[3]{2, 0, 1};
+	const uint32_t binding{(symbol.binding < 3) ? binding_ranks[symbol.binding] : 3U};
+	/* Functions, objects, then whatever's left */
+	const uint32_t type{(symbol.type == 0x02U || symbol.type == 0x0AU) ? 0U : (symbol.type == 0x01U) ? 1U : 2U};
+	return ((symbol.size == 0) ? 0x100U : 0U) | (binding << 4U) | type;
+}
+
+static bool symbol_order(const symbol_entry_t& a, const symbol_entry_t& b) noexcept {
+	if(a.address != b.address)
+		return a.address < b.address;
+	const uint32_t a_rank{alias_rank(a)};
+	const uint32_t b_rank{alias_rank(b)};
+	if(a_rank != b_rank)
+		return a_rank < b_rank;
+	if(a.table != b.table)
+		return a.table < b.table;
+	return a.index < b.index;
+}
+
+symbol_index_t::symbol_index_t(std::vector<symbol_entry_t> symbols, size_t threads) :
+	_symbols{std::move(symbols)}, _parents{}, _layout{}, _ranks{} {
+
+	/* Sort in chunks across the workers, then merge them back together pairwise */
+	if(threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1U);
+	const size_t chunks{std::max<size_t>(1, std::min(threads, _symbols.size() / 4096))};
+	const size_t chunk_len{(_symbols.size() + chunks - 1) / std::max<size_t>(chunks, 1)};
+	const auto chunk_bound = [&](const size_t chunk) {
+		return _symbols.begin() + std::ptrdiff_t(std::min(chunk * chunk_len, _symbols.size()));
+	};
+
+	parallel_for(chunks, [&](const size_t chunk) {
+		std::sort(chunk_bound(chunk), chunk_bound(chunk + 1), symbol_order);
+	}, threads);
+	for(size_t width{1}; width < chunks; width *= 2) {
+		parallel_for((chunks + (width * 2) - 1) / (width * 2), [&](const size_t pair) {
+			const size_t first{pair * width * 2};
+			if(first + width < chunks)
+				std::inplace_merge(chunk_bound(first), chunk_bound(first + width),
+					chunk_bound(std::min(first + (width * 2), chunks)), symbol_order);
+		}, threads);
+	}
+
+	/* Collapse aliases, the best name comes first and the largest size wins */
+	size_t kept{};
+	for(size_t idx{}; idx < _symbols.size(); ++idx) {
+		if(kept != 0 && _symbols[kept - 1].address == _symbols[idx].address) {
+			_symbols[kept - 1].size = std::max(_symbols[kept - 1].size, _symbols[idx].size);
+			continue;
+		}
+		_symbols[kept++] = _symbols[idx];
+	}
+	_symbols.resize(kept);
+	_symbols.shrink_to_fit();
+
+	_parents.resize(_symbols.size(), npos);
+	std::vector<uint32_t> open{};
+	for(size_t idx{}; idx < _symbols.size(); ++idx) {
+		const auto& symbol = _symbols[idx];
+		while(!open.empty() && !_symbols[open.back()].contains(symbol.address))
+			open.pop_back();
+		if(!open.empty())
+			_parents[idx] = open.back();
+		if(symbol.size != 0)
+			open.push_back(uint32_t(idx));
+	}
+
+	_layout.resize(_symbols.size() + 1);
+	_ranks.resize(_symbols.size() + 1);
+	size_t next{};
+	build_layout(next, 1);
+}
+
+/* In-order walk of the implicit tree hands out the sorted entries */
+void symbol_index_t::build_layout(size_t& next, const size_t position) noexcept {
+	if(position > _symbols.size())
+		return;
+	build_layout(next, position * 2);
+	_layout[position] = _symbols[next].address;
+	_ranks[position] = uint32_t(next++);
+	build_layout(next, (position * 2) + 1);
+}
+
+const symbol_entry_t* symbol_index_t::resolve(size_t position, const uint64_t address) const noexcept {
+	/* Drop the trailing right turns, leaving the first address past ours */
+	position >>= uint32_t(__builtin_ffsll(int64_t(~position)));
+	const size_t upper{(position == 0) ? _symbols.size() : _ranks[position]};
+	if(upper == 0)
+		return nullptr;
+
+	/* The one before it is the candidate, or failing that whatever encloses it */
+	uint32_t candidate{uint32_t(upper - 1)};
+	while(candidate != npos && !_symbols[candidate].contains(address))
+		candidate = _parents[candidate];
+	return (candidate == npos) ? nullptr : &_symbols[candidate];
+}
+
+const symbol_entry_t* symbol_index_t::find(const uint64_t address) const noexcept {
+	const size_t count{_symbols.size()};
+	if(count == 0)
+		return nullptr;
+
+	size_t position{1};
+	while(position <= count) {
+		__builtin_prefetch(_layout.data() + std::min(position * 16, count));
+		position = (position * 2) + size_t(_layout[position] <= address);
+	}
+	return resolve(position, address);
+}
+
+/*
+	Several searches are walked down the tree in lockstep so their cache
+	misses overlap, lanes that hit the bottom early just stop moving.
+*/
+void symbol_index_t::find(const uint64_t* addresses, const size_t count,
+	const symbol_entry_t** results) const noexcept {
+
+	constexpr size_t lanes{8};
+	const size_t symbols{_symbols.size()};
+	if(symbols == 0) {
+		std::fill(results, results + count, nullptr);
+		return;
+	}
+
+	size_t depth{};
+	for(size_t level{symbols}; level != 0; level >>= 1U)
+		++depth;
+
+	for(size_t base{}; base < count; base += lanes) {
+		const size_t active{std::min(lanes, count - base)};
+		std::array<size_t, lanes> positions{};
+		positions.fill(1);
+
+		for(size_t level{}; level < depth; ++level) {
+			for(size_t lane{}; lane < active; ++lane) {
+				const size_t position{positions[lane]};
+				const size_t clamped{std::min(position, symbols)};
+				const size_t next{(position * 2) + size_t(_layout[clamped] <= addresses[base + lane])};
+				positions[lane] = (position <= symbols) ? next : position;
+			}
+		}
+
+		for(size_t lane{}; lane < active; ++lane)
+			results[base + lane] = resolve(positions[lane], addresses[base + lane]);
+	}
+}
@@ -0,0 +1,164 @@
+/* elf-image.hh - Tiny ELF writer for building test objects on the fly */
+#pragma once
+#if !defined(__SNS_TEST_ELF_IMAGE_HH__)
+#define __SNS_TEST_ELF_IMAGE_HH__
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <elf.hh>
+
+/*
+	Lays the file out as [ehdr][phdrs][section contents][shstrtab][shdrs],
+	segments are described in terms of the sections they cover and get their
+	offsets fixed up once everything has been placed.
+*/
+template<typename T>
+struct elf_image_t final {
+	using ehdr_t    = typename T::ehdr_t;
+	using shdr_t    = typename T::shdr_t;
+	using phdr_t    = typename T::phdr_t;
+	using shflags_t = typename T::shflags_t;
+
+	struct section_t final {
+		shdr_t header;
+		std::vector<uint8_t> contents;
+	};
+
+	struct segment_t final {
+		phdr_t header;
+		size_t first;
+		size_t last;
+	};
+
+	elf_type_t type{elf_type_t::Relocatable};
+	elf_machine_t machine{elf_machine_t::X86_64};
+	std::vector<section_t> sections{section_t{}};
+	std::vector<segment_t> segments{};
+	std::string shstrtab{std::string(1, '\0')};
+
+	uint32_t add_name(const std::string& name) {
+		const auto offset = uint32_t(shstrtab.size());
+		shstrtab += name;
+		shstrtab += '\0';
+		return offset;
+	}
+
+	size_t add_section(const std::string& name, elf_shtype_t shtype,
+		const void* data, size_t len, shflags_t flags = shflags_t::None,
+		uint64_t addr = 0, uint32_t link = 0, uint32_t info = 0, uint64_t entsize = 0) {
+
+		section_t section{};
+		section.header.name(add_name(name));
+		section.header.type(shtype);
+		section.header.flags(flags);
+		section.header.addr(typename T::addr_t(addr));
+		section.header.size(typename T::xword_t(len));
+		section.header.link(link);
+		section.header.info(info);
+		section.header.addraline(1);
+		section.header.entsize(typename T::xword_t(entsize));
+		if(data != nullptr)
+			section.contents.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + len);
+		sections.emplace_back(std::move(section));
+		return sections.size() - 1;
+	}
+
+	template<typename U>
+	size_t add_section(const std::string& name, elf_shtype_t shtype, const std::vector<U>& data,
+		shflags_t flags = shflags_t::None, uint64_t addr = 0, uint32_t link = 0,
+		uint32_t info = 0, uint64_t entsize = 0) {
+		return add_section(name, shtype, data.data(), data.size() * sizeof(U), flags, addr,
+			link, info, entsize);
+	}
+
+	/* Segment covering sections [first, last] */
+	void add_segment(elf_phdr_type_t phtype, elf_phdr_flags_t flags, size_t first, size_t last) {
+		phdr_t phdr{};
+		phdr.type(phtype);
+		phdr.flags(flags);
+		phdr.align(1);
+		segments.push_back({phdr, first, last});
+	}
+
+	std::vector<uint8_t> build() {
+		/* Adding the name can reallocate shstrtab, so the contents are filled in after */
+		const size_t shstrndx = add_section(".shstrtab", elf_shtype_t::StringTable, nullptr, 0);
+		/* Including our own name, which was only just added */
+		sections[shstrndx].contents.assign(shstrtab.begin(), shstrtab.end());
+		sections[shstrndx].header.size(typename T::xword_t(shstrtab.size()));
+
+		std::vector<uint8_t> image(sizeof(ehdr_t) + (segments.size() * sizeof(phdr_t)));
+		for(auto& section : sections) {
+			if(&section == &sections.front())
+				continue;
+			image.resize((image.size() + 7U) & ~size_t(7U));
+			section.header.offset(typename T::offset_t(image.size()));
+			if(section.header.type() != elf_shtype_t::NoBits)
+				image.insert(image.end(), section.contents.begin(), section.contents.end());
+		}
+		image.resize((image.size() + 7U) & ~size_t(7U));
+		const size_t shoff{image.size()};
+
+		/* Counts too large for the ehdr_t get escaped into section 0 */
+		const bool extended_shnum{sections.size() >= size_t(elf_shns_t::LowReserve)};
+		const bool extended_shstrndx{shstrndx >= size_t(elf_shns_t::LowReserve)};
+		const bool extended_phnum{segments.size() >= elf_pn_xnum};
+		if(extended_shnum)
+			sections.front().header.size(typename T::xword_t(sections.size()));
+		if(extended_shstrndx)
+			sections.front().header.link(uint32_t(shstrndx));
+		if(extended_phnum)
+			sections.front().header.info(uint32_t(segments.size()));
+		for(const auto& section : sections) {
+			const auto* header = reinterpret_cast<const uint8_t*>(&section.header); // lgtm[cpp/reinterpret-cast]
+			image.insert(image.end(), header, header + sizeof(shdr_t));
+		}
+
+		for(size_t idx{}; idx < segments.size(); ++idx) {
+			auto& segment = segments[idx];
+			const auto& first = sections[segment.first].header;
+			const auto& last = sections[segment.last].header;
+			segment.header.offset(first.offset());
+			segment.header.vaddr(first.addr());
+			segment.header.paddr(first.addr());
+			const uint64_t file_end = last.offset() +
+				((last.type() == elf_shtype_t::NoBits) ? 0U : last.size());
+			segment.header.filesz(typename T::xword_t(file_end - first.offset()));
+			segment.header.memsize(typename T::xword_t((last.addr() + last.size()) - first.addr()));
+			std::memcpy(image.data() + sizeof(ehdr_t) + (idx * sizeof(phdr_t)), &segment.header, sizeof(phdr_t));
+		}
+
+		elf_magic_t magic{};
+		magic.set();
+		ehdr_t ehdr{};
+		ehdr.ident({magic, (sizeof(typename T::addr_t) == 8) ? elf_class_t::ELF64 : elf_class_t::ELF32,
+			elf_data_t::LSB, elf_ident_version_t::Current, elf_osabi_t::SystemV, 0});
+		ehdr.type(type);
+		ehdr.machine(machine);
+		ehdr.version(elf_version_t::Current);
+		ehdr.phoff(segments.empty() ? 0 : typename T::offset_t(sizeof(ehdr_t)));
+		ehdr.shoff(typename T::offset_t(shoff));
+		ehdr.ehsize(sizeof(ehdr_t));
+		ehdr.phentsize(sizeof(phdr_t));
+		ehdr.phnum(typename T::half_t(extended_phnum ? elf_pn_xnum : segments.size()));
+		ehdr.shentsize(sizeof(shdr_t));
+		ehdr.shnum(typename T::half_t(extended_shnum ? 0U : sections.size()));
+		ehdr.shstrndx(typename T::half_t(extended_shstrndx ? size_t(elf_shns_t::XIndex) : shstrndx));
+		std::memcpy(image.data(), &ehdr, sizeof(ehdr_t));
+		return image;
+	}
+
+	fs::path write(const std::string& name) {
+		const auto image = build();
+		const fs::path path{fs::temp_directory_path() / ("sns-test-" + name)};
+		std::ofstream file{path, std::ios::binary | std::ios::trunc};
+		file.write(reinterpret_cast<const char*>(image.data()), std::streamsize(image.size())); // lgtm[cpp/reinterpret-cast]
+		return path;
+	}
+};
+
+#endif /* __SNS_TEST_ELF_IMAGE_HH__ */
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <address_index.hh>
+
+/* What the index should be doing, the slow way, over ranges that have already been clipped */
+static uint64_t brute_force_offset(const std::vector<address_range_t>& ranges, const uint64_t address) {
+	for(const auto& range : ranges) {
+		if(range.contains_address(address))
+			return ((address - range.address) < range.file_size) ?
+				range.offset + (address - range.address) : address_index_t::npos;
+	}
+	return address_index_t::npos;
+}
+
+static uint64_t brute_force_address(const std::vector<address_range_t>& ranges, const uint64_t offset) {
+	for(const auto& range : ranges) {
+		/* Sorted by address, so the first hit is the lowest */
+		if(range.contains_offset(offset))
+			return range.address + (offset - range.offset);
+	}
+	return address_index_t::npos;
+}
+
+TEST_CASE( "Address index", "[address_index]" ) {
+	SECTION( "Empty" ) {
+		address_index_t index{};
+		REQUIRE(index.empty());
+		REQUIRE(index.find_address(0x1000) == nullptr);
+		REQUIRE(index.to_offset(0x1000) == address_index_t::npos);
+		REQUIRE(index.to_address(0) == address_index_t::npos);
+	}
+
+	SECTION( "Segments" ) {
+		/* A typical executable, the text and data segments both mapping the page between them */
+		address_index_t index{{
+			{0x404E10, 0x3E10, 0x220, 0x1000, 3},
+			{0x400000, 0x0000, 0x3E80, 0x3E80, 2},
+		}};
+		REQUIRE(index.size() == 2);
+
+		REQUIRE(index.to_offset(0x3FFFFF) == address_index_t::npos);
+		REQUIRE(index.to_offset(0x400000) == 0);
+		REQUIRE(index.to_offset(0x401234) == 0x1234);
+		REQUIRE(index.find_address(0x403E80) == nullptr);
+		REQUIRE(index.find_address(0x404E10)->index == 3);
+		REQUIRE(index.to_offset(0x404E20) == 0x3E20);
+		REQUIRE(index.to_offset(0x40502F) == 0x402F);
+		/* .bss */
+		REQUIRE(index.find_address(0x405030)->index == 3);
+		REQUIRE(index.to_offset(0x405030) == address_index_t::npos);
+		REQUIRE(index.find_address(0x405E10) == nullptr);
+
+		REQUIRE(index.to_address(0x1234) == 0x401234);
+		/* Loaded twice as far as the file goes, the lower address wins */
+		REQUIRE(index.to_address(0x3E20) == 0x403E20);
+		REQUIRE(index.to_address(0x3E80) == 0x404E80);
+		REQUIRE(index.to_address(0x4030) == address_index_t::npos);
+
+		REQUIRE(index.file_extent(0x400000) == 0x3E80);
+		REQUIRE(index.file_extent(0x405000) == 0x30);
+		REQUIRE(index.file_extent(0x405030) == 0);
+	}
+
+	SECTION( "Overlapping memory" ) {
+		address_index_t index{{
+			{0x2000, 0x100, 0x800, 0x1000, 1},
+			{0x1000, 0x000, 0x1800, 0x1800, 0},
+			{0x2000, 0x900, 0x000, 0x0000, 2},
+		}};
+		/* The empty one is dropped, the first is cut short where the next starts */
+		REQUIRE(index.size() == 2);
+		REQUIRE(index.ranges()[0].mem_size == 0x1000);
+		REQUIRE(index.ranges()[0].file_size == 0x1000);
+		REQUIRE(index.to_offset(0x1FFF) == 0xFFF);
+		REQUIRE(index.to_offset(0x2000) == 0x100);
+		REQUIRE(index.to_offset(0x2800) == address_index_t::npos);
+		REQUIRE(index.to_address(0x1000) == address_index_t::npos);
+		REQUIRE(index.to_address(0x100) == 0x1100);
+	}
+
+	SECTION( "Shared file ranges" ) {
+		address_index_t index{{
+			{0x10000, 0x000, 0x800, 0x800, 0},
+			{0x20000, 0x400, 0x800, 0x800, 1},
+			{0x08000, 0x600, 0x100, 0x100, 2},
+		}};
+		REQUIRE(index.to_address(0x3FF) == 0x103FF);
+		REQUIRE(index.to_address(0x400) == 0x10400);
+		REQUIRE(index.to_address(0x650) == 0x08050);
+		REQUIRE(index.to_address(0x700) == 0x10700);
+		REQUIRE(index.to_address(0x800) == 0x20400);
+
+		/* The previous hit isn't where these belong even though it covers them */
+		const std::vector<uint64_t> offsets{0x500, 0x650, 0x7FF, 0xBFF, 0xC00};
+		std::vector<uint64_t> addresses(offsets.size());
+		index.to_addresses(offsets.data(), offsets.size(), addresses.data());
+		REQUIRE(addresses == std::vector<uint64_t>{0x10500, 0x08050, 0x107FF, 0x207FF, address_index_t::npos});
+	}
+
+	SECTION( "Matches a linear scan" ) {
+		std::mt19937_64 rng{0xA5A5A5A5U};
+		std::vector<address_range_t> ranges{};
+		uint64_t address{0x10000};
+		uint64_t offset{};
+		for(uint32_t idx{}; idx < 2000; ++idx) {
+			address += (rng() % 4 == 0) ? 0 : (rng() % 0x400);
+			const uint64_t mem_size{(rng() % 0x800) + 1};
+			const uint64_t file_size{(rng() % 8 == 0) ? 0 : (rng() % mem_size) + 1};
+			/* Every so often reload some of what came before */
+			if(rng() % 4 == 0 && offset > 0x1000)
+				offset -= rng() % 0x1000;
+			ranges.push_back({address, offset, file_size, mem_size, idx});
+			address += mem_size;
+			offset += file_size;
+		}
+
+		std::vector<address_range_t> shuffled{ranges};
+		std::shuffle(shuffled.begin(), shuffled.end(), rng);
+		address_index_t index{shuffled};
+		REQUIRE(index.size() == ranges.size());
+
+		std::vector<uint64_t> addresses(4099);
+		for(auto& addr : addresses)
+			addr = 0x10000 - 16 + (rng() % (address - 0x10000 + 32));
+		std::vector<uint64_t> offsets(4099);
+		for(auto& off : offsets)
+			off = rng() % (offset + 32);
+		/* Sorted input is what the batch lookups are expecting */
+		std::sort(addresses.begin() + 2048, addresses.end());
+		std::sort(offsets.begin() + 2048, offsets.end());
+
+		std::vector<uint64_t> batch_offsets(addresses.size());
+		index.to_offsets(addresses.data(), addresses.size(), batch_offsets.data());
+		std::vector<uint64_t> batch_addresses(offsets.size());
+		index.to_addresses(offsets.data(), offsets.size(), batch_addresses.data());
+
+		for(size_t idx{}; idx < addresses.size(); ++idx) {
+			const uint64_t expected{brute_force_offset(ranges, addresses[idx])};
+			REQUIRE(index.to_offset(addresses[idx]) == expected);
+			REQUIRE(batch_offsets[idx] == expected);
+		}
+		for(size_t idx{}; idx < offsets.size(); ++idx) {
+			const uint64_t expected{brute_force_address(ranges, offsets[idx])};
+			REQUIRE(index.to_address(offsets[idx]) == expected);
+			REQUIRE(batch_addresses[idx] == expected);
+		}
+	}
+}
@@ -0,0 +1,223 @@
+#include <array>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <codec.hh>
+#include <utility.hh>
+
+static const std::string codec_text{
+	"Slice 'N Splice (SNS) is an application that encourages gross abuse of object files in all "
+	"their forms, mix and match them as you please. Slice 'N Splice (SNS) is an application that "
+	"encourages gross abuse of object files in all their forms, mix and match them as you please."
+};
+
+static void codec_round_trip(const codec_t& codec) {
+	const auto* input = reinterpret_cast<const uint8_t*>(codec_text.data());
+	/*
+		Both ends and the defaults, stepping across the range would take
+		zstd's hundreds of thousands of negative levels one at a time
+	*/
+	const std::array<int32_t, 5> levels{{codec.min_level(), -1, 1, codec.default_level(), codec.max_level()}};
+	for(const int32_t level : levels) {
+		/* zlib has no negative levels */
+		if(level < codec.min_level() || level > codec.max_level())
+			continue;
+		auto compressed = codec.compress(input, codec_text.size(), level);
+		REQUIRE(compressed.size() > 0);
+		/* The negative levels trade away too much ratio to shrink text this short */
+		if(level > 0)
+			REQUIRE(compressed.size() < codec_text.size());
+
+		std::vector<uint8_t> output(codec_text.size());
+		REQUIRE(codec.decompress(compressed.data(), compressed.size(), output.data(), output.size()));
+		REQUIRE(std::memcmp(output.data(), input, output.size()) == 0);
+
+		/* Being told the wrong size is an error */
+		std::vector<uint8_t> larger(codec_text.size() + 1);
+		REQUIRE_FALSE(codec.decompress(compressed.data(), compressed.size(), larger.data(), larger.size()));
+	}
+}
+
+TEST_CASE( "Codec lookup", "[codec]" ) {
+	REQUIRE(get_codec(codec_type_t::None) == nullptr);
+	REQUIRE(codec_available(codec_type_t::Zlib));
+	REQUIRE(get_codec(codec_type_t::Zlib)->type() == codec_type_t::Zlib);
+#if defined(SNS_WITH_ZSTD)
+	REQUIRE(codec_available(codec_type_t::Zstd));
+#else
+	REQUIRE_FALSE(codec_available(codec_type_t::Zstd));
+#endif
+}
+
+TEST_CASE( "Zlib codec", "[codec]" ) {
+	codec_round_trip(*get_codec(codec_type_t::Zlib));
+}
+
+#if defined(SNS_WITH_ZSTD)
+TEST_CASE( "Zstd codec", "[codec]" ) {
+	codec_round_trip(*get_codec(codec_type_t::Zstd));
+}
+#endif
+
+TEST_CASE( "Byte entropy", "[codec]" ) {
+	std::vector<uint8_t> zeros(4_KiB);
+	REQUIRE(byte_entropy(zeros.data(), zeros.size()) == Approx(0.0));
+
+	std::vector<uint8_t> uniform(256 * 16);
+	for(size_t idx{}; idx < uniform.size(); ++idx)
+		uniform[idx] = uint8_t(idx);
+	REQUIRE(byte_entropy(uniform.data(), uniform.size()) == Approx(8.0));
+
+	REQUIRE(byte_entropy(nullptr, 0) == Approx(0.0));
+}
+
+TEST_CASE( "Compression policy", "[codec]" ) {
+	compression_policy_t policy{};
+	const codec_t* codec{policy.codec()};
+	REQUIRE(codec != nullptr);
+
+	SECTION( "Random data is skipped without a trial" ) {
+		std::mt19937 rng{0x1B4DB007U};
+		std::vector<uint8_t> noise(256_KiB);
+		for(auto& byte : noise)
+			byte = uint8_t(rng());
+
+		auto choice = policy.choose(noise.data(), noise.size());
+		REQUIRE(choice.codec == codec_type_t::None);
+		REQUIRE(choice.entropy > policy.max_entropy());
+		REQUIRE(choice.ratio == Approx(1.0));
+	}
+
+	SECTION( "Small buffers are skipped" ) {
+		auto choice = policy.choose(reinterpret_cast<const uint8_t*>(codec_text.data()), policy.min_size() - 1);
+		REQUIRE(choice.codec == codec_type_t::None);
+	}
+
+	SECTION( "Highly compressible data gets the strong level" ) {
+		std::string text{};
+		while(text.size() < 256_KiB)
+			text += codec_text;
+
+		auto choice = policy.choose(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+		REQUIRE(choice.codec == codec->type());
+		REQUIRE(choice.level == codec->strong_level());
+		REQUIRE(choice.ratio < policy.strong_ratio());
+	}
+
+	SECTION( "Marginally compressible data gets the fast level" ) {
+		/* Random bytes restricted to a 128 symbol alphabet only compress ~12% */
+		std::mt19937 rng{0x7B04D1BU};
+		std::vector<uint8_t> data(256_KiB);
+		for(auto& byte : data)
+			byte = uint8_t(rng() & 0x7FU);
+
+		auto choice = policy.choose(data.data(), data.size());
+		REQUIRE(choice.codec == codec->type());
+		REQUIRE(choice.level == codec->fast_level());
+	}
+
+	SECTION( "Falls back to zlib if the preferred codec is missing" ) {
+		policy.preferred(codec_type_t::None);
+		REQUIRE(policy.codec()->type() == codec_type_t::Zlib);
+	}
+}
+
+/* Lots of small, nearly identical buffers, like the same section across builds */
+static std::vector<std::string> dictionary_corpus(const size_t count) {
+	std::mt19937 rng{0xD1C7U};
+	std::vector<std::string> corpus{};
+	for(size_t idx{}; idx < count; ++idx) {
+		corpus.push_back(
+			"GCC: (GNU) 9.2.0 build " + std::to_string(rng() % 100000) + " " +
+			"/usr/src/slice-n-splice/src/elf.cc:" + std::to_string(rng() % 4096) + " " +
+			codec_text.substr(0, 96 + (rng() % 64)) + " " + std::to_string(rng())
+		);
+	}
+	return corpus;
+}
+
+static std::vector<span<const uint8_t>> dictionary_samples(const std::vector<std::string>& corpus) {
+	std::vector<span<const uint8_t>> samples{};
+	for(const auto& entry : corpus)
+		samples.emplace_back(reinterpret_cast<const uint8_t*>(entry.data()), entry.size());
+	return samples;
+}
+
+static void codec_dictionary(const codec_t& codec, const size_t capacity) {
+	const auto corpus = dictionary_corpus(1000);
+	const auto dictionary = codec.train(dictionary_samples(corpus), capacity);
+	REQUIRE_FALSE(dictionary.empty());
+	REQUIRE(dictionary.codec() == codec.type());
+	REQUIRE(dictionary.id() != 0);
+	REQUIRE(dictionary.contents().size() <= capacity);
+
+	/* Something that wasn't part of the training set */
+	const std::string entry{dictionary_corpus(1001).back()};
+	const auto* input = reinterpret_cast<const uint8_t*>(entry.data());
+
+	const auto plain = codec.compress(input, entry.size(), codec.default_level());
+	const auto compressed = codec.compress(input, entry.size(), codec.default_level(), dictionary);
+	REQUIRE(compressed.size() > 0);
+	REQUIRE(compressed.size() < plain.size());
+	REQUIRE(codec.dictionary_id(compressed.data(), compressed.size()) == dictionary.id());
+	REQUIRE(codec.dictionary_id(plain.data(), plain.size()) == 0);
+
+	std::vector<uint8_t> output(entry.size());
+	REQUIRE(codec.decompress(compressed.data(), compressed.size(), output.data(), output.size(), dictionary));
+	REQUIRE(std::memcmp(output.data(), input, output.size()) == 0);
+
+	/* Needs the dictionary, and the right one at that */
+	REQUIRE_FALSE(codec.decompress(compressed.data(), compressed.size(), output.data(), output.size()));
+	REQUIRE_FALSE(codec.decompress(compressed.data(), compressed.size(), output.data(), output.size(),
+		codec_dictionary_t{}));
+
+	/* Reloading the raw contents gives back the same ID */
+	REQUIRE(codec.dictionary(dictionary.contents()).id() == dictionary.id());
+
+	dictionary_store_t store{};
+	REQUIRE_FALSE(store.decompress(codec.type(), compressed.data(), compressed.size(), output.data(), output.size()));
+	auto stored = store.add(dictionary);
+	REQUIRE(stored);
+	REQUIRE(store.add(dictionary) == stored);
+	REQUIRE(store.count() == 1);
+	REQUIRE(store.find(codec.type(), dictionary.id()) == stored);
+	REQUIRE_FALSE(store.find(codec_type_t::None, dictionary.id()));
+
+	std::fill(output.begin(), output.end(), 0);
+	REQUIRE(store.decompress(codec.type(), compressed.data(), compressed.size(), output.data(), output.size()));
+	REQUIRE(std::memcmp(output.data(), input, output.size()) == 0);
+	/* Plain data goes straight through */
+	REQUIRE(store.decompress(codec.type(), plain.data(), plain.size(), output.data(), output.size()));
+}
+
+TEST_CASE( "Zlib dictionaries", "[codec]" ) {
+	codec_dictionary(*get_codec(codec_type_t::Zlib), 4_KiB);
+
+	SECTION( "Nothing in common" ) {
+		std::mt19937 rng{0x5EEDU};
+		std::vector<std::vector<uint8_t>> noise(16, std::vector<uint8_t>(1_KiB));
+		std::vector<span<const uint8_t>> samples{};
+		for(auto& sample : noise) {
+			for(auto& byte : sample)
+				byte = uint8_t(rng());
+			samples.emplace_back(sample.data(), sample.size());
+		}
+		REQUIRE(get_codec(codec_type_t::Zlib)->train(samples).empty());
+	}
+
+	SECTION( "Empty dictionaries aren't stored" ) {
+		dictionary_store_t store{};
+		REQUIRE_FALSE(store.add(codec_dictionary_t{}));
+		REQUIRE(store.count() == 0);
+	}
+}
+
+#if defined(SNS_WITH_ZSTD)
+TEST_CASE( "Zstd dictionaries", "[codec]" ) {
+	codec_dictionary(*get_codec(codec_type_t::Zstd), 4_KiB);
+}
+#endif
@@ -0,0 +1,283 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "elf-image.hh"
+
+#include <dwarf.hh>
+#include <elf.hh>
+
+/* Just enough of an assembler to put DWARF together by hand */
+struct dwarf_writer_t final {
+	std::vector<uint8_t> data{};
+
+	template<typename U>
+	dwarf_writer_t& put(const U value) {
+		const auto* bytes = reinterpret_cast<const uint8_t*>(&value); // lgtm[cpp/reinterpret-cast]
+		data.insert(data.end(), bytes, bytes + sizeof(U));
+		return *this;
+	}
+	dwarf_writer_t& bytes(const std::vector<uint8_t>& values) {
+		data.insert(data.end(), values.begin(), values.end());
+		return *this;
+	}
+	dwarf_writer_t& str(const std::string& value) {
+		data.insert(data.end(), value.begin(), value.end());
+		data.push_back(0);
+		return *this;
+	}
+	dwarf_writer_t& uleb(uint64_t value) {
+		do {
+			const auto byte = uint8_t(value & 0x7FU);
+			value >>= 7U;
+			data.push_back(byte | ((value != 0) ? 0x80U : 0U));
+		} while(value != 0);
+		return *this;
+	}
+	dwarf_writer_t& sleb(int64_t value) {
+		for(bool more{true}; more;) {
+			const auto byte = uint8_t(value & 0x7F);
+			value >>= 7;
+			more = !((value == 0 && (byte & 0x40U) == 0) || (value == -1 && (byte & 0x40U) != 0));
+			data.push_back(byte | (more ? 0x80U : 0U));
+		}
+		return *this;
+	}
+	dwarf_writer_t& set_address(const uint64_t address) {
+		return bytes({0x00U, 9U, 0x02U}).put(address);
+	}
+	dwarf_writer_t& end_sequence() { return bytes({0x00U, 1U, 0x01U}); }
+
+	/* Patches the 32-bit unit_length at `offset` to run to the end */
+	void finish(const size_t offset) {
+		const auto length = uint32_t(data.size() - offset - sizeof(uint32_t));
+		std::memcpy(data.data() + offset, &length, sizeof(uint32_t));
+	}
+};
+
+/*
+	Two CUs, a DWARF 4 one with a.c and b.h whose sequences are out of order
+	and a DWARF 5 one with c.c, along with the .debug_info, .debug_abbrev,
+	and .debug_aranges to get to them.
+*/
+struct dwarf_fixture_t final {
+	dwarf_writer_t info{};
+	dwarf_writer_t abbrev{};
+	dwarf_writer_t aranges{};
+	dwarf_writer_t line{};
+	dwarf_writer_t line_str{};
+	size_t v5_line{};
+	size_t v5_unit{};
+
+	dwarf_fixture_t() {
+		/* DW_TAG_compile_unit, DW_AT_name as a string, DW_AT_stmt_list */
+		abbrev.uleb(1).uleb(0x11U).put(uint8_t{0}).uleb(0x03U).uleb(0x08U).uleb(0x10U).uleb(0x17U)
+			.uleb(0).uleb(0).uleb(0);
+		line_str.str("/work");
+
+		const std::vector<uint8_t> opcode_lengths{0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1};
+		line.put(uint32_t{}).put(uint16_t{4}).put(uint32_t{});
+		const size_t v4_header{line.data.size()};
+		line.bytes({1U, 1U, 1U}).put(int8_t{-5}).bytes({14U, 13U}).bytes(opcode_lengths);
+		line.str("src").put(uint8_t{0});
+		line.str("a.c").uleb(1).uleb(0).uleb(0).str("b.h").uleb(0).uleb(0).uleb(0).put(uint8_t{0});
+		const auto v4_header_length = uint32_t(line.data.size() - v4_header);
+		std::memcpy(line.data.data() + v4_header - sizeof(uint32_t), &v4_header_length, sizeof(uint32_t));
+		line.set_address(0x1000U).put(uint8_t{0x03U}).sleb(9).put(uint8_t{0x01U});
+		line.bytes({0x02U, 0x10U, 0x03U, 0x02U, 0x05U, 0x05U, 0x01U});
+		line.bytes({0x04U, 0x02U, 0x02U, 0x08U, 0x01U, 0x02U, 0x08U}).end_sequence();
+		/* Special opcode 75, +4 bytes and +1 line */
+		line.set_address(0x800U).bytes({0x01U, 75U, 0x02U, 0x04U}).end_sequence();
+		line.finish(0);
+
+		v5_line = line.data.size();
+		line.put(uint32_t{}).put(uint16_t{5}).bytes({8U, 0U}).put(uint32_t{});
+		const size_t v5_header{line.data.size()};
+		line.bytes({1U, 1U, 1U}).put(int8_t{-5}).bytes({14U, 13U}).bytes(opcode_lengths);
+		/* DW_LNCT_path as line_strp, then DW_LNCT_path as a string and DW_LNCT_directory_index */
+		line.put(uint8_t{1}).uleb(1).uleb(0x1FU).uleb(1).put(uint32_t{0});
+		line.put(uint8_t{2}).uleb(1).uleb(0x08U).uleb(2).uleb(0x0FU).uleb(1).str("c.c").uleb(0);
+		const auto v5_header_length = uint32_t(line.data.size() - v5_header);
+		std::memcpy(line.data.data() + v5_header - sizeof(uint32_t), &v5_header_length, sizeof(uint32_t));
+		line.set_address(0x2000U).bytes({0x04U, 0x00U, 0x03U}).sleb(99).bytes({0x01U, 0x02U, 0x20U}).end_sequence();
+		line.finish(v5_line);
+
+		info.put(uint32_t{}).put(uint16_t{4}).put(uint32_t{0}).put(uint8_t{8}).uleb(1).str("a.c").put(uint32_t{0});
+		info.finish(0);
+		v5_unit = info.data.size();
+		info.put(uint32_t{}).put(uint16_t{5}).bytes({0x01U, 8U}).put(uint32_t{0}).uleb(1).str("c.c")
+			.put(uint32_t(v5_line));
+		info.finish(v5_unit);
+
+		const auto add_set = [this](const size_t unit, const std::vector<std::pair<uint64_t, uint64_t>>& tuples) {
+			const size_t offset{aranges.data.size()};
+			aranges.put(uint32_t{}).put(uint16_t{2}).put(uint32_t(unit)).bytes({8U, 0U}).put(uint32_t{0});
+			for(const auto& tuple : tuples)
+				aranges.put(tuple.first).put(tuple.second);
+			aranges.put(uint64_t{0}).put(uint64_t{0});
+			aranges.finish(offset);
+		};
+		add_set(0, {{0x1000U, 0x20U}, {0x800U, 0x8U}});
+		add_set(v5_unit, {{0x2000U, 0x20U}});
+	}
+
+	[[nodiscard]]
+	dwarf_sections_t sections(const bool with_aranges = true) const {
+		return {
+			{info.data.data(), info.data.size()},
+			{abbrev.data.data(), abbrev.data.size()},
+			with_aranges ? span<const uint8_t>{aranges.data.data(), aranges.data.size()} : span<const uint8_t>{},
+			{line.data.data(), line.data.size()},
+			{line_str.data.data(), line_str.data.size()},
+			{}
+		};
+	}
+};
+
+static void check_lines(const dwarf_line_index_t& index) {
+	dwarf_line_t line{};
+	REQUIRE(index.find(0x1000U, line));
+	REQUIRE(line.directory == "src");
+	REQUIRE(line.file == "a.c");
+	REQUIRE(line.line == 10);
+	REQUIRE(index.find(0x100FU, line));
+	REQUIRE(line.line == 10);
+	REQUIRE(index.find(0x1010U, line));
+	REQUIRE(line.line == 12);
+	REQUIRE(line.column == 5);
+	REQUIRE(index.find(0x101CU, line));
+	REQUIRE(line.directory.empty());
+	REQUIRE(line.file == "b.h");
+	REQUIRE(index.find(0x803U, line));
+	REQUIRE(line.line == 1);
+	REQUIRE(index.find(0x804U, line));
+	REQUIRE(line.line == 2);
+	REQUIRE(index.find(0x2010U, line));
+	REQUIRE(line.directory == "/work");
+	REQUIRE(line.file == "c.c");
+	REQUIRE(line.line == 100);
+
+	REQUIRE_FALSE(index.find(0x1020U, line));
+	REQUIRE(line.line == 0);
+	REQUIRE(line.file.empty());
+	REQUIRE_FALSE(index.find(0x7FFU, line));
+	REQUIRE_FALSE(index.find(0x3000U, line));
+
+	const std::vector<uint64_t> addresses{0x2010U, 0x1000U, 0x3000U, 0x804U, 0x101CU, 0x1000U};
+	std::vector<dwarf_line_t> results(addresses.size());
+	index.find(addresses.data(), addresses.size(), results.data());
+	for(size_t idx{}; idx < addresses.size(); ++idx) {
+		dwarf_line_t single{};
+		(void)index.find(addresses[idx], single);
+		REQUIRE(results[idx].file == single.file);
+		REQUIRE(results[idx].directory == single.directory);
+		REQUIRE(results[idx].line == single.line);
+		REQUIRE(results[idx].column == single.column);
+	}
+}
+
+TEST_CASE( "DWARF aranges and stmt_list", "[dwarf]" ) {
+	const dwarf_fixture_t fixture{};
+	const auto sections = fixture.sections();
+
+	const auto aranges = decode_aranges(sections.aranges);
+	REQUIRE(aranges.size() == 3);
+	REQUIRE(aranges[1].address == 0x800U);
+	REQUIRE(aranges[1].length == 0x8U);
+	REQUIRE(aranges[2].unit == fixture.v5_unit);
+
+	uint64_t offset{};
+	REQUIRE(decode_stmt_list(sections.info, sections.abbrev, 0, offset));
+	REQUIRE(offset == 0);
+	REQUIRE(decode_stmt_list(sections.info, sections.abbrev, fixture.v5_unit, offset));
+	REQUIRE(offset == fixture.v5_line);
+	REQUIRE_FALSE(decode_stmt_list(sections.info, sections.abbrev, fixture.v5_unit + 1U, offset));
+	REQUIRE_FALSE(decode_stmt_list(sections.info, {}, 0, offset));
+}
+
+TEST_CASE( "DWARF line tables", "[dwarf]" ) {
+	const dwarf_fixture_t fixture{};
+	const auto sections = fixture.sections();
+
+	dwarf_line_table_t table{};
+	REQUIRE(decode_line_table(sections, 0, table));
+	REQUIRE(table.files.size() == 3);
+	REQUIRE(table.files[1].name == "a.c");
+	REQUIRE(table.files[1].directory == "src");
+	/* Sequences sorted, each with its end row */
+	REQUIRE(table.rows.size() == 7);
+	REQUIRE(table.rows[0].address == 0x800U);
+	REQUIRE(table.rows[2].file == dwarf_line_row_t::end_sequence);
+	REQUIRE(table.rows[2].address == 0x808U);
+	REQUIRE(table.rows[3].address == 0x1000U);
+	REQUIRE(table.find(0x808U) == nullptr);
+	REQUIRE(table.find(0x1018U)->file == 2);
+
+	REQUIRE(decode_line_table(sections, fixture.v5_line, table));
+	REQUIRE(table.files.size() == 1);
+	REQUIRE(table.files[0].directory == "/work");
+	REQUIRE(table.rows.size() == 2);
+
+	REQUIRE_FALSE(decode_line_table(sections, fixture.v5_line + 1U, table));
+	REQUIRE_FALSE(decode_line_table(sections, fixture.line.data.size() + 1U, table));
+}
+
+TEST_CASE( "DWARF line index", "[dwarf]" ) {
+	const dwarf_fixture_t fixture{};
+
+	SECTION( "From .debug_aranges" ) {
+		const dwarf_line_index_t index{fixture.sections()};
+		REQUIRE(index.ranges().size() == 3);
+		REQUIRE(index.cache().count() == 0);
+		check_lines(index);
+		REQUIRE(index.cache().count() == 2);
+	}
+
+	SECTION( "Without .debug_aranges" ) {
+		const dwarf_line_index_t index{fixture.sections(false)};
+		REQUIRE(index.ranges().size() == 3);
+		/* Everything had to be decoded to get the ranges, and it's all kept */
+		REQUIRE(index.cache().count() == 2);
+		check_lines(index);
+	}
+
+	SECTION( "Nothing is retained past the cache limit" ) {
+		const dwarf_line_index_t index{fixture.sections(), 0};
+		check_lines(index);
+		REQUIRE(index.cache().count() == 0);
+		REQUIRE(index.cache().size() == 0);
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Source lines", "[elf][dwarf]", elf_types_32_t, elf_types_64_t ) {
+	const dwarf_fixture_t fixture{};
+	const auto compressed = elf_t<TestType>::compress_section(
+		{fixture.line.data.data(), fixture.line.data.size()}, elf_chdr_type_t::Zlib, 1);
+	REQUIRE_FALSE(compressed.empty());
+
+	elf_image_t<TestType> image{};
+	image.type = elf_type_t::Executable;
+	image.add_section(".debug_info", elf_shtype_t::ProgBits, fixture.info.data);
+	image.add_section(".debug_abbrev", elf_shtype_t::ProgBits, fixture.abbrev.data);
+	image.add_section(".debug_aranges", elf_shtype_t::ProgBits, fixture.aranges.data);
+	image.add_section(".debug_line", elf_shtype_t::ProgBits, compressed, TestType::shflags_t::Compressed);
+	image.add_section(".debug_line_str", elf_shtype_t::ProgBits, fixture.line_str.data);
+	const auto path = image.write("source-lines");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	/* Inflating for the index doesn't tie up the section cache */
+	elf.section_cache_limit(0);
+	check_lines(elf.line_index());
+
+	dwarf_line_t line{};
+	REQUIRE(elf.find_line(0x1010U, line));
+	REQUIRE(line.file == "a.c");
+	const std::vector<uint64_t> addresses{0x2000U, 0x800U};
+	std::vector<dwarf_line_t> results(addresses.size());
+	elf.find_lines(addresses.data(), addresses.size(), results.data());
+	REQUIRE(results[0].line == 100);
+	REQUIRE(results[1].line == 1);
+}
@@ -2,9 +2,14 @@
 #include <iostream>
 #include <type_traits>
 #include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
 
 #include <catch2/catch.hpp>
 
+#include "elf-image.hh"
+
 #include <zlib.hh>
 #include <elf.hh>
 #include <utility.hh>
@@ -83,3 +88,1929 @@ TEST_CASE( "ELF File Test", "[elf]" ) {
 
 	REQUIRE(self.header().shnum() == self.sheaders().size());
 }
+
+static const std::string section_text{
+	"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+	"incididunt ut labore et dolore magna aliqua. Lorem ipsum dolor sit amet, consectetur "
+	"adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua."
+};
+
+template<typename T>
+static std::vector<uint8_t> compressed_section(const std::string& contents) {
+	typename T::chdr_t chdr{};
+	chdr.type(elf_chdr_type_t::Zlib);
+	chdr.size(contents.size());
+	chdr.addr_align(1);
+
+	std::vector<uint8_t> section(sizeof(chdr));
+	std::memcpy(section.data(), &chdr, sizeof(chdr));
+	auto payload = zlib_t::deflate_buffer(reinterpret_cast<const uint8_t*>(contents.data()), contents.size());
+	section.insert(section.end(), payload.begin(), payload.end());
+	return section;
+}
+
+TEMPLATE_TEST_CASE( "ELF Section contents", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	elf_image_t<TestType> image{};
+	const auto plain = image.add_section(".text", elf_shtype_t::ProgBits,
+		section_text.data(), section_text.size());
+	const auto compressed = image.add_section(".debug_str", elf_shtype_t::ProgBits,
+		compressed_section<TestType>(section_text), TestType::shflags_t::Compressed);
+	const auto path = image.write("section-contents");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+
+	SECTION( "Uncompressed sections are passed straight through" ) {
+		auto view = elf.section_data(plain);
+		REQUIRE_FALSE(view.compressed());
+		REQUIRE(view.size() == section_text.size());
+		REQUIRE(std::string(reinterpret_cast<const char*>(view.data().data()), view.data().size()) == section_text);
+		REQUIRE(elf.section_cache().count() == 0);
+	}
+
+	SECTION( "Compressed sections are inflated on first access" ) {
+		auto view = elf.section_data(compressed);
+		REQUIRE(view.compressed());
+		REQUIRE(view.compression() == elf_chdr_type_t::Zlib);
+		REQUIRE(view.size() == section_text.size());
+		REQUIRE(elf.section_cache().count() == 0);
+
+		auto contents = view.data();
+		REQUIRE(std::string(reinterpret_cast<const char*>(contents.data()), contents.size()) == section_text);
+		REQUIRE(elf.section_cache().count() == 1);
+
+		/* A second view is served from the cache */
+		REQUIRE(elf.section_data(compressed).data().data() == contents.data());
+	}
+
+	SECTION( "Sections larger than the cache are not retained" ) {
+		elf.section_cache_limit(section_text.size() - 1);
+		auto view = elf.section_data(compressed);
+		REQUIRE(view.data().size() == section_text.size());
+		REQUIRE(elf.section_cache().count() == 0);
+	}
+
+	SECTION( "Out of range sections are empty" ) {
+		REQUIRE(elf.section_data(elf.sheaders().size()).data().empty());
+	}
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Section compression", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	const span<const uint8_t> contents{reinterpret_cast<const uint8_t*>(section_text.data()), section_text.size()};
+
+	for(const auto type : { elf_chdr_type_t::Zlib, elf_chdr_type_t::Zstd }) {
+		auto section = elf_t<TestType>::compress_section(contents, type, 4);
+		if(!codec_available(elf_chdr_codec(type))) {
+			REQUIRE(section.empty());
+			continue;
+		}
+		REQUIRE(section.size() < section_text.size());
+
+		elf_image_t<TestType> image{};
+		const auto index = image.add_section(".debug_info", elf_shtype_t::ProgBits, section,
+			TestType::shflags_t::Compressed);
+		const auto path = image.write("section-compression");
+
+		elf_t<TestType> elf{path};
+		auto view = elf.section_data(index);
+		REQUIRE(view.compression() == type);
+		REQUIRE(view.addr_align() == 4);
+		REQUIRE(std::string(reinterpret_cast<const char*>(view.data().data()), view.data().size()) == section_text);
+		fs::remove(path);
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Section compression policy", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	compression_policy_t policy{};
+
+	std::string text{};
+	while(text.size() < 64_KiB)
+		text += section_text;
+	const span<const uint8_t> contents{reinterpret_cast<const uint8_t*>(text.data()), text.size()};
+	auto section = elf_t<TestType>::compress_section(contents, 1, policy);
+	REQUIRE_FALSE(section.empty());
+	REQUIRE(section.size() < text.size());
+
+	std::vector<uint8_t> noise(64_KiB);
+	std::mt19937 rng{0xEDF3U};
+	for(auto& byte : noise)
+		byte = uint8_t(rng());
+	REQUIRE(elf_t<TestType>::compress_section({noise.data(), noise.size()}, 1, policy).empty());
+}
+
+template<typename T>
+static std::vector<uint8_t> gnu_compressed_section(const std::string& contents) {
+	auto payload = zlib_t::deflate_buffer(reinterpret_cast<const uint8_t*>(contents.data()), contents.size());
+	std::vector<uint8_t> section(zlib_t::gnu_header_size);
+	zlib_t::write_gnu_header(section.data(), contents.size());
+	section.insert(section.end(), payload.begin(), payload.end());
+	return section;
+}
+
+TEMPLATE_TEST_CASE( "ELF Legacy .zdebug sections", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using elf_type = elf_t<TestType>;
+	using style_t = typename elf_type::compression_style_t;
+
+	elf_image_t<TestType> image{};
+	const auto legacy = image.add_section(".zdebug_info", elf_shtype_t::ProgBits,
+		gnu_compressed_section<TestType>(section_text));
+	const auto modern = image.add_section(".debug_str", elf_shtype_t::ProgBits,
+		compressed_section<TestType>(section_text), TestType::shflags_t::Compressed);
+	/* Has the name, but not the magic */
+	const auto bogus = image.add_section(".zdebug_line", elf_shtype_t::ProgBits,
+		section_text.data(), section_text.size());
+	const auto path = image.write("zdebug");
+
+	elf_type elf{path};
+
+	SECTION( "GNU header" ) {
+		std::array<uint8_t, zlib_t::gnu_header_size> header{};
+		zlib_t::write_gnu_header(header.data(), 0x0102030405060708U);
+		REQUIRE(header == std::array<uint8_t, zlib_t::gnu_header_size>{{
+			'Z', 'L', 'I', 'B', 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+		}});
+		uint64_t size{};
+		REQUIRE(zlib_t::read_gnu_header(header.data(), header.size(), size));
+		REQUIRE(size == 0x0102030405060708U);
+		REQUIRE_FALSE(zlib_t::read_gnu_header(header.data(), header.size() - 1, size));
+	}
+
+	SECTION( "Read transparently" ) {
+		auto view = elf.section_data(legacy);
+		REQUIRE(view.compressed());
+		REQUIRE(view.legacy());
+		REQUIRE(view.size() == section_text.size());
+		REQUIRE(std::string(reinterpret_cast<const char*>(view.data().data()), view.data().size()) == section_text);
+
+		REQUIRE_FALSE(elf.section_data(bogus).compressed());
+	}
+
+	SECTION( "Convert to SHF_COMPRESSED and back" ) {
+		auto rewrites = elf.convert_compressed_sections(style_t::Chdr);
+		REQUIRE(rewrites.size() == 1);
+		REQUIRE(rewrites[0].index == legacy);
+		REQUIRE(rewrites[0].name == ".debug_info");
+		REQUIRE((rewrites[0].flags & TestType::shflags_t::Compressed) == TestType::shflags_t::Compressed);
+
+		elf_image_t<TestType> converted{};
+		const auto index = converted.add_section(rewrites[0].name, elf_shtype_t::ProgBits,
+			rewrites[0].contents, rewrites[0].flags);
+		const auto converted_path = converted.write("zdebug-converted");
+		{
+			elf_type converted_elf{converted_path};
+			auto view = converted_elf.section_data(index);
+			REQUIRE(view.compression() == elf_chdr_type_t::Zlib);
+			REQUIRE_FALSE(view.legacy());
+			REQUIRE(std::string(reinterpret_cast<const char*>(view.data().data()), view.data().size()) == section_text);
+
+			auto back = converted_elf.convert_compressed_sections(style_t::GNU);
+			REQUIRE(back.size() == 1);
+			REQUIRE(back[0].name == ".zdebug_info");
+			REQUIRE(back[0].flags == TestType::shflags_t::None);
+			REQUIRE(back[0].contents == gnu_compressed_section<TestType>(section_text));
+		}
+		fs::remove(converted_path);
+	}
+
+	SECTION( "Convert to GNU" ) {
+		auto rewrites = elf.convert_compressed_sections(style_t::GNU, 4);
+		REQUIRE(rewrites.size() == 1);
+		REQUIRE(rewrites[0].index == modern);
+		REQUIRE(rewrites[0].name == ".zdebug_str");
+	}
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Extended numbering", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+
+	elf_image_t<TestType> image{};
+	std::vector<symbol_t> symbols(3);
+	symbols[1].shndx(uint16_t(elf_shns_t::ABS));
+	symbols[2].shndx(uint16_t(elf_shns_t::XIndex));
+	const auto symtab = image.add_section(".symtab", elf_shtype_t::SymbolTable, symbols,
+		TestType::shflags_t::None, 0, 0, 0, sizeof(symbol_t));
+	std::vector<uint32_t> shndx(3);
+	const auto shndx_index = image.add_section(".symtab_shndx", elf_shtype_t::SymbolTableIndex,
+		nullptr, shndx.size() * sizeof(uint32_t), TestType::shflags_t::None, 0, uint32_t(symtab), 0,
+		sizeof(uint32_t));
+
+	/* Enough to push everything past SHN_LORESERVE and PN_XNUM */
+	while(image.sections.size() < 0x11000U)
+		image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0);
+	const auto target = image.add_section(".target", elf_shtype_t::ProgBits,
+		section_text.data(), section_text.size());
+	for(size_t idx{}; idx < elf_pn_xnum + 1U; ++idx)
+		image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read, target, target);
+
+	shndx[2] = uint32_t(target);
+	image.sections[shndx_index].contents.assign(reinterpret_cast<const uint8_t*>(shndx.data()),
+		reinterpret_cast<const uint8_t*>(shndx.data() + shndx.size()));
+	const auto path = image.write("extended-numbering");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	REQUIRE(elf.header().shnum() == 0);
+	REQUIRE(elf.header().shstrndx() == uint16_t(elf_shns_t::XIndex));
+	REQUIRE(elf.header().phnum() == elf_pn_xnum);
+
+	REQUIRE(elf.shnum() == image.sections.size());
+	REQUIRE(elf.shstrndx() == image.sections.size() - 1);
+	REQUIRE(elf.phnum() == elf_pn_xnum + 1U);
+	REQUIRE(elf.section_name(elf.sheaders()[target].name()) == ".target");
+	REQUIRE(elf.section_name(elf.sheaders()[elf.shstrndx()].name()) == ".shstrtab");
+
+	auto view = elf.section_data(target);
+	REQUIRE(std::string(reinterpret_cast<const char*>(view.data().data()), view.data().size()) == section_text);
+
+	REQUIRE(elf.shndx_table(symtab).size() == shndx.size());
+	REQUIRE(elf.shndx_table(target).size() == 0);
+	REQUIRE(elf.symbol_section(symtab, 0, symbols[0]) == 0);
+	REQUIRE(elf.symbol_section(symtab, 1, symbols[1]) == size_t(elf_shns_t::ABS));
+	REQUIRE(elf.symbol_section(symtab, 2, symbols[2]) == target);
+	/* No entry for it, so it stays escaped */
+	REQUIRE(elf.symbol_section(symtab, 3, symbols[2]) == size_t(elf_shns_t::XIndex));
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Section lookup", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	elf_image_t<TestType> image{};
+	const auto text = image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0);
+	const auto text_foo = image.add_section(".text.foo", elf_shtype_t::ProgBits, nullptr, 0);
+	const auto data = image.add_section(".data", elf_shtype_t::ProgBits, nullptr, 0);
+	const auto text_bar = image.add_section(".text.bar", elf_shtype_t::ProgBits, nullptr, 0);
+	const auto text_again = image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0);
+	const auto path = image.write("section-lookup");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+
+	SECTION( "By name" ) {
+		REQUIRE(elf.find_section(".data") == data);
+		REQUIRE(elf.find_section(".text.bar") == text_bar);
+		REQUIRE(elf.find_section(".shstrtab") == elf.shstrndx());
+		/* Duplicates give the first one */
+		REQUIRE(elf.find_section(".text") == text);
+		REQUIRE(elf.find_section(".bss") == 0);
+		REQUIRE(elf.find_section(".tex") == 0);
+	}
+
+	SECTION( "By prefix" ) {
+		REQUIRE(elf.find_sections(".text.") == std::vector<size_t>{text_foo, text_bar});
+		REQUIRE(elf.find_sections(".text") == std::vector<size_t>{text, text_foo, text_bar, text_again});
+		REQUIRE(elf.find_sections(".debug").empty());
+		REQUIRE(elf.find_sections("").size() == elf.shnum());
+	}
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Symbol index", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+
+	elf_image_t<TestType> image{};
+	image.type = elf_type_t::Executable;
+	std::string strtab{std::string(1, '\0')};
+	const auto add_string = [&](const std::string& str) {
+		const auto offset = uint32_t(strtab.size());
+		strtab += str + '\0';
+		return offset;
+	};
+	const auto text = image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0x100,
+		TestType::shflags_t::None, 0x401000);
+
+	const auto make_symbol = [&](const std::string& name, const uint64_t value, const uint64_t size,
+		const elf_symbol_binding_t bind, const elf_symbol_type_t type, const uint16_t shndx) {
+		symbol_t symbol{};
+		symbol.name(add_string(name));
+		symbol.value(typename TestType::addr_t(value));
+		symbol.size(typename TestType::xword_t(size));
+		symbol.info(symbol_t::make_info(uint8_t(bind), uint8_t(type)));
+		symbol.shndx(shndx);
+		return symbol;
+	};
+
+	std::vector<symbol_t> symbols{
+		symbol_t{},
+		make_symbol("main.c", 0, 0, elf_symbol_binding_t::Local, elf_symbol_type_t::File, uint16_t(elf_shns_t::ABS)),
+		make_symbol(".text", 0x401000, 0, elf_symbol_binding_t::Local, elf_symbol_type_t::Section, uint16_t(text)),
+		make_symbol("main", 0x401000, 0x20, elf_symbol_binding_t::Global, elf_symbol_type_t::Function, uint16_t(text)),
+		make_symbol("__main_alias", 0x401000, 0x20, elf_symbol_binding_t::Weak, elf_symbol_type_t::Function, uint16_t(text)),
+		make_symbol("$x", 0x401020, 0, elf_symbol_binding_t::Local, elf_symbol_type_t::NoType, uint16_t(text)),
+		make_symbol("helper", 0x401040, 0x10, elf_symbol_binding_t::Local, elf_symbol_type_t::Function, uint16_t(text)),
+		make_symbol("puts", 0, 0, elf_symbol_binding_t::Global, elf_symbol_type_t::Function, 0),
+	};
+	const auto strtab_index = image.add_section(".strtab", elf_shtype_t::StringTable,
+		strtab.data(), strtab.size());
+	image.add_section(".symtab", elf_shtype_t::SymbolTable, symbols, TestType::shflags_t::None,
+		0, uint32_t(strtab_index), 1, sizeof(symbol_t));
+	const auto path = image.write("symbol-index");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+
+	/* Only main and helper are things that live at an address */
+	REQUIRE(elf.symbol_index().size() == 2);
+	REQUIRE(elf.find_symbol(0x401000)->name == "main");
+	REQUIRE(elf.find_symbol(0x40101F)->name == "main");
+	REQUIRE(elf.find_symbol(0x401020) == nullptr);
+	REQUIRE(elf.find_symbol(0x401048)->name == "helper");
+	REQUIRE(elf.find_symbol(0x401048)->index == 6);
+	REQUIRE(elf.find_symbol(0) == nullptr);
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Symbol index of a relocatable object", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+	using shflags_t = typename TestType::shflags_t;
+
+	/* As -ffunction-sections leaves it, everything at 0 in its own section */
+	elf_image_t<TestType> image{};
+	const auto text_a = image.add_section(".text.a", elf_shtype_t::ProgBits, std::vector<uint8_t>(0x20),
+		shflags_t::Alloc | shflags_t::ExecInstr);
+	const auto text_b = image.add_section(".text.b", elf_shtype_t::ProgBits, std::vector<uint8_t>(0x10),
+		shflags_t::Alloc | shflags_t::ExecInstr);
+	const auto comment = image.add_section(".comment", elf_shtype_t::ProgBits, std::vector<uint8_t>(0x10));
+
+	std::string strtab{std::string(1, '\0')};
+	std::vector<symbol_t> symbols(1);
+	const auto add_symbol = [&](const std::string& name, const size_t section, const uint64_t value,
+		const uint64_t size) {
+		symbol_t symbol{};
+		symbol.name(uint32_t(strtab.size()));
+		strtab += name + '\0';
+		symbol.info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Global), uint8_t(elf_symbol_type_t::Function)));
+		symbol.shndx(uint16_t(section));
+		symbol.value(typename TestType::addr_t(value));
+		symbol.size(typename TestType::xword_t(size));
+		symbols.push_back(symbol);
+	};
+	add_symbol("a", text_a, 0, 0x20);
+	add_symbol("b", text_b, 0, 0x10);
+	add_symbol("stray", comment, 0, 0x10);
+	add_symbol("absolute", size_t(elf_shns_t::ABS), 0x1000, 4);
+	const auto strtab_index = image.add_section(".strtab", elf_shtype_t::StringTable, strtab.data(), strtab.size());
+	image.add_section(".symtab", elf_shtype_t::SymbolTable, symbols, shflags_t::None,
+		0, uint32_t(strtab_index), 1, sizeof(symbol_t));
+	const auto path = image.write("symbol-index-relocatable");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	const auto addresses = elf.section_addresses();
+	REQUIRE(addresses[text_a] != addresses[text_b]);
+	REQUIRE(elf.symbol_index().size() == 3);
+	REQUIRE(elf.find_symbol(addresses[text_a])->name == "a");
+	REQUIRE(elf.find_symbol(addresses[text_b])->name == "b");
+	REQUIRE(elf.find_symbol(addresses[text_b] + 0x0F)->name == "b");
+	REQUIRE(elf.find_symbol(0x1000)->name == "absolute");
+
+	fs::remove(path);
+}
+
+TEST_CASE( "ELF Symbol hashes", "[elf]" ) {
+	REQUIRE(elf_hash(reinterpret_cast<const uint8_t*>("printf")) == 0x077905A6U);
+	REQUIRE(elf_hash(std::string_view{"printf"}) == 0x077905A6U);
+	REQUIRE(gnu_hash(reinterpret_cast<const uint8_t*>("printf")) == 0x156B2BB8U);
+	REQUIRE(gnu_hash(std::string_view{"printf"}) == 0x156B2BB8U);
+	REQUIRE(gnu_hash(std::string_view{}) == 5381U);
+}
+
+/*
+	Hand rolled .dynsym/.dynstr/.hash/.gnu.hash, with `puts` left undefined
+	ahead of everything that is, the way linkers lay them out.
+*/
+template<typename T>
+static std::vector<std::string> dynamic_symbols(elf_image_t<T>& image,
+	const std::vector<std::string>& defined, const bool gnu, const bool sysv) {
+
+	using symbol_t = typename T::symbol_t;
+	using bloom_word_t = std::conditional_t<sizeof(typename T::addr_t) == 8, uint64_t, uint32_t>;
+	constexpr uint32_t bloom_bits{sizeof(bloom_word_t) * 8U};
+	constexpr uint32_t nbuckets{4};
+	constexpr uint32_t bloom_shift{6};
+	constexpr uint32_t symoffset{2};
+
+	/* GNU hash needs the defined symbols grouped by bucket */
+	std::vector<std::string> order{defined};
+	std::stable_sort(order.begin(), order.end(), [](const std::string& a, const std::string& b) {
+		return (gnu_hash(std::string_view{a}) % nbuckets) < (gnu_hash(std::string_view{b}) % nbuckets);
+	});
+	order.insert(order.begin(), {"", "puts"});
+
+	std::string dynstr{std::string(1, '\0')};
+	std::vector<symbol_t> symbols(order.size());
+	for(size_t idx{1}; idx < order.size(); ++idx) {
+		symbols[idx].name(uint32_t(dynstr.size()));
+		dynstr += order[idx] + '\0';
+		symbols[idx].info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Global),
+			uint8_t(elf_symbol_type_t::Function)));
+		if(idx >= symoffset) {
+			symbols[idx].shndx(1);
+			symbols[idx].value(typename T::addr_t(0x1000U + (idx * 0x10U)));
+		}
+	}
+
+	const auto dynstr_index = image.add_section(".dynstr", elf_shtype_t::StringTable, dynstr.data(), dynstr.size());
+	const auto dynsym_index = image.add_section(".dynsym", elf_shtype_t::DynamicSymbols, symbols,
+		T::shflags_t::None, 0, uint32_t(dynstr_index), 1, sizeof(symbol_t));
+
+	if(gnu) {
+		std::vector<bloom_word_t> bloom(2);
+		std::vector<uint32_t> buckets(nbuckets);
+		std::vector<uint32_t> chains{};
+		for(size_t idx{symoffset}; idx < order.size(); ++idx) {
+			const uint32_t hash{gnu_hash(std::string_view{order[idx]})};
+			bloom[(hash / bloom_bits) % bloom.size()] |= (bloom_word_t{1} << (hash % bloom_bits)) |
+				(bloom_word_t{1} << ((hash >> bloom_shift) % bloom_bits));
+			if(buckets[hash % nbuckets] == 0)
+				buckets[hash % nbuckets] = uint32_t(idx);
+			const bool last{idx + 1 == order.size() ||
+				(gnu_hash(std::string_view{order[idx + 1]}) % nbuckets) != (hash % nbuckets)};
+			chains.push_back((hash & ~1U) | (last ? 1U : 0U));
+		}
+
+		std::vector<uint8_t> table{};
+		const auto append = [&](const void* data, const size_t len) {
+			table.insert(table.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + len);
+		};
+		const std::array<uint32_t, 4> header{{nbuckets, symoffset, uint32_t(bloom.size()), bloom_shift}};
+		append(header.data(), sizeof(header));
+		append(bloom.data(), bloom.size() * sizeof(bloom_word_t));
+		append(buckets.data(), buckets.size() * sizeof(uint32_t));
+		append(chains.data(), chains.size() * sizeof(uint32_t));
+		image.add_section(".gnu.hash", elf_shtype_t::GNUHash, table, T::shflags_t::None, 0, uint32_t(dynsym_index));
+	}
+
+	if(sysv) {
+		constexpr uint32_t nbucket{3};
+		std::vector<uint32_t> table(2 + nbucket + order.size());
+		table[0] = nbucket;
+		table[1] = uint32_t(order.size());
+		for(size_t idx{1}; idx < order.size(); ++idx) {
+			uint32_t& bucket{table[2 + (elf_hash(std::string_view{order[idx]}) % nbucket)]};
+			table[2 + nbucket + idx] = bucket;
+			bucket = uint32_t(idx);
+		}
+		image.add_section(".hash", elf_shtype_t::HashTable, table, T::shflags_t::None, 0,
+			uint32_t(dynsym_index), 0, sizeof(uint32_t));
+	}
+	return order;
+}
+
+TEMPLATE_TEST_CASE( "ELF Dynamic symbol lookup", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	const std::vector<std::string> defined{
+		"sns_open", "sns_close", "sns_read", "sns_write", "sns_map", "sns_unmap", "_init", "_fini", "a", "b"
+	};
+
+	for(const auto& [gnu, sysv] : std::vector<std::pair<bool, bool>>{{true, false}, {false, true}, {true, true}}) {
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::SharedObject;
+		image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0);
+		const auto order = dynamic_symbols(image, defined, gnu, sysv);
+		const auto path = image.write("dynamic-lookup");
+
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		REQUIRE(elf.dynamic_symbol_table() != 0);
+
+		for(const auto& name : defined) {
+			const auto index = elf.find_dynamic_symbol(name);
+			REQUIRE(index != 0);
+			REQUIRE(order[index] == name);
+		}
+		/* Present, but not a definition */
+		REQUIRE(elf.find_dynamic_symbol("puts") == 0);
+		REQUIRE(elf.find_dynamic_symbol("sns_") == 0);
+		REQUIRE(elf.find_dynamic_symbol("missing") == 0);
+		REQUIRE(elf.find_dynamic_symbol("") == 0);
+
+		fs::remove(path);
+	}
+
+	SECTION( "No hash table" ) {
+		elf_image_t<TestType> image{};
+		const auto path = image.write("dynamic-lookup-none");
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.dynamic_symbol_table() == 0);
+		REQUIRE(elf.find_dynamic_symbol("sns_open") == 0);
+		fs::remove(path);
+	}
+}
+
+TEST_CASE( "ELF Batch symbol hashes", "[elf]" ) {
+	std::mt19937 rng{0xBA7C4U};
+	std::string strtab{std::string(1, '\0')};
+	std::vector<uint32_t> offsets{0};
+	for(size_t idx{}; idx < 1021; ++idx) {
+		offsets.push_back(uint32_t(strtab.size()));
+		/* Mostly similar lengths with the odd long C++ name thrown in */
+		const size_t len{(idx % 17 == 0) ? (rng() % 200) : (rng() % 24)};
+		for(size_t chr{}; chr < len; ++chr)
+			strtab += char(1 + (rng() % 255));
+		strtab += '\0';
+	}
+	/* Somewhere in the middle of a name, past the end, and one left unterminated */
+	offsets.push_back(offsets[5] + 1);
+	offsets.push_back(uint32_t(strtab.size() + 10));
+	offsets.push_back(uint32_t(strtab.size()));
+	strtab += "_ZN3sns4elf_tILb1EE13find_sectionEv";
+
+	std::vector<uint32_t> elf_hashes(offsets.size());
+	std::vector<uint32_t> gnu_hashes(offsets.size());
+	elf_hash_batch(strtab.data(), strtab.size(), offsets.data(), offsets.size(), elf_hashes.data());
+	gnu_hash_batch(strtab.data(), strtab.size(), offsets.data(), offsets.size(), gnu_hashes.data());
+
+	for(size_t idx{}; idx < offsets.size(); ++idx) {
+		std::string_view name{};
+		if(offsets[idx] < strtab.size()) {
+			name = std::string_view{strtab}.substr(offsets[idx]);
+			name = name.substr(0, name.find('\0'));
+		}
+		REQUIRE(elf_hashes[idx] == elf_hash(name));
+		REQUIRE(gnu_hashes[idx] == gnu_hash(name));
+	}
+	REQUIRE(gnu_hashes.back() == gnu_hash(std::string_view{"_ZN3sns4elf_tILb1EE13find_sectionEv"}));
+}
+
+TEMPLATE_TEST_CASE( "ELF Hash table rebuild", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+	constexpr size_t word_size{sizeof(typename TestType::addr_t)};
+
+	/* A library's worth of exports, with every 7th one an import */
+	std::mt19937 rng{0x6A54U};
+	std::string dynstr{std::string(1, '\0')};
+	std::vector<uint32_t> names{0};
+	std::vector<uint8_t> hashed{0};
+	for(size_t idx{1}; idx < 5003; ++idx) {
+		names.push_back(uint32_t(dynstr.size()));
+		dynstr += "sns_" + std::to_string(rng()) + '\0';
+		hashed.push_back(uint8_t(idx % 7 != 0));
+	}
+	const size_t defined{size_t(std::count(hashed.begin(), hashed.end(), 1U))};
+
+	const auto tables = build_hash_tables(dynstr.data(), dynstr.size(), names.data(), hashed.data(),
+		names.size(), word_size, default_hash_false_positive, 4);
+	REQUIRE(tables.order.size() == names.size());
+	REQUIRE(tables.symoffset == names.size() - defined);
+	REQUIRE(tables.order.front() == 0);
+
+	/* Imports keep their order ahead of the exports */
+	for(size_t idx{1}; idx < tables.symoffset; ++idx) {
+		REQUIRE(hashed[tables.order[idx]] == 0);
+		REQUIRE(tables.order[idx - 1] < tables.order[idx]);
+	}
+
+	/* lld sizing, a bucket per 4 symbols and ~12 bits of bloom filter each */
+	std::array<uint32_t, 4> header{};
+	std::memcpy(header.data(), tables.gnu_hash.data(), sizeof(header));
+	REQUIRE(header[0] == defined / 4);
+	REQUIRE(header[1] == tables.symoffset);
+	REQUIRE((header[2] & (header[2] - 1U)) == 0);
+	REQUIRE(header[2] * word_size * 8 >= defined * 11);
+	REQUIRE(header[2] * word_size * 8 < defined * 24);
+	REQUIRE(tables.gnu_hash.size() == (4 + header[0] + defined) * 4 + header[2] * word_size);
+	REQUIRE(tables.sysv_hash.size() == (2 + names.size() * 2) * 4);
+
+	/* Same tables no matter how the work was split up */
+	const auto serial = build_hash_tables(dynstr.data(), dynstr.size(), names.data(), hashed.data(),
+		names.size(), word_size, default_hash_false_positive, 1);
+	REQUIRE(serial.order == tables.order);
+	REQUIRE(serial.gnu_hash == tables.gnu_hash);
+	REQUIRE(serial.sysv_hash == tables.sysv_hash);
+
+	/* Nonsense in, nothing out */
+	REQUIRE(build_hash_tables(dynstr.data(), dynstr.size(), names.data(), hashed.data(),
+		names.size(), 2).order.empty());
+	REQUIRE(build_hash_tables(dynstr.data(), dynstr.size(), names.data(), hashed.data(),
+		names.size(), word_size, 0.0).order.empty());
+
+	std::vector<symbol_t> symbols(names.size());
+	for(size_t idx{1}; idx < symbols.size(); ++idx) {
+		const uint32_t old{tables.order[idx]};
+		symbols[idx].name(names[old]);
+		symbols[idx].info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Global),
+			uint8_t(elf_symbol_type_t::Function)));
+		if(hashed[old] != 0) {
+			symbols[idx].shndx(1);
+			symbols[idx].value(typename TestType::addr_t(0x1000U + (old * 0x10U)));
+		}
+	}
+
+	for(const bool gnu : {true, false}) {
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::SharedObject;
+		image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0);
+		const auto dynstr_index = image.add_section(".dynstr", elf_shtype_t::StringTable, dynstr.data(), dynstr.size());
+		const auto dynsym_index = image.add_section(".dynsym", elf_shtype_t::DynamicSymbols, symbols,
+			TestType::shflags_t::None, 0, uint32_t(dynstr_index), 1, sizeof(symbol_t));
+		if(gnu)
+			image.add_section(".gnu.hash", elf_shtype_t::GNUHash, tables.gnu_hash,
+				TestType::shflags_t::None, 0, uint32_t(dynsym_index));
+		else
+			image.add_section(".hash", elf_shtype_t::HashTable, tables.sysv_hash,
+				TestType::shflags_t::None, 0, uint32_t(dynsym_index), 0, sizeof(uint32_t));
+		const auto path = image.write("hash-rebuild");
+
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.dynamic_symbol_table() == dynsym_index);
+		for(size_t idx{1}; idx < symbols.size(); ++idx) {
+			const uint32_t old{tables.order[idx]};
+			const std::string_view name{dynstr.data() + names[old]};
+			REQUIRE(elf.find_dynamic_symbol(name) == ((hashed[old] != 0) ? idx : 0));
+		}
+		REQUIRE(elf.find_dynamic_symbol("sns_") == 0);
+		fs::remove(path);
+	}
+
+	SECTION( "From an existing object" ) {
+		const std::vector<std::string> exports{
+			"sns_open", "sns_close", "sns_read", "sns_write", "sns_map", "sns_unmap", "_init", "_fini", "a", "b"
+		};
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::SharedObject;
+		image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0);
+		const auto order = dynamic_symbols(image, exports, true, true);
+		const auto path = image.write("hash-rebuild-object");
+
+		elf_t<TestType> elf{path};
+		const auto rewrite = elf.rebuild_symbol_hash();
+		REQUIRE(rewrite.order.size() == order.size());
+		REQUIRE(rewrite.sections.size() == 3);
+		REQUIRE(rewrite.sections[0].name == ".dynsym");
+		REQUIRE(rewrite.sections[1].name == ".gnu.hash");
+		REQUIRE(rewrite.sections[2].name == ".hash");
+
+		/* Drop the rewritten sections back in and everything still resolves */
+		for(const auto& section : rewrite.sections) {
+			image.sections[section.index].contents = section.contents;
+			image.sections[section.index].header.size(typename TestType::xword_t(section.contents.size()));
+		}
+		image.sections.pop_back();
+		image.shstrtab.resize(image.shstrtab.size() - sizeof(".shstrtab"));
+		fs::remove(path);
+		const auto rebuilt = image.write("hash-rebuild-object");
+
+		elf_t<TestType> updated{rebuilt};
+		for(const auto& name : exports) {
+			const auto index = updated.find_dynamic_symbol(name);
+			REQUIRE(index != 0);
+			REQUIRE(order[rewrite.order[index]] == name);
+		}
+		REQUIRE(updated.find_dynamic_symbol("puts") == 0);
+		fs::remove(rebuilt);
+	}
+}
+
+template<typename U>
+static U read_le(const std::vector<uint8_t>& buffer, const size_t offset) {
+	U value{};
+	std::memcpy(&value, buffer.data() + offset, sizeof(U));
+	return value;
+}
+
+template<typename U>
+static void write_le(std::vector<uint8_t>& buffer, const size_t offset, const U value) {
+	std::memcpy(buffer.data() + offset, &value, sizeof(U));
+}
+
+TEST_CASE( "ELF Relocation engine", "[elf]" ) {
+	REQUIRE(elf_relocations_supported(elf_machine_t::X86_64));
+	REQUIRE(elf_relocations_supported(elf_machine_t::AARCH64));
+	REQUIRE(elf_relocations_supported(elf_machine_t::RISCV));
+	REQUIRE_FALSE(elf_relocations_supported(elf_machine_t::SPARC));
+
+	SECTION( "x86-64" ) {
+		std::vector<uint8_t> text(32);
+		const std::vector<uint64_t> symbols{0, 0x2000U, 0x1234U, 0x100000000U};
+		const std::vector<uint64_t> sizes{0, 0x40U, 8U, 0};
+		const std::vector<elf_relocation_t> relocations{
+			{16, 0,  32, 1, false}, /* R_X86_64_SIZE32 */
+			{0,  8,  1,  1, false}, /* R_X86_64_64 */
+			{8,  -4, 2,  1, false}, /* R_X86_64_PC32 */
+			{12, 0,  11, 2, false}, /* R_X86_64_32S */
+			{20, 0,  10, 3, false}, /* R_X86_64_32, doesn't fit */
+			{24, 0,  9,  1, false}, /* R_X86_64_GOTPCREL */
+			{30, 0,  1,  1, false}, /* Runs off the end */
+			{24, 0,  1,  9, false}, /* No such symbol */
+		};
+		const auto stats = apply_relocations(elf_machine_t::X86_64, {
+			{text.data(), text.size()}, 0x1000U, {symbols.data(), symbols.size()}, {sizes.data(), sizes.size()}
+		}, relocations.data(), relocations.size());
+
+		REQUIRE(stats.applied == 4);
+		REQUIRE(stats.unsupported == 1);
+		REQUIRE(stats.failed == 3);
+		REQUIRE(read_le<uint64_t>(text, 0) == 0x2008U);
+		REQUIRE(read_le<uint32_t>(text, 8) == 0xFF4U);
+		REQUIRE(read_le<uint32_t>(text, 12) == 0x1234U);
+		REQUIRE(read_le<uint32_t>(text, 16) == 0x40U);
+		REQUIRE(read_le<uint32_t>(text, 20) == 0);
+
+		/* SHT_REL keeps the addend in the section */
+		write_le<uint32_t>(text, 24, 0x10U);
+		const elf_relocation_t implicit{24, 0, 10, 2, true};
+		REQUIRE(apply_relocations(elf_machine_t::X86_64, {
+			{text.data(), text.size()}, 0x1000U, {symbols.data(), symbols.size()}, {}
+		}, &implicit, 1).applied == 1);
+		REQUIRE(read_le<uint32_t>(text, 24) == 0x1244U);
+	}
+
+	SECTION( "AArch64" ) {
+		std::vector<uint8_t> text(28);
+		write_le<uint32_t>(text, 0, 0x94000000U);  /* bl . */
+		write_le<uint32_t>(text, 4, 0x90000000U);  /* adrp x0, . */
+		write_le<uint32_t>(text, 8, 0x91000000U);  /* add x0, x0, #0 */
+		write_le<uint32_t>(text, 12, 0xF9400001U); /* ldr x1, [x0] */
+		write_le<uint32_t>(text, 16, 0x54000000U); /* b.eq . */
+		write_le<uint32_t>(text, 20, 0xF2A00000U); /* movk x0, #0, lsl #16 */
+		write_le<uint32_t>(text, 24, 0x94000000U); /* bl . */
+		const std::vector<uint64_t> symbols{0, 0x10100U, 0x12345678U, 0x10000U, 0x20000000U};
+		const std::vector<elf_relocation_t> relocations{
+			{0,  0, 283, 1, false}, /* R_AARCH64_CALL26 */
+			{4,  0, 275, 2, false}, /* R_AARCH64_ADR_PREL_PG_HI21 */
+			{8,  0, 277, 2, false}, /* R_AARCH64_ADD_ABS_LO12_NC */
+			{12, 0, 286, 2, false}, /* R_AARCH64_LDST64_ABS_LO12_NC */
+			{16, 0, 280, 3, false}, /* R_AARCH64_CONDBR19 */
+			{20, 0, 266, 2, false}, /* R_AARCH64_MOVW_UABS_G1_NC */
+			{24, 0, 283, 4, false}, /* R_AARCH64_CALL26, out of range */
+			{0,  0, 311, 1, false}, /* R_AARCH64_ADR_GOT_PAGE */
+		};
+		const auto stats = apply_relocations(elf_machine_t::AARCH64, {
+			{text.data(), text.size()}, 0x10000U, {symbols.data(), symbols.size()}, {}
+		}, relocations.data(), relocations.size());
+
+		REQUIRE(stats.applied == 6);
+		REQUIRE(stats.unsupported == 1);
+		REQUIRE(stats.failed == 1);
+		REQUIRE(read_le<uint32_t>(text, 0) == 0x94000040U);
+		REQUIRE(read_le<uint32_t>(text, 4) == 0xB00919A0U);
+		REQUIRE(read_le<uint32_t>(text, 8) == 0x9119E000U);
+		REQUIRE(read_le<uint32_t>(text, 12) == 0xF9433C01U);
+		REQUIRE(read_le<uint32_t>(text, 16) == 0x54FFFF80U);
+		REQUIRE(read_le<uint32_t>(text, 20) == 0xF2A24680U);
+		REQUIRE(read_le<uint32_t>(text, 24) == 0x94000000U);
+	}
+
+	SECTION( "RISC-V" ) {
+		std::vector<uint8_t> text(32);
+		write_le<uint32_t>(text, 0, 0x00000097U);  /* auipc ra, 0 */
+		write_le<uint32_t>(text, 4, 0x000080E7U);  /* jalr ra, 0(ra) */
+		write_le<uint32_t>(text, 8, 0x00000517U);  /* auipc a0, 0 */
+		write_le<uint32_t>(text, 12, 0x00050513U); /* addi a0, a0, 0 */
+		write_le<uint32_t>(text, 16, 0x00B50063U); /* beq a0, a1, . */
+		write_le<uint32_t>(text, 20, 0x000000EFU); /* jal ra, . */
+		text[28] = 0xC0U;
+		write_le<uint16_t>(text, 30, 0xA001U);     /* c.j . */
+		const std::vector<uint64_t> symbols{0, 0x2844U, 0x3010U, 0x1008U, 0x1000U, 0x1814U, 0x25U, 0x5U, 0x101CU};
+		const std::vector<elf_relocation_t> relocations{
+			{28, 0, 53, 6, false}, /* R_RISCV_SET6 */
+			{12, 0, 24, 3, false}, /* R_RISCV_PCREL_LO12_I, before its %hi */
+			{0,  0, 18, 1, false}, /* R_RISCV_CALL */
+			{0,  0, 51, 0, false}, /* R_RISCV_RELAX */
+			{8,  0, 23, 2, false}, /* R_RISCV_PCREL_HI20 */
+			{16, 0, 16, 4, false}, /* R_RISCV_BRANCH */
+			{20, 0, 17, 5, false}, /* R_RISCV_JAL */
+			{24, 0, 35, 2, false}, /* R_RISCV_ADD32 */
+			{24, 0, 39, 4, false}, /* R_RISCV_SUB32 */
+			{28, 0, 52, 7, false}, /* R_RISCV_SUB6 */
+			{30, 0, 45, 8, false}, /* R_RISCV_RVC_JUMP */
+			{12, 0, 24, 5, false}, /* R_RISCV_PCREL_LO12_I, no %hi there */
+		};
+		const auto stats = apply_relocations(elf_machine_t::RISCV, {
+			{text.data(), text.size()}, 0x1000U, {symbols.data(), symbols.size()}, {}
+		}, relocations.data(), relocations.size());
+
+		REQUIRE(stats.applied == 11);
+		REQUIRE(stats.failed == 1);
+		REQUIRE(read_le<uint32_t>(text, 0) == 0x00002097U);
+		REQUIRE(read_le<uint32_t>(text, 4) == 0x844080E7U);
+		REQUIRE(read_le<uint32_t>(text, 8) == 0x00002517U);
+		REQUIRE(read_le<uint32_t>(text, 12) == 0x00850513U);
+		REQUIRE(read_le<uint32_t>(text, 16) == 0xFEB508E3U);
+		REQUIRE(read_le<uint32_t>(text, 20) == 0x001000EFU);
+		REQUIRE(read_le<uint32_t>(text, 24) == 0x2010U);
+		REQUIRE(text[28] == 0xE0U);
+		REQUIRE(read_le<uint16_t>(text, 30) == 0xBFFDU);
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Relocated sections", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+	using rel_t = typename TestType::rel_t;
+	using rela_t = typename TestType::rela_t;
+	using shflags_t = typename TestType::shflags_t;
+	const auto alloc = shflags_t::Alloc;
+
+	elf_image_t<TestType> image{};
+	image.machine = elf_machine_t::RISCV;
+
+	std::vector<uint8_t> text(16);
+	write_le<uint32_t>(text, 0, 0x00000097U); /* auipc ra, 0 */
+	write_le<uint32_t>(text, 4, 0x000080E7U); /* jalr ra, 0(ra) */
+	std::vector<uint8_t> debug_info(8);
+	write_le<uint32_t>(debug_info, 4, 0x20U);
+
+	const auto text_index = image.add_section(".text", elf_shtype_t::ProgBits, text, alloc);
+	image.sections[text_index].header.addraline(4);
+	const auto data_index = image.add_section(".data", elf_shtype_t::ProgBits, std::vector<uint8_t>(8), alloc);
+	image.sections[data_index].header.addraline(8);
+	const auto debug_index = image.add_section(".debug_info", elf_shtype_t::ProgBits, debug_info);
+
+	std::string strtab{std::string(1, '\0')};
+	std::vector<symbol_t> symbols(4);
+	symbols[1].info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Local), uint8_t(elf_symbol_type_t::Section)));
+	symbols[1].shndx(uint16_t(text_index));
+	symbols[2].name(uint32_t(strtab.size()));
+	strtab += std::string{"target"} + '\0';
+	symbols[2].info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Global), uint8_t(elf_symbol_type_t::Function)));
+	symbols[2].shndx(uint16_t(text_index));
+	symbols[2].value(8);
+	symbols[3].name(uint32_t(strtab.size()));
+	strtab += std::string{"external"} + '\0';
+	symbols[3].info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Global), uint8_t(elf_symbol_type_t::NoType)));
+
+	const auto strtab_index = image.add_section(".strtab", elf_shtype_t::StringTable, strtab.data(), strtab.size());
+	const auto symtab_index = image.add_section(".symtab", elf_shtype_t::SymbolTable, symbols,
+		shflags_t::None, 0, uint32_t(strtab_index), 2, sizeof(symbol_t));
+	const auto add_rela = [&](const std::string& name, const size_t target, const std::vector<rela_t>& entries) {
+		return image.add_section(name, elf_shtype_t::RelA, entries, shflags_t::InfoLink, 0,
+			uint32_t(symtab_index), uint32_t(target), sizeof(rela_t));
+	};
+	const auto rela_text = add_rela(".rela.text", text_index, {
+		{0, rela_t::make_info(2, 18), 0},    /* R_RISCV_CALL target */
+		{0, rela_t::make_info(2, 51), 0},    /* R_RISCV_RELAX */
+	});
+	add_rela(".rela.data", data_index, {
+		{0, rela_t::make_info(2, 1), 0},     /* R_RISCV_32 target */
+		{4, rela_t::make_info(3, 1), 0x10},  /* R_RISCV_32 external+0x10 */
+	});
+	add_rela(".rela.debug_info", debug_index, {
+		{0, rela_t::make_info(1, 1), 4},     /* R_RISCV_32 .text+4 */
+	});
+	const std::vector<rel_t> rel_debug{{4, rel_t::make_info(1, 1)}};
+	image.add_section(".rel.debug_info", elf_shtype_t::Rel, rel_debug, shflags_t::InfoLink, 0,
+		uint32_t(symtab_index), uint32_t(debug_index), sizeof(rel_t));
+	const auto path = image.write("relocated-sections");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	REQUIRE(elf.rela_table(rela_text).size() == 2);
+	REQUIRE(elf.rel_table(rela_text).empty());
+	const auto entries = elf.relocations(rela_text);
+	REQUIRE(entries.size() == 2);
+	REQUIRE(entries[0].type == 18);
+	REQUIRE(entries[0].symbol == 2);
+	REQUIRE_FALSE(entries[0].implicit);
+
+	const auto addresses = elf.section_addresses(0x10000U);
+	REQUIRE(addresses[text_index] == 0x10000U);
+	REQUIRE(addresses[data_index] == 0x10010U);
+	REQUIRE(addresses[debug_index] == 0);
+
+	for(const size_t threads : {size_t{1}, size_t{0}}) {
+		auto relocated = elf.relocate_sections(0x10000U, threads);
+		REQUIRE(relocated.size() == 3);
+		std::sort(relocated.begin(), relocated.end(), [](const auto& a, const auto& b) { return a.index < b.index; });
+
+		REQUIRE(relocated[0].index == text_index);
+		REQUIRE(relocated[0].stats.applied == 2);
+		REQUIRE(read_le<uint32_t>(relocated[0].contents, 0) == 0x00000097U);
+		REQUIRE(read_le<uint32_t>(relocated[0].contents, 4) == 0x008080E7U);
+
+		REQUIRE(relocated[1].index == data_index);
+		REQUIRE(relocated[1].address == 0x10010U);
+		REQUIRE(read_le<uint32_t>(relocated[1].contents, 0) == 0x10008U);
+		REQUIRE(read_le<uint32_t>(relocated[1].contents, 4) == 0x10U);
+
+		REQUIRE(relocated[2].index == debug_index);
+		REQUIRE(relocated[2].stats.applied == 2);
+		REQUIRE(read_le<uint32_t>(relocated[2].contents, 0) == 0x10004U);
+		REQUIRE(read_le<uint32_t>(relocated[2].contents, 4) == 0x10020U);
+	}
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Relocated compressed section", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+	using rela_t = typename TestType::rela_t;
+	using shflags_t = typename TestType::shflags_t;
+
+	std::vector<uint8_t> debug_info(8);
+	write_le<uint32_t>(debug_info, 4, 0x20U);
+	const auto compressed = elf_t<TestType>::compress_section({debug_info.data(), debug_info.size()},
+		elf_chdr_type_t::Zlib, 4);
+	REQUIRE_FALSE(compressed.empty());
+
+	elf_image_t<TestType> image{};
+	image.machine = elf_machine_t::RISCV;
+	const auto text_index = image.add_section(".text", elf_shtype_t::ProgBits, std::vector<uint8_t>(16),
+		shflags_t::Alloc);
+	const auto debug_index = image.add_section(".debug_info", elf_shtype_t::ProgBits, compressed,
+		shflags_t::Compressed);
+
+	std::vector<symbol_t> symbols(2);
+	symbols[1].info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Local), uint8_t(elf_symbol_type_t::Section)));
+	symbols[1].shndx(uint16_t(text_index));
+	const auto strtab_index = image.add_section(".strtab", elf_shtype_t::StringTable, std::vector<uint8_t>(1));
+	const auto symtab_index = image.add_section(".symtab", elf_shtype_t::SymbolTable, symbols,
+		shflags_t::None, 0, uint32_t(strtab_index), 2, sizeof(symbol_t));
+	const std::vector<rela_t> rela{{0, rela_t::make_info(1, 1), 4}}; /* R_RISCV_32 .text+4 */
+	image.add_section(".rela.debug_info", elf_shtype_t::RelA, rela, shflags_t::InfoLink, 0,
+		uint32_t(symtab_index), uint32_t(debug_index), sizeof(rela_t));
+	const auto path = image.write("relocated-compressed");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	/* Nothing inflated gets cached, so only the view keeps the contents alive */
+	elf.section_cache_limit(0);
+	for(const size_t threads : {size_t{1}, size_t{0}}) {
+		const auto relocated = elf.relocate_sections(0x10000U, threads);
+		REQUIRE(relocated.size() == 1);
+		REQUIRE(relocated[0].index == debug_index);
+		REQUIRE(relocated[0].stats.applied == 1);
+		REQUIRE(read_le<uint32_t>(relocated[0].contents, 0) == 0x10004U);
+		REQUIRE(read_le<uint32_t>(relocated[0].contents, 4) == 0x20U);
+	}
+	REQUIRE(elf.section_cache().size() == 0);
+
+	fs::remove(path);
+}
+
+TEST_CASE( "ELF RELR encoding", "[elf]" ) {
+	std::mt19937_64 rng{0x2E12U};
+	for(const size_t word_size : {size_t{4}, size_t{8}}) {
+		std::vector<uint64_t> addresses{};
+		uint64_t address{0x10000U};
+		for(size_t idx{}; idx < 5000; ++idx) {
+			/* Mostly runs of neighbouring words, with the odd jump */
+			address += word_size * ((rng() % 16 == 0) ? (1 + rng() % 4096) : (1 + rng() % 3));
+			addresses.push_back(address);
+		}
+		std::vector<uint64_t> shuffled{addresses};
+		std::shuffle(shuffled.begin(), shuffled.end(), rng);
+		shuffled.push_back(addresses[17]);
+		shuffled.push_back(addresses[17] + 1);
+
+		const auto relr = encode_relr(shuffled, word_size);
+		REQUIRE(relr.size() % word_size == 0);
+		REQUIRE(relr.size() * 4 < addresses.size() * word_size);
+		REQUIRE(decode_relr({relr.data(), relr.size()}, word_size) == addresses);
+	}
+	REQUIRE(encode_relr({0x1000U}, 2).empty());
+	REQUIRE(decode_relr({}, 8).empty());
+}
+
+TEMPLATE_TEST_CASE( "ELF RELR packing", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using rela_t = typename TestType::rela_t;
+	using dyn_t = typename TestType::dyn_t;
+	using dyn_tag_t = typename TestType::dyn_tag_t;
+	using xword_t = typename TestType::xword_t;
+	using verneed_t = typename TestType::verneed_t;
+	using vernaux_t = typename TestType::vernaux_t;
+	constexpr size_t word_size{sizeof(typename TestType::addr_t)};
+	constexpr uint32_t relative{3}; /* R_RISCV_RELATIVE */
+	const auto alloc = TestType::shflags_t::Alloc;
+
+	/* Unpackable ones first, a misaligned one and one into .bss */
+	std::vector<rela_t> relocations{
+		{0x4002U, rela_t::make_info(0, relative), 1},
+		{0x20000U, rela_t::make_info(0, relative), 2},
+	};
+	std::vector<uint64_t> packable{};
+	for(uint64_t slot{}; slot < 1000; ++slot) {
+		if(slot % 5 == 3 || (slot > 400 && slot < 480))
+			continue;
+		packable.push_back(0x4000U + (slot * word_size));
+		relocations.emplace_back(typename TestType::addr_t(packable.back()), rela_t::make_info(0, relative),
+			typename rela_t::sxword_t(0x5000U + slot));
+	}
+	relocations.emplace_back(0x4008U, rela_t::make_info(1, 1), 0);
+
+	/* How .dynamic starts out, and whether there's a .gnu.version_r to go with it */
+	enum class variant_t { Plain, Packed, Full, Glibc, OtherVerneed };
+	const auto make_dynamic = [&](const variant_t variant) {
+		std::vector<dyn_t> dynamic{
+			{dyn_tag_t::RelA, 0x1000U},
+			{dyn_tag_t::RelASize, xword_t(relocations.size() * sizeof(rela_t))},
+			{dyn_tag_t::RelAEnt, xword_t(sizeof(rela_t))},
+			{dyn_tag_t::RelACount, xword_t(relocations.size() - 1)},
+		};
+		if(variant == variant_t::Packed)
+			dynamic.insert(dynamic.begin(), dyn_t{dyn_tag_t::Relr, 0x3000U});
+		if(variant == variant_t::Glibc || variant == variant_t::OtherVerneed) {
+			dynamic.emplace_back(dyn_tag_t::StrTab, 0x2000U);
+			dynamic.emplace_back(dyn_tag_t::StrTabSize, 0x20U);
+			dynamic.emplace_back(dyn_tag_t::VerNeed, 0x2100U);
+			dynamic.emplace_back(dyn_tag_t::VerNeedNum, 1U);
+		}
+		dynamic.resize(dynamic.size() + (variant == variant_t::Full ? 1U : 4U));
+		return dynamic;
+	};
+
+	const auto build = [&](const variant_t variant) {
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::SharedObject;
+		image.machine = elf_machine_t::RISCV;
+		image.add_section(".rela.dyn", elf_shtype_t::RelA, relocations, alloc, 0x1000U, 0, 0, sizeof(rela_t));
+		if(variant == variant_t::Glibc || variant == variant_t::OtherVerneed) {
+			/* One GLIBC_2.2.5 need as version 2 */
+			std::string dynstr{std::string(1, '\0')};
+			dynstr += (variant == variant_t::Glibc) ? "libc.so.6" : "libm.so.6";
+			dynstr += std::string(1, '\0') + "GLIBC_2.2.5" + std::string(1, '\0');
+			dynstr.resize(0x20);
+			const auto dynstr_index = image.add_section(".dynstr", elf_shtype_t::StringTable, dynstr.data(),
+				dynstr.size(), alloc, 0x2000U);
+			std::vector<uint8_t> verneed(sizeof(verneed_t) + sizeof(vernaux_t));
+			const verneed_t file{1, 1, 1, sizeof(verneed_t), 0};
+			const vernaux_t need{elf_hash("GLIBC_2.2.5"), elf_vernaux_flag_t::None, 2, 11, 0};
+			std::memcpy(verneed.data(), &file, sizeof(verneed_t));
+			std::memcpy(verneed.data() + sizeof(verneed_t), &need, sizeof(vernaux_t));
+			image.add_section(".gnu.version_r", elf_shtype_t::GNUVerNeed, verneed, alloc, 0x2100U,
+				uint32_t(dynstr_index), 1);
+		}
+		image.add_section(".data.rel.ro", elf_shtype_t::ProgBits, std::vector<uint8_t>(1000 * word_size), alloc, 0x4000U);
+		image.add_section(".bss", elf_shtype_t::NoBits, nullptr, 0x100, alloc, 0x20000U);
+		image.add_section(".dynamic", elf_shtype_t::Dynamic, make_dynamic(variant), alloc, 0x30000U, 0, 0, sizeof(dyn_t));
+		return image.write("relr-packing");
+	};
+
+	const auto dynamic_entries = [](const typename elf_t<TestType>::section_rewrite_t& dynamic) {
+		REQUIRE(dynamic.name == ".dynamic");
+		std::vector<dyn_t> entries(dynamic.contents.size() / sizeof(dyn_t));
+		std::memcpy(entries.data(), dynamic.contents.data(), dynamic.contents.size());
+		return entries;
+	};
+	const auto value_of = [](const std::vector<dyn_t>& entries, const dyn_tag_t tag) {
+		const auto entry = std::find_if(entries.begin(), entries.end(), [tag](const dyn_t& dyn) { return dyn.tag() == tag; });
+		REQUIRE(entry != entries.end());
+		return uint64_t(entry->value());
+	};
+
+	SECTION( "Packing" ) {
+		const auto path = build(variant_t::Plain);
+		elf_t<TestType> elf{path};
+		const auto rewrite = elf.pack_relative_relocations();
+
+		REQUIRE(rewrite.packed == packable.size());
+		REQUIRE(rewrite.remaining == 3);
+		REQUIRE(rewrite.sections.size() == 4);
+
+		const auto& rela_dyn = rewrite.sections[0];
+		REQUIRE(rela_dyn.name == ".rela.dyn");
+		REQUIRE(rela_dyn.contents.size() == 3 * sizeof(rela_t));
+		rela_t kept{};
+		std::memcpy(&kept, rela_dyn.contents.data() + (2 * sizeof(rela_t)), sizeof(rela_t));
+		REQUIRE(kept.type() == 1);
+		REQUIRE(kept.sym() == 1);
+
+		/* A new section in the space .rela.dyn gave up */
+		const auto& relr = rewrite.sections[1];
+		REQUIRE(relr.name == ".relr.dyn");
+		REQUIRE(relr.index == elf.sheaders().size());
+		REQUIRE(decode_relr({relr.contents.data(), relr.contents.size()}, word_size) == packable);
+		REQUIRE(relr.contents.size() * 10 <= rewrite.packed * sizeof(rela_t));
+
+		const auto& rela_shdr = elf.sheaders()[rela_dyn.index];
+		REQUIRE(rewrite.headers.size() == 2);
+		REQUIRE(rewrite.headers[0].index == rela_dyn.index);
+		REQUIRE(rewrite.headers[0].header.size() == 3 * sizeof(rela_t));
+		REQUIRE(rewrite.headers[0].header.addr() == rela_shdr.addr());
+		const auto& relr_shdr = rewrite.headers[1].header;
+		REQUIRE(rewrite.headers[1].index == relr.index);
+		REQUIRE(relr_shdr.type() == elf_shtype_t::Relr);
+		REQUIRE(relr_shdr.addr() == ((0x1000U + (3 * sizeof(rela_t)) + word_size - 1) / word_size) * word_size);
+		REQUIRE(relr_shdr.offset() == rela_shdr.offset() + (relr_shdr.addr() - rela_shdr.addr()));
+		REQUIRE(relr_shdr.size() == relr.contents.size());
+		REQUIRE(relr_shdr.entsize() == word_size);
+		REQUIRE(relr_shdr.addr() + relr_shdr.size() <= rela_shdr.addr() + rela_shdr.size());
+
+		/* The new tags take the spare DT_NULLs, .dynamic stays the same size */
+		const auto entries = dynamic_entries(rewrite.sections[2]);
+		REQUIRE(entries.size() == 8);
+		REQUIRE(entries.back().tag() == dyn_tag_t::None);
+		REQUIRE(value_of(entries, dyn_tag_t::RelA) == 0x1000U);
+		REQUIRE(value_of(entries, dyn_tag_t::RelASize) == 3 * sizeof(rela_t));
+		REQUIRE(value_of(entries, dyn_tag_t::RelACount) == 2);
+		REQUIRE(value_of(entries, dyn_tag_t::Relr) == relr_shdr.addr());
+		REQUIRE(value_of(entries, dyn_tag_t::RelrSize) == relr.contents.size());
+		REQUIRE(value_of(entries, dyn_tag_t::RelrEnt) == word_size);
+
+		/* The addends now live in the words being relocated */
+		const auto& data = rewrite.sections[3];
+		REQUIRE(data.name == ".data.rel.ro");
+		for(const uint64_t address : packable) {
+			typename TestType::addr_t value{};
+			std::memcpy(&value, data.contents.data() + (address - 0x4000U), word_size);
+			REQUIRE(value == 0x5000U + ((address - 0x4000U) / word_size));
+		}
+		fs::remove(path);
+	}
+
+	SECTION( "GLIBC_ABI_DT_RELR" ) {
+		const auto path = build(variant_t::Glibc);
+		elf_t<TestType> elf{path};
+		const auto rewrite = elf.pack_relative_relocations();
+		REQUIRE(rewrite.packed == packable.size());
+		REQUIRE(rewrite.sections.size() == 6);
+		REQUIRE(rewrite.headers.size() == 4);
+
+		const auto& verneed = rewrite.sections[3];
+		const auto& dynstr = rewrite.sections[4];
+		REQUIRE(verneed.name == ".gnu.version_r");
+		REQUIRE(dynstr.name == ".dynstr");
+		const std::string_view strings{reinterpret_cast<const char*>(dynstr.contents.data()), dynstr.contents.size()}; // lgtm[cpp/reinterpret-cast]
+
+		/* libc.so.6 now has a second need, chained on from the first */
+		verneed_t file{};
+		std::memcpy(&file, verneed.contents.data(), sizeof(verneed_t));
+		REQUIRE(file.count() == 2);
+		vernaux_t need{};
+		std::memcpy(&need, verneed.contents.data() + file.aux(), sizeof(vernaux_t));
+		REQUIRE(need.next() != 0);
+		std::memcpy(&need, verneed.contents.data() + file.aux() + need.next(), sizeof(vernaux_t));
+		REQUIRE(need.next() == 0);
+		REQUIRE(need.other() == 3);
+		REQUIRE(need.hash() == elf_hash("GLIBC_ABI_DT_RELR"));
+		REQUIRE(std::string_view{strings.data() + need.name()} == "GLIBC_ABI_DT_RELR");
+
+		/* Both moved in after .relr.dyn, with .dynamic pointing at them */
+		const auto& rela_shdr = elf.sheaders()[rewrite.sections[0].index];
+		const auto& relr_shdr = rewrite.headers[1].header;
+		const auto& verneed_shdr = rewrite.headers[2].header;
+		const auto& dynstr_shdr = rewrite.headers[3].header;
+		REQUIRE(rewrite.headers[2].index == verneed.index);
+		REQUIRE(rewrite.headers[3].index == dynstr.index);
+		REQUIRE(verneed_shdr.addr() >= relr_shdr.addr() + relr_shdr.size());
+		REQUIRE(verneed_shdr.addr() % 4 == 0);
+		REQUIRE(verneed_shdr.size() == verneed.contents.size());
+		REQUIRE(verneed_shdr.info() == 1);
+		REQUIRE(dynstr_shdr.addr() >= verneed_shdr.addr() + verneed_shdr.size());
+		REQUIRE(dynstr_shdr.addr() + dynstr_shdr.size() <= rela_shdr.addr() + rela_shdr.size());
+		REQUIRE(dynstr_shdr.offset() == rela_shdr.offset() + (dynstr_shdr.addr() - rela_shdr.addr()));
+
+		const auto entries = dynamic_entries(rewrite.sections[2]);
+		REQUIRE(value_of(entries, dyn_tag_t::VerNeed) == verneed_shdr.addr());
+		REQUIRE(value_of(entries, dyn_tag_t::StrTab) == dynstr_shdr.addr());
+		REQUIRE(value_of(entries, dyn_tag_t::StrTabSize) == dynstr.contents.size());
+		REQUIRE(value_of(entries, dyn_tag_t::VerNeedNum) == 1);
+		fs::remove(path);
+	}
+
+	SECTION( "Not packed" ) {
+		/* Already packed, .dynamic too full, and a DT_VERNEED with no libc.so.6 to add to */
+		for(const auto variant : {variant_t::Packed, variant_t::Full, variant_t::OtherVerneed}) {
+			const auto path = build(variant);
+			elf_t<TestType> elf{path};
+			const auto rewrite = elf.pack_relative_relocations();
+			REQUIRE(rewrite.packed == 0);
+			REQUIRE(rewrite.sections.empty());
+			REQUIRE(rewrite.headers.empty());
+			fs::remove(path);
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Address translation", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using shflags_t = typename TestType::shflags_t;
+	const auto alloc = shflags_t::Alloc;
+
+	const auto build = [alloc](elf_image_t<TestType>& image) {
+		std::vector<uint8_t> text(0x40);
+		std::vector<uint8_t> data(0x20);
+		for(size_t idx{}; idx < text.size(); ++idx)
+			text[idx] = uint8_t(idx);
+		for(size_t idx{}; idx < data.size(); ++idx)
+			data[idx] = uint8_t(0x80U + idx);
+		const auto text_index = image.add_section(".text", elf_shtype_t::ProgBits, text,
+			alloc | shflags_t::ExecInstr, 0x401000);
+		const auto data_index = image.add_section(".data", elf_shtype_t::ProgBits, data,
+			alloc | shflags_t::Write, 0x402000);
+		image.add_section(".bss", elf_shtype_t::NoBits, nullptr, 0x100, alloc | shflags_t::Write, 0x402020);
+		image.add_section(".comment", elf_shtype_t::ProgBits, text);
+		return std::make_pair(text_index, data_index);
+	};
+
+	SECTION( "Segments" ) {
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::Executable;
+		const auto [text_index, data_index] = build(image);
+		image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read | elf_phdr_flags_t::Execute,
+			text_index, text_index);
+		image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read | elf_phdr_flags_t::Write,
+			data_index, data_index + 1);
+		const auto path = image.write("address-translation");
+
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		REQUIRE(elf.address_index().size() == 2);
+		const uint64_t text_offset{elf.sheaders()[text_index].offset()};
+		const uint64_t data_offset{elf.sheaders()[data_index].offset()};
+
+		REQUIRE(elf.vaddr_to_offset(0x401000) == text_offset);
+		REQUIRE(elf.vaddr_to_offset(0x40103F) == text_offset + 0x3F);
+		REQUIRE(elf.vaddr_to_offset(0x401040) == address_index_t::npos);
+		REQUIRE(elf.vaddr_to_offset(0x402010) == data_offset + 0x10);
+		REQUIRE(elf.vaddr_to_offset(0x402020) == address_index_t::npos);
+		REQUIRE(elf.address_index().find_address(0x402100)->index == 1);
+		REQUIRE(elf.offset_to_vaddr(text_offset + 4) == 0x401004);
+		REQUIRE(elf.offset_to_vaddr(data_offset + 0x1F) == 0x40201F);
+
+		const std::vector<uint64_t> addresses{0x401000, 0x401010, 0x402000, 0x402030, 0x401020};
+		std::vector<uint64_t> offsets(addresses.size());
+		elf.vaddr_to_offset(addresses.data(), addresses.size(), offsets.data());
+		REQUIRE(offsets == std::vector<uint64_t>{text_offset, text_offset + 0x10, data_offset,
+			address_index_t::npos, text_offset + 0x20});
+		std::vector<uint64_t> round_trip(offsets.size());
+		elf.offset_to_vaddr(offsets.data(), offsets.size(), round_trip.data());
+		REQUIRE(round_trip == std::vector<uint64_t>{0x401000, 0x401010, 0x402000,
+			address_index_t::npos, 0x401020});
+
+		const auto view = elf.vaddr_view(0x401008, 8);
+		REQUIRE(view.size() == 8);
+		REQUIRE(view[0] == 0x08);
+		REQUIRE(view[7] == 0x0F);
+		REQUIRE(elf.vaddr_view(0x402018, 8)[0] == 0x98);
+		/* Running into .bss or off the end of .text */
+		REQUIRE(elf.vaddr_view(0x402018, 9).empty());
+		REQUIRE(elf.vaddr_view(0x401038, 9).empty());
+		REQUIRE(elf.vaddr_view(0x400000, 1).empty());
+
+		fs::remove(path);
+	}
+
+	SECTION( "Relocatable" ) {
+		elf_image_t<TestType> image{};
+		const auto [text_index, data_index] = build(image);
+		const auto path = image.write("address-translation-rel");
+
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		const auto addresses = elf.section_addresses();
+		REQUIRE(elf.address_index().size() == 3);
+		REQUIRE(elf.address_index().find_address(addresses[text_index])->index == text_index);
+		REQUIRE(elf.vaddr_to_offset(addresses[text_index] + 1) == elf.sheaders()[text_index].offset() + 1U);
+		REQUIRE(elf.vaddr_to_offset(addresses[data_index]) == elf.sheaders()[data_index].offset());
+		REQUIRE(elf.offset_to_vaddr(elf.sheaders()[data_index].offset() + 2U) == addresses[data_index] + 2);
+		REQUIRE(elf.vaddr_view(addresses[data_index], 0x20)[0x1F] == 0x9F);
+
+		fs::remove(path);
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Notes", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using shflags_t = typename TestType::shflags_t;
+	constexpr size_t word_size{sizeof(typename TestType::addr_t)};
+
+	std::vector<uint8_t> abi_tag{};
+	std::vector<uint8_t> build_id{};
+	std::vector<uint8_t> property{};
+	const auto add_note = [](std::vector<uint8_t>& notes, const uint32_t type, const std::string& name,
+		const std::vector<uint8_t>& desc, const size_t align) {
+		const typename TestType::nhdr_t nhdr{uint32_t(name.size() + 1U), uint32_t(desc.size()), type};
+		REQUIRE(nhdr.type() == type);
+		const auto* header = reinterpret_cast<const uint8_t*>(&nhdr); // lgtm[cpp/reinterpret-cast]
+		notes.insert(notes.end(), header, header + sizeof(nhdr));
+		notes.insert(notes.end(), name.begin(), name.end());
+		notes.resize(((notes.size() + 1U) + align - 1U) & ~(align - 1U));
+		notes.insert(notes.end(), desc.begin(), desc.end());
+		notes.resize((notes.size() + align - 1U) & ~(align - 1U));
+	};
+
+	add_note(abi_tag, uint32_t(elf_note_type_t::GNUABI), "GNU", {0, 0, 0, 0, 3, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0}, 4);
+	add_note(build_id, 0x100U, "Go", {1, 2, 3, 4}, 4);
+	add_note(build_id, uint32_t(elf_note_type_t::GNUBuildID), "GNU",
+		{0xDEU, 0xADU, 0xBEU, 0xEFU, 0x01U, 0x23U, 0x45U, 0x67U}, 4);
+	std::vector<uint8_t> properties{
+		0x02U, 0x00U, 0x00U, 0xC0U,  0x04U, 0x00U, 0x00U, 0x00U,  0x03U, 0x00U, 0x00U, 0x00U,
+	};
+	properties.resize((properties.size() + word_size - 1U) & ~(word_size - 1U));
+	properties.insert(properties.end(), {0x01U, 0x00U, 0x00U, 0x00U,  0x08U, 0x00U, 0x00U, 0x00U});
+	properties.resize(properties.size() + 8U, 0x5AU);
+	add_note(property, uint32_t(elf_note_type_t::GNUPropertyType), "GNU", properties, word_size);
+
+	const auto build = [&](elf_image_t<TestType>& image, const bool segments) {
+		const auto abi_index = image.add_section(".note.ABI-tag", elf_shtype_t::Note, abi_tag, shflags_t::Alloc);
+		const auto id_index = image.add_section(".note.gnu.build-id", elf_shtype_t::Note, build_id, shflags_t::Alloc);
+		const auto property_index = image.add_section(".note.gnu.property", elf_shtype_t::Note, property,
+			shflags_t::Alloc);
+		image.sections[abi_index].header.addraline(4);
+		image.sections[id_index].header.addraline(4);
+		image.sections[property_index].header.addraline(word_size);
+		if(!segments)
+			return;
+		image.type = elf_type_t::Executable;
+		image.add_segment(elf_phdr_type_t::Note, elf_phdr_flags_t::Read, property_index, property_index);
+		image.segments.back().header.align(word_size);
+		image.add_segment(elf_phdr_type_t::Note, elf_phdr_flags_t::Read, abi_index, id_index);
+		image.segments.back().header.align(4);
+		image.add_segment(elf_phdr_type_t::GNUProperty, elf_phdr_flags_t::Read, property_index, property_index);
+		image.segments.back().header.align(word_size);
+	};
+
+	const auto check = [&](const elf_t<TestType>& elf) {
+		const auto id = elf.build_id();
+		REQUIRE(id.size() == 8);
+		REQUIRE(id[0] == 0xDEU);
+		REQUIRE(id[7] == 0x67U);
+
+		elf_abi_tag_t tag{};
+		REQUIRE(elf.abi_tag(tag));
+		REQUIRE(tag.os == elf_note_os_t::Linux);
+		REQUIRE(tag.major == 3);
+		REQUIRE(tag.minor == 2);
+		REQUIRE(tag.patch == 0);
+
+		const auto found = elf.gnu_properties();
+		REQUIRE(found.size() == 2);
+		REQUIRE(found[0].type == uint32_t(elf_gnu_property_type_t::X86Feature1And));
+		REQUIRE(found[0].data.size() == 4);
+		REQUIRE(found[0].data[0] == 3);
+		REQUIRE(found[1].type == uint32_t(elf_gnu_property_type_t::StackSize));
+		REQUIRE(found[1].data.size() == 8);
+
+		elf_note_t note{};
+		REQUIRE_FALSE(elf.find_note(uint32_t(elf_note_type_t::GNUBuildID), "Go", note));
+		REQUIRE(elf.find_note(0x100U, "Go", note));
+		REQUIRE(note.desc.size() == 4);
+	};
+
+	SECTION( "Segments" ) {
+		elf_image_t<TestType> image{};
+		build(image, true);
+		const auto path = image.write("notes");
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+
+		size_t count{};
+		for(const auto& note : elf.segment_notes(1)) {
+			REQUIRE(note.name == ((count == 1) ? "Go" : "GNU"));
+			++count;
+		}
+		REQUIRE(count == 3);
+		REQUIRE(elf.segment_notes(0).align() == word_size);
+		check(elf);
+
+		/* Without the section headers it all still comes out of the segments */
+		elf.sheaders({});
+		check(elf);
+		fs::remove(path);
+	}
+
+	SECTION( "Sections" ) {
+		elf_image_t<TestType> image{};
+		build(image, false);
+		const auto path = image.write("notes-rel");
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		REQUIRE(elf.pheaders().size() == 0);
+		check(elf);
+		fs::remove(path);
+	}
+
+	SECTION( "Truncated" ) {
+		std::vector<uint8_t> notes{build_id};
+		notes.resize(notes.size() - 2U);
+		size_t count{};
+		for(const auto& note : elf_notes_t{{notes.data(), notes.size()}, 4}) {
+			REQUIRE(note.type == 0x100U);
+			++count;
+		}
+		REQUIRE(count == 1);
+		REQUIRE(elf_notes_t{}.begin() == elf_notes_t{}.end());
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Dynamic table", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using dyn_t = typename TestType::dyn_t;
+	using dyn_tag_t = typename TestType::dyn_tag_t;
+	using xword_t = typename TestType::xword_t;
+	using shflags_t = typename TestType::shflags_t;
+
+	const std::string dynstr{std::string{"\0libc.so.6\0libm.so.6\0libfoo.so.1\0$ORIGIN/../lib\0", 48}};
+	const auto build = [&](const uint64_t strtab_address) {
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::SharedObject;
+		const auto strtab = image.add_section(".dynstr", elf_shtype_t::StringTable, dynstr.data(), dynstr.size(),
+			shflags_t::Alloc, 0x1000);
+		const std::vector<dyn_t> entries{
+			{dyn_tag_t::Needed, 1},
+			{dyn_tag_t::StrTab, xword_t(strtab_address)},
+			{dyn_tag_t::Flags_1, 0x08000001U},
+			{dyn_tag_t::SOName, 21},
+			{dyn_tag_t::Needed, 11},
+			{dyn_tag_t::StrTabSize, xword_t(dynstr.size())},
+			{dyn_tag_t::RunPath, 33},
+			{dyn_tag_t::VerNeedNum, 2},
+			{dyn_tag_t::None, 0},
+			{dyn_tag_t::Needed, 1},
+		};
+		const auto dynamic = image.add_section(".dynamic", elf_shtype_t::Dynamic, entries,
+			shflags_t::Alloc | shflags_t::Write, 0x2000, uint32_t(strtab), 0, sizeof(dyn_t));
+		image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read, strtab, strtab);
+		image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read | elf_phdr_flags_t::Write, dynamic, dynamic);
+		image.add_segment(elf_phdr_type_t::Dynamic, elf_phdr_flags_t::Read, dynamic, dynamic);
+		return image.write("dynamic-table");
+	};
+
+	const auto check = [&dynstr](const elf_t<TestType>& elf) {
+		REQUIRE(elf.dynamic_entries().size() == 8);
+		REQUIRE(elf.dynamic_count(dyn_tag_t::Needed) == 2);
+		REQUIRE(elf.dynamic_count(dyn_tag_t::RPath) == 0);
+		REQUIRE(elf.needed() == std::vector<std::string_view>{"libc.so.6", "libm.so.6"});
+		REQUIRE(elf.dynamic_string(dyn_tag_t::SOName) == "libfoo.so.1");
+		REQUIRE(elf.dynamic_string(dyn_tag_t::RunPath) == "$ORIGIN/../lib");
+		REQUIRE(elf.dynamic_string(dyn_tag_t::RPath).empty());
+		REQUIRE(elf.dynamic_string_at(dynstr.size()).empty());
+
+		uint64_t value{};
+		REQUIRE(elf.dynamic_value(dyn_tag_t::Flags_1, value));
+		REQUIRE(value == 0x08000001U);
+		REQUIRE(elf.dynamic_value(dyn_tag_t::VerNeedNum, value));
+		REQUIRE(value == 2);
+		REQUIRE(elf.dynamic_value(dyn_tag_t::Needed, value, 1));
+		REQUIRE(value == 11);
+		REQUIRE_FALSE(elf.dynamic_value(dyn_tag_t::Needed, value, 2));
+		REQUIRE_FALSE(elf.dynamic_value(dyn_tag_t::VerDefNum, value));
+	};
+
+	SECTION( "Through DT_STRTAB" ) {
+		const auto path = build(0x1000);
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		check(elf);
+
+		/* PT_DYNAMIC when there aren't any section headers */
+		elf.sheaders({});
+		check(elf);
+		fs::remove(path);
+	}
+
+	SECTION( "Through the section link" ) {
+		const auto path = build(0x9000);
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		check(elf);
+
+		elf.sheaders({});
+		REQUIRE(elf.dynamic_entries().size() == 8);
+		REQUIRE(elf.dynamic_string(dyn_tag_t::SOName).empty());
+		fs::remove(path);
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Symbol versions", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+	using verdef_t = typename TestType::verdef_t;
+	using verdaux_t = typename TestType::verdaux_t;
+	using verneed_t = typename TestType::verneed_t;
+	using vernaux_t = typename TestType::vernaux_t;
+
+	std::string dynstr{std::string(1, '\0')};
+	const auto add_string = [&dynstr](const std::string& str) {
+		const auto offset = uint32_t(dynstr.size());
+		dynstr += str + '\0';
+		return offset;
+	};
+	std::vector<uint8_t> verdefs{};
+	std::vector<uint8_t> verneeds{};
+	const auto append = [](std::vector<uint8_t>& data, const auto& value) {
+		const auto* bytes = reinterpret_cast<const uint8_t*>(&value); // lgtm[cpp/reinterpret-cast]
+		data.insert(data.end(), bytes, bytes + sizeof(value));
+	};
+
+	const auto verdef_len = uint32_t(sizeof(verdef_t) + sizeof(verdaux_t));
+	append(verdefs, verdef_t{elf_verdef_revision_t::Current, elf_verdef_flag_t::Base, elf_verdef_index_t(1), 1, 0,
+		sizeof(verdef_t), verdef_len});
+	append(verdefs, verdaux_t{add_string("libfoo.so.1"), 0});
+	append(verdefs, verdef_t{elf_verdef_revision_t::Current, elf_verdef_flag_t::None, elf_verdef_index_t(2), 1, 0,
+		sizeof(verdef_t), verdef_len});
+	append(verdefs, verdaux_t{add_string("FOO_1.0"), 0});
+	/* The second aux is the version it inherits from */
+	append(verdefs, verdef_t{elf_verdef_revision_t::Current, elf_verdef_flag_t::Weak, elf_verdef_index_t(3), 2, 0,
+		sizeof(verdef_t), 0});
+	append(verdefs, verdaux_t{add_string("FOO_2.0"), sizeof(verdaux_t)});
+	append(verdefs, verdaux_t{add_string("FOO_1.0"), 0});
+
+	append(verneeds, verneed_t{1, 2, add_string("libc.so.6"), sizeof(verneed_t), 0});
+	append(verneeds, vernaux_t{0, elf_vernaux_flag_t::None, 4, add_string("GLIBC_2.2.5"), sizeof(vernaux_t)});
+	append(verneeds, vernaux_t{0, elf_vernaux_flag_t::Weak, 5, add_string("GLIBC_2.34"), 0});
+
+	const std::vector<uint16_t> versym{0, 1, 0x8002U, 3, 4, 5, 9};
+	elf_image_t<TestType> image{};
+	image.type = elf_type_t::SharedObject;
+	const auto strtab = image.add_section(".dynstr", elf_shtype_t::StringTable, dynstr.data(), dynstr.size());
+	const auto symtab = image.add_section(".dynsym", elf_shtype_t::DynamicSymbols, std::vector<symbol_t>(versym.size()),
+		TestType::shflags_t::None, 0, uint32_t(strtab), 1, sizeof(symbol_t));
+	image.add_section(".gnu.version", elf_shtype_t::GNUVerSym, versym, TestType::shflags_t::None, 0,
+		uint32_t(symtab), 0, sizeof(uint16_t));
+	image.add_section(".gnu.version_d", elf_shtype_t::GNUVerDef, verdefs, TestType::shflags_t::None, 0,
+		uint32_t(strtab), 3);
+	image.add_section(".gnu.version_r", elf_shtype_t::GNUVerNeed, verneeds, TestType::shflags_t::None, 0,
+		uint32_t(strtab), 1);
+	const auto path = image.write("symbol-versions");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	REQUIRE(elf.versioned_symbol_table() == symtab);
+
+	REQUIRE(elf.symbol_version(0).name.empty());
+	REQUIRE(elf.symbol_version(0).index == uint16_t(elf_verdef_index_t::Local));
+	/* Global, not the base definition */
+	REQUIRE(elf.symbol_version(1).name.empty());
+	REQUIRE(elf.symbol_version(1).index == uint16_t(elf_verdef_index_t::Global));
+
+	const auto hidden = elf.symbol_version(2);
+	REQUIRE(hidden.name == "FOO_1.0");
+	REQUIRE(hidden.file.empty());
+	REQUIRE(hidden.index == 2);
+	REQUIRE(hidden.hidden);
+	REQUIRE_FALSE(hidden.weak);
+
+	const auto current = elf.symbol_version(3);
+	REQUIRE(current.name == "FOO_2.0");
+	REQUIRE_FALSE(current.hidden);
+	REQUIRE(current.weak);
+
+	REQUIRE(elf.symbol_version(4).name == "GLIBC_2.2.5");
+	REQUIRE(elf.symbol_version(4).file == "libc.so.6");
+	REQUIRE_FALSE(elf.symbol_version(4).weak);
+	REQUIRE(elf.symbol_version(5).name == "GLIBC_2.34");
+	REQUIRE(elf.symbol_version(5).weak);
+
+	/* Indices nothing defines, and symbols past the end of .gnu.version */
+	REQUIRE(elf.symbol_version(6).name.empty());
+	REQUIRE(elf.symbol_version(6).index == 9);
+	REQUIRE(elf.symbol_version(7).index == 0);
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF EH frame", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	constexpr size_t word_size{sizeof(typename TestType::addr_t)};
+	constexpr uint64_t frame_addr{0x2000U};
+	constexpr uint64_t hdr_addr{0x1800U};
+
+	std::vector<uint8_t> eh_frame{};
+	const auto append = [](std::vector<uint8_t>& data, const auto value) {
+		const auto* bytes = reinterpret_cast<const uint8_t*>(&value); // lgtm[cpp/reinterpret-cast]
+		data.insert(data.end(), bytes, bytes + sizeof(value));
+	};
+	/* The length, the CIE id/pointer, then `body` padded out with DW_CFA_nop */
+	const auto add_entry = [&eh_frame, &append](const uint32_t id, std::vector<uint8_t> body) {
+		body.resize((body.size() + 3U) & ~size_t(3U));
+		const size_t offset{eh_frame.size()};
+		append(eh_frame, uint32_t(body.size() + sizeof(uint32_t)));
+		append(eh_frame, id);
+		eh_frame.insert(eh_frame.end(), body.begin(), body.end());
+		return offset;
+	};
+	/* pc_begin is pc relative, the range and any LSDA are udata4 */
+	const auto add_fde = [&eh_frame, &append, &add_entry](const size_t cie, const uint64_t pc, const uint32_t range,
+		const bool lsda) {
+		const size_t offset{eh_frame.size()};
+		std::vector<uint8_t> body{};
+		append(body, int32_t(pc - (frame_addr + offset + 8U)));
+		append(body, range);
+		body.push_back(lsda ? 4U : 0U);
+		if(lsda)
+			append(body, uint32_t(0x5000U));
+		body.push_back(0x41U); /* DW_CFA_advance_loc 1 */
+		return add_entry(uint32_t(offset + 4U - cie), body);
+	};
+
+	/* "zR", def_cfa r7+8 */
+	const size_t plain_cie = add_entry(0, {1U, 'z', 'R', 0U, 1U, 0x78U, 16U, 1U, 0x1BU, 0x0CU, 0x07U, 0x08U});
+	const size_t first = add_fde(plain_cie, 0x1000U, 0x40U, false);
+	const size_t third = add_fde(plain_cie, 0x1040U, 0x20U, false);
+
+	/* "zPLR", the personality being pc relative from its own field */
+	const size_t personality_cie{eh_frame.size()};
+	std::vector<uint8_t> cie_body{3U, 'z', 'P', 'L', 'R', 0U, 4U, 0x78U, 16U, 7U, 0x1BU};
+	append(cie_body, int32_t(0x3000U - (frame_addr + personality_cie + 8U + cie_body.size())));
+	cie_body.push_back(0x03U);
+	cie_body.push_back(0x1BU);
+	add_entry(0, cie_body);
+	const size_t second = add_fde(personality_cie, 0x1100U, 0x80U, true);
+	append(eh_frame, uint32_t{0});
+
+	const auto parsed = parse_eh_frame({eh_frame.data(), eh_frame.size()}, frame_addr, word_size);
+	REQUIRE(parsed.cies.size() == 2);
+	REQUIRE(parsed.fdes.size() == 3);
+	REQUIRE(parsed.cies[0].augmentation == "zR");
+	REQUIRE(parsed.cies[0].code_align == 1U);
+	REQUIRE(parsed.cies[0].data_align == -8);
+	REQUIRE(parsed.cies[0].return_register == 16U);
+	REQUIRE(parsed.cies[0].lsda_encoding == uint8_t(elf_eh_encoding_t::Omit));
+	REQUIRE(parsed.cies[0].instructions.size() == 3U);
+	REQUIRE(parsed.cies[1].version == 3U);
+	REQUIRE(parsed.cies[1].code_align == 4U);
+	REQUIRE(parsed.cies[1].personality == 0x3000U);
+	REQUIRE(parsed.cies[1].lsda_encoding == uint8_t(elf_eh_encoding_t::UData4));
+
+	/* Sorted by pc rather than by where they are in .eh_frame */
+	REQUIRE(parsed.fdes[0].offset == first);
+	REQUIRE(parsed.fdes[1].offset == third);
+	REQUIRE(parsed.fdes[2].offset == second);
+	REQUIRE(parsed.fdes[2].pc_begin == 0x1100U);
+	REQUIRE(parsed.fdes[2].pc_range == 0x80U);
+	REQUIRE(parsed.fdes[2].lsda == 0x5000U);
+	REQUIRE(parsed.cie(parsed.fdes[2]) == &parsed.cies[1]);
+	REQUIRE(parsed.find(0x1050U) == &parsed.fdes[1]);
+	REQUIRE(parsed.find(0x1060U) == nullptr);
+	REQUIRE(parsed.find(0xFFFU) == nullptr);
+
+	const auto hdr_contents = build_eh_frame_hdr(parsed, frame_addr, hdr_addr);
+	REQUIRE(hdr_contents.size() == 12U + (3U * 8U));
+	elf_eh_frame_hdr_t hdr{};
+	REQUIRE(parse_eh_frame_hdr({hdr_contents.data(), hdr_contents.size()}, hdr_addr, word_size, hdr));
+	REQUIRE(hdr.eh_frame == frame_addr);
+	REQUIRE(hdr.count == 3);
+	uint64_t fde_addr{};
+	REQUIRE(hdr.find(0x1100U, fde_addr));
+	REQUIRE(fde_addr == frame_addr + second);
+	REQUIRE_FALSE(hdr.find(0xFFFU, fde_addr));
+	/* Too far away to be encoded */
+	REQUIRE(build_eh_frame_hdr(parsed, frame_addr, hdr_addr + 0x100000000U).empty());
+
+	const auto lookups = [](const elf_t<TestType>& elf) {
+		elf_eh_fde_t fde{};
+		REQUIRE(elf.find_fde(0x1000U, fde));
+		REQUIRE(fde.pc_begin == 0x1000U);
+		REQUIRE(elf.find_fde(0x117FU, fde));
+		REQUIRE(fde.pc_begin == 0x1100U);
+		REQUIRE(fde.lsda == 0x5000U);
+		REQUIRE(elf.find_fde(0x1045U, fde));
+		REQUIRE(fde.pc_range == 0x20U);
+		REQUIRE_FALSE(elf.find_fde(0x1060U, fde));
+		REQUIRE_FALSE(elf.find_fde(0x1180U, fde));
+		REQUIRE_FALSE(elf.find_fde(0x800U, fde));
+		REQUIRE(elf.eh_frame().fdes.size() == 3);
+	};
+
+	SECTION( "Sections" ) {
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::SharedObject;
+		/* Stale, regenerated below */
+		const auto hdr_section = image.add_section(".eh_frame_hdr", elf_shtype_t::ProgBits,
+			std::vector<uint8_t>(hdr_contents.size()), TestType::shflags_t::Alloc, hdr_addr);
+		image.add_section(".eh_frame", elf_shtype_t::ProgBits, eh_frame, TestType::shflags_t::Alloc, frame_addr);
+		const auto path = image.write("eh-frame-sections");
+
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		/* No table, so everything goes through the parsed .eh_frame */
+		REQUIRE_FALSE(elf.eh_frame_hdr(hdr));
+		lookups(elf);
+
+		const auto rewrite = elf.rebuild_eh_frame_hdr();
+		REQUIRE(rewrite.index == hdr_section);
+		REQUIRE(rewrite.name == ".eh_frame_hdr");
+		REQUIRE(rewrite.contents == hdr_contents);
+	}
+
+	SECTION( "Segments" ) {
+		elf_image_t<TestType> image{};
+		image.type = elf_type_t::SharedObject;
+		/* Neither has the name anything looks for, it all has to come through PT_GNU_EH_FRAME */
+		const auto hdr_section = image.add_section("hdr", elf_shtype_t::ProgBits, hdr_contents,
+			TestType::shflags_t::Alloc, hdr_addr);
+		const auto frame_section = image.add_section("frame", elf_shtype_t::ProgBits, eh_frame,
+			TestType::shflags_t::Alloc, frame_addr);
+		image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read, hdr_section, hdr_section);
+		image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read, frame_section, frame_section);
+		image.add_segment(elf_phdr_type_t::GNUEHFrame, elf_phdr_flags_t::Read, hdr_section, hdr_section);
+		const auto path = image.write("eh-frame-segments");
+
+		elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		REQUIRE(elf.eh_frame_hdr(hdr));
+		REQUIRE(hdr.count == 3);
+		lookups(elf);
+		REQUIRE(elf.rebuild_eh_frame_hdr().contents.empty());
+	}
+}
+
+TEMPLATE_TEST_CASE( "ELF Open any class", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	elf_image_t<TestType> image{};
+	image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0x40, TestType::shflags_t::Alloc, 0x401000);
+	const auto path = image.write("open-any");
+	constexpr auto eclass = (sizeof(typename TestType::addr_t) == 8U) ? elf_class_t::ELF64 : elf_class_t::ELF32;
+
+	REQUIRE(elf_class_of(path) == eclass);
+	elf_any_t elf{};
+	REQUIRE(open_elf(path, elf));
+	REQUIRE(std::holds_alternative<elf_t<TestType>>(elf));
+
+	size_t text{};
+	size_t header_size{};
+	REQUIRE(visit_elf(elf, [&](const auto& object) {
+		text = object.find_section(".text");
+		header_size = sizeof(typename std::decay_t<decltype(object)>::ehdr_t);
+	}));
+	REQUIRE(text != 0);
+	REQUIRE(header_size == sizeof(typename TestType::ehdr_t));
+
+	SECTION( "Other byte order" ) {
+		{
+			std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+			file.seekp(5);
+			file.put(char(elf_host_data == elf_data_t::LSB ? elf_data_t::MSB : elf_data_t::LSB));
+		}
+		REQUIRE(elf_class_of(path) == elf_class_t::None);
+		REQUIRE_FALSE(open_elf(path, elf));
+		REQUIRE(std::holds_alternative<std::monostate>(elf));
+		REQUIRE_FALSE(visit_elf(elf, [](const auto&) { FAIL(); }));
+	}
+
+	SECTION( "Not ELF" ) {
+		fs::resize_file(path, 2);
+		REQUIRE_FALSE(open_elf(path, elf));
+		REQUIRE_FALSE(open_elf(path.string() + ".missing", elf));
+	}
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Xref index", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+	using rela_t = typename TestType::rela_t;
+	using shflags_t = typename TestType::shflags_t;
+
+	elf_image_t<TestType> image{};
+	const auto text_index = image.add_section(".text", elf_shtype_t::ProgBits, std::vector<uint8_t>(0x50),
+		shflags_t::Alloc | shflags_t::ExecInstr);
+	const auto data_index = image.add_section(".data", elf_shtype_t::ProgBits, std::vector<uint8_t>(8),
+		shflags_t::Alloc | shflags_t::Write);
+
+	std::string strtab{std::string(1, '\0')};
+	std::vector<symbol_t> symbols(1);
+	const auto add_symbol = [&](const std::string& name, const elf_symbol_type_t type, const size_t section,
+		const uint64_t value, const uint64_t size) {
+		symbol_t symbol{};
+		symbol.name(uint32_t(strtab.size()));
+		strtab += name + '\0';
+		symbol.info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Global), uint8_t(type)));
+		symbol.shndx(uint16_t(section));
+		symbol.value(typename TestType::addr_t(value));
+		symbol.size(typename TestType::xword_t(size));
+		symbols.push_back(symbol);
+		return symbols.size() - 1U;
+	};
+	const auto text_sym = add_symbol("", elf_symbol_type_t::Section, text_index, 0, 0);
+	const auto main_sym = add_symbol("main", elf_symbol_type_t::Function, text_index, 0x00, 0x20);
+	const auto helper = add_symbol("helper", elf_symbol_type_t::Function, text_index, 0x20, 0x10);
+	const auto alias = add_symbol("helper_alias", elf_symbol_type_t::Function, text_index, 0x20, 0x10);
+	const auto unused = add_symbol("unused", elf_symbol_type_t::Function, text_index, 0x30, 0x10);
+	const auto table = add_symbol("table", elf_symbol_type_t::Object, data_index, 0, 8);
+	const auto puts = add_symbol("puts", elf_symbol_type_t::NoType, 0, 0, 0);
+	const auto local = add_symbol("local", elf_symbol_type_t::Function, text_index, 0x40, 0x10);
+
+	const auto strtab_index = image.add_section(".strtab", elf_shtype_t::StringTable, strtab.data(), strtab.size());
+	const auto symtab = image.add_section(".symtab", elf_shtype_t::SymbolTable, symbols,
+		shflags_t::None, 0, uint32_t(strtab_index), 1, sizeof(symbol_t));
+	const auto add_rela = [&](const std::string& name, const size_t target, const std::vector<rela_t>& entries) {
+		return image.add_section(name, elf_shtype_t::RelA, entries, shflags_t::InfoLink, 0,
+			uint32_t(symtab), uint32_t(target), sizeof(rela_t));
+	};
+	const auto rela_text = add_rela(".rela.text", text_index, {
+		{0x04, rela_t::make_info(uint32_t(alias), 2), 0},
+		{0x08, rela_t::make_info(uint32_t(puts), 2), 0},
+		{0x10, rela_t::make_info(uint32_t(text_sym), 4), 0x3C}, /* R_X86_64_PLT32 .text+0x40-4 */
+		{0x24, rela_t::make_info(uint32_t(table), 1), 0},
+		{0x34, rela_t::make_info(uint32_t(helper), 2), 0},
+		{0x38, rela_t::make_info(0, 3), 0},
+	});
+	add_rela(".rela.data", data_index, {
+		{0x00, rela_t::make_info(uint32_t(main_sym), 1), 0},
+	});
+	const auto path = image.write("xref-index");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	const auto& xrefs = elf.xref_index();
+	REQUIRE(xrefs.tables.size() == 1);
+	/* The one without a symbol isn't a reference to anything */
+	REQUIRE(xrefs.index.size() == 6);
+
+	const uint32_t main_node{xrefs.node(symtab, main_sym)};
+	const uint32_t unused_node{xrefs.node(symtab, unused)};
+	REQUIRE(xrefs.node(symtab, alias) == xrefs.node(symtab, helper));
+	REQUIRE(xrefs.node(symtab, symbols.size()) == elf_xref_index_t::npos);
+	REQUIRE(xrefs.node(strtab_index, 1) == elf_xref_index_t::npos);
+	size_t table_section{};
+	size_t symbol{};
+	REQUIRE(xrefs.symbol(main_node, table_section, symbol));
+	REQUIRE(table_section == symtab);
+	REQUIRE(symbol == main_sym);
+
+	/* Either name gets both */
+	const auto helper_sites = elf.references(symtab, alias);
+	REQUIRE(helper_sites.size() == 2);
+	REQUIRE(helper_sites[0].offset == 0x04);
+	REQUIRE(helper_sites[0].from == main_node);
+	REQUIRE(helper_sites[1].offset == 0x34);
+	REQUIRE(helper_sites[1].from == unused_node);
+	REQUIRE(elf.references(symtab, helper).size() == 2);
+
+	const auto puts_sites = elf.references(symtab, puts);
+	REQUIRE(puts_sites.size() == 1);
+	REQUIRE(puts_sites[0].section == text_index);
+	REQUIRE(puts_sites[0].source == rela_text);
+	REQUIRE(puts_sites[0].type == 2);
+
+	const auto main_sites = elf.references(symtab, main_sym);
+	REQUIRE(main_sites.size() == 1);
+	REQUIRE(main_sites[0].section == data_index);
+	REQUIRE(main_sites[0].from == xrefs.node(symtab, table));
+	REQUIRE(elf.references(symtab, unused).size() == 0);
+
+	/* Statics are referred to through the section symbol */
+	const auto local_sites = elf.references(symtab, local);
+	REQUIRE(local_sites.size() == 1);
+	REQUIRE(local_sites[0].offset == 0x10);
+	REQUIRE(local_sites[0].from == main_node);
+	REQUIRE(elf.references(symtab, text_sym).size() == 0);
+
+	/* main and table reference each other, nothing keeps unused alive */
+	const auto live = xrefs.reachable({main_node});
+	REQUIRE(live.size() == 5);
+	REQUIRE(std::find(live.begin(), live.end(), unused_node) == live.end());
+	REQUIRE(std::find(live.begin(), live.end(), xrefs.node(symtab, puts)) != live.end());
+	REQUIRE(std::find(live.begin(), live.end(), xrefs.node(symtab, local)) != live.end());
+	/* Roots are folded as well */
+	REQUIRE(xrefs.reachable({uint32_t(xrefs.bases[0] + alias)}) == live);
+	REQUIRE(xrefs.reachable({unused_node}).size() == 6);
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Section to segment mapping", "[elf]", elf_types_32_t, elf_types_64_t ) {
+	using shflags_t = typename TestType::shflags_t;
+	const auto alloc = shflags_t::Alloc;
+	const auto data = shflags_t::Alloc | shflags_t::Write;
+	const auto tls = shflags_t::Alloc | shflags_t::Write | shflags_t::TLS;
+
+	elf_image_t<TestType> image{};
+	image.type = elf_type_t::Executable;
+	const auto interp = image.add_section(".interp", elf_shtype_t::ProgBits, std::vector<uint8_t>(16), alloc, 0x400200);
+	const auto note = image.add_section(".note", elf_shtype_t::Note, std::vector<uint8_t>(8), alloc, 0x400210);
+	const auto text = image.add_section(".text", elf_shtype_t::ProgBits, std::vector<uint8_t>(0x40),
+		alloc | shflags_t::ExecInstr, 0x400300);
+	const auto tdata = image.add_section(".tdata", elf_shtype_t::ProgBits, std::vector<uint8_t>(8), tls, 0x401000);
+	const auto tbss = image.add_section(".tbss", elf_shtype_t::NoBits, nullptr, 0x10, tls, 0x401008);
+	const auto data_index = image.add_section(".data", elf_shtype_t::ProgBits, std::vector<uint8_t>(8), data, 0x401008);
+	const auto bss = image.add_section(".bss", elf_shtype_t::NoBits, nullptr, 0x20, data, 0x401010);
+	const auto comment = image.add_section(".comment", elf_shtype_t::ProgBits, std::vector<uint8_t>(4));
+	/* Right on the end of PT_NOTE, but inside of the first PT_LOAD */
+	const auto empty = image.add_section(".empty", elf_shtype_t::NoBits, nullptr, 0, alloc, 0x400218);
+
+	image.add_segment(elf_phdr_type_t::Interpreter, elf_phdr_flags_t::Read, interp, interp);
+	image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read, interp, text);
+	image.add_segment(elf_phdr_type_t::Note, elf_phdr_flags_t::Read, note, note);
+	image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read, tdata, bss);
+	image.add_segment(elf_phdr_type_t::ThreadLocalStorage, elf_phdr_flags_t::Read, tdata, tbss);
+	image.add_segment(elf_phdr_type_t::GNUStack, elf_phdr_flags_t::Read, 0, 0);
+	const auto path = image.write("segment-map");
+
+	elf_t<TestType> elf{path};
+	REQUIRE(elf.valid());
+	const auto sections_of = [&elf](const size_t segment) {
+		const auto sections = elf.segment_sections(segment);
+		return std::vector<uint32_t>(sections.data(), sections.data() + sections.size());
+	};
+	const auto segments_of = [&elf](const size_t section) {
+		const auto segments = elf.section_segments(section);
+		return std::vector<uint32_t>(segments.data(), segments.data() + segments.size());
+	};
+
+	REQUIRE(sections_of(0) == std::vector<uint32_t>{uint32_t(interp)});
+	REQUIRE(sections_of(1) == std::vector<uint32_t>{uint32_t(interp), uint32_t(note), uint32_t(text),
+		uint32_t(empty)});
+	REQUIRE(sections_of(2) == std::vector<uint32_t>{uint32_t(note)});
+	/* .tbss only takes up room in PT_TLS */
+	REQUIRE(sections_of(3) == std::vector<uint32_t>{uint32_t(tdata), uint32_t(data_index), uint32_t(bss)});
+	REQUIRE(sections_of(4) == std::vector<uint32_t>{uint32_t(tdata), uint32_t(tbss)});
+	REQUIRE(sections_of(5).empty());
+	REQUIRE(sections_of(6).empty());
+
+	REQUIRE(segments_of(0).empty());
+	REQUIRE(segments_of(interp) == std::vector<uint32_t>{0, 1});
+	REQUIRE(segments_of(note) == std::vector<uint32_t>{1, 2});
+	REQUIRE(segments_of(tdata) == std::vector<uint32_t>{3, 4});
+	REQUIRE(segments_of(tbss) == std::vector<uint32_t>{4});
+	REQUIRE(segments_of(empty) == std::vector<uint32_t>{1});
+	REQUIRE(segments_of(comment).empty());
+	REQUIRE(segments_of(elf.sheaders().size()).empty());
+
+	/* Dropping the program headers drops the mapping with them */
+	elf.pheaders({});
+	REQUIRE(segments_of(interp).empty());
+
+	fs::remove(path);
+}
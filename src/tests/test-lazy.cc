@@ -0,0 +1,51 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <lazy.hh>
+
+TEST_CASE( "Lazy values", "[lazy]" ) {
+	lazy_t<std::string> lazy{};
+	size_t calls{};
+	auto make = [&]() { ++calls; return std::string{"Slice 'N Splice"}; };
+
+	SECTION( "Built once on first use" ) {
+		REQUIRE_FALSE(lazy.built());
+		const auto& first = lazy.get(make);
+		const auto& second = lazy.get(make);
+		REQUIRE(lazy.built());
+		REQUIRE(calls == 1);
+		REQUIRE(&first == &second);
+		REQUIRE(first == "Slice 'N Splice");
+	}
+
+	SECTION( "Reset rebuilds" ) {
+		(void)lazy.get(make);
+		lazy.reset();
+		REQUIRE_FALSE(lazy.built());
+		(void)lazy.get(make);
+		REQUIRE(calls == 2);
+	}
+
+	SECTION( "Moves keep the value" ) {
+		const auto* value = &lazy.get(make);
+		lazy_t<std::string> moved{std::move(lazy)};
+		REQUIRE(moved.built());
+		REQUIRE(&moved.get(make) == value);
+		REQUIRE(calls == 1);
+	}
+
+	SECTION( "Concurrent first use" ) {
+		std::vector<std::thread> threads{};
+		std::vector<const std::string*> seen(8);
+		for(size_t idx{}; idx < seen.size(); ++idx)
+			threads.emplace_back([&, idx]() { seen[idx] = &lazy.get(make); });
+		for(auto& thread : threads)
+			thread.join();
+		REQUIRE(calls == 1);
+		for(const auto* value : seen)
+			REQUIRE(value == seen.front());
+	}
+}
@@ -0,0 +1,60 @@
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <lru_cache.hh>
+
+using test_cache_t = lru_cache_t<int, std::vector<uint8_t>>;
+
+TEST_CASE( "LRU Cache", "[lru_cache]" ) {
+	test_cache_t cache{64};
+
+	SECTION( "Insertion and lookup" ) {
+		REQUIRE(cache.find(1) == nullptr);
+		cache.insert(1, std::make_shared<const std::vector<uint8_t>>(16));
+		REQUIRE(cache.find(1) != nullptr);
+		REQUIRE(cache.size() == 16);
+		REQUIRE(cache.count() == 1);
+	}
+
+	SECTION( "Factory is only run on a miss" ) {
+		size_t calls{};
+		auto make = [&]() { ++calls; return std::vector<uint8_t>(8, 0xAAU); };
+		auto first = cache.get_or_insert(1, make);
+		auto second = cache.get_or_insert(1, make);
+		REQUIRE(calls == 1);
+		REQUIRE(first == second);
+	}
+
+	SECTION( "Eviction by bytes" ) {
+		cache.insert(1, std::make_shared<const std::vector<uint8_t>>(32));
+		cache.insert(2, std::make_shared<const std::vector<uint8_t>>(16));
+		auto pinned = cache.find(2);
+		/* Touch 1 so 2 is the oldest */
+		REQUIRE(cache.find(1) != nullptr);
+		cache.insert(3, std::make_shared<const std::vector<uint8_t>>(24));
+
+		REQUIRE(cache.contains(1));
+		REQUIRE_FALSE(cache.contains(2));
+		REQUIRE(cache.contains(3));
+		REQUIRE(cache.size() == 56);
+		/* Evicted values stay alive for whoever is holding them */
+		REQUIRE(pinned->size() == 16);
+	}
+
+	SECTION( "Oversized values are not retained" ) {
+		auto value = cache.insert(1, std::make_shared<const std::vector<uint8_t>>(128));
+		REQUIRE(value->size() == 128);
+		REQUIRE_FALSE(cache.contains(1));
+		REQUIRE(cache.size() == 0);
+	}
+
+	SECTION( "Shrinking the capacity evicts" ) {
+		cache.insert(1, std::make_shared<const std::vector<uint8_t>>(32));
+		cache.insert(2, std::make_shared<const std::vector<uint8_t>>(32));
+		cache.capacity(40);
+		REQUIRE(cache.count() == 1);
+		REQUIRE(cache.contains(2));
+	}
+}
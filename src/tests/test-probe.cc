@@ -0,0 +1,214 @@
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "elf-image.hh"
+
+#include <probe.hh>
+
+static fs::path write_file(const std::string& name, const std::vector<uint8_t>& contents) {
+	const fs::path path{fs::temp_directory_path() / ("sns-test-" + name)};
+	std::ofstream file{path, std::ios::binary | std::ios::trunc};
+	file.write(reinterpret_cast<const char*>(contents.data()), std::streamsize(contents.size())); // lgtm[cpp/reinterpret-cast]
+	return path;
+}
+
+static probe_t probe_bytes(const std::string& name, const std::vector<uint8_t>& contents) {
+	const auto path = write_file(name, contents);
+	auto probe = probe_object(path);
+	fs::remove(path);
+	return probe;
+}
+
+TEMPLATE_TEST_CASE( "Probe ELF", "[probe]", elf_types_32_t, elf_types_64_t ) {
+	using shflags_t = typename TestType::shflags_t;
+	constexpr uint8_t bits{sizeof(typename TestType::addr_t) * 8U};
+
+	elf_image_t<TestType> image{};
+	image.type = elf_type_t::SharedObject;
+	image.machine = elf_machine_t::AARCH64;
+	/* Something first that the note walk has to step over */
+	std::vector<uint8_t> notes{
+		4, 0, 0, 0,  4, 0, 0, 0,  1, 0, 0, 0,  'G', 'N', 'U', 0,  0, 0, 0, 0,
+		4, 0, 0, 0,  20, 0, 0, 0,  3, 0, 0, 0,  'G', 'N', 'U', 0,
+	};
+	for(uint8_t idx{}; idx < 20; ++idx)
+		notes.push_back(uint8_t(0xA0U + idx));
+	/* Well past the first read so the segment has to be fetched */
+	image.add_section(".text", elf_shtype_t::ProgBits, std::vector<uint8_t>(8_KiB), shflags_t::Alloc, 0x1000);
+	const auto note = image.add_section(".note.gnu.build-id", elf_shtype_t::Note, notes, shflags_t::Alloc, 0x3000);
+	image.add_segment(elf_phdr_type_t::Note, elf_phdr_flags_t::Read, note, note);
+	const auto path = image.write("probe-elf");
+
+	const auto probe = probe_object(path);
+	REQUIRE(probe.valid());
+	REQUIRE(probe.format == object_format_t::ELF);
+	REQUIRE(probe.bits == bits);
+	REQUIRE_FALSE(probe.big_endian);
+	REQUIRE(probe.machine == uint32_t(elf_machine_t::AARCH64));
+	REQUIRE(probe.type == uint32_t(elf_type_t::SharedObject));
+	REQUIRE(probe.file_size == fs::file_size(path));
+	REQUIRE(probe.build_id.size() == 20);
+	REQUIRE(probe.build_id.front() == 0xA0U);
+	REQUIRE(probe.build_id.back() == 0xB3U);
+	/* The header, then just the note */
+	REQUIRE(probe.bytes_read == probe_header_len + notes.size());
+	REQUIRE(probe.bytes_read < probe.file_size);
+
+	fs::remove(path);
+}
+
+TEST_CASE( "Probe formats", "[probe]" ) {
+	std::vector<uint8_t> contents(128);
+	const auto put32 = [&contents](const size_t offset, const uint32_t value) {
+		std::memcpy(contents.data() + offset, &value, sizeof(value));
+	};
+
+	SECTION( "Empty and unknown" ) {
+		REQUIRE_FALSE(probe_object(fs::path{"/nonexistent/sns-test-probe"}).valid());
+		REQUIRE(probe_bytes("probe-empty", {}).format == object_format_t::Unknown);
+		REQUIRE(probe_bytes("probe-zero", contents).format == object_format_t::Unknown);
+	}
+
+	SECTION( "Truncated ELF" ) {
+		const auto probe = probe_bytes("probe-elf-magic", {0x7FU, 'E', 'L', 'F'});
+		REQUIRE(probe.format == object_format_t::ELF);
+		REQUIRE(probe.bits == 0);
+		REQUIRE(probe.build_id.empty());
+	}
+
+	SECTION( "Big endian ELF" ) {
+		contents[0] = 0x7FU;
+		contents[1] = 'E';
+		contents[2] = 'L';
+		contents[3] = 'F';
+		contents[4] = uint8_t(elf_class_t::ELF32);
+		contents[5] = uint8_t(elf_data_t::MSB);
+		contents[17] = uint8_t(elf_type_t::Executable);
+		contents[19] = uint8_t(elf_machine_t::MIPS);
+		const auto probe = probe_bytes("probe-elf-msb", contents);
+		REQUIRE(probe.format == object_format_t::ELF);
+		REQUIRE(probe.bits == 32);
+		REQUIRE(probe.big_endian);
+		REQUIRE(probe.machine == uint32_t(elf_machine_t::MIPS));
+		REQUIRE(probe.type == uint32_t(elf_type_t::Executable));
+	}
+
+	SECTION( "Mach-O" ) {
+		put32(0, 0xFEEDFACFU);
+		put32(4, 0x0100000CU); /* ARM64 */
+		put32(12, 2);          /* MH_EXECUTE */
+		put32(16, 2);
+		put32(20, 40);
+		put32(32, 0x2AU);      /* LC_SOURCE_VERSION */
+		put32(36, 16);
+		put32(48, 0x1BU);      /* LC_UUID */
+		put32(52, 24);
+		for(uint8_t idx{}; idx < 16; ++idx)
+			contents[56U + idx] = idx;
+		const auto probe = probe_bytes("probe-macho", contents);
+		REQUIRE(probe.format == object_format_t::MachO);
+		REQUIRE(probe.bits == 64);
+		REQUIRE(probe.machine == 0x0100000CU);
+		REQUIRE(probe.type == 2);
+		REQUIRE(probe.build_id.size() == 16);
+		REQUIRE(probe.build_id[15] == 15);
+	}
+
+	SECTION( "Mach-O Universal, not Java" ) {
+		contents[0] = 0xCAU;
+		contents[1] = 0xFEU;
+		contents[2] = 0xBAU;
+		contents[3] = 0xBEU;
+		contents[7] = 2;
+		contents[8] = 0x01U;
+		contents[11] = 0x07U;
+		const auto probe = probe_bytes("probe-fat", contents);
+		REQUIRE(probe.format == object_format_t::MachOFat);
+		REQUIRE(probe.machine == 0x01000007U);
+
+		/* Class file version 52.0 */
+		contents[7] = 52;
+		REQUIRE(probe_bytes("probe-class", contents).format == object_format_t::Unknown);
+	}
+
+	SECTION( "PE" ) {
+		contents[0] = 'M';
+		contents[1] = 'Z';
+		REQUIRE(probe_bytes("probe-mz", contents).format == object_format_t::Unknown);
+
+		put32(0x3C, 0x40);
+		std::memcpy(contents.data() + 0x40, "PE\0\0", 4);
+		put32(0x44, 0x8664U);
+		put32(0x54, 0xF0U | (0x2022U << 16U));
+		put32(0x58, 0x020BU);
+		const auto probe = probe_bytes("probe-pe", contents);
+		REQUIRE(probe.format == object_format_t::PE);
+		REQUIRE(probe.machine == 0x8664U);
+		REQUIRE(probe.type == 0x2022U);
+		REQUIRE(probe.bits == 64);
+	}
+
+	SECTION( "COFF family" ) {
+		contents[0] = 0x4CU;
+		contents[1] = 0x01U;
+		auto probe = probe_bytes("probe-coff", contents);
+		REQUIRE(probe.format == object_format_t::COFF);
+		REQUIRE(probe.machine == 0x014CU);
+
+		contents[0] = 0x01U;
+		contents[1] = 0xF7U;
+		probe = probe_bytes("probe-xcoff", contents);
+		REQUIRE(probe.format == object_format_t::XCOFF);
+		REQUIRE(probe.bits == 64);
+		REQUIRE(probe.big_endian);
+
+		contents[0] = 0x01U;
+		contents[1] = 0x60U;
+		probe = probe_bytes("probe-ecoff", contents);
+		REQUIRE(probe.format == object_format_t::ECOFF);
+		REQUIRE(probe.big_endian);
+		REQUIRE(probe.machine == 0x0160U);
+	}
+
+	SECTION( "a.out" ) {
+		put32(0, 0x00640000U | 0413U);
+		auto probe = probe_bytes("probe-aout", contents);
+		REQUIRE(probe.format == object_format_t::AOut);
+		REQUIRE(probe.machine == 0x64U);
+		REQUIRE_FALSE(probe.big_endian);
+
+		contents[0] = 0x00U;
+		contents[1] = 0x86U;
+		contents[2] = 0x01U;
+		contents[3] = 0x07U;
+		probe = probe_bytes("probe-aout-netbsd", contents);
+		REQUIRE(probe.format == object_format_t::AOut);
+		REQUIRE(probe.machine == 0x86U);
+		REQUIRE(probe.big_endian);
+	}
+
+	SECTION( "OS/360 object deck" ) {
+		contents[0] = 0x02U;
+		contents[1] = 0xC5U;
+		contents[2] = 0xE2U;
+		contents[3] = 0xC4U;
+		REQUIRE(probe_bytes("probe-os360", contents).format == object_format_t::OS360);
+	}
+
+	SECTION( "Batch" ) {
+		elf_image_t<elf_types_64_t> image{};
+		const auto elf = image.write("probe-batch-elf");
+		const auto unknown = write_file("probe-batch-unknown", contents);
+		const auto probes = probe_objects({elf, unknown, elf}, 2);
+		REQUIRE(probes.size() == 3);
+		REQUIRE(probes[0].format == object_format_t::ELF);
+		REQUIRE(probes[1].format == object_format_t::Unknown);
+		REQUIRE(probes[2].format == object_format_t::ELF);
+		fs::remove(elf);
+		fs::remove(unknown);
+	}
+}
@@ -0,0 +1,194 @@
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "elf-image.hh"
+
+#include <sidecar.hh>
+
+TEST_CASE( "Sidecar", "[sidecar]" ) {
+	const fs::path path{fs::temp_directory_path() / "sns-test-sidecar.sns-index"};
+
+	std::vector<symbol_entry_t> entries{
+		{0x1000, 0x100, "function", 1, 1, 1, 2},
+		{0x1000, 0x100, "function_alias", 1, 2, 2, 2},
+		{0x1080, 0, "label", 1, 3, 0, 0},
+		{0x2000, 8, "object", 1, 4, 1, 1},
+		{0x3000, 0, "unsized", 1, 5, 1, 2},
+	};
+	const symbol_index_t symbols{entries};
+	const address_index_t addresses{{
+		{0x404E10, 0x3E10, 0x220, 0x1000, 3},
+		{0x400000, 0x0000, 0x3E80, 0x3E80, 2},
+	}};
+	const std::vector<std::pair<std::string_view, size_t>> sections{
+		{".text", 1}, {".data", 3}, {".text", 5}, {".bss", 4},
+	};
+
+	sidecar_key_t key{};
+	key.inode = 42;
+	key.size = 0x8000;
+	key.mtime = 1234567890;
+	REQUIRE(write_sidecar(path, key, sections, symbols, addresses));
+
+	SECTION( "Round trip" ) {
+		const sidecar_t sidecar{path, key};
+		REQUIRE(sidecar.valid());
+
+		REQUIRE(sidecar.sections().size() == 3);
+		REQUIRE(sidecar.find_section(".bss") == 4);
+		REQUIRE(sidecar.find_section(".data") == 3);
+		/* The first one wins */
+		REQUIRE(sidecar.find_section(".text") == 1);
+		REQUIRE(sidecar.find_section(".rodata") == 0);
+
+		REQUIRE(sidecar.symbols().size() == symbols.size());
+		std::mt19937_64 rng{0x5EED};
+		std::uniform_int_distribution<uint64_t> dist{0x0F00, 0x3100};
+		for(size_t idx{}; idx < 4096; ++idx) {
+			const uint64_t address{dist(rng)};
+			const auto* expected = symbols.find(address);
+			const auto* symbol = sidecar.find_symbol(address);
+			REQUIRE((expected == nullptr) == (symbol == nullptr));
+			if(expected == nullptr)
+				continue;
+			REQUIRE(sidecar.symbol_name(*symbol) == expected->name);
+			REQUIRE(symbol->index == expected->index);
+			REQUIRE(symbol->size == expected->size);
+		}
+		REQUIRE(sidecar.symbol_name(*sidecar.find_symbol(0x1080)) == "label");
+		REQUIRE(sidecar.symbol_name(*sidecar.find_symbol(0x1081)) == "function");
+
+		for(uint64_t address{0x3FFF00}; address < 0x406000; address += 0x10)
+			REQUIRE(sidecar.to_offset(address) == addresses.to_offset(address));
+	}
+
+	SECTION( "Key mismatch" ) {
+		sidecar_key_t other{key};
+		other.mtime += 1;
+		REQUIRE_FALSE(sidecar_t{path, other}.valid());
+
+		other = key;
+		other.build_id = {1, 2, 3, 4};
+		REQUIRE_FALSE(sidecar_t{path, other}.valid());
+	}
+
+	SECTION( "Truncated" ) {
+		fs::resize_file(path, fs::file_size(path) - 1U);
+		REQUIRE_FALSE(sidecar_t{path, key}.valid());
+		fs::resize_file(path, sizeof(sidecar_header_t) - 1U);
+		REQUIRE_FALSE(sidecar_t{path, key}.valid());
+	}
+
+	SECTION( "Concurrent writers" ) {
+		std::vector<std::thread> writers{};
+		std::atomic<size_t> failed{};
+		for(size_t idx{}; idx < 8; ++idx) {
+			writers.emplace_back([&]() {
+				for(size_t round{}; round < 16; ++round) {
+					if(!write_sidecar(path, key, sections, symbols, addresses))
+						++failed;
+				}
+			});
+		}
+		for(auto& writer : writers)
+			writer.join();
+		REQUIRE(failed == 0);
+
+		const sidecar_t sidecar{path, key};
+		REQUIRE(sidecar.valid());
+		REQUIRE(sidecar.symbols().size() == symbols.size());
+		REQUIRE(sidecar.symbol_name(*sidecar.find_symbol(0x1080)) == "label");
+		/* Nothing left behind by any of them */
+		for(const auto& entry : fs::directory_iterator{path.parent_path()})
+			REQUIRE(entry.path().filename().string().rfind(path.filename().string() + ".tmp.", 0) != 0);
+	}
+
+	SECTION( "Missing" ) {
+		REQUIRE_FALSE(sidecar_t{path.string() + ".missing", key}.valid());
+	}
+
+	fs::remove(path);
+}
+
+TEMPLATE_TEST_CASE( "ELF Sidecar", "[elf][sidecar]", elf_types_32_t, elf_types_64_t ) {
+	using symbol_t = typename TestType::symbol_t;
+	using shflags_t = typename TestType::shflags_t;
+
+	elf_image_t<TestType> image{};
+	image.type = elf_type_t::Executable;
+
+	std::vector<uint8_t> build_id{};
+	const typename TestType::nhdr_t nhdr{4U, 8U, uint32_t(elf_note_type_t::GNUBuildID)};
+	const auto* header = reinterpret_cast<const uint8_t*>(&nhdr); // lgtm[cpp/reinterpret-cast]
+	build_id.insert(build_id.end(), header, header + sizeof(nhdr));
+	build_id.insert(build_id.end(), {'G', 'N', 'U', '\0', 0xDEU, 0xADU, 0xBEU, 0xEFU, 0x01U, 0x23U, 0x45U, 0x67U});
+	const auto id_index = image.add_section(".note.gnu.build-id", elf_shtype_t::Note, build_id, shflags_t::Alloc);
+	image.sections[id_index].header.addraline(4);
+	image.add_segment(elf_phdr_type_t::Note, elf_phdr_flags_t::Read, id_index, id_index);
+	image.segments.back().header.align(4);
+
+	const auto text = image.add_section(".text", elf_shtype_t::ProgBits, nullptr, 0x100,
+		shflags_t::Alloc | shflags_t::ExecInstr, 0x401000);
+	image.add_segment(elf_phdr_type_t::Load, elf_phdr_flags_t::Read, text, text);
+
+	std::string strtab{std::string(1, '\0')};
+	const auto make_symbol = [&](const std::string& name, const uint64_t value, const uint64_t size) {
+		symbol_t symbol{};
+		symbol.name(uint32_t(strtab.size()));
+		strtab += name + '\0';
+		symbol.value(typename TestType::addr_t(value));
+		symbol.size(typename TestType::xword_t(size));
+		symbol.info(symbol_t::make_info(uint8_t(elf_symbol_binding_t::Global), uint8_t(elf_symbol_type_t::Function)));
+		symbol.shndx(uint16_t(text));
+		return symbol;
+	};
+	std::vector<symbol_t> symbols{
+		symbol_t{},
+		make_symbol("main", 0x401000, 0x20),
+		make_symbol("helper", 0x401040, 0x10),
+	};
+	const auto strtab_index = image.add_section(".strtab", elf_shtype_t::StringTable,
+		strtab.data(), strtab.size());
+	image.add_section(".symtab", elf_shtype_t::SymbolTable, symbols, shflags_t::None,
+		0, uint32_t(strtab_index), 1, sizeof(symbol_t));
+	const auto path = image.write("sidecar");
+	const fs::path cache_dir{fs::temp_directory_path() / "sns-test-sidecar-cache"};
+
+	{
+		const elf_t<TestType> elf{path};
+		REQUIRE(elf.valid());
+		REQUIRE(elf.save_sidecar());
+		REQUIRE(elf.save_sidecar(cache_dir));
+	}
+	REQUIRE(fs::exists(fs::path{path.string() + ".sns-index"}));
+	REQUIRE(fs::exists(cache_dir / "deadbeef01234567.sns-index"));
+
+	const auto check = [&](const sidecar_t& sidecar) {
+		REQUIRE(sidecar.valid());
+		REQUIRE(sidecar.find_section(".text") == text);
+		REQUIRE(sidecar.find_section(".symtab") != 0);
+		REQUIRE(sidecar.symbol_name(*sidecar.find_symbol(0x401010)) == "main");
+		REQUIRE(sidecar.symbol_name(*sidecar.find_symbol(0x40104F)) == "helper");
+		REQUIRE(sidecar.find_symbol(0x401020) == nullptr);
+		REQUIRE(sidecar.to_offset(0x401010) != sidecar_t::npos);
+		REQUIRE(sidecar.to_offset(0x402000) == sidecar_t::npos);
+	};
+	check(open_sidecar(path));
+	check(open_sidecar(path, cache_dir));
+
+	/* Keyed on the build-id, so a copy shares the cached one */
+	const fs::path copy{path.string() + "-copy"};
+	fs::copy_file(path, copy, fs::copy_options::overwrite_existing);
+	check(open_sidecar(copy, cache_dir));
+	REQUIRE_FALSE(open_sidecar(copy).valid());
+
+	fs::remove(copy);
+	fs::remove(fs::path{path.string() + ".sns-index"});
+	fs::remove_all(cache_dir);
+	fs::remove(path);
+}
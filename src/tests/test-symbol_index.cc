@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <symbol_index.hh>
+
+static symbol_entry_t test_symbol(const char* name, const uint64_t address, const uint64_t size,
+	const uint8_t binding = 1, const uint8_t type = 2) {
+	return {address, size, name, 1, 0, binding, type};
+}
+
+/* What the index should be doing, the slow way */
+static const symbol_entry_t* brute_force(const std::vector<symbol_entry_t>& symbols, const uint64_t address) {
+	const symbol_entry_t* best{nullptr};
+	for(const auto& symbol : symbols) {
+		if(!symbol.contains(address))
+			continue;
+		/* Innermost wins */
+		if(best == nullptr || symbol.address > best->address)
+			best = &symbol;
+	}
+	return best;
+}
+
+TEST_CASE( "Symbol index", "[symbol_index]" ) {
+	SECTION( "Empty" ) {
+		symbol_index_t index{};
+		REQUIRE(index.empty());
+		REQUIRE(index.find(0x1000) == nullptr);
+	}
+
+	SECTION( "Containment" ) {
+		symbol_index_t index{{
+			test_symbol("object", 0x2000, 8, 1, 1),
+			test_symbol("function_alias", 0x1000, 0x100, 2),
+			test_symbol("label", 0x1080, 0, 0, 0),
+			test_symbol("function", 0x1000, 0x100),
+			test_symbol("unsized", 0x3000, 0),
+		}};
+		REQUIRE(index.size() == 4);
+
+		REQUIRE(index.find(0x0FFF) == nullptr);
+		REQUIRE(index.find(0x1000)->name == "function");
+		REQUIRE(index.find(0x10FF)->name == "function");
+		REQUIRE(index.find(0x1100) == nullptr);
+		/* Nested inside of function */
+		REQUIRE(index.find(0x1080)->name == "label");
+		REQUIRE(index.find(0x1081)->name == "function");
+		REQUIRE(index.find(0x2007)->name == "object");
+		REQUIRE(index.find(0x2008) == nullptr);
+		REQUIRE(index.find(0x3000)->name == "unsized");
+		REQUIRE(index.find(0x3001) == nullptr);
+	}
+
+	SECTION( "Aliases keep the best name and the largest size" ) {
+		symbol_index_t index{{
+			test_symbol("local", 0x1000, 0x10, 0),
+			test_symbol("weak", 0x1000, 0x40, 2),
+			test_symbol("unsized_global", 0x1000, 0),
+		}};
+		REQUIRE(index.size() == 1);
+		REQUIRE(index.find(0x1000)->name == "weak");
+		REQUIRE(index.find(0x103F)->name == "weak");
+	}
+
+	SECTION( "Matches a linear scan" ) {
+		std::mt19937_64 rng{0x5A5A5A5AU};
+		std::vector<symbol_entry_t> symbols{};
+		uint64_t address{0x400000};
+		for(size_t idx{}; idx < 20000; ++idx) {
+			address += 1 + (rng() % 64);
+			const uint64_t size{(rng() % 4 == 0) ? 0 : (rng() % 48) + 1};
+			symbols.push_back(test_symbol("sym", address, size));
+			address += size;
+		}
+		std::vector<symbol_entry_t> shuffled{symbols};
+		std::shuffle(shuffled.begin(), shuffled.end(), rng);
+		symbol_index_t index{shuffled, 4};
+		REQUIRE(index.size() == symbols.size());
+
+		std::vector<uint64_t> addresses(4099);
+		for(auto& addr : addresses)
+			addr = 0x400000 - 16 + (rng() % (address - 0x400000 + 32));
+		std::vector<const symbol_entry_t*> batch(addresses.size());
+		index.find(addresses.data(), addresses.size(), batch.data());
+
+		for(size_t idx{}; idx < addresses.size(); ++idx) {
+			const auto* expected = brute_force(symbols, addresses[idx]);
+			const auto* found = index.find(addresses[idx]);
+			REQUIRE((found == nullptr) == (expected == nullptr));
+			if(found != nullptr)
+				REQUIRE(found->address == expected->address);
+			REQUIRE(batch[idx] == found);
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <type_traits>
 #include <algorithm>
+#include <array>
 #include <string>
 #include <vector>
 
@@ -179,3 +180,49 @@ TEST_CASE( "Enum and string mapping", "[utility]" ) {
 	REQUIRE(enum_name(flags_s, Flags::Quux) == std::string{"Quux"});
 	REQUIRE(enum_value(flags_s, "Quux") == Flags::Quux);
 }
+
+TEST_CASE( "Parallel for", "[utility]" ) {
+	std::vector<std::atomic<uint32_t>> hits(1000);
+	parallel_for(hits.size(), [&](const size_t idx) { ++hits[idx]; }, 4);
+	REQUIRE(std::all_of(hits.begin(), hits.end(), [](const std::atomic<uint32_t>& hit) { return hit == 1; }));
+
+	size_t calls{};
+	parallel_for(0, [&](const size_t) { ++calls; });
+	REQUIRE(calls == 0);
+}
+
+TEST_CASE( "LEB128", "[utility]" ) {
+	const std::array<uint8_t, 13> data{{
+		0x02U, 0xE5U, 0x8EU, 0x26U, 0x7FU, 0x80U, 0x7FU,
+		0xC0U, 0xBBU, 0x78U, 0x80U, 0x80U, 0x80U
+	}};
+	size_t pos{};
+	uint64_t value{};
+	REQUIRE(read_uleb128(data.data(), data.size(), pos, value));
+	REQUIRE(value == 2U);
+	REQUIRE(read_uleb128(data.data(), data.size(), pos, value));
+	REQUIRE(value == 624485U);
+	REQUIRE(pos == 4U);
+
+	int64_t signed_value{};
+	REQUIRE(read_sleb128(data.data(), data.size(), pos, signed_value));
+	REQUIRE(signed_value == -1);
+	REQUIRE(read_sleb128(data.data(), data.size(), pos, signed_value));
+	REQUIRE(signed_value == -128);
+	REQUIRE(read_sleb128(data.data(), data.size(), pos, signed_value));
+	REQUIRE(signed_value == -123456);
+	REQUIRE(pos == 10U);
+
+	/* Runs off the end and leaves pos alone */
+	REQUIRE_FALSE(read_uleb128(data.data(), data.size(), pos, value));
+	REQUIRE(pos == 10U);
+
+	const std::array<uint8_t, 11> overlong{{
+		0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0x7FU, 0x00U
+	}};
+	pos = 0;
+	REQUIRE_FALSE(read_uleb128(overlong.data(), overlong.size(), pos, value));
+	pos = 0;
+	REQUIRE(read_sleb128(overlong.data(), overlong.size(), pos, signed_value));
+	REQUIRE(signed_value == -1);
+}
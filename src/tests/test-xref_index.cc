@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <xref_index.hh>
+
+static xref_t test_xref(const uint32_t target, const uint64_t offset, const uint32_t from = xref_index_t::npos) {
+	return {target, {offset, 1, 2, 3, from}};
+}
+
+TEST_CASE( "Xref index", "[xref_index]" ) {
+	SECTION( "Empty" ) {
+		xref_index_t index{};
+		REQUIRE(index.empty());
+		REQUIRE(index.references(0).size() == 0);
+		REQUIRE(index.referenced(0).size() == 0);
+		REQUIRE(index.reachable({0}).empty());
+	}
+
+	SECTION( "References" ) {
+		/* 0 calls 1 twice and 2, 1 calls 3, 4 calls 0, and 5 is referenced from nowhere */
+		const xref_index_t index{6, {
+			{test_xref(1, 0x10, 0), test_xref(2, 0x14, 0), test_xref(1, 0x18, 0)},
+			{},
+			{test_xref(3, 0x20, 1), test_xref(0, 0x40, 4), test_xref(5, 0x50), test_xref(9, 0x60, 0)},
+		}};
+		REQUIRE(index.nodes() == 6);
+		/* The one past the end is dropped */
+		REQUIRE(index.size() == 6);
+
+		const auto one = index.references(1);
+		REQUIRE(one.size() == 2);
+		REQUIRE(one[0].offset == 0x10);
+		REQUIRE(one[1].offset == 0x18);
+		REQUIRE(one[0].from == 0);
+		REQUIRE(one[0].type == 3);
+		REQUIRE(index.references(4).size() == 0);
+		REQUIRE(index.references(5)[0].from == xref_index_t::npos);
+		REQUIRE(index.references(6).size() == 0);
+
+		const auto called = index.referenced(0);
+		REQUIRE(called.size() == 2);
+		REQUIRE(called[0] == 1);
+		REQUIRE(called[1] == 2);
+		REQUIRE(index.referenced(5).size() == 0);
+
+		REQUIRE(index.reachable({0}) == std::vector<uint32_t>{0, 1, 2, 3});
+		REQUIRE(index.reachable({4}) == std::vector<uint32_t>{0, 1, 2, 3, 4});
+		REQUIRE(index.reachable({5, 5, 42}) == std::vector<uint32_t>{5});
+	}
+
+	SECTION( "Matches brute force" ) {
+		constexpr uint32_t nodes{257};
+		std::mt19937 rng{0x5EED};
+		std::uniform_int_distribution<uint32_t> node{0, nodes - 1U};
+		std::vector<std::vector<xref_t>> references(7);
+		std::vector<xref_t> all{};
+		for(auto& chunk : references) {
+			const size_t count{node(rng) * 4U};
+			for(size_t idx{}; idx < count; ++idx) {
+				chunk.push_back(test_xref(node(rng), all.size(), (idx % 5U) ? node(rng) : xref_index_t::npos));
+				all.push_back(chunk.back());
+			}
+		}
+		const xref_index_t index{nodes, references};
+		REQUIRE(index.size() == all.size());
+
+		std::vector<std::vector<uint32_t>> edges(nodes);
+		for(uint32_t target{}; target < nodes; ++target) {
+			std::vector<uint64_t> expected{};
+			for(const auto& reference : all) {
+				if(reference.target == target)
+					expected.push_back(reference.site.offset);
+				if(reference.site.from == target)
+					edges[target].push_back(reference.target);
+			}
+			const auto sites = index.references(target);
+			REQUIRE(sites.size() == expected.size());
+			for(size_t idx{}; idx < expected.size(); ++idx)
+				REQUIRE(sites[idx].offset == expected[idx]);
+
+			std::sort(edges[target].begin(), edges[target].end());
+			edges[target].erase(std::unique(edges[target].begin(), edges[target].end()), edges[target].end());
+			const auto referenced = index.referenced(target);
+			REQUIRE(std::vector<uint32_t>(referenced.data(), referenced.data() + referenced.size()) == edges[target]);
+		}
+
+		std::vector<uint8_t> seen(nodes);
+		std::vector<uint32_t> stack{7};
+		seen[7] = 1U;
+		while(!stack.empty()) {
+			const uint32_t current{stack.back()};
+			stack.pop_back();
+			for(const uint32_t target : edges[current]) {
+				if(!seen[target]) {
+					seen[target] = 1U;
+					stack.push_back(target);
+				}
+			}
+		}
+		std::vector<uint32_t> expected{};
+		for(uint32_t idx{}; idx < nodes; ++idx) {
+			if(seen[idx])
+				expected.push_back(idx);
+		}
+		REQUIRE(index.reachable({7}) == expected);
+	}
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 
 #include <catch2/catch.hpp>
 
@@ -94,6 +95,16 @@ TEST_CASE( "zlib Compression", "[zlib]" ) {
 	// // dump_hex(output_buffer, out);
 
 	// REQUIRE(out == zlib_uncompressed_size);
+
+	SECTION( "Whole buffer" ) {
+		auto compressed = zlib_t::deflate_buffer(reinterpret_cast<const uint8_t*>(zlib_uncompressed), zlib_uncompressed_size);
+		REQUIRE(compressed.size() > 0);
+		REQUIRE(compressed.size() < zlib_uncompressed_size);
+
+		std::array<uint8_t, zlib_uncompressed_size> output{};
+		REQUIRE(zlib_t::inflate_buffer(compressed.data(), compressed.size(), output.data(), output.size()));
+		REQUIRE(std::memcmp(output.data(), zlib_uncompressed, zlib_uncompressed_size) == 0);
+	}
 }
 
 TEST_CASE( "zlib Decompression", "[zlib]" ) {
@@ -104,4 +115,75 @@ TEST_CASE( "zlib Decompression", "[zlib]" ) {
 	// // dump_hex(output_buffer, out);
 
 	// REQUIRE(out == zlib_compressed_size);
+
+	SECTION( "Whole buffer" ) {
+		std::array<uint8_t, zlib_uncompressed_size> output{};
+		REQUIRE(zlib_t::inflate_buffer(zlib_compressed, zlib_compressed_size, output.data(), output.size()));
+		REQUIRE(std::memcmp(output.data(), zlib_uncompressed, zlib_uncompressed_size) == 0);
+	}
+
+	SECTION( "Whole buffer size mismatch" ) {
+		std::array<uint8_t, zlib_uncompressed_size + 1> larger{};
+		REQUIRE_FALSE(zlib_t::inflate_buffer(zlib_compressed, zlib_compressed_size, larger.data(), larger.size()));
+		std::array<uint8_t, zlib_uncompressed_size - 1> smaller{};
+		REQUIRE_FALSE(zlib_t::inflate_buffer(zlib_compressed, zlib_compressed_size, smaller.data(), smaller.size()));
+	}
+
+	SECTION( "Whole buffer truncated input" ) {
+		std::array<uint8_t, zlib_uncompressed_size> output{};
+		REQUIRE_FALSE(zlib_t::inflate_buffer(zlib_compressed, zlib_compressed_size / 2, output.data(), output.size()));
+	}
+}
+
+/* Whatever is doing the whole buffer work has to interoperate with stock zlib */
+TEST_CASE( "zlib Backend compatibility", "[zlib]" ) {
+	std::vector<uint8_t> input{};
+	for(size_t idx{}; idx < 64; ++idx) {
+		input.insert(input.end(), zlib_uncompressed, zlib_uncompressed + zlib_uncompressed_size);
+		input.push_back(uint8_t(idx));
+	}
+
+	SECTION( "Backend output inflates with zlib" ) {
+		const auto compressed = zlib_t::deflate_buffer(input.data(), input.size());
+		REQUIRE(compressed.size() > 0);
+
+		std::vector<uint8_t> output(input.size());
+		uLongf output_len{uLongf(output.size())};
+		REQUIRE(::uncompress(output.data(), &output_len, compressed.data(), uLong(compressed.size())) == Z_OK);
+		REQUIRE(output_len == input.size());
+		REQUIRE(output == input);
+	}
+
+	SECTION( "zlib output inflates with the backend" ) {
+		for(const int32_t level : {Z_BEST_SPEED, Z_DEFAULT_COMPRESSION, Z_BEST_COMPRESSION}) {
+			std::vector<uint8_t> compressed(::compressBound(uLong(input.size())));
+			uLongf compressed_len{uLongf(compressed.size())};
+			REQUIRE(::compress2(compressed.data(), &compressed_len, input.data(), uLong(input.size()), level) == Z_OK);
+
+			std::vector<uint8_t> output(input.size());
+			REQUIRE(zlib_t::inflate_buffer(compressed.data(), compressed_len, output.data(), output.size()));
+			REQUIRE(output == input);
+		}
+	}
+
+	SECTION( "Checksums" ) {
+		const auto* check = reinterpret_cast<const uint8_t*>("123456789");
+		REQUIRE(zlib_t::crc32(check, 9) == 0xCBF43926U);
+		REQUIRE(zlib_t::adler32(check, 9) == 0x091E01DEU);
+
+		REQUIRE(zlib_t::adler32(input.data(), input.size()) ==
+			uint32_t(::adler32(1U, input.data(), uInt(input.size()))));
+		REQUIRE(zlib_t::crc32(input.data(), input.size()) ==
+			uint32_t(::crc32(0U, input.data(), uInt(input.size()))));
+	}
+
+	SECTION( "Running checksums" ) {
+		const size_t split{input.size() / 3};
+		const uint32_t adler{zlib_t::adler32(input.data() + split, input.size() - split,
+			zlib_t::adler32(input.data(), split))};
+		const uint32_t crc{zlib_t::crc32(input.data() + split, input.size() - split,
+			zlib_t::crc32(input.data(), split))};
+		REQUIRE(adler == zlib_t::adler32(input.data(), input.size()));
+		REQUIRE(crc == zlib_t::crc32(input.data(), input.size()));
+	}
 }
@@ -24,3 +24,38 @@ uint64_t _sns_bswap64(const uint64_t x) noexcept {
 	        ((x & 0x00FF000000000000U) >> 40U) |
 	        ((x & 0xFF00000000000000U) >> 56U));
 }
+
+bool read_uleb128(const uint8_t* const data, const size_t len, size_t& pos, uint64_t& value) noexcept {
+	uint64_t result{};
+	for(size_t offset{pos}, shift{}; offset < len; ++offset, shift += 7U) {
+		const uint8_t byte{data[offset]};
+		if(shift >= 64U || (shift == 63U && (byte & 0x7EU) != 0))
+			return false;
+		result |= uint64_t(byte & 0x7FU) << shift;
+		if((byte & 0x80U) == 0) {
+			pos = offset + 1U;
+			value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool read_sleb128(const uint8_t* const data, const size_t len, size_t& pos, int64_t& value) noexcept {
+	uint64_t result{};
+	for(size_t offset{pos}, shift{}; offset < len; ++offset, shift += 7U) {
+		const uint8_t byte{data[offset]};
+		if(shift >= 64U)
+			return false;
+		result |= uint64_t(byte & 0x7FU) << shift;
+		if((byte & 0x80U) == 0) {
+			/* Sign extend from the last bit read */
+			if(shift + 7U < 64U && (byte & 0x40U) != 0)
+				result |= ~uint64_t{} << (shift + 7U);
+			pos = offset + 1U;
+			value = int64_t(result);
+			return true;
+		}
+	}
+	return false;
+}
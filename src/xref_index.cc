@@ -0,0 +1,101 @@
+/* xref_index.cc - Who references what, inverted from relocations */
+#include <xref_index.hh>
+
+#include <algorithm>
+
+xref_index_t::xref_index_t(const size_t nodes, const std::vector<std::vector<xref_t>>& references) :
+	_site_rows{}, _sites{}, _edge_rows{}, _edges{} {
+
+	size_t total{};
+	for(const auto& chunk : references)
+		total += chunk.size();
+	if(nodes >= npos || total >= npos)
+		return;
+
+	/* Counts first, shifted up one so the prefix sum leaves each row's start behind */
+	_site_rows.assign(nodes + 1U, 0U);
+	_edge_rows.assign(nodes + 1U, 0U);
+	for(const auto& chunk : references) {
+		for(const auto& reference : chunk) {
+			if(reference.target >= nodes)
+				continue;
+			++_site_rows[reference.target + 1U];
+			if(reference.site.from < nodes)
+				++_edge_rows[reference.site.from + 1U];
+		}
+	}
+	for(size_t node{}; node < nodes; ++node) {
+		_site_rows[node + 1U] += _site_rows[node];
+		_edge_rows[node + 1U] += _edge_rows[node];
+	}
+
+	_sites.resize(_site_rows[nodes]);
+	_edges.resize(_edge_rows[nodes]);
+	std::vector<uint32_t> next_site(_site_rows.begin(), _site_rows.end() - 1);
+	std::vector<uint32_t> next_edge(_edge_rows.begin(), _edge_rows.end() - 1);
+	for(const auto& chunk : references) {
+		for(const auto& reference : chunk) {
+			if(reference.target >= nodes)
+				continue;
+			auto& site = _sites[next_site[reference.target]++];
+			site = reference.site;
+			if(site.from < nodes)
+				_edges[next_edge[site.from]++] = reference.target;
+			else
+				site.from = npos;
+		}
+	}
+
+	/* A function calling the same thing a dozen times is one edge */
+	uint32_t kept{};
+	for(size_t node{}; node < nodes; ++node) {
+		uint32_t* const first{_edges.data() + _edge_rows[node]};
+		uint32_t* const last{_edges.data() + _edge_rows[node + 1U]};
+		std::sort(first, last);
+		_edge_rows[node] = kept;
+		for(uint32_t* edge{first}; edge != last; ++edge) {
+			if(edge == first || *edge != *(edge - 1))
+				_edges[kept++] = *edge;
+		}
+	}
+	_edge_rows[nodes] = kept;
+	_edges.resize(kept);
+	_edges.shrink_to_fit();
+}
+
+span<const xref_site_t> xref_index_t::references(const uint32_t node) const noexcept {
+	if(node >= nodes())
+		return {};
+	return {_sites.data() + _site_rows[node], size_t(_site_rows[node + 1U] - _site_rows[node])};
+}
+
+span<const uint32_t> xref_index_t::referenced(const uint32_t node) const noexcept {
+	if(node >= nodes())
+		return {};
+	return {_edges.data() + _edge_rows[node], size_t(_edge_rows[node + 1U] - _edge_rows[node])};
+}
+
+std::vector<uint32_t> xref_index_t::reachable(const std::vector<uint32_t>& roots) const {
+	std::vector<uint8_t> seen(nodes());
+	std::vector<uint32_t> found{};
+	for(const uint32_t root : roots) {
+		if(root < seen.size() && !seen[root]) {
+			seen[root] = 1U;
+			found.push_back(root);
+		}
+	}
+
+	/* `found` doubles as the queue */
+	for(size_t idx{}; idx < found.size(); ++idx) {
+		const uint32_t node{found[idx]};
+		for(uint32_t edge{_edge_rows[node]}; edge < _edge_rows[node + 1U]; ++edge) {
+			const uint32_t target{_edges[edge]};
+			if(!seen[target]) {
+				seen[target] = 1U;
+				found.push_back(target);
+			}
+		}
+	}
+	std::sort(found.begin(), found.end());
+	return found;
+}
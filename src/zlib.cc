@@ -2,7 +2,223 @@
 
 #include <zlib.hh>
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <cstdio>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 
+/* z_stream only takes 32-bit lengths, so big sections get fed in pieces */
+static constexpr size_t max_chunk{std::numeric_limits<uInt>::max()};
+
+static void refill(uInt& avail, size_t& left) noexcept {
+	if(avail == 0 && left > 0) {
+		avail = uInt(std::min(left, max_chunk));
+		left -= avail;
+	}
+}
+
+bool zlib_t::inflate_buffer(const uint8_t* input, const size_t input_len,
+	uint8_t* output, const size_t output_len) noexcept {
+	return zlib_backend_t::inflate(input, input_len, output, output_len);
+}
+
+std::vector<uint8_t> zlib_t::deflate_buffer(const uint8_t* input, const size_t input_len,
+	const int32_t level) {
+	return zlib_backend_t::deflate(input, input_len, level);
+}
+
+bool zlib_t::inflate_buffer(const uint8_t* input, const size_t input_len,
+	uint8_t* output, const size_t output_len, const uint8_t* dictionary,
+	const size_t dictionary_len) noexcept {
+
+	z_stream stream{};
+	if(::inflateInit(&stream) != Z_OK)
+		return false;
+
+	stream.next_in = const_cast<uint8_t*>(input); // lgtm[cpp/const-cast]
+	stream.next_out = output;
+	size_t input_left{input_len};
+	size_t output_left{output_len};
+	int32_t result{Z_OK};
+
+	while(result == Z_OK) {
+		refill(stream.avail_in, input_left);
+		refill(stream.avail_out, output_left);
+		result = ::inflate(&stream, Z_NO_FLUSH);
+		/* The stream tells us the adler32 of the dictionary it wants */
+		if(result == Z_NEED_DICT) {
+			if(dictionary_len == 0 || dictionary_len > max_dictionary ||
+				stream.adler != adler32(dictionary, dictionary_len))
+				break;
+			result = ::inflateSetDictionary(&stream, dictionary, uInt(dictionary_len));
+		}
+	}
+
+	const bool complete{result == Z_STREAM_END && stream.avail_out == 0 && output_left == 0};
+	::inflateEnd(&stream);
+	return complete;
+}
+
+std::vector<uint8_t> zlib_t::deflate_buffer(const uint8_t* input, const size_t input_len,
+	const uint8_t* dictionary, const size_t dictionary_len, const int32_t level) {
+
+	if(dictionary_len > max_dictionary)
+		return {};
+
+	z_stream stream{};
+	if(::deflateInit(&stream, level) != Z_OK)
+		return {};
+
+	if(dictionary_len != 0 &&
+		::deflateSetDictionary(&stream, dictionary, uInt(dictionary_len)) != Z_OK) {
+		::deflateEnd(&stream);
+		return {};
+	}
+
+	/* The bound doesn't account for the 4 byte dictionary ID in the header */
+	std::vector<uint8_t> output(::deflateBound(&stream, uLong(input_len)) + 4U);
+
+	stream.next_in = const_cast<uint8_t*>(input); // lgtm[cpp/const-cast]
+	stream.next_out = output.data();
+	size_t input_left{input_len};
+	size_t output_left{output.size()};
+	int32_t result{Z_OK};
+
+	while(result == Z_OK) {
+		refill(stream.avail_in, input_left);
+		refill(stream.avail_out, output_left);
+		result = ::deflate(&stream, (input_left == 0) ? Z_FINISH : Z_NO_FLUSH);
+	}
+
+	output.resize((result == Z_STREAM_END) ? stream.total_out : 0);
+	::deflateEnd(&stream);
+	return output;
+}
+
+uint32_t zlib_t::dictionary_id(const uint8_t* input, const size_t input_len) noexcept {
+	/* CMF, FLG with FDICT set, then the big-endian DICTID */
+	if(input_len < 6 || (input[0] & 0x0FU) != Z_DEFLATED || (input[1] & 0x20U) == 0 ||
+		((uint32_t(input[0]) << 8U) | input[1]) % 31U != 0)
+		return 0;
+	return (uint32_t(input[2]) << 24U) | (uint32_t(input[3]) << 16U) |
+		(uint32_t(input[4]) << 8U) | uint32_t(input[5]);
+}
+
+/*
+	zlib has no trainer of its own, a preset dictionary is just history the
+	window starts out with. So we look for content that shows up across as
+	many samples as possible: every 8 byte string is counted once per sample
+	it appears in, and the samples are then cut into segments which are
+	scored by how much of that shared content they carry. Segments are taken
+	greedily, only counting strings no earlier pick already covers, with the
+	best ones placed at the end of the dictionary where matches are cheapest.
+*/
+std::vector<uint8_t> zlib_t::train_dictionary(const std::vector<span<const uint8_t>>& samples,
+	size_t capacity) {
+
+	constexpr size_t kmer_len{sizeof(uint64_t)};
+	constexpr size_t segment_len{64};
+	capacity = std::min(capacity, max_dictionary);
+
+	const auto kmer_at = [](const uint8_t* data) noexcept {
+		uint64_t kmer{};
+		std::memcpy(&kmer, data, kmer_len);
+		return kmer;
+	};
+
+	std::unordered_map<uint64_t, uint32_t> frequency{};
+	for(const auto& sample : samples) {
+		if(sample.size() < kmer_len)
+			continue;
+		std::unordered_set<uint64_t> seen{};
+		for(size_t idx{}; idx + kmer_len <= sample.size(); ++idx) {
+			const uint64_t kmer{kmer_at(sample.data() + idx)};
+			if(seen.insert(kmer).second)
+				++frequency[kmer];
+		}
+	}
+
+	struct segment_t final {
+		const uint8_t* data;
+		size_t len;
+		uint64_t score;
+	};
+
+	/* Only strings in at least two samples are worth anything */
+	const auto score = [&](const uint8_t* data, const size_t len,
+		const std::unordered_set<uint64_t>* covered) {
+		std::unordered_set<uint64_t> seen{};
+		uint64_t total{};
+		for(size_t idx{}; idx + kmer_len <= len; ++idx) {
+			const uint64_t kmer{kmer_at(data + idx)};
+			if((covered != nullptr && covered->count(kmer) != 0) || !seen.insert(kmer).second)
+				continue;
+			total += frequency[kmer] - 1U;
+		}
+		return total;
+	};
+
+	std::vector<segment_t> segments{};
+	std::unordered_set<std::string_view> unique{};
+	for(const auto& sample : samples) {
+		for(size_t offset{}; offset + kmer_len <= sample.size(); offset += segment_len) {
+			const uint8_t* data{sample.data() + offset};
+			const size_t len{std::min(segment_len, sample.size() - offset)};
+			if(!unique.emplace(reinterpret_cast<const char*>(data), len).second) // lgtm[cpp/reinterpret-cast]
+				continue;
+			const uint64_t total{score(data, len, nullptr)};
+			if(total != 0)
+				segments.push_back({data, len, total});
+		}
+	}
+
+	std::stable_sort(segments.begin(), segments.end(),
+		[](const segment_t& a, const segment_t& b) noexcept { return a.score > b.score; });
+
+	std::vector<const segment_t*> chosen{};
+	std::unordered_set<uint64_t> covered{};
+	size_t used{};
+	for(const auto& segment : segments) {
+		if(used + segment.len > capacity)
+			continue;
+		/* Mostly redundant with what we've already got */
+		if(score(segment.data, segment.len, &covered) * 2U < segment.score)
+			continue;
+
+		for(size_t idx{}; idx + kmer_len <= segment.len; ++idx)
+			covered.insert(kmer_at(segment.data + idx));
+		chosen.push_back(&segment);
+		used += segment.len;
+	}
+
+	std::vector<uint8_t> dictionary{};
+	dictionary.reserve(used);
+	for(auto segment = chosen.rbegin(); segment != chosen.rend(); ++segment)
+		dictionary.insert(dictionary.end(), (*segment)->data, (*segment)->data + (*segment)->len);
+	return dictionary;
+}
+
+static constexpr std::array<uint8_t, 4> gnu_magic{{'Z', 'L', 'I', 'B'}};
+
+bool zlib_t::read_gnu_header(const uint8_t* data, const size_t len, uint64_t& size) noexcept {
+	if(len < gnu_header_size || std::memcmp(data, gnu_magic.data(), gnu_magic.size()) != 0)
+		return false;
+
+	size = 0;
+	for(size_t idx{gnu_magic.size()}; idx < gnu_header_size; ++idx)
+		size = (size << 8U) | data[idx];
+	return true;
+}
+
+void zlib_t::write_gnu_header(uint8_t* data, uint64_t size) noexcept {
+	std::memcpy(data, gnu_magic.data(), gnu_magic.size());
+	for(size_t idx{gnu_header_size}; idx > gnu_magic.size(); --idx) {
+		data[idx - 1] = uint8_t(size & 0xFFU);
+		size >>= 8U;
+	}
+}
@@ -0,0 +1,118 @@
+/* zlib_backend.cc - Whole buffer deflate backend selection */
+
+#include <zlib_backend.hh>
+
+#include <algorithm>
+#include <memory>
+
+#if defined(SNS_ZLIB_LIBDEFLATE)
+#include <libdeflate.h>
+
+/* Decompressors are cheap to keep around but can't be shared across threads */
+struct decompressor_deleter_t final {
+	void operator()(libdeflate_decompressor* ctx) const noexcept { ::libdeflate_free_decompressor(ctx); }
+};
+struct compressor_deleter_t final {
+	void operator()(libdeflate_compressor* ctx) const noexcept { ::libdeflate_free_compressor(ctx); }
+};
+
+const char* zlib_backend_t::name() noexcept { return "libdeflate"; }
+
+bool zlib_backend_t::inflate(const uint8_t* input, const size_t input_len,
+	uint8_t* output, const size_t output_len) noexcept {
+
+	thread_local std::unique_ptr<libdeflate_decompressor, decompressor_deleter_t> ctx{
+		::libdeflate_alloc_decompressor()
+	};
+	if(!ctx)
+		return false;
+
+	/* Without somewhere to put the actual size, anything short of exact is an error */
+	return ::libdeflate_zlib_decompress(ctx.get(), input, input_len,
+		output, output_len, nullptr) == LIBDEFLATE_SUCCESS;
+}
+
+std::vector<uint8_t> zlib_backend_t::deflate(const uint8_t* input, const size_t input_len,
+	const int32_t level) {
+
+	/* libdeflate goes up to 12, but the zlib levels mean roughly the same thing */
+	std::unique_ptr<libdeflate_compressor, compressor_deleter_t> ctx{
+		::libdeflate_alloc_compressor((level < 0) ? 6 : std::min(level, 12))
+	};
+	if(!ctx)
+		return {};
+
+	std::vector<uint8_t> output(::libdeflate_zlib_compress_bound(ctx.get(), input_len));
+	output.resize(::libdeflate_zlib_compress(ctx.get(), input, input_len,
+		output.data(), output.size()));
+	return output;
+}
+
+uint32_t zlib_backend_t::adler32(const uint32_t adler, const uint8_t* data, const size_t len) noexcept {
+	return ::libdeflate_adler32(adler, data, len);
+}
+
+uint32_t zlib_backend_t::crc32(const uint32_t crc, const uint8_t* data, const size_t len) noexcept {
+	return ::libdeflate_crc32(crc, data, len);
+}
+
+#elif defined(SNS_ZLIB_NG)
+#include <zlib-ng.h>
+
+const char* zlib_backend_t::name() noexcept { return "zlib-ng"; }
+
+bool zlib_backend_t::inflate(const uint8_t* input, const size_t input_len,
+	uint8_t* output, const size_t output_len) noexcept {
+
+	/* The native API takes size_t lengths, so there's no need to chunk */
+	size_t consumed{input_len};
+	size_t produced{output_len};
+	if(::zng_uncompress2(output, &produced, input, &consumed) != Z_OK)
+		return false;
+	return produced == output_len;
+}
+
+std::vector<uint8_t> zlib_backend_t::deflate(const uint8_t* input, const size_t input_len,
+	const int32_t level) {
+
+	std::vector<uint8_t> output(::zng_compressBound(input_len));
+	size_t produced{output.size()};
+	if(::zng_compress2(output.data(), &produced, input, input_len, level) != Z_OK)
+		return {};
+	output.resize(produced);
+	return output;
+}
+
+uint32_t zlib_backend_t::adler32(const uint32_t adler, const uint8_t* data, const size_t len) noexcept {
+	return ::zng_adler32_z(adler, data, len);
+}
+
+uint32_t zlib_backend_t::crc32(const uint32_t crc, const uint8_t* data, const size_t len) noexcept {
+	return ::zng_crc32_z(crc, data, len);
+}
+
+#else
+#include <zlib.hh>
+
+const char* zlib_backend_t::name() noexcept { return "zlib"; }
+
+/* Plain zlib is just the streaming path without a dictionary */
+bool zlib_backend_t::inflate(const uint8_t* input, const size_t input_len,
+	uint8_t* output, const size_t output_len) noexcept {
+	return zlib_t::inflate_buffer(input, input_len, output, output_len, nullptr, 0);
+}
+
+std::vector<uint8_t> zlib_backend_t::deflate(const uint8_t* input, const size_t input_len,
+	const int32_t level) {
+	return zlib_t::deflate_buffer(input, input_len, nullptr, 0, level);
+}
+
+uint32_t zlib_backend_t::adler32(const uint32_t adler, const uint8_t* data, const size_t len) noexcept {
+	return uint32_t(::adler32_z(adler, data, len));
+}
+
+uint32_t zlib_backend_t::crc32(const uint32_t crc, const uint8_t* data, const size_t len) noexcept {
+	return uint32_t(::crc32_z(crc, data, len));
+}
+
+#endif
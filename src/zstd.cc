@@ -0,0 +1,83 @@
+/* zstd.cc - Zstandard whole buffer compression */
+
+#include <zstd.hh>
+
+#if defined(SNS_WITH_ZSTD)
+#include <algorithm>
+#include <thread>
+
+#include <zdict.h>
+
+bool zstd_t::decompress_buffer(const uint8_t* input, const size_t input_len,
+	uint8_t* output, const size_t output_len) noexcept {
+
+	/* Takes care of multiple concatenated frames as well */
+	const size_t result{::ZSTD_decompress(output, output_len, input, input_len)};
+	return !::ZSTD_isError(result) && result == output_len;
+}
+
+std::vector<uint8_t> zstd_t::compress_buffer(const uint8_t* input, const size_t input_len,
+	const int32_t level, const uint32_t workers) {
+	return compress_buffer(input, input_len, nullptr, 0, level, workers);
+}
+
+bool zstd_t::decompress_buffer(const uint8_t* input, const size_t input_len, uint8_t* output,
+	const size_t output_len, const uint8_t* dictionary, const size_t dictionary_len) noexcept {
+
+	ZSTD_DCtx* ctx{::ZSTD_createDCtx()};
+	if(ctx == nullptr)
+		return false;
+
+	const size_t result{::ZSTD_decompress_usingDict(ctx, output, output_len, input, input_len,
+		dictionary, dictionary_len)};
+	::ZSTD_freeDCtx(ctx);
+	return !::ZSTD_isError(result) && result == output_len;
+}
+
+std::vector<uint8_t> zstd_t::compress_buffer(const uint8_t* input, const size_t input_len,
+	const uint8_t* dictionary, const size_t dictionary_len, const int32_t level, uint32_t workers) {
+
+	ZSTD_CCtx* ctx{::ZSTD_createCCtx()};
+	if(ctx == nullptr)
+		return {};
+
+	if(workers == 0 && input_len >= mt_threshold)
+		workers = std::max(std::thread::hardware_concurrency(), 1U);
+
+	::ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, level);
+	/* This fails if libzstd was built without threading, which is fine */
+	if(workers > 1)
+		::ZSTD_CCtx_setParameter(ctx, ZSTD_c_nbWorkers, int32_t(workers));
+
+	if(dictionary_len != 0 && ::ZSTD_isError(::ZSTD_CCtx_loadDictionary(ctx, dictionary, dictionary_len))) {
+		::ZSTD_freeCCtx(ctx);
+		return {};
+	}
+
+	std::vector<uint8_t> output(::ZSTD_compressBound(input_len));
+	const size_t result{::ZSTD_compress2(ctx, output.data(), output.size(), input, input_len)};
+	output.resize(::ZSTD_isError(result) ? 0 : result);
+	::ZSTD_freeCCtx(ctx);
+	return output;
+}
+
+std::vector<uint8_t> zstd_t::train_dictionary(const std::vector<span<const uint8_t>>& samples,
+	const size_t capacity) {
+
+	/* ZDICT wants everything back to back with a list of sizes */
+	std::vector<uint8_t> joined{};
+	std::vector<size_t> sizes{};
+	sizes.reserve(samples.size());
+	for(const auto& sample : samples) {
+		joined.insert(joined.end(), sample.data(), sample.data() + sample.size());
+		sizes.push_back(sample.size());
+	}
+
+	std::vector<uint8_t> dictionary(capacity);
+	const size_t result{::ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+		joined.data(), sizes.data(), uint32_t(sizes.size()))};
+	dictionary.resize(::ZDICT_isError(result) ? 0 : result);
+	return dictionary;
+}
+
+#endif /* SNS_WITH_ZSTD */